@@ -901,9 +901,11 @@ void ndDemoEntityManager::ShowMainMenuBar()
 			ImGui::RadioButton("default", &solverMode, ndWorld::ndStandardSolver);
 			ImGui::RadioButton("sse", &solverMode, ndWorld::ndSimdSoaSolver);
 			ImGui::RadioButton("avx2", &solverMode, ndWorld::ndSimdAvx2Solver);
+			ImGui::RadioButton("avx512", &solverMode, ndWorld::ndSimdAvx512Solver);
 			ImGui::RadioButton("cuda", &solverMode, ndWorld::ndCudaSolver);
 			ImGui::RadioButton("opencl1", &solverMode, ndWorld::ndOpenclSolver1);
 			ImGui::RadioButton("opencl2", &solverMode, ndWorld::ndOpenclSolver2);
+			ImGui::RadioButton("graph color", &solverMode, ndWorld::ndGraphColorSolver);
 
 			m_solverMode = ndWorld::ndSolverModes(solverMode);
 			ImGui::Separator();
@@ -70,7 +70,7 @@ class ndRegularProceduralGrid : public ndShapeStaticProceduralMesh
 		ndBodyKinematic::ndContactMap::Iterator it(contactJoints);
 		for (it.Begin(); it; it++)
 		{
-			const ndContact* const contact = it.GetNode()->GetInfo();
+			const ndContact* const contact = *it;
 			if (contact->IsActive())
 			{
 				ndBodyKinematic* const body0 = contact->GetBody0();
@@ -115,6 +115,7 @@ class ndBody : public ndContainersFreeListAlloc<ndBody>
 			ndUnsigned32 m_skeletonMark : 1;
 			ndUnsigned32 m_skeletonMark0 : 1;
 			ndUnsigned32 m_skeletonMark1 : 1;
+			ndUnsigned32 m_skeletonDirty : 1;
 			ndUnsigned32 m_contactTestOnly : 1;
 			ndUnsigned32 m_transformIsDirty : 1;
 			ndUnsigned32 m_equilibriumOverride : 1;
@@ -47,30 +47,65 @@ bool ndBodyKinematic::ndContactkey::operator== (const ndContactkey& key) const
 	return m_tag == key.m_tag;
 }
 
-bool ndBodyKinematic::ndContactkey::operator< (const ndContactkey& key) const
+ndBodyKinematic::ndContactMap::ndContactMap()
+	:m_slots()
+	,m_count(0)
 {
-	return m_tag < key.m_tag;
 }
 
-bool ndBodyKinematic::ndContactkey::operator> (const ndContactkey& key) const
+ndBodyKinematic::ndContactMap::~ndContactMap()
 {
-	return m_tag > key.m_tag;
 }
 
-ndBodyKinematic::ndContactMap::ndContactMap()
-	:ndTree<ndContact*, ndContactkey, ndContainersFreeListAlloc<ndContact*>>()
+ndInt32 ndBodyKinematic::ndContactMap::FindSlot(ndUnsigned64 key) const
 {
+	if (m_count)
+	{
+		const ndInt32 mask = m_slots.GetCount() - 1;
+		for (ndInt32 i = GetHomeSlot(key); m_slots[i].m_contact; i = (i + 1) & mask)
+		{
+			if (m_slots[i].m_key == key)
+			{
+				return i;
+			}
+		}
+	}
+	return -1;
 }
 
-ndBodyKinematic::ndContactMap::~ndContactMap()
+void ndBodyKinematic::ndContactMap::Rehash(ndInt32 capacity)
 {
+	ndAssert(!(capacity & (capacity - 1)));
+	ndArray<ndSlot> slots;
+	slots.Swap(m_slots);
+	m_slots.SetCount(capacity);
+	for (ndInt32 i = 0; i < capacity; ++i)
+	{
+		m_slots[i].m_key = 0;
+		m_slots[i].m_contact = nullptr;
+	}
+
+	const ndInt32 mask = capacity - 1;
+	for (ndInt32 i = slots.GetCount() - 1; i >= 0; --i)
+	{
+		const ndSlot& slot = slots[i];
+		if (slot.m_contact)
+		{
+			ndInt32 index = GetHomeSlot(slot.m_key);
+			while (m_slots[index].m_contact)
+			{
+				index = (index + 1) & mask;
+			}
+			m_slots[index] = slot;
+		}
+	}
 }
 
 ndContact* ndBodyKinematic::ndContactMap::FindContact(const ndBody* const body0, const ndBody* const body1) const
 {
 	ndContactkey key(body0->GetId(), body1->GetId());
-	ndNode* const node = Find(key);
-	return node ? node->GetInfo() : nullptr;
+	const ndInt32 index = FindSlot(key.GetTag());
+	return (index >= 0) ? m_slots[index].m_contact : nullptr;
 }
 
 void ndBodyKinematic::ndContactMap::AttachContact(ndContact* const contact)
@@ -78,8 +113,23 @@ void ndBodyKinematic::ndContactMap::AttachContact(ndContact* const contact)
 	ndBody* const body0 = contact->GetBody0();
 	ndBody* const body1 = contact->GetBody1();
 	ndContactkey key(body0->GetId(), body1->GetId());
-	ndAssert(!Find(key));
-	Insert(contact, key);
+	ndAssert(FindSlot(key.GetTag()) < 0);
+
+	// keep the load factor below one half, so that probe sequences are short.
+	if ((m_count + 1) * 2 > m_slots.GetCount())
+	{
+		Rehash(ndMax(m_slots.GetCount() * 2, 8));
+	}
+
+	const ndInt32 mask = m_slots.GetCount() - 1;
+	ndInt32 index = GetHomeSlot(key.GetTag());
+	while (m_slots[index].m_contact)
+	{
+		index = (index + 1) & mask;
+	}
+	m_slots[index].m_key = key.GetTag();
+	m_slots[index].m_contact = contact;
+	m_count++;
 }
 
 void ndBodyKinematic::ndContactMap::DetachContact(ndContact* const contact)
@@ -87,8 +137,44 @@ void ndBodyKinematic::ndContactMap::DetachContact(ndContact* const contact)
 	ndBody* const body0 = contact->GetBody0();
 	ndBody* const body1 = contact->GetBody1();
 	ndContactkey key(body0->GetId(), body1->GetId());
-	ndAssert(Find(key));
-	Remove(key);
+	ndInt32 hole = FindSlot(key.GetTag());
+	ndAssert(hole >= 0);
+	ndAssert(m_slots[hole].m_contact == contact);
+
+	// back shift deletion, move any entry of the probe sequence 
+	// that can be found from the hole into the hole.
+	const ndInt32 mask = m_slots.GetCount() - 1;
+	for (ndInt32 i = (hole + 1) & mask; m_slots[i].m_contact; i = (i + 1) & mask)
+	{
+		const ndInt32 home = GetHomeSlot(m_slots[i].m_key);
+		const bool inRange = (hole <= i) ? ((home > hole) && (home <= i)) : ((home > hole) || (home <= i));
+		if (!inRange)
+		{
+			m_slots[hole] = m_slots[i];
+			hole = i;
+		}
+	}
+	m_slots[hole].m_key = 0;
+	m_slots[hole].m_contact = nullptr;
+	m_count--;
+}
+
+bool ndBodyKinematic::ndContactMap::SanityCheck() const
+{
+	ndInt32 count = 0;
+	for (ndInt32 i = m_slots.GetCount() - 1; i >= 0; --i)
+	{
+		const ndSlot& slot = m_slots[i];
+		if (slot.m_contact)
+		{
+			count++;
+			if (FindSlot(slot.m_key) != i)
+			{
+				return false;
+			}
+		}
+	}
+	return count == m_count;
 }
 
 ndBodyKinematic::ndBodyKinematic()
@@ -118,8 +204,6 @@ ndBodyKinematic::ndBodyKinematic()
 	,m_bodyNodeIndex(-1)
 	,m_buildSkelIndex(0)
 	,m_sceneNodeIndex(-1)
-	,m_buildBodyNodeIndex(-1)
-	,m_buildSceneNodeIndex(-1)
 {
 	m_invWorldInertiaMatrix[3][3] = ndFloat32(1.0f);
 	m_shapeInstance.m_ownerBody = this;
@@ -151,8 +235,6 @@ ndBodyKinematic::ndBodyKinematic(const ndLoadSaveBase::ndLoadDescriptor& desc)
 	,m_bodyNodeIndex(-1)
 	,m_buildSkelIndex(0)
 	,m_sceneNodeIndex(-1)
-	,m_buildBodyNodeIndex(-1)
-	,m_buildSceneNodeIndex(-1)
 {
 	const nd::TiXmlNode* const xmlNode = desc.m_rootNode;
 	m_invWorldInertiaMatrix[3][3] = ndFloat32(1.0f);
@@ -230,7 +312,9 @@ void ndBodyKinematic::AttachContact(ndContact* const contact)
 {
 	ndScopeSpinLock lock(m_lock);
 	ndAssert((this == contact->GetBody0()) || (this == contact->GetBody1()));
-	if (m_invMass.m_w > ndFloat32(0.0f))
+	// the flag is read without the lock by the narrow phase of other 
+	// contacts, a body that is already awake is not written again.
+	if ((m_invMass.m_w > ndFloat32(0.0f)) && m_equilibrium)
 	{
 		m_equilibrium = 0;
 	}
@@ -43,8 +43,7 @@ class ndBodyKinematic : public ndBody
 		public:
 		ndContactkey(ndUnsigned32 tag0, ndUnsigned32 tag1);
 
-		bool operator> (const ndContactkey& key) const;
-		bool operator< (const ndContactkey& key) const;
+		ndUnsigned64 GetTag() const;
 		bool operator== (const ndContactkey& key) const;
 		private:
 		union
@@ -77,16 +76,55 @@ class ndBodyKinematic : public ndBody
 		}
 	};
 
-	class ndContactMap: public ndTree<ndContact*, ndContactkey, ndContainersFreeListAlloc<ndContact*>>
+	// open addressing hash map of all the contacts of a body.
+	// slots are stored in a flat array with linear probing and back shift 
+	// deletion, so look ups do not chase pointers and do not allocate nodes.
+	// the map is read without locks during the broad phase, since 
+	// contacts are only attached or detached in later stages. 
+	class ndContactMap
 	{
+		class ndSlot
+		{
+			public:
+			ndUnsigned64 m_key;
+			ndContact* m_contact;
+		};
+
 		public:
+		class Iterator
+		{
+			public:
+			Iterator(const ndContactMap& map);
+
+			void Begin();
+			operator ndInt32() const;
+			void operator++ ();
+			void operator++ (ndInt32);
+			ndContact* operator* () const;
+
+			private:
+			void Advance();
+
+			const ndContactMap* m_map;
+			ndInt32 m_index;
+		};
+
 		D_COLLISION_API ndContact* FindContact(const ndBody* const body0, const ndBody* const body1) const;
+		ndInt32 GetCount() const;
+		D_COLLISION_API bool SanityCheck() const;
 
 		private:
 		ndContactMap();
 		~ndContactMap();
 		void AttachContact(ndContact* const contact);
 		void DetachContact(ndContact* const contact);
+
+		void Rehash(ndInt32 capacity);
+		ndInt32 GetHomeSlot(ndUnsigned64 key) const;
+		ndInt32 FindSlot(ndUnsigned64 key) const;
+
+		ndArray<ndSlot> m_slots;
+		ndInt32 m_count;
 		friend class ndBodyKinematic;
 	};
 
@@ -225,8 +263,6 @@ class ndBodyKinematic : public ndBody
 	ndInt32 m_bodyNodeIndex;
 	ndInt32 m_buildSkelIndex;
 	ndInt32 m_sceneNodeIndex;
-	ndInt32 m_buildBodyNodeIndex;
-	ndInt32 m_buildSceneNodeIndex;
 
 	D_COLLISION_API static ndVector m_velocTol;
 
@@ -241,8 +277,10 @@ class ndBodyKinematic : public ndBody
 	friend class ndSkeletonContainer;
 	friend class ndDynamicsUpdateSoa;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateCuda;
 	friend class ndDynamicsUpdateOpencl;
+	friend class ndDynamicsUpdateGraphColor;
 	friend class ndJointBilateralConstraint;
 } D_GCC_NEWTON_ALIGN_32;
 
@@ -408,6 +446,69 @@ inline void ndBodyKinematic::PrepareStep(ndInt32 index)
 	m_equilibrium0 = m_equilibrium;
 }
 
+inline ndUnsigned64 ndBodyKinematic::ndContactkey::GetTag() const
+{
+	return m_tag;
+}
+
+inline ndInt32 ndBodyKinematic::ndContactMap::GetCount() const
+{
+	return m_count;
+}
+
+inline ndInt32 ndBodyKinematic::ndContactMap::GetHomeSlot(ndUnsigned64 key) const
+{
+	ndAssert(m_slots.GetCount() && !(m_slots.GetCount() & (m_slots.GetCount() - 1)));
+	const ndUnsigned64 hash = key * ndUnsigned64(0x9e3779b97f4a7c15);
+	return ndInt32(hash >> 32) & (m_slots.GetCount() - 1);
+}
+
+inline ndBodyKinematic::ndContactMap::Iterator::Iterator(const ndContactMap& map)
+	:m_map(&map)
+	,m_index(map.m_slots.GetCount())
+{
+}
+
+inline void ndBodyKinematic::ndContactMap::Iterator::Advance()
+{
+	const ndInt32 capacity = m_map->m_slots.GetCount();
+	while ((m_index < capacity) && !m_map->m_slots[m_index].m_contact)
+	{
+		m_index++;
+	}
+}
+
+inline void ndBodyKinematic::ndContactMap::Iterator::Begin()
+{
+	m_index = 0;
+	Advance();
+}
+
+inline ndBodyKinematic::ndContactMap::Iterator::operator ndInt32() const
+{
+	return m_index < m_map->m_slots.GetCount();
+}
+
+inline void ndBodyKinematic::ndContactMap::Iterator::operator++ ()
+{
+	ndAssert(m_index < m_map->m_slots.GetCount());
+	m_index++;
+	Advance();
+}
+
+inline void ndBodyKinematic::ndContactMap::Iterator::operator++ (ndInt32)
+{
+	ndAssert(m_index < m_map->m_slots.GetCount());
+	m_index++;
+	Advance();
+}
+
+inline ndContact* ndBodyKinematic::ndContactMap::Iterator::operator* () const
+{
+	ndAssert(m_map->m_slots[m_index].m_contact);
+	return m_map->m_slots[m_index].m_contact;
+}
+
 inline ndBodyKinematic::ndContactMap& ndBodyKinematic::GetContactMap()
 {
 	return m_contactList;
@@ -182,22 +182,48 @@ void ndBvhNodeArray::Swap(ndBvhNodeArray& src)
 	}
 }
 
+ndBvhSceneManager::ndBackgroundBuild::ndBackgroundBuild(ndBvhSceneManager* const owner)
+	:ndBackgroundTask()
+	,m_owner(owner)
+	,m_root(nullptr)
+	,m_generation(0)
+	,m_age(0)
+	,m_pending(false)
+{
+}
+
+void ndBvhSceneManager::ndBackgroundBuild::Execute(ndThreadPool* const threadPool)
+{
+	D_TRACKTIME();
+	m_owner->BuildBvhTreeInitBuildNodes(*threadPool);
+	m_root = m_owner->BuildBvhTreeLayers(*threadPool, m_owner->m_buildArray, m_owner->m_backgroundBuildState);
+}
+
 ndBvhSceneManager::ndBvhSceneManager()
 	:m_workingArray()
-#ifdef D_NEW_SCENE
 	,m_buildArray()
-#endif
 	,m_bvhBuildState()
+	,m_backgroundBuildState()
+	,m_backgroundBuild(this)
+	,m_generation(0)
+	,m_backgroundBuildEnabled(true)
 {
 }
 
 ndBvhSceneManager::ndBvhSceneManager(const ndBvhSceneManager& src)
 	:m_workingArray(src.m_workingArray)
-#ifdef D_NEW_SCENE
-	,m_buildArray(src.m_buildArray)
-#endif
+	,m_buildArray()
 	,m_bvhBuildState(src.m_bvhBuildState)
+	,m_backgroundBuildState()
+	,m_backgroundBuild(this)
+	,m_generation(src.m_generation + 1)
+	,m_backgroundBuildEnabled(src.m_backgroundBuildEnabled)
 {
+	// the background build only touches the build array, so it 
+	// is safe to steal it once the build is done.
+	ndBvhSceneManager* const stealData = (ndBvhSceneManager*)&src;
+	stealData->SyncBackgroundBuild();
+	m_buildArray.Swap(stealData->m_buildArray);
 }
 
 ndBvhSceneManager::~ndBvhSceneManager()
@@ -219,13 +245,8 @@ ndBvhNode* ndBvhSceneManager::AddBody(ndBodyKinematic* const body, ndBvhNode* ro
 	m_workingArray.PushBack(bodyNode);
 	body->m_bodyNodeIndex = m_workingArray.GetCount() - 1;
 
-	#ifdef D_NEW_SCENE
-	m_buildArray.m_isDirty = 1;
-	m_buildArray.PushBack(sceneNode->Clone());
-	body->m_buildSceneNodeIndex = m_buildArray.GetCount() - 1;
-	m_buildArray.PushBack(bodyNode->Clone());
-	body->m_buildBodyNodeIndex = m_buildArray.GetCount() - 1;
-	#endif
+	// a tree built in the background would miss this body
+	m_generation++;
 
 	if (m_workingArray.GetCount() > 2)
 	{
@@ -308,10 +329,7 @@ ndBvhNode* ndBvhSceneManager::AddBody(ndBodyKinematic* const body, ndBvhNode* ro
 
 void ndBvhSceneManager::RemoveBody(ndBodyKinematic* const body)
 {
-	#ifdef D_NEW_SCENE
-	m_buildArray.m_isDirty = 1;
-	#endif
-
+	m_generation++;
 	m_workingArray.m_isDirty = 1;
 	ndBvhLeafNode* const bodyNode = (ndBvhLeafNode*)m_workingArray[body->m_bodyNodeIndex];
 	ndBvhInternalNode* const sceneNode = (ndBvhInternalNode*)m_workingArray[body->m_sceneNodeIndex];
@@ -330,19 +348,19 @@ ndBvhLeafNode* ndBvhSceneManager::GetLeafNode(ndBodyKinematic* const body) const
 
 void ndBvhSceneManager::CleanUp()
 {
+	SyncBackgroundBuild();
+	m_generation++;
 	m_workingArray.CleanUp();
-#ifdef D_NEW_SCENE	
+	for (ndInt32 i = m_buildArray.GetCount() - 1; i >= 0; --i)
+	{
+		m_buildArray[i]->Kill();
+	}
 	m_buildArray.CleanUp();
-#endif
 }
 
 void ndBvhSceneManager::Update(ndThreadPool& threadPool)
 {
-#ifdef D_NEW_SCENE
-	ndBvhNodeArray& nodeArray = m_buildArray;
-#else
 	ndBvhNodeArray& nodeArray = m_workingArray;
-#endif
 
 	if (nodeArray.m_isDirty && nodeArray.GetCount())
 	{
@@ -380,9 +398,6 @@ void ndBvhSceneManager::Update(ndThreadPool& threadPool)
 		for (ndInt32 i = 0; i < deadCount; ++i)
 		{
 			ndBvhNode* const node = nodeArray[alivedStart + i];
-			#ifdef D_NEW_SCENE
-				ndAssert(0);
-			#endif
 			delete node;
 		}
 		nodeArray.SetCount(alivedStart);
@@ -403,13 +418,8 @@ void ndBvhSceneManager::Update(ndThreadPool& threadPool)
 					ndAssert(nodes[baseCount + i]->GetAsSceneBodyNode());
 
 					ndBodyKinematic* const body = bodyNode->m_body;
-					#ifdef D_NEW_SCENE
-					body->m_buildSceneNodeIndex = i;
-					body->m_buildBodyNodeIndex = baseCount + i;
-					#else
 					body->m_sceneNodeIndex = i;
 					body->m_bodyNodeIndex = baseCount + i;
-					#endif
 				}
 			});
 			threadPool.ParallelExecute(EnumerateNodes);
@@ -490,11 +500,7 @@ bool ndBvhSceneManager::BuildBvhTreeInitNodes(ndThreadPool& threadPool)
 	{
 		D_TRACKTIME_NAMED(CopyBodyNodes);
 
-		#ifdef D_NEW_SCENE
-		ndBvhNodeArray& nodeArray = m_buildArray;
-		#else
 		ndBvhNodeArray& nodeArray = m_workingArray;
-		#endif
 
 		const ndInt32 baseCount = nodeArray.GetCount() / 2;
 		ndBvhNode** const srcArray = m_bvhBuildState.m_srcArray;
@@ -519,11 +525,7 @@ bool ndBvhSceneManager::BuildBvhTreeInitNodes(ndThreadPool& threadPool)
 	auto CopySceneNode = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(CopySceneNode);
-		#ifdef D_NEW_SCENE
-		ndBvhNodeArray& nodeArray = m_buildArray;
-		#else
 		ndBvhNodeArray& nodeArray = m_workingArray;
-		#endif
 
 		const ndInt32 baseCount = nodeArray.GetCount() / 2;
 		ndBvhInternalNode** const sceneNodes = (ndBvhInternalNode**)&nodeArray[0];
@@ -546,12 +548,7 @@ bool ndBvhSceneManager::BuildBvhTreeInitNodes(ndThreadPool& threadPool)
 
 	bool ret = false;
 
-	#ifdef D_NEW_SCENE
-	ndBvhNodeArray& nodeArray = m_buildArray;
-	#else
 	ndBvhNodeArray& nodeArray = m_workingArray;
-	#endif
-
 	if (nodeArray.GetCount())
 	{
 		ret = true;
@@ -562,21 +559,21 @@ bool ndBvhSceneManager::BuildBvhTreeInitNodes(ndThreadPool& threadPool)
 	return ret;
 }
 
-void ndBvhSceneManager::BuildBvhTreeCalculateLeafBoxes(ndThreadPool& threadPool)
+void ndBvhSceneManager::BuildBvhTreeCalculateLeafBoxes(ndThreadPool& threadPool, ndBuildBvhTreeBuildState& state)
 {
 	D_TRACKTIME();
 	ndVector boxes[D_MAX_THREADS_COUNT][2];
 	ndFloat32 boxSizes[D_MAX_THREADS_COUNT];
 
-	auto CalculateBoxSize = ndMakeObject::ndFunction([this, &boxSizes, &boxes](ndInt32 threadIndex, ndInt32 threadCount)
+	auto CalculateBoxSize = ndMakeObject::ndFunction([&state, &boxSizes, &boxes](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(CalculateBoxSize);
 		ndVector minP(ndFloat32(1.0e15f));
 		ndVector maxP(ndFloat32(-1.0e15f));
 		ndFloat32 minSize = ndFloat32(1.0e15f);
 
-		ndBvhNode** const srcArray = m_bvhBuildState.m_srcArray;
-		const ndInt32 leafNodesCount = m_bvhBuildState.m_leafNodesCount;
+		ndBvhNode** const srcArray = state.m_srcArray;
+		const ndInt32 leafNodesCount = state.m_leafNodesCount;
 		const ndStartEnd startEnd(leafNodesCount, threadIndex, threadCount);
 		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 		{
@@ -605,22 +602,22 @@ void ndBvhSceneManager::BuildBvhTreeCalculateLeafBoxes(ndThreadPool& threadPool)
 		minBoxSize = ndMin(minBoxSize, boxSizes[i]);
 	}
 
-	m_bvhBuildState.m_origin = minP;
-	m_bvhBuildState.m_size = ndVector::m_triplexMask & ndVector(minBoxSize);
+	state.m_origin = minP;
+	state.m_size = ndVector::m_triplexMask & ndVector(minBoxSize);
 }
 
-ndInt32 ndBvhSceneManager::BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode** const parentsArray, ndInt32 bashCount)
+ndInt32 ndBvhSceneManager::BuildSmallBvhTree(ndThreadPool& threadPool, ndBuildBvhTreeBuildState& state, ndBvhNode** const parentsArray, ndInt32 bashCount)
 {
 	ndInt32 depthLevel[D_MAX_THREADS_COUNT];
-	auto SmallBhvNodes = ndMakeObject::ndFunction([this, parentsArray, bashCount, &depthLevel](ndInt32 threadIndex, ndInt32 threadCount)
+	auto SmallBhvNodes = ndMakeObject::ndFunction([&state, parentsArray, bashCount, &depthLevel](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(SmallBhvNodes);
 
-		const ndCellScanPrefix* const srcCellNodes = &m_bvhBuildState.m_cellCounts0[0];
-		const ndCellScanPrefix* const newParentsDest = &m_bvhBuildState.m_cellCounts1[0];
-		const ndBottomUpCell* const nodesCells = &m_bvhBuildState.m_cellBuffer0[0];
+		const ndCellScanPrefix* const srcCellNodes = &state.m_cellCounts0[0];
+		const ndCellScanPrefix* const newParentsDest = &state.m_cellCounts1[0];
+		const ndBottomUpCell* const nodesCells = &state.m_cellBuffer0[0];
 
-		ndAssert(m_bvhBuildState.m_cellCounts0.GetCount() == m_bvhBuildState.m_cellCounts1.GetCount());
+		ndAssert(state.m_cellCounts0.GetCount() == state.m_cellCounts1.GetCount());
 
 		auto MakeTwoNodesTree = [](ndBvhInternalNode* const root, ndBvhNode* const left, ndBvhNode* const right)
 		{
@@ -844,7 +841,7 @@ ndInt32 ndBvhSceneManager::BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode
 
 						info.m_index = index;
 						info.m_midPoint = median[index] / ndFloat32(block.m_count);
-						ndCountingSortInPlace<ndBottomUpCell, ndCompareKey, 2>(&m_bvhBuildState.m_cellBuffer0[block.m_start], &m_bvhBuildState.m_cellBuffer1[block.m_start], block.m_count, scan, &info);
+						ndCountingSortInPlace<ndBottomUpCell, ndCompareKey, 2>(&state.m_cellBuffer0[block.m_start], &state.m_cellBuffer1[block.m_start], block.m_count, scan, &info);
 						index0 = block.m_start + ndInt32(scan[1]);
 						if (index0 == block.m_start)
 						{
@@ -864,15 +861,15 @@ ndInt32 ndBvhSceneManager::BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode
 					ndAssert(count0);
 					if (count0 == 1)
 					{
-						ndBvhNode* const node = m_bvhBuildState.m_cellBuffer0[block.m_start].m_node;
+						ndBvhNode* const node = state.m_cellBuffer0[block.m_start].m_node;
 						node->m_bhvLinked = 1;
 						node->m_parent = root;
 						root->m_left = node;
 					}
 					else if (count0 == 2)
 					{
-						ndBvhNode* const node0 = m_bvhBuildState.m_cellBuffer0[block.m_start + 0].m_node;
-						ndBvhNode* const node1 = m_bvhBuildState.m_cellBuffer0[block.m_start + 1].m_node;
+						ndBvhNode* const node0 = state.m_cellBuffer0[block.m_start + 0].m_node;
+						ndBvhNode* const node1 = state.m_cellBuffer0[block.m_start + 1].m_node;
 						ndBvhInternalNode* const parent = parentsArray[rootNodeIndex]->GetAsSceneTreeNode();
 						rootNodeIndex++;
 
@@ -884,9 +881,9 @@ ndInt32 ndBvhSceneManager::BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode
 					}
 					else if (count0 == 3)
 					{
-						ndBvhNode* const node0 = m_bvhBuildState.m_cellBuffer0[block.m_start + 0].m_node;
-						ndBvhNode* const node1 = m_bvhBuildState.m_cellBuffer0[block.m_start + 1].m_node;
-						ndBvhNode* const node2 = m_bvhBuildState.m_cellBuffer0[block.m_start + 2].m_node;
+						ndBvhNode* const node0 = state.m_cellBuffer0[block.m_start + 0].m_node;
+						ndBvhNode* const node1 = state.m_cellBuffer0[block.m_start + 1].m_node;
+						ndBvhNode* const node2 = state.m_cellBuffer0[block.m_start + 2].m_node;
 
 						ndBvhInternalNode* const grandParent = parentsArray[rootNodeIndex]->GetAsSceneTreeNode();
 						rootNodeIndex++;
@@ -923,15 +920,15 @@ ndInt32 ndBvhSceneManager::BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode
 					ndAssert(count1);
 					if (count1 == 1)
 					{
-						ndBvhNode* const node = m_bvhBuildState.m_cellBuffer0[index0].m_node;
+						ndBvhNode* const node = state.m_cellBuffer0[index0].m_node;
 						node->m_bhvLinked = 1;
 						node->m_parent = root;
 						root->m_right = node;
 					}
 					else if (count1 == 2)
 					{
-						ndBvhNode* const node0 = m_bvhBuildState.m_cellBuffer0[index0 + 0].m_node;
-						ndBvhNode* const node1 = m_bvhBuildState.m_cellBuffer0[index0 + 1].m_node;
+						ndBvhNode* const node0 = state.m_cellBuffer0[index0 + 0].m_node;
+						ndBvhNode* const node1 = state.m_cellBuffer0[index0 + 1].m_node;
 						ndBvhInternalNode* const parent = parentsArray[rootNodeIndex]->GetAsSceneTreeNode();
 						rootNodeIndex++;
 
@@ -943,9 +940,9 @@ ndInt32 ndBvhSceneManager::BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode
 					}
 					else if (count1 == 3)
 					{
-						ndBvhNode* const node0 = m_bvhBuildState.m_cellBuffer0[index0 + 0].m_node;
-						ndBvhNode* const node1 = m_bvhBuildState.m_cellBuffer0[index0 + 1].m_node;
-						ndBvhNode* const node2 = m_bvhBuildState.m_cellBuffer0[index0 + 2].m_node;
+						ndBvhNode* const node0 = state.m_cellBuffer0[index0 + 0].m_node;
+						ndBvhNode* const node1 = state.m_cellBuffer0[index0 + 1].m_node;
+						ndBvhNode* const node2 = state.m_cellBuffer0[index0 + 2].m_node;
 
 						ndBvhInternalNode* const grandParent = parentsArray[rootNodeIndex]->GetAsSceneTreeNode();
 						rootNodeIndex++;
@@ -1004,7 +1001,7 @@ ndInt32 ndBvhSceneManager::BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode
 	return depth;
 }
 
-void ndBvhSceneManager::BuildBvhTreeSetNodesDepth(ndThreadPool& threadPool)
+void ndBvhSceneManager::BuildBvhTreeSetNodesDepth(ndThreadPool& threadPool, ndBvhNodeArray& nodeArray, ndBuildBvhTreeBuildState& state)
 {
 	D_TRACKTIME();
 	class ndSortGetDethpKey
@@ -1020,15 +1017,9 @@ void ndBvhSceneManager::BuildBvhTreeSetNodesDepth(ndThreadPool& threadPool)
 		}
 	};
 
-	#ifdef D_NEW_SCENE
-	ndBvhNodeArray& nodeArray = m_buildArray;
-	#else
-	ndBvhNodeArray& nodeArray = m_workingArray;
-	#endif
-
 	ndInt32 sceneNodeCount = nodeArray.GetCount() / 2 - 1;
 	ndBvhInternalNode** const view = (ndBvhInternalNode**)&nodeArray[0];
-	ndBvhInternalNode** tmpBuffer = (ndBvhInternalNode**)&m_bvhBuildState.m_tempNodeBuffer[0];
+	ndBvhInternalNode** tmpBuffer = (ndBvhInternalNode**)&state.m_tempNodeBuffer[0];
 
 	ndUnsigned32 scans[257];
 	ndCountingSortInPlace<ndBvhInternalNode*, ndSortGetDethpKey, 8>(threadPool, &view[0], tmpBuffer, sceneNodeCount, scans, nullptr);
@@ -1043,7 +1034,7 @@ void ndBvhSceneManager::BuildBvhTreeSetNodesDepth(ndThreadPool& threadPool)
 	ndAssert(nodeArray.m_scans[0] == 0);
 }
 
-void ndBvhSceneManager::BuildBvhGenerateLayerGrids(ndThreadPool& threadPool)
+void ndBvhSceneManager::BuildBvhGenerateLayerGrids(ndThreadPool& threadPool, ndBuildBvhTreeBuildState& state)
 {
 	D_TRACKTIME();
 	enum
@@ -1195,26 +1186,26 @@ void ndBvhSceneManager::BuildBvhGenerateLayerGrids(ndThreadPool& threadPool)
 	ndUnsigned32 prefixScan[8];
 	ndInt32 maxGrids[D_MAX_THREADS_COUNT][3];
 
-	ndCountingSortInPlace<ndBvhNode*, ndGridClassifier, 2>(threadPool, m_bvhBuildState.m_srcArray, m_bvhBuildState.m_tmpArray, m_bvhBuildState.m_leafNodesCount, prefixScan, &m_bvhBuildState);
+	ndCountingSortInPlace<ndBvhNode*, ndGridClassifier, 2>(threadPool, state.m_srcArray, state.m_tmpArray, state.m_leafNodesCount, prefixScan, &state);
 	ndInt32 insideCellsCount = ndInt32(prefixScan[m_insideCell + 1] - prefixScan[m_insideCell]);
 	if (insideCellsCount)
 	{
-		m_bvhBuildState.m_cellBuffer0.SetCount(insideCellsCount);
-		m_bvhBuildState.m_cellBuffer1.SetCount(insideCellsCount);
+		state.m_cellBuffer0.SetCount(insideCellsCount);
+		state.m_cellBuffer1.SetCount(insideCellsCount);
 		const ndUnsigned32 linkedNodes = prefixScan[m_linkedCell + 1] - prefixScan[m_linkedCell];
-		m_bvhBuildState.m_srcArray += linkedNodes;
-		m_bvhBuildState.m_leafNodesCount -= linkedNodes;
-		auto MakeGrids = ndMakeObject::ndFunction([this, &maxGrids](ndInt32 threadIndex, ndInt32 threadCount)
+		state.m_srcArray += linkedNodes;
+		state.m_leafNodesCount -= linkedNodes;
+		auto MakeGrids = ndMakeObject::ndFunction([&state, &maxGrids](ndInt32 threadIndex, ndInt32 threadCount)
 		{
 			D_TRACKTIME_NAMED(MakeGrids);
 
-			const ndGridClassifier gridClassifier(&m_bvhBuildState);
+			const ndGridClassifier gridClassifier(&state);
 			const ndVector origin(gridClassifier.m_origin);
 			const ndVector invSize(gridClassifier.m_invSize);
 
-			ndBvhNode** const srcArray = m_bvhBuildState.m_srcArray;
+			ndBvhNode** const srcArray = state.m_srcArray;
 
-			const ndStartEnd startEnd(m_bvhBuildState.m_cellBuffer0.GetCount(), threadIndex, threadCount);
+			const ndStartEnd startEnd(state.m_cellBuffer0.GetCount(), threadIndex, threadCount);
 			ndInt32 max_x = 0;
 			ndInt32 max_y = 0;
 			ndInt32 max_z = 0;
@@ -1224,10 +1215,10 @@ void ndBvhSceneManager::BuildBvhGenerateLayerGrids(ndThreadPool& threadPool)
 				const ndVector dist(node->m_minBox - origin);
 				const ndVector posit(invSize * dist);
 				const ndVector intPosit(posit.GetInt());
-				m_bvhBuildState.m_cellBuffer0[i].m_x = intPosit.m_ix;
-				m_bvhBuildState.m_cellBuffer0[i].m_y = intPosit.m_iy;
-				m_bvhBuildState.m_cellBuffer0[i].m_z = intPosit.m_iz;
-				m_bvhBuildState.m_cellBuffer0[i].m_node = node;
+				state.m_cellBuffer0[i].m_x = intPosit.m_ix;
+				state.m_cellBuffer0[i].m_y = intPosit.m_iy;
+				state.m_cellBuffer0[i].m_z = intPosit.m_iz;
+				state.m_cellBuffer0[i].m_node = node;
 				max_x = ndMax(ndInt32(intPosit.m_ix), max_x);
 				max_y = ndMax(ndInt32(intPosit.m_iy), max_y);
 				max_z = ndMax(ndInt32(intPosit.m_iz), max_z);
@@ -1246,24 +1237,24 @@ void ndBvhSceneManager::BuildBvhGenerateLayerGrids(ndThreadPool& threadPool)
 			maxGrids[0][2] = ndMax(maxGrids[i][2], maxGrids[0][2]);
 		}
 
-		ndCountingSort<ndBottomUpCell, ndSortCell_xlow, 8>(threadPool, m_bvhBuildState.m_cellBuffer0, m_bvhBuildState.m_cellBuffer1, nullptr, nullptr);
+		ndCountingSort<ndBottomUpCell, ndSortCell_xlow, 8>(threadPool, state.m_cellBuffer0, state.m_cellBuffer1, nullptr, nullptr);
 		if (maxGrids[0][0] > 256)
 		{
-			ndCountingSort<ndBottomUpCell, ndSortCell_xMid, 8>(threadPool, m_bvhBuildState.m_cellBuffer0, m_bvhBuildState.m_cellBuffer1, nullptr, nullptr);
+			ndCountingSort<ndBottomUpCell, ndSortCell_xMid, 8>(threadPool, state.m_cellBuffer0, state.m_cellBuffer1, nullptr, nullptr);
 			ndAssert(maxGrids[0][0] < 256 * 256);
 		}
 
-		ndCountingSort<ndBottomUpCell, ndSortCell_ylow, 8>(threadPool, m_bvhBuildState.m_cellBuffer0, m_bvhBuildState.m_cellBuffer1, nullptr, nullptr);
+		ndCountingSort<ndBottomUpCell, ndSortCell_ylow, 8>(threadPool, state.m_cellBuffer0, state.m_cellBuffer1, nullptr, nullptr);
 		if (maxGrids[0][1] > 256)
 		{
-			ndCountingSort<ndBottomUpCell, ndSortCell_yMid, 8>(threadPool, m_bvhBuildState.m_cellBuffer0, m_bvhBuildState.m_cellBuffer1, nullptr, nullptr);
+			ndCountingSort<ndBottomUpCell, ndSortCell_yMid, 8>(threadPool, state.m_cellBuffer0, state.m_cellBuffer1, nullptr, nullptr);
 			ndAssert(maxGrids[0][1] < 256 * 256);
 		}
 
-		ndCountingSort<ndBottomUpCell, ndSortCell_zlow, 8>(threadPool, m_bvhBuildState.m_cellBuffer0, m_bvhBuildState.m_cellBuffer1, nullptr, nullptr);
+		ndCountingSort<ndBottomUpCell, ndSortCell_zlow, 8>(threadPool, state.m_cellBuffer0, state.m_cellBuffer1, nullptr, nullptr);
 		if (maxGrids[0][2] > 256)
 		{
-			ndCountingSort<ndBottomUpCell, ndSortCell_zMid, 8>(threadPool, m_bvhBuildState.m_cellBuffer0, m_bvhBuildState.m_cellBuffer1, nullptr, nullptr);
+			ndCountingSort<ndBottomUpCell, ndSortCell_zMid, 8>(threadPool, state.m_cellBuffer0, state.m_cellBuffer1, nullptr, nullptr);
 			ndAssert(maxGrids[0][2] < 256 * 256);
 		}
 
@@ -1273,20 +1264,20 @@ void ndBvhSceneManager::BuildBvhGenerateLayerGrids(ndThreadPool& threadPool)
 		sentinelCell.m_z = ndUnsigned32(-1);
 		sentinelCell.m_node = nullptr;
 
-		m_bvhBuildState.m_cellBuffer0.PushBack(sentinelCell);
-		m_bvhBuildState.m_cellBuffer1.PushBack(sentinelCell);
-		m_bvhBuildState.m_cellCounts0.SetCount(m_bvhBuildState.m_cellBuffer0.GetCount());
-		m_bvhBuildState.m_cellCounts1.SetCount(m_bvhBuildState.m_cellBuffer1.GetCount());
-		auto MarkCellBounds = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+		state.m_cellBuffer0.PushBack(sentinelCell);
+		state.m_cellBuffer1.PushBack(sentinelCell);
+		state.m_cellCounts0.SetCount(state.m_cellBuffer0.GetCount());
+		state.m_cellCounts1.SetCount(state.m_cellBuffer1.GetCount());
+		auto MarkCellBounds = ndMakeObject::ndFunction([&state](ndInt32 threadIndex, ndInt32 threadCount)
 		{
 			D_TRACKTIME_NAMED(MarkCellBounds);
-			ndCellScanPrefix* const dst = &m_bvhBuildState.m_cellCounts0[0];
-			const ndStartEnd startEnd(m_bvhBuildState.m_cellBuffer0.GetCount() - 1, threadIndex, threadCount);
+			ndCellScanPrefix* const dst = &state.m_cellCounts0[0];
+			const ndStartEnd startEnd(state.m_cellBuffer0.GetCount() - 1, threadIndex, threadCount);
 
 			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 			{
-				const ndBottomUpCell& cell0 = m_bvhBuildState.m_cellBuffer0[i + 1];
-				const ndBottomUpCell& cell1 = m_bvhBuildState.m_cellBuffer0[i];
+				const ndBottomUpCell& cell0 = state.m_cellBuffer0[i + 1];
+				const ndBottomUpCell& cell1 = state.m_cellBuffer0[i];
 				const ndUnsigned8 test = ndUnsigned8((cell0.m_x == cell1.m_x) & (cell0.m_y == cell1.m_y) & (cell0.m_z == cell1.m_z) & (cell1.m_node != nullptr));
 				dst[i + 1].m_cellTest = test;
 				dst[i + 1].m_location = i + 1;
@@ -1294,29 +1285,29 @@ void ndBvhSceneManager::BuildBvhGenerateLayerGrids(ndThreadPool& threadPool)
 		});
 		threadPool.ParallelExecute(MarkCellBounds);
 
-		m_bvhBuildState.m_cellCounts0[0].m_cellTest = 0;
-		m_bvhBuildState.m_cellCounts0[0].m_location = 0;
-		ndCountingSort<ndCellScanPrefix, ndSortCellCount, 1>(threadPool, m_bvhBuildState.m_cellCounts0, m_bvhBuildState.m_cellCounts1, prefixScan, nullptr);
+		state.m_cellCounts0[0].m_cellTest = 0;
+		state.m_cellCounts0[0].m_location = 0;
+		ndCountingSort<ndCellScanPrefix, ndSortCellCount, 1>(threadPool, state.m_cellCounts0, state.m_cellCounts1, prefixScan, nullptr);
 
 		ndUnsigned32 sum = 0;
 		const ndInt32 bashCount = ndInt32(prefixScan[1] - 1);
 		for (ndInt32 i = 0; i < bashCount; ++i)
 		{
-			const ndInt32 count = m_bvhBuildState.m_cellCounts0[i + 1].m_location - m_bvhBuildState.m_cellCounts0[i].m_location - 1;
-			m_bvhBuildState.m_cellCounts1[i].m_location = ndInt32(sum);
+			const ndInt32 count = state.m_cellCounts0[i + 1].m_location - state.m_cellCounts0[i].m_location - 1;
+			state.m_cellCounts1[i].m_location = ndInt32(sum);
 			sum += count;
 		}
 		if (sum)
 		{
-			m_bvhBuildState.m_cellCounts1[bashCount].m_location = ndInt32(sum);
-			ndInt32 subTreeDepth = BuildSmallBvhTree(threadPool, m_bvhBuildState.m_parentsArray, bashCount);
-			m_bvhBuildState.m_depthLevel += subTreeDepth;
-			auto EnumerateSmallBvh = ndMakeObject::ndFunction([this, sum](ndInt32 threadIndex, ndInt32 threadCount)
+			state.m_cellCounts1[bashCount].m_location = ndInt32(sum);
+			ndInt32 subTreeDepth = BuildSmallBvhTree(threadPool, state, state.m_parentsArray, bashCount);
+			state.m_depthLevel += subTreeDepth;
+			auto EnumerateSmallBvh = ndMakeObject::ndFunction([&state, sum](ndInt32 threadIndex, ndInt32 threadCount)
 			{
 				D_TRACKTIME_NAMED(EnumerateSmallBvh);
 
-				ndInt32 depthLevel = m_bvhBuildState.m_depthLevel;
-				ndBvhNode** const parentsArray = m_bvhBuildState.m_parentsArray;
+				ndInt32 depthLevel = state.m_depthLevel;
+				ndBvhNode** const parentsArray = state.m_parentsArray;
 
 				const ndStartEnd startEnd(ndInt32(sum), threadIndex, threadCount);
 				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
@@ -1370,9 +1361,9 @@ void ndBvhSceneManager::BuildBvhGenerateLayerGrids(ndThreadPool& threadPool)
 			});
 			threadPool.ParallelExecute(EnumerateSmallBvh);
 
-			m_bvhBuildState.m_parentsArray += sum;
-			m_bvhBuildState.m_leafNodesCount += sum;
-			m_bvhBuildState.m_depthLevel++;
+			state.m_parentsArray += sum;
+			state.m_leafNodesCount += sum;
+			state.m_depthLevel++;
 		}
 	}
 }
@@ -1394,7 +1385,7 @@ ndBvhNode* ndBvhSceneManager::BuildIncrementalBvhTree(ndThreadPool& threadPool)
 
 		case ndBuildBvhTreeBuildState::m_calculateBoxes:
 		{
-			BuildBvhTreeCalculateLeafBoxes(threadPool);
+			BuildBvhTreeCalculateLeafBoxes(threadPool, m_bvhBuildState);
 			m_bvhBuildState.m_state = m_bvhBuildState.m_buildLayer;
 			break;
 		}
@@ -1404,7 +1395,7 @@ ndBvhNode* ndBvhSceneManager::BuildIncrementalBvhTree(ndThreadPool& threadPool)
 			if (m_bvhBuildState.m_leafNodesCount > 1)
 			{
 				m_bvhBuildState.m_size = m_bvhBuildState.m_size * ndVector::m_two;
-				BuildBvhGenerateLayerGrids(threadPool);
+				BuildBvhGenerateLayerGrids(threadPool, m_bvhBuildState);
 			}
 			else
 			{
@@ -1416,7 +1407,7 @@ ndBvhNode* ndBvhSceneManager::BuildIncrementalBvhTree(ndThreadPool& threadPool)
 
 		case ndBuildBvhTreeBuildState::m_enumerateLayers:
 		{
-			BuildBvhTreeSetNodesDepth(threadPool);
+			BuildBvhTreeSetNodesDepth(threadPool, m_workingArray, m_bvhBuildState);
 			m_bvhBuildState.m_state = m_bvhBuildState.m_endBuild;
 			break;
 		}
@@ -1424,7 +1415,6 @@ ndBvhNode* ndBvhSceneManager::BuildIncrementalBvhTree(ndThreadPool& threadPool)
 		case ndBuildBvhTreeBuildState::m_endBuild:
 		{
 			root = m_bvhBuildState.m_root;
-			BuildBvhTreeSwapBuffers(threadPool);
 			ndAssert(m_bvhBuildState.m_root->SanityCheck(0));
 			m_bvhBuildState.m_state = m_bvhBuildState.m_beginBuild;
 			break;
@@ -1436,60 +1426,203 @@ ndBvhNode* ndBvhSceneManager::BuildIncrementalBvhTree(ndThreadPool& threadPool)
 	return root;
 }
 
-//void ndBvhSceneManager::BuildBvhTreeSwapBuffers(ndThreadPool& threadPool)
-void ndBvhSceneManager::BuildBvhTreeSwapBuffers(ndThreadPool& )
+ndBvhNode* ndBvhSceneManager::BuildBvhTreeLayers(ndThreadPool& threadPool, ndBvhNodeArray& nodeArray, ndBuildBvhTreeBuildState& state)
 {
-#ifdef D_NEW_SCENE
+	BuildBvhTreeCalculateLeafBoxes(threadPool, state);
+	while (state.m_leafNodesCount > 1)
+	{
+		state.m_size = state.m_size * ndVector::m_two;
+		BuildBvhGenerateLayerGrids(threadPool, state);
+	}
+
+	state.m_root = state.m_srcArray[0];
+
+	BuildBvhTreeSetNodesDepth(threadPool, nodeArray, state);
+	ndAssert(state.m_root->SanityCheck(0));
+	return state.m_root;
+}
 
+ndBvhNode* ndBvhSceneManager::BuildBvhTree(ndThreadPool& threadPool)
+{
 	D_TRACKTIME();
-	auto SwapBodyIndices = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+
+	// the node indices of the bodies change, 
+	// so a tree built in the background is stale.
+	m_generation++;
+	if (!BuildBvhTreeInitNodes(threadPool))
 	{
-		D_TRACKTIME_NAMED(MarkCellBounds);
-		ndBvhNodeArray& array = m_buildArray;
-		ndInt32 baseIndex = array.GetCount() / 2;
-		const ndStartEnd startEnd(baseIndex, threadIndex, threadCount);
-		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
-		{
-			ndBvhLeafNode* const bodyNode = (ndBvhLeafNode*)array[baseIndex + i];
-			ndAssert(bodyNode->GetAsSceneBodyNode());
+		return nullptr;
+	}
+	return BuildBvhTreeLayers(threadPool, m_workingArray, m_bvhBuildState);
+}
 
-			ndBodyKinematic* const body = bodyNode->m_body;
-			ndSwap(body->m_bodyNodeIndex, body->m_buildBodyNodeIndex);
-			ndSwap(body->m_sceneNodeIndex, body->m_buildSceneNodeIndex);
+void ndBvhSceneManager::SetBackgroundBuild(bool state)
+{
+	SyncBackgroundBuild();
+	m_backgroundBuildEnabled = state;
+}
+
+void ndBvhSceneManager::SyncBackgroundBuild()
+{
+	if (m_backgroundBuild.m_pending)
+	{
+		m_backgroundBuild.Sync();
+		m_backgroundBuild.m_pending = false;
+	}
+}
+
+bool ndBvhSceneManager::BeginBackgroundBuild(ndThreadBackgroundWorker& backgroundThread)
+{
+	D_TRACKTIME();
+	if (m_backgroundBuild.m_pending || m_workingArray.m_isDirty || backgroundThread.IsTerminated())
+	{
+		return false;
+	}
+
+	// take a snapshot of the scene in the build array, one scene node and 
+	// one leaf node per body, with the leaf boxes of the working tree.
+	// the nodes left from the previous build are recycled.
+	const ndInt32 count = m_workingArray.GetCount() / 2;
+	if (count < 2)
+	{
+		return false;
+	}
+
+	ndBvhNodeArray& buildArray = m_buildArray;
+	const ndInt32 oldCount = buildArray.GetCount() / 2;
+	ndAssert(buildArray.GetCount() == oldCount * 2);
+	for (ndInt32 i = count; i < oldCount; ++i)
+	{
+		delete buildArray[i];
+		delete buildArray[oldCount + i];
+	}
+
+	buildArray.SetCount(count * 2);
+	if (count < oldCount)
+	{
+		for (ndInt32 i = 0; i < count; ++i)
+		{
+			buildArray[count + i] = buildArray[oldCount + i];
 		}
-	});
-	threadPool.ParallelExecute(SwapBodyIndices);
+	}
+	else
+	{
+		for (ndInt32 i = oldCount - 1; i >= 0; --i)
+		{
+			buildArray[count + i] = buildArray[oldCount + i];
+		}
+	}
 
-	// for now just swap buffers
-	m_buildArray.Swap(m_workingArray);
+	const ndBvhNode* const* const workingLeafs = &m_workingArray[count];
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		const ndBvhLeafNode* const srcNode = workingLeafs[i]->GetAsSceneBodyNode();
+		ndAssert(srcNode && !srcNode->m_isDead);
+		if (i >= oldCount)
+		{
+			buildArray[i] = new ndBvhInternalNode();
+			buildArray[count + i] = new ndBvhLeafNode(*srcNode);
+		}
+		ndBvhLeafNode* const leafNode = buildArray[count + i]->GetAsSceneBodyNode();
+		ndAssert(leafNode);
+		leafNode->m_body = srcNode->m_body;
+		leafNode->m_minBox = srcNode->m_minBox;
+		leafNode->m_maxBox = srcNode->m_maxBox;
+	}
+	buildArray.m_isDirty = 0;
 
-	UpdateScene(threadPool);
-#endif
+	m_backgroundBuild.m_root = nullptr;
+	m_backgroundBuild.m_generation = m_generation;
+	m_backgroundBuild.m_age = 0;
+	m_backgroundBuild.m_pending = true;
+	backgroundThread.SendTask(&m_backgroundBuild);
+	return true;
 }
 
-ndBvhNode* ndBvhSceneManager::BuildBvhTree(ndThreadPool& threadPool)
+void ndBvhSceneManager::BuildBvhTreeInitBuildNodes(ndThreadPool& threadPool)
 {
-	D_TRACKTIME();
+	// same as BuildBvhTreeInitNodes, but reading the leaf boxes 
+	// from the snapshot, since the bodies keep moving.
+	ndBvhNodeArray& nodeArray = m_buildArray;
+	const ndInt32 baseCount = nodeArray.GetCount() / 2;
+	m_backgroundBuildState.Init(baseCount);
 
-	//while (!BuildIncrementalBvhTree());
+	auto CopyBuildNodes = ndMakeObject::ndFunction([this, baseCount](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CopyBuildNodes);
+		ndBvhNodeArray& nodeArray = m_buildArray;
+		ndBvhNode** const srcArray = m_backgroundBuildState.m_srcArray;
+		ndBvhNode** const parentsArray = m_backgroundBuildState.m_parentsArray;
 
-	if (!BuildBvhTreeInitNodes(threadPool))
+		const ndStartEnd startEnd(baseCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBvhNode* const leafNode = nodeArray[baseCount + i];
+			ndBvhNode* const sceneNode = nodeArray[i];
+			ndAssert(leafNode->GetAsSceneBodyNode());
+			ndAssert(sceneNode->GetAsSceneTreeNode());
+
+			leafNode->m_bhvLinked = 0;
+			leafNode->m_depthLevel = 0;
+			leafNode->m_parent = nullptr;
+			srcArray[i] = leafNode;
+
+			sceneNode->m_bhvLinked = 0;
+			sceneNode->m_depthLevel = 0;
+			sceneNode->m_parent = nullptr;
+			parentsArray[i] = sceneNode;
+		}
+	});
+	threadPool.ParallelExecute(CopyBuildNodes);
+}
+
+ndBvhNode* ndBvhSceneManager::EndBackgroundBuild(ndThreadPool& threadPool)
+{
+	if (!m_backgroundBuild.m_pending)
 	{
 		return nullptr;
 	}
 
-	BuildBvhTreeCalculateLeafBoxes(threadPool);
-	while (m_bvhBuildState.m_leafNodesCount > 1)
+	m_backgroundBuild.m_age++;
+	if (m_backgroundBuild.m_age < D_BVH_BACKGROUND_BUILD_LATENCY)
 	{
-		m_bvhBuildState.m_size = m_bvhBuildState.m_size * ndVector::m_two;
-		BuildBvhGenerateLayerGrids(threadPool);
+		return nullptr;
 	}
 
-	m_bvhBuildState.m_root = m_bvhBuildState.m_srcArray[0];
+	D_TRACKTIME();
+	SyncBackgroundBuild();
+	if ((m_backgroundBuild.m_generation != m_generation) || m_workingArray.m_isDirty)
+	{
+		// bodies were added or removed since the snapshot
+		return nullptr;
+	}
 
-	BuildBvhTreeSetNodesDepth(threadPool);
-	ndAssert(m_bvhBuildState.m_root->SanityCheck(0));
+	// move the bodies to the new tree, the leaf boxes are 
+	// copied from the working tree, since they are more recent.
+	auto SwapBodyNodes = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(SwapBodyNodes);
+		ndBvhNodeArray& buildArray = m_buildArray;
+		const ndBvhNodeArray& workingArray = m_workingArray;
+		const ndInt32 baseCount = buildArray.GetCount() / 2;
+		const ndStartEnd startEnd(baseCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBvhLeafNode* const leafNode = (ndBvhLeafNode*)buildArray[baseCount + i];
+			ndAssert(leafNode->GetAsSceneBodyNode());
+			ndBodyKinematic* const body = leafNode->m_body;
+			const ndBvhNode* const srcNode = workingArray[body->m_bodyNodeIndex];
+			ndAssert(srcNode->GetBody() == body);
+			leafNode->m_minBox = srcNode->m_minBox;
+			leafNode->m_maxBox = srcNode->m_maxBox;
+			body->m_sceneNodeIndex = i;
+			body->m_bodyNodeIndex = baseCount + i;
+		}
+	});
+	threadPool.ParallelExecute(SwapBodyNodes);
+	m_workingArray.Swap(m_buildArray);
 
-	BuildBvhTreeSwapBuffers(threadPool);
-	return m_bvhBuildState.m_root;
+	// refit the new tree to the current leaf boxes.
+	UpdateScene(threadPool);
+	return m_backgroundBuild.m_root;
 }
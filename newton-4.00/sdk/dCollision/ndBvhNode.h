@@ -24,7 +24,11 @@
 
 #include "ndCollisionStdafx.h"
 
-//#define D_NEW_SCENE
+// number of scene updates between the snapshot of the leaf boxes taken for 
+// a background rebuild and the swap of the new tree, the build runs on the 
+// background thread in the mean time. A fixed latency keeps the simulation 
+// deterministic, the swap only waits if the build is not done by then.
+#define D_BVH_BACKGROUND_BUILD_LATENCY	4
 
 class ndBodyKinematic;
 class ndBvhLeafNode;
@@ -56,9 +60,6 @@ class ndBvhNode : public ndContainersFreeListAlloc<ndBvhNode>
 	ndVector m_minBox;
 	ndVector m_maxBox;
 	ndBvhNode* m_parent;
-#ifdef D_NEW_SCENE
-	ndBvhNode* m_buildNode;
-#endif
 	ndSpinLock m_lock;
 	ndInt32 m_depthLevel;
 	ndUnsigned8 m_isDead;
@@ -170,6 +171,22 @@ class ndBvhNodeArray : public ndArray<ndBvhNode*>
 
 class ndBvhSceneManager
 {
+	class ndBackgroundBuild: public ndBackgroundTask
+	{
+		public:
+		ndBackgroundBuild(ndBvhSceneManager* const owner);
+
+		protected:
+		virtual void Execute(ndThreadPool* const threadPool);
+
+		public:
+		ndBvhSceneManager* m_owner;
+		ndBvhNode* m_root;
+		ndUnsigned32 m_generation;
+		ndInt32 m_age;
+		bool m_pending;
+	};
+
 	public:
 	ndBvhSceneManager();
 	ndBvhSceneManager(const ndBvhSceneManager& src);
@@ -182,27 +199,37 @@ class ndBvhSceneManager
 	void UpdateScene(ndThreadPool& threadPool);
 	ndBvhNode* BuildBvhTree(ndThreadPool& threadPool);
 
+	bool GetBackgroundBuild() const;
+	void SetBackgroundBuild(bool state);
+	bool BeginBackgroundBuild(ndThreadBackgroundWorker& backgroundThread);
+	ndBvhNode* EndBackgroundBuild(ndThreadPool& threadPool);
+	void SyncBackgroundBuild();
+
 	ndBvhNodeArray& GetNodeArray();
 	ndBvhLeafNode* GetLeafNode(ndBodyKinematic* const body) const;
 
 	private:
 	void Update(ndThreadPool& threadPool);
 	bool BuildBvhTreeInitNodes(ndThreadPool& threadPool);
-	void BuildBvhTreeSetNodesDepth(ndThreadPool& threadPool);
-	void BuildBvhGenerateLayerGrids(ndThreadPool& threadPool);
-	void BuildBvhTreeCalculateLeafBoxes(ndThreadPool& threadPool);
+	void BuildBvhTreeInitBuildNodes(ndThreadPool& threadPool);
+	void BuildBvhTreeSetNodesDepth(ndThreadPool& threadPool, ndBvhNodeArray& nodeArray, ndBuildBvhTreeBuildState& state);
+	void BuildBvhGenerateLayerGrids(ndThreadPool& threadPool, ndBuildBvhTreeBuildState& state);
+	void BuildBvhTreeCalculateLeafBoxes(ndThreadPool& threadPool, ndBuildBvhTreeBuildState& state);
+	ndBvhNode* BuildBvhTreeLayers(ndThreadPool& threadPool, ndBvhNodeArray& nodeArray, ndBuildBvhTreeBuildState& state);
 	
 	ndBvhNode* BuildIncrementalBvhTree(ndThreadPool& threadPool);
-	ndInt32 BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode** const parentsArray, ndInt32 bashCount);
-
-	void BuildBvhTreeSwapBuffers(ndThreadPool& threadPool);
+	ndInt32 BuildSmallBvhTree(ndThreadPool& threadPool, ndBuildBvhTreeBuildState& state, ndBvhNode** const parentsArray, ndInt32 bashCount);
 
+	// m_workingArray holds the tree used by the scene, m_buildArray 
+	// holds the nodes of the tree built in the background.
 	ndBvhNodeArray m_workingArray;
-#ifdef D_NEW_SCENE
 	ndBvhNodeArray m_buildArray;
-#endif
 
 	ndBuildBvhTreeBuildState m_bvhBuildState;
+	ndBuildBvhTreeBuildState m_backgroundBuildState;
+	ndBackgroundBuild m_backgroundBuild;
+	ndUnsigned32 m_generation;
+	bool m_backgroundBuildEnabled;
 };
 
 
@@ -216,9 +243,6 @@ inline ndBvhNode::ndBvhNode(ndBvhNode* const parent)
 	,m_minBox(ndFloat32(-1.0e15f))
 	,m_maxBox(ndFloat32(1.0e15f))
 	,m_parent(parent)
-#ifdef D_NEW_SCENE
-	,m_buildNode(nullptr)
-#endif
 	,m_lock()
 	,m_depthLevel(0)
 	,m_isDead(0)
@@ -234,18 +258,11 @@ inline ndBvhNode::ndBvhNode(const ndBvhNode& src)
 	,m_minBox(src.m_minBox)
 	,m_maxBox(src.m_maxBox)
 	,m_parent(nullptr)
-#ifdef D_NEW_SCENE
-	,m_buildNode((ndBvhNode*)&src)
-#endif
 	,m_lock()
 	,m_depthLevel(0)
 	,m_isDead(0)
 	,m_bhvLinked(0)
 {
-#ifdef D_NEW_SCENE
-	m_buildNode->m_buildNode = this;
-#endif
-
 #ifdef _DEBUG
 	m_nodeId = 0;
 #endif
@@ -288,9 +305,6 @@ inline ndBvhNode* ndBvhNode::GetRight() const
 inline void ndBvhNode::Kill()
 {
 	m_isDead = 1;
-#ifdef D_NEW_SCENE
-	m_buildNode->m_isDead = 1;
-#endif
 }
 
 inline void ndBvhNode::GetAabb(ndVector& minBox, ndVector& maxBox) const
@@ -351,4 +365,9 @@ inline ndBvhNodeArray& ndBvhSceneManager::GetNodeArray()
 	return m_workingArray;
 }
 
+inline bool ndBvhSceneManager::GetBackgroundBuild() const
+{
+	return m_backgroundBuildEnabled;
+}
+
 #endif
@@ -91,13 +91,12 @@ void ndContact::JacobianDerivative(ndConstraintDescritor& desc)
 	ndInt32 frictionIndex = 0;
 	if (m_maxDOF) 
 	{
-		ndInt32 i = 0;
-		frictionIndex = m_contacPointsList.GetCount();
-		for (ndContactPointList::ndNode* node = m_contacPointsList.GetFirst(); node; node = node->GetNext())
+		const ndInt32 count = m_contacPointsList.GetCount();
+		frictionIndex = count;
+		for (ndInt32 i = 0; i < count; ++i)
 		{
-			const ndContactMaterial& contact = node->GetInfo();
+			const ndContactMaterial& contact = m_contacPointsList[i];
 			JacobianContactDerivative(desc, contact, i, frictionIndex);
-			i++;
 		}
 	}
 	desc.m_rowsCount = frictionIndex;
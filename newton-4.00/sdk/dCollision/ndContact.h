@@ -83,14 +83,78 @@ class ndContactMaterial: public ndContactPoint
 	ndMaterial m_material;
 } D_GCC_NEWTON_ALIGN_32;
 
-class ndContactPointList : public ndList<ndContactMaterial, ndContainersFreeListAlloc<ndContactMaterial>>
+// a contact joint never has more points than its rows can hold
+#define D_MAX_CONTACT_POINTS			(D_CONSTRAINT_MAX_ROWS / 3)
+
+// the contact points are stored in a small fixed size array inside the 
+// contact joint, so that the manifold is contiguous in memory. 
+// the node interface is the same than the one of the old linked list, 
+// so that client code can still iterate over the points like before.
+D_MSV_NEWTON_ALIGN_32
+class ndContactPointList
 {
 	public:
-	ndContactPointList()
-		:ndList<ndContactMaterial, ndContainersFreeListAlloc<ndContactMaterial>>()
+	D_MSV_NEWTON_ALIGN_32
+	class ndNode
 	{
-	}
-};
+		public:
+		ndContactMaterial& GetInfo();
+		const ndContactMaterial& GetInfo() const;
+		ndNode* GetNext() const;
+		ndNode* GetPrev() const;
+
+		private:
+		ndContactMaterial m_info;
+		ndContactPointList* m_owner;
+		friend class ndContactPointList;
+	} D_GCC_NEWTON_ALIGN_32;
+
+	ndContactPointList();
+	ndContactPointList(const ndContactPointList& src);
+	ndContactPointList& operator=(const ndContactPointList& src);
+
+	ndInt32 GetCount() const;
+	ndInt32 GetCapacity() const;
+	ndNode* GetFirst() const;
+	ndNode* GetLast() const;
+
+	ndContactMaterial& operator[](ndInt32 i);
+	const ndContactMaterial& operator[](ndInt32 i) const;
+
+	ndNode* Append();
+	void Remove(ndNode* const node);
+	void RemoveAll();
+
+	private:
+	void SetCount(ndInt32 count);
+
+	ndNode m_nodes[D_MAX_CONTACT_POINTS];
+	ndInt32 m_count;
+	friend class ndScene;
+} D_GCC_NEWTON_ALIGN_32;
+
+// narrow phase state of a contact from its last update, the points of 
+// the closest simplex in the space of each shape, and for penetrating 
+// polytopes the vertex pair and normal found by the epa. it is used to 
+// warm start the gjk, and to skip the epa while the features do not change.
+D_MSV_NEWTON_ALIGN_32
+class ndContactSimplexCache
+{
+	public:
+	ndContactSimplexCache();
+	void Reset();
+
+	ndVector m_point0[3];
+	ndVector m_point1[3];
+	ndVector m_normal0;
+	ndVector m_normal1;
+	ndVector m_origin;
+	const ndShape* m_shape0;
+	const ndShape* m_shape1;
+	ndInt32 m_count;
+	ndInt32 m_feature0;
+	ndInt32 m_feature1;
+} D_GCC_NEWTON_ALIGN_32;
 
 D_MSV_NEWTON_ALIGN_32 
 class ndContact: public ndConstraint
@@ -127,6 +191,7 @@ class ndContact: public ndConstraint
 	ndQuaternion m_rotationAcc;
 	ndVector m_separatingVector;
 	ndContactPointList m_contacPointsList;
+	ndContactSimplexCache m_simplexCache;
 	ndBodyKinematic* m_body0;
 	ndBodyKinematic* m_body1;
 	ndMaterial* m_material;
@@ -147,10 +212,25 @@ class ndContact: public ndConstraint
 	friend class ndContactSolver;
 	friend class ndShapeInstance;
 	friend class ndConvexCastNotify;
+	friend class ndWorldSnapshot;
 	friend class ndShapeConvexPolygon;
 	friend class ndBodyPlayerCapsuleContactSolver;
 } D_GCC_NEWTON_ALIGN_32 ;
 
+inline ndContactSimplexCache::ndContactSimplexCache()
+{
+	Reset();
+}
+
+inline void ndContactSimplexCache::Reset()
+{
+	m_shape0 = nullptr;
+	m_shape1 = nullptr;
+	m_count = 0;
+	m_feature0 = -1;
+	m_feature1 = -1;
+}
+
 inline ndContact* ndContact::GetAsContact()
 {
 	return this;
@@ -186,6 +266,126 @@ inline const ndContactPointList& ndContact::GetContactPoints() const
 	return m_contacPointsList;
 }
 
+inline ndContactMaterial& ndContactPointList::ndNode::GetInfo()
+{
+	return m_info;
+}
+
+inline const ndContactMaterial& ndContactPointList::ndNode::GetInfo() const
+{
+	return m_info;
+}
+
+inline ndContactPointList::ndNode* ndContactPointList::ndNode::GetNext() const
+{
+	const ndNode* const next = this + 1;
+	return (next < &m_owner->m_nodes[m_owner->m_count]) ? (ndNode*)next : nullptr;
+}
+
+inline ndContactPointList::ndNode* ndContactPointList::ndNode::GetPrev() const
+{
+	return (this > &m_owner->m_nodes[0]) ? (ndNode*)(this - 1) : nullptr;
+}
+
+inline ndContactPointList::ndContactPointList()
+	:m_count(0)
+{
+	for (ndInt32 i = 0; i < D_MAX_CONTACT_POINTS; ++i)
+	{
+		m_nodes[i].m_owner = this;
+	}
+}
+
+inline ndContactPointList::ndContactPointList(const ndContactPointList& src)
+	:m_count(0)
+{
+	for (ndInt32 i = 0; i < D_MAX_CONTACT_POINTS; ++i)
+	{
+		m_nodes[i].m_owner = this;
+	}
+	*this = src;
+}
+
+inline ndContactPointList& ndContactPointList::operator=(const ndContactPointList& src)
+{
+	// copy the points only, the nodes must keep pointing to this list
+	for (ndInt32 i = 0; i < src.m_count; ++i)
+	{
+		m_nodes[i].m_info = src.m_nodes[i].m_info;
+	}
+	m_count = src.m_count;
+	return *this;
+}
+
+inline ndInt32 ndContactPointList::GetCount() const
+{
+	return m_count;
+}
+
+inline ndInt32 ndContactPointList::GetCapacity() const
+{
+	return D_MAX_CONTACT_POINTS;
+}
+
+inline ndContactPointList::ndNode* ndContactPointList::GetFirst() const
+{
+	return m_count ? (ndNode*)&m_nodes[0] : nullptr;
+}
+
+inline ndContactPointList::ndNode* ndContactPointList::GetLast() const
+{
+	return m_count ? (ndNode*)&m_nodes[m_count - 1] : nullptr;
+}
+
+inline ndContactMaterial& ndContactPointList::operator[](ndInt32 i)
+{
+	ndAssert(i >= 0);
+	ndAssert(i < m_count);
+	return m_nodes[i].m_info;
+}
+
+inline const ndContactMaterial& ndContactPointList::operator[](ndInt32 i) const
+{
+	ndAssert(i >= 0);
+	ndAssert(i < m_count);
+	return m_nodes[i].m_info;
+}
+
+inline void ndContactPointList::SetCount(ndInt32 count)
+{
+	ndAssert(count >= 0);
+	ndAssert(count <= D_MAX_CONTACT_POINTS);
+	m_count = count;
+}
+
+inline ndContactPointList::ndNode* ndContactPointList::Append()
+{
+	ndAssert(m_count < D_MAX_CONTACT_POINTS);
+	ndNode* const node = &m_nodes[m_count];
+	node->m_info = ndContactMaterial();
+	m_count++;
+	return node;
+}
+
+inline void ndContactPointList::Remove(ndNode* const node)
+{
+	// shift the tail down, so that the nodes before the one 
+	// removed stay valid and the order of the points is preserved.
+	ndInt32 index = ndInt32(node - &m_nodes[0]);
+	ndAssert(index >= 0);
+	ndAssert(index < m_count);
+	m_count--;
+	for (; index < m_count; ++index)
+	{
+		m_nodes[index].m_info = m_nodes[index + 1].m_info;
+	}
+}
+
+inline void ndContactPointList::RemoveAll()
+{
+	m_count = 0;
+}
+
 //inline bool ndContact::IsActive() const
 //{
 //	return m_active ? true : false;
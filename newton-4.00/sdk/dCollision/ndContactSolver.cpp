@@ -24,8 +24,11 @@
 #include "ndScene.h"
 #include "ndShape.h"
 #include "ndContact.h"
+#include "ndShapeBox.h"
 #include "ndShapePoint.h"
 #include "ndShapeConvex.h"
+#include "ndShapeSphere.h"
+#include "ndShapeCapsule.h"
 #include "ndShapeCompound.h"
 #include "ndBodyKinematic.h"
 #include "ndContactSolver.h"
@@ -65,6 +68,23 @@ ndInt32 ndContactSolver::m_rayCastSimplex[4][4] =
 	{ 1, 0, 3, 2 },
 };
 
+bool ndContactSolver::m_analyticContacts = true;
+bool ndContactSolver::m_simplexWarmStart = true;
+
+// pairs that have a closed form closest points, the 
+// empty entries go through the gjk and epa search.
+ndContactSolver::ndAnalyticClosestPoints ndContactSolver::m_analyticClosestPoints[m_convexHull + 1][m_convexHull + 1] =
+{
+	// box, cone, sphere, capsule, cylinder, chamferCylinder, convexHull
+	{ &ndContactSolver::BoxToBoxClosestPoints, nullptr, &ndContactSolver::BoxToSphereClosestPoints, nullptr, nullptr, nullptr, nullptr },
+	{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+	{ &ndContactSolver::SphereToBoxClosestPoints, nullptr, &ndContactSolver::SphereToSphereClosestPoints, &ndContactSolver::SphereToCapsuleClosestPoints, nullptr, nullptr, nullptr },
+	{ nullptr, nullptr, &ndContactSolver::CapsuleToSphereClosestPoints, &ndContactSolver::CapsuleToCapsuleClosestPoints, nullptr, nullptr, nullptr },
+	{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+	{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+	{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+};
+
 D_MSV_NEWTON_ALIGN_32
 class ndContactSolver::ndBoxBoxDistance2
 {
@@ -350,6 +370,7 @@ ndContactSolver::ndContactSolver()
 	,m_vertexIndex(0)
 	,m_pruneContacts(1)
 	,m_intersectionTestOnly(0)
+	,m_warmStart(0)
 {
 }
 
@@ -371,6 +392,7 @@ ndContactSolver::ndContactSolver(ndShapeInstance* const instance, ndContactNotif
 	,m_vertexIndex(0)
 	,m_pruneContacts(1)
 	,m_intersectionTestOnly(0)
+	,m_warmStart(0)
 {
 }
 
@@ -394,6 +416,7 @@ ndContactSolver::ndContactSolver(ndContact* const contact, ndContactNotify* cons
 	,m_vertexIndex(0)
 	,m_pruneContacts(1)
 	,m_intersectionTestOnly(0)
+	,m_warmStart(0)
 {
 }
 
@@ -417,6 +440,7 @@ ndContactSolver::ndContactSolver(const ndContactSolver& src, const ndShapeInstan
 	,m_vertexIndex(0)
 	,m_pruneContacts(src.m_pruneContacts)
 	,m_intersectionTestOnly(src.m_intersectionTestOnly)
+	,m_warmStart(0)
 {
 }
 
@@ -2349,6 +2373,172 @@ bool ndContactSolver::CalculateClosestPoints()
 	return simplexPointCount >= 0;
 }
 
+bool ndContactSolver::CalculateCachedClosestPoints()
+{
+	if (!(m_warmStart && m_simplexWarmStart) ||
+		(m_instance0.GetScaleType() == ndShapeInstance::m_global) ||
+		(m_instance1.GetScaleType() == ndShapeInstance::m_global))
+	{
+		return CalculateClosestPoints();
+	}
+
+	ndAssert(m_contact);
+	ndContactSimplexCache& cache = m_contact->m_simplexCache;
+	if ((cache.m_shape0 != m_instance0.GetShape()) || (cache.m_shape1 != m_instance1.GetShape()))
+	{
+		// first update of the pair, or one of the bodies changed shape
+		cache.Reset();
+	}
+	else if (CalculateFeatureClosestPoints(cache))
+	{
+		return true;
+	}
+
+	RestoreSimplex(cache);
+	const bool state = CalculateClosestPoints();
+	if (state)
+	{
+		SaveSimplex(cache);
+	}
+	else
+	{
+		cache.Reset();
+	}
+	return state;
+}
+
+bool ndContactSolver::CalculateFeatureClosestPoints(const ndContactSimplexCache& cache)
+{
+	if ((cache.m_feature0 < 0) || (cache.m_feature1 < 0))
+	{
+		return false;
+	}
+
+	// the epa normal is only reused while the pair is close to 
+	// the configuration it was calculated for.
+	const ndMatrix& matrix0 = m_instance0.m_globalMatrix;
+	const ndMatrix& matrix1 = m_instance1.m_globalMatrix;
+	const ndVector drift((matrix0.UntransformVector(matrix1.m_posit) - cache.m_origin) & ndVector::m_triplexMask);
+	if (drift.DotProduct(drift).GetScalar() > (D_FEATURE_CACHE_MAX_DRIFT * D_FEATURE_CACHE_MAX_DRIFT))
+	{
+		return false;
+	}
+
+	const ndVector normal0(matrix0.RotateVector(cache.m_normal0));
+	const ndVector normal1(matrix1.RotateVector(cache.m_normal1));
+	if (normal0.DotProduct(normal1).GetScalar() < D_FEATURE_CACHE_MAX_TILT)
+	{
+		return false;
+	}
+
+	ndInt32 feature0 = -1;
+	ndInt32 feature1 = -1;
+	const ndVector normal((normal0 + normal1).Normalize());
+	const ndVector localNormal0(matrix0.UnrotateVector(normal));
+	const ndVector localNormal1(matrix1.UnrotateVector(normal * ndVector::m_negOne));
+	const ndVector point0(m_instance0.SupportVertexSpecial(localNormal0, &feature0));
+	const ndVector point1(m_instance1.SupportVertexSpecial(localNormal1, &feature1));
+	if ((feature0 != cache.m_feature0) || (feature1 != cache.m_feature1))
+	{
+		return false;
+	}
+
+	const ndVector closestPoint0(matrix0.TransformVector(m_instance0.SupportVertexSpecialProjectPoint(point0, localNormal0)));
+	const ndVector closestPoint1(matrix1.TransformVector(m_instance1.SupportVertexSpecialProjectPoint(point1, localNormal1)));
+	if (normal.DotProduct(closestPoint1 - closestPoint0).GetScalar() > ndFloat32(0.0f))
+	{
+		// the shapes may have separated, the gjk finds the distance
+		return false;
+	}
+
+	m_separatingVector = normal;
+	m_closestPoint0 = closestPoint0;
+	m_closestPoint1 = closestPoint1;
+	return true;
+}
+
+void ndContactSolver::RestoreSimplex(const ndContactSimplexCache& cache)
+{
+	const ndMatrix& matrix0 = m_instance0.m_globalMatrix;
+	const ndMatrix& matrix1 = m_instance1.m_globalMatrix;
+	const ndVector scale0(m_instance0.GetScale());
+	const ndVector scale1(m_instance1.GetScale());
+
+	ndInt32 count = 0;
+	for (ndInt32 i = 0; i < cache.m_count; ++i)
+	{
+		const ndVector p(matrix0.TransformVector(scale0 * cache.m_point0[i]) & ndVector::m_triplexMask);
+		const ndVector q(matrix1.TransformVector(scale1 * cache.m_point1[i]) & ndVector::m_triplexMask);
+		const ndVector diff(p - q);
+
+		bool duplicated = false;
+		for (ndInt32 j = 0; j < count; ++j)
+		{
+			const ndVector error(diff - m_hullDiff[j]);
+			duplicated = duplicated || (error.DotProduct(error).GetScalar() < ndFloat32(1.0e-12f));
+		}
+		if (!duplicated)
+		{
+			m_hullDiff[count] = diff;
+			m_hullSum[count] = p + q;
+			count++;
+		}
+	}
+
+	if (count == 3)
+	{
+		// the triangle may have collapsed with the motion of the bodies
+		const ndVector e10(m_hullDiff[1] - m_hullDiff[0]);
+		const ndVector e20(m_hullDiff[2] - m_hullDiff[0]);
+		const ndVector area(e10.CrossProduct(e20));
+		if (area.DotProduct(area).GetScalar() < ndFloat32(1.0e-12f))
+		{
+			count = 2;
+		}
+	}
+	m_vertexIndex = count;
+}
+
+void ndContactSolver::SaveSimplex(ndContactSimplexCache& cache)
+{
+	const ndMatrix& matrix0 = m_instance0.m_globalMatrix;
+	const ndMatrix& matrix1 = m_instance1.m_globalMatrix;
+	const ndVector invScale0(m_instance0.GetInvScale());
+	const ndVector invScale1(m_instance1.GetInvScale());
+
+	cache.m_shape0 = m_instance0.GetShape();
+	cache.m_shape1 = m_instance1.GetShape();
+	cache.m_count = ndMin(m_vertexIndex, ndInt32(3));
+	for (ndInt32 i = 0; i < cache.m_count; ++i)
+	{
+		const ndVector p(ndVector::m_half * (m_hullSum[i] + m_hullDiff[i]));
+		const ndVector q(ndVector::m_half * (m_hullSum[i] - m_hullDiff[i]));
+		cache.m_point0[i] = invScale0 * matrix0.UntransformVector(p);
+		cache.m_point1[i] = invScale1 * matrix1.UntransformVector(q);
+	}
+
+	cache.m_feature0 = -1;
+	cache.m_feature1 = -1;
+	if (m_separatingVector.DotProduct(m_closestPoint1 - m_closestPoint0).GetScalar() < ndFloat32(0.0f))
+	{
+		// only the polytopes report the index of their support vertex
+		ndInt32 feature0 = -1;
+		ndInt32 feature1 = -1;
+		const ndVector normal0(matrix0.UnrotateVector(m_separatingVector));
+		const ndVector normal1(matrix1.UnrotateVector(m_separatingVector));
+		m_instance0.SupportVertexSpecial(normal0, &feature0);
+		m_instance1.SupportVertexSpecial(normal1 * ndVector::m_negOne, &feature1);
+		if ((feature0 >= 0) && (feature1 >= 0))
+		{
+			cache.m_feature0 = feature0;
+			cache.m_feature1 = feature1;
+			cache.m_normal0 = normal0;
+			cache.m_normal1 = normal1;
+			cache.m_origin = matrix0.UntransformVector(matrix1.m_posit);
+		}
+	}
+}
+
 //*************************************************************
 // calculate proper separation distance for discrete collision.
 //*************************************************************
@@ -2445,8 +2635,19 @@ ndInt32 ndContactSolver::ConvexToConvexContactsDiscrete()
 	ndAssert(!m_instance0.GetShape()->GetAsShapeNull());
 	ndAssert(!m_instance1.GetShape()->GetAsShapeNull());
 
+	bool analytic = false;
+	if (m_analyticContacts)
+	{
+		const ndShapeID id0 = m_instance0.GetShape()->GetCollisionId();
+		const ndShapeID id1 = m_instance1.GetShape()->GetCollisionId();
+		if ((id0 <= m_convexHull) && (id1 <= m_convexHull) && m_analyticClosestPoints[id0][id1])
+		{
+			analytic = (this->*m_analyticClosestPoints[id0][id1])();
+		}
+	}
+
 	ndInt32 count = 0;
-	bool colliding = CalculateClosestPoints();
+	bool colliding = analytic || CalculateCachedClosestPoints();
 	ndFloat32 penetration = m_separatingVector.DotProduct(m_closestPoint1 - m_closestPoint0).GetScalar() - m_skinMargin - D_PENETRATION_TOL;
 	m_separationDistance = penetration;
 	if (m_intersectionTestOnly)
@@ -2457,7 +2658,16 @@ ndInt32 ndContactSolver::ConvexToConvexContactsDiscrete()
 	{
 		if (penetration <= ndFloat32(1.0e-5f))
 		{
-			if (ndInt8 (m_instance0.GetCollisionMode()) & ndInt8(m_instance1.GetCollisionMode()))
+			if (analytic && (m_instance0.GetShape()->GetAsShapeSphere() || m_instance1.GetShape()->GetAsShapeSphere()))
+			{
+				// a sphere touches at a single point
+				if (ndInt8(m_instance0.GetCollisionMode()) & ndInt8(m_instance1.GetCollisionMode()))
+				{
+					m_buffer[0] = ndVector::m_half * (m_closestPoint0 + m_closestPoint1);
+					count = 1;
+				}
+			}
+			else if (ndInt8 (m_instance0.GetCollisionMode()) & ndInt8(m_instance1.GetCollisionMode()))
 			{
 				count = CalculateContacts(m_closestPoint0, m_closestPoint1, m_separatingVector * ndVector::m_negOne);
 				// skip convex shape polygon because they could have a skirt
@@ -2522,6 +2732,452 @@ ndInt32 ndContactSolver::ConvexToConvexContactsDiscrete()
 	return count;
 }
 
+bool ndContactSolver::GetAnalyticContacts()
+{
+	return m_analyticContacts;
+}
+
+void ndContactSolver::SetAnalyticContacts(bool state)
+{
+	m_analyticContacts = state;
+}
+
+bool ndContactSolver::GetWarmStart()
+{
+	return m_simplexWarmStart;
+}
+
+void ndContactSolver::SetWarmStart(bool state)
+{
+	m_simplexWarmStart = state;
+}
+
+bool ndContactSolver::SetSpheresClosestPoints(const ndVector& center0, ndFloat32 radius0, const ndVector& center1, ndFloat32 radius1)
+{
+	const ndVector dir((center1 - center0) & ndVector::m_triplexMask);
+	const ndFloat32 dist2 = dir.DotProduct(dir).GetScalar();
+	if (dist2 < ndFloat32(1.0e-10f))
+	{
+		// concentric, let the gjk find a direction
+		return false;
+	}
+	// same penetration margin as the support functions of round shapes
+	m_separatingVector = dir.Scale(ndRsqrt(dist2));
+	m_closestPoint0 = center0 + m_separatingVector.Scale(radius0 - D_PENETRATION_TOL);
+	m_closestPoint1 = center1 - m_separatingVector.Scale(radius1 - D_PENETRATION_TOL);
+	return true;
+}
+
+bool ndContactSolver::SphereToSphereClosestPoints()
+{
+	if ((m_instance0.GetScaleType() != ndShapeInstance::m_unit) || (m_instance1.GetScaleType() != ndShapeInstance::m_unit))
+	{
+		return false;
+	}
+	const ndShapeSphere* const sphere0 = m_instance0.GetShape()->GetAsShapeSphere();
+	const ndShapeSphere* const sphere1 = m_instance1.GetShape()->GetAsShapeSphere();
+	return SetSpheresClosestPoints(m_instance0.m_globalMatrix.m_posit, sphere0->m_radius, m_instance1.m_globalMatrix.m_posit, sphere1->m_radius);
+}
+
+bool ndContactSolver::SphereToCapsuleClosestPoints()
+{
+	const ndShapeCapsule* const capsule = m_instance1.GetShape()->GetAsShapeCapsule();
+	if ((m_instance0.GetScaleType() != ndShapeInstance::m_unit) || (m_instance1.GetScaleType() != ndShapeInstance::m_unit) || (capsule->m_radius0 != capsule->m_radius1))
+	{
+		return false;
+	}
+	const ndShapeSphere* const sphere = m_instance0.GetShape()->GetAsShapeSphere();
+	const ndMatrix& matrix = m_instance1.m_globalMatrix;
+	const ndVector center(matrix.UntransformVector(m_instance0.m_globalMatrix.m_posit));
+	const ndVector closestPoint(ndClamp(center.m_x, -capsule->m_height, capsule->m_height), ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(1.0f));
+	return SetSpheresClosestPoints(m_instance0.m_globalMatrix.m_posit, sphere->m_radius, matrix.TransformVector(closestPoint), capsule->m_radius0);
+}
+
+bool ndContactSolver::CapsuleToSphereClosestPoints()
+{
+	const ndShapeCapsule* const capsule = m_instance0.GetShape()->GetAsShapeCapsule();
+	if ((m_instance0.GetScaleType() != ndShapeInstance::m_unit) || (m_instance1.GetScaleType() != ndShapeInstance::m_unit) || (capsule->m_radius0 != capsule->m_radius1))
+	{
+		return false;
+	}
+	const ndShapeSphere* const sphere = m_instance1.GetShape()->GetAsShapeSphere();
+	const ndMatrix& matrix = m_instance0.m_globalMatrix;
+	const ndVector center(matrix.UntransformVector(m_instance1.m_globalMatrix.m_posit));
+	const ndVector closestPoint(ndClamp(center.m_x, -capsule->m_height, capsule->m_height), ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(1.0f));
+	return SetSpheresClosestPoints(matrix.TransformVector(closestPoint), capsule->m_radius0, m_instance1.m_globalMatrix.m_posit, sphere->m_radius);
+}
+
+bool ndContactSolver::CapsuleToCapsuleClosestPoints()
+{
+	const ndShapeCapsule* const capsule0 = m_instance0.GetShape()->GetAsShapeCapsule();
+	const ndShapeCapsule* const capsule1 = m_instance1.GetShape()->GetAsShapeCapsule();
+	if ((m_instance0.GetScaleType() != ndShapeInstance::m_unit) || (m_instance1.GetScaleType() != ndShapeInstance::m_unit) ||
+		(capsule0->m_radius0 != capsule0->m_radius1) || (capsule1->m_radius0 != capsule1->m_radius1))
+	{
+		return false;
+	}
+
+	const ndMatrix& matrix0 = m_instance0.m_globalMatrix;
+	const ndMatrix& matrix1 = m_instance1.m_globalMatrix;
+	const ndVector p0(matrix0.m_posit - matrix0.m_front.Scale(capsule0->m_height));
+	const ndVector p1(matrix0.m_posit + matrix0.m_front.Scale(capsule0->m_height));
+	const ndVector q0(matrix1.m_posit - matrix1.m_front.Scale(capsule1->m_height));
+	const ndVector q1(matrix1.m_posit + matrix1.m_front.Scale(capsule1->m_height));
+
+	const ndFastRay ray(p0, p1);
+	const ndRay segment(ray.RayDistance(q0, q1));
+	return SetSpheresClosestPoints(segment.m_p0 | ndVector::m_wOne, capsule0->m_radius0, segment.m_p1 | ndVector::m_wOne, capsule1->m_radius0);
+}
+
+bool ndContactSolver::SphereToBoxClosestPoints(const ndShapeInstance& sphereInstance, const ndShapeInstance& boxInstance, ndVector& pointOnSphere, ndVector& pointOnBox, ndVector& dir) const
+{
+	if ((sphereInstance.GetScaleType() != ndShapeInstance::m_unit) || (boxInstance.GetScaleType() != ndShapeInstance::m_unit))
+	{
+		return false;
+	}
+
+	const ndShapeSphere* const sphere = ((ndShape*)sphereInstance.GetShape())->GetAsShapeSphere();
+	const ndShapeBox* const box = ((ndShape*)boxInstance.GetShape())->GetAsShapeBox();
+	const ndMatrix& matrix = boxInstance.m_globalMatrix;
+	const ndVector& size = box->m_size[0];
+	const ndVector center(matrix.UntransformVector(sphereInstance.m_globalMatrix.m_posit));
+
+	ndVector closestPoint(
+		ndClamp(center.m_x, -size.m_x, size.m_x),
+		ndClamp(center.m_y, -size.m_y, size.m_y),
+		ndClamp(center.m_z, -size.m_z, size.m_z), ndFloat32(1.0f));
+
+	ndVector normal((center - closestPoint) & ndVector::m_triplexMask);
+	const ndFloat32 dist2 = normal.DotProduct(normal).GetScalar();
+	if (dist2 > ndFloat32(1.0e-10f))
+	{
+		normal = normal.Scale(ndRsqrt(dist2));
+	}
+	else
+	{
+		// the center is inside the box, push it out the closest face
+		ndInt32 index = 0;
+		ndFloat32 minDist = ndFloat32(1.0e10f);
+		for (ndInt32 i = 0; i < 3; ++i)
+		{
+			const ndFloat32 dist = size[i] - ndAbs(center[i]);
+			if (dist < minDist)
+			{
+				index = i;
+				minDist = dist;
+			}
+		}
+		normal = ndVector::m_zero;
+		normal[index] = (center[index] >= ndFloat32(0.0f)) ? ndFloat32(1.0f) : ndFloat32(-1.0f);
+		closestPoint = center;
+		closestPoint[index] = normal[index] * size[index];
+	}
+
+	dir = matrix.RotateVector(normal);
+	pointOnBox = matrix.TransformVector(closestPoint);
+	pointOnSphere = sphereInstance.m_globalMatrix.m_posit - dir.Scale(sphere->m_radius - D_PENETRATION_TOL);
+	return true;
+}
+
+bool ndContactSolver::SphereToBoxClosestPoints()
+{
+	ndVector dir;
+	ndVector pointOnBox;
+	ndVector pointOnSphere;
+	if (!SphereToBoxClosestPoints(m_instance0, m_instance1, pointOnSphere, pointOnBox, dir))
+	{
+		return false;
+	}
+	m_separatingVector = dir * ndVector::m_negOne;
+	m_closestPoint0 = pointOnSphere;
+	m_closestPoint1 = pointOnBox;
+	return true;
+}
+
+bool ndContactSolver::BoxToSphereClosestPoints()
+{
+	ndVector dir;
+	ndVector pointOnBox;
+	ndVector pointOnSphere;
+	if (!SphereToBoxClosestPoints(m_instance1, m_instance0, pointOnSphere, pointOnBox, dir))
+	{
+		return false;
+	}
+	m_separatingVector = dir;
+	m_closestPoint0 = pointOnBox;
+	m_closestPoint1 = pointOnSphere;
+	return true;
+}
+
+void ndContactSolver::CalculateBatchedClosestPoints(ndBatchedPair* const pairs, ndInt32 count)
+{
+	ndAssert(count && (count <= 4));
+	ndBatchedPair batch[4];
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		// the unused lanes repeat the last pair
+		const ndBatchedPair& pair = pairs[ndMin(i, count - 1)];
+		ndAssert(((ndShape*)pair.m_instance0->GetShape())->GetAsShapeSphere());
+		batch[i].m_instance0 = pair.m_instance0;
+		batch[i].m_instance1 = pair.m_instance1;
+	}
+
+	if (((ndShape*)batch[0].m_instance1->GetShape())->GetAsShapeSphere())
+	{
+		SphereToSphereClosestPoints(batch);
+	}
+	else
+	{
+		SphereToBoxClosestPoints(batch);
+	}
+
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		pairs[i] = batch[i];
+	}
+}
+
+bool ndContactSolver::CalculateAnalyticClosestPoints(ndBatchedPair& pair)
+{
+	const ndContactSolver src;
+	ndContactSolver solver(src, *pair.m_instance0, *pair.m_instance1);
+	const ndShapeID id0 = solver.m_instance0.GetShape()->GetCollisionId();
+	const ndShapeID id1 = solver.m_instance1.GetShape()->GetCollisionId();
+	pair.m_valid = false;
+	if ((id0 <= m_convexHull) && (id1 <= m_convexHull) && m_analyticClosestPoints[id0][id1])
+	{
+		pair.m_valid = (solver.*m_analyticClosestPoints[id0][id1])();
+		pair.m_separatingVector = solver.m_separatingVector;
+		pair.m_closestPoint0 = solver.m_closestPoint0;
+		pair.m_closestPoint1 = solver.m_closestPoint1;
+	}
+	return pair.m_valid;
+}
+
+void ndContactSolver::SphereToSphereClosestPoints(ndBatchedPair* const pairs)
+{
+	// the same as SphereToSphereClosestPoints, for four 
+	// pairs of unit scale spheres in structure of arrays.
+	ndVector x0, y0, z0, w0;
+	ndVector x1, y1, z1, w1;
+	ndVector::Transpose4x4(x0, y0, z0, w0,
+		pairs[0].m_instance0->m_globalMatrix.m_posit, pairs[1].m_instance0->m_globalMatrix.m_posit,
+		pairs[2].m_instance0->m_globalMatrix.m_posit, pairs[3].m_instance0->m_globalMatrix.m_posit);
+	ndVector::Transpose4x4(x1, y1, z1, w1,
+		pairs[0].m_instance1->m_globalMatrix.m_posit, pairs[1].m_instance1->m_globalMatrix.m_posit,
+		pairs[2].m_instance1->m_globalMatrix.m_posit, pairs[3].m_instance1->m_globalMatrix.m_posit);
+
+	ndVector radius0;
+	ndVector radius1;
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		radius0[i] = ((ndShape*)pairs[i].m_instance0->GetShape())->GetAsShapeSphere()->m_radius;
+		radius1[i] = ((ndShape*)pairs[i].m_instance1->GetShape())->GetAsShapeSphere()->m_radius;
+	}
+	const ndVector penetrationTol(D_PENETRATION_TOL);
+	radius0 = radius0 - penetrationTol;
+	radius1 = radius1 - penetrationTol;
+
+	const ndVector minDist2(ndFloat32(1.0e-10f));
+	const ndVector dx(x1 - x0);
+	const ndVector dy(y1 - y0);
+	const ndVector dz(z1 - z0);
+	const ndVector dist2(dx * dx + dy * dy + dz * dz);
+	const ndVector invDist(dist2.GetMax(minDist2).InvSqrt());
+	const ndVector nx(dx * invDist);
+	const ndVector ny(dy * invDist);
+	const ndVector nz(dz * invDist);
+
+	ndVector normal[4];
+	ndVector point0[4];
+	ndVector point1[4];
+	ndVector::Transpose4x4(normal[0], normal[1], normal[2], normal[3], nx, ny, nz, ndVector::m_zero);
+	ndVector::Transpose4x4(point0[0], point0[1], point0[2], point0[3], x0 + nx * radius0, y0 + ny * radius0, z0 + nz * radius0, ndVector::m_one);
+	ndVector::Transpose4x4(point1[0], point1[1], point1[2], point1[3], x1 - nx * radius1, y1 - ny * radius1, z1 - nz * radius1, ndVector::m_one);
+
+	// concentric spheres go to the gjk
+	const ndInt32 validMask = (dist2 > minDist2).GetSignMask();
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		pairs[i].m_separatingVector = normal[i];
+		pairs[i].m_closestPoint0 = point0[i];
+		pairs[i].m_closestPoint1 = point1[i];
+		pairs[i].m_valid = (validMask >> i) & 1;
+	}
+}
+
+void ndContactSolver::SphereToBoxClosestPoints(ndBatchedPair* const pairs)
+{
+	// the same as SphereToBoxClosestPoints, for four pairs of 
+	// unit scale spheres and boxes in structure of arrays.
+	ndVector fx, fy, fz, fw;
+	ndVector ux, uy, uz, uw;
+	ndVector rx, ry, rz, rw;
+	ndVector px, py, pz, pw;
+	ndVector cx, cy, cz, cw;
+	ndVector sx, sy, sz, sw;
+	const ndMatrix& matrix0 = pairs[0].m_instance1->m_globalMatrix;
+	const ndMatrix& matrix1 = pairs[1].m_instance1->m_globalMatrix;
+	const ndMatrix& matrix2 = pairs[2].m_instance1->m_globalMatrix;
+	const ndMatrix& matrix3 = pairs[3].m_instance1->m_globalMatrix;
+	ndVector::Transpose4x4(fx, fy, fz, fw, matrix0.m_front, matrix1.m_front, matrix2.m_front, matrix3.m_front);
+	ndVector::Transpose4x4(ux, uy, uz, uw, matrix0.m_up, matrix1.m_up, matrix2.m_up, matrix3.m_up);
+	ndVector::Transpose4x4(rx, ry, rz, rw, matrix0.m_right, matrix1.m_right, matrix2.m_right, matrix3.m_right);
+	ndVector::Transpose4x4(px, py, pz, pw, matrix0.m_posit, matrix1.m_posit, matrix2.m_posit, matrix3.m_posit);
+	ndVector::Transpose4x4(cx, cy, cz, cw,
+		pairs[0].m_instance0->m_globalMatrix.m_posit, pairs[1].m_instance0->m_globalMatrix.m_posit,
+		pairs[2].m_instance0->m_globalMatrix.m_posit, pairs[3].m_instance0->m_globalMatrix.m_posit);
+	ndVector::Transpose4x4(sx, sy, sz, sw,
+		((ndShape*)pairs[0].m_instance1->GetShape())->GetAsShapeBox()->m_size[0],
+		((ndShape*)pairs[1].m_instance1->GetShape())->GetAsShapeBox()->m_size[0],
+		((ndShape*)pairs[2].m_instance1->GetShape())->GetAsShapeBox()->m_size[0],
+		((ndShape*)pairs[3].m_instance1->GetShape())->GetAsShapeBox()->m_size[0]);
+
+	ndVector radius;
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		radius[i] = ((ndShape*)pairs[i].m_instance0->GetShape())->GetAsShapeSphere()->m_radius;
+	}
+	radius = radius - ndVector(D_PENETRATION_TOL);
+
+	// sphere center in the space of the box, and its closest point on the box
+	const ndVector dx(cx - px);
+	const ndVector dy(cy - py);
+	const ndVector dz(cz - pz);
+	const ndVector localX(fx * dx + fy * dy + fz * dz);
+	const ndVector localY(ux * dx + uy * dy + uz * dz);
+	const ndVector localZ(rx * dx + ry * dy + rz * dz);
+	const ndVector boxX(localX.GetMax(sx * ndVector::m_negOne).GetMin(sx));
+	const ndVector boxY(localY.GetMax(sy * ndVector::m_negOne).GetMin(sy));
+	const ndVector boxZ(localZ.GetMax(sz * ndVector::m_negOne).GetMin(sz));
+
+	const ndVector minDist2(ndFloat32(1.0e-10f));
+	const ndVector nx(localX - boxX);
+	const ndVector ny(localY - boxY);
+	const ndVector nz(localZ - boxZ);
+	const ndVector dist2(nx * nx + ny * ny + nz * nz);
+	const ndVector invDist(dist2.GetMax(minDist2).InvSqrt());
+
+	// back to global space, the normal points from the box to the sphere
+	const ndVector localNx(nx * invDist);
+	const ndVector localNy(ny * invDist);
+	const ndVector localNz(nz * invDist);
+	const ndVector dirX(fx * localNx + ux * localNy + rx * localNz);
+	const ndVector dirY(fy * localNx + uy * localNy + ry * localNz);
+	const ndVector dirZ(fz * localNx + uz * localNy + rz * localNz);
+
+	ndVector normal[4];
+	ndVector point0[4];
+	ndVector point1[4];
+	ndVector::Transpose4x4(normal[0], normal[1], normal[2], normal[3], dirX * ndVector::m_negOne, dirY * ndVector::m_negOne, dirZ * ndVector::m_negOne, ndVector::m_zero);
+	ndVector::Transpose4x4(point0[0], point0[1], point0[2], point0[3], cx - dirX * radius, cy - dirY * radius, cz - dirZ * radius, ndVector::m_one);
+	ndVector::Transpose4x4(point1[0], point1[1], point1[2], point1[3],
+		px + fx * boxX + ux * boxY + rx * boxZ,
+		py + fy * boxX + uy * boxY + ry * boxZ,
+		pz + fz * boxX + uz * boxY + rz * boxZ, ndVector::m_one);
+
+	// centers inside the boxes go to the scalar kernel
+	const ndInt32 validMask = (dist2 > minDist2).GetSignMask();
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		pairs[i].m_separatingVector = normal[i];
+		pairs[i].m_closestPoint0 = point0[i];
+		pairs[i].m_closestPoint1 = point1[i];
+		pairs[i].m_valid = (validMask >> i) & 1;
+	}
+}
+
+bool ndContactSolver::BoxToBoxClosestPoints()
+{
+	if ((m_instance0.GetScaleType() != ndShapeInstance::m_unit) || (m_instance1.GetScaleType() != ndShapeInstance::m_unit))
+	{
+		return false;
+	}
+
+	// separating axis test in the space of box0, the 3 faces of each box
+	// and the 9 edge pairs. the axis with the largest separation is the 
+	// contact normal, edge axes are only taken if they are clearly better, 
+	// so that resting boxes get face contacts.
+	const ndVector& size0 = m_instance0.GetShape()->GetAsShapeBox()->m_size[0];
+	const ndVector& size1 = m_instance1.GetShape()->GetAsShapeBox()->m_size[0];
+	const ndMatrix& matrix0 = m_instance0.m_globalMatrix;
+	const ndMatrix matrix(m_instance1.m_globalMatrix * matrix0.Inverse());
+	const ndVector origin(matrix.m_posit & ndVector::m_triplexMask);
+
+	auto Separation = [&size0, &size1, &matrix, &origin](const ndVector& axis)
+	{
+		const ndFloat32 radius0 = (size0 * axis.Abs()).AddHorizontal().GetScalar();
+		const ndFloat32 radius1 = 
+			size1.m_x * ndAbs(axis.DotProduct(matrix.m_front).GetScalar()) +
+			size1.m_y * ndAbs(axis.DotProduct(matrix.m_up).GetScalar()) +
+			size1.m_z * ndAbs(axis.DotProduct(matrix.m_right).GetScalar());
+		return ndAbs(axis.DotProduct(origin).GetScalar()) - radius0 - radius1;
+	};
+
+	ndVector axis(ndVector::m_zero);
+	ndFloat32 separation = ndFloat32(-1.0e10f);
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		ndVector faceAxis(ndVector::m_zero);
+		faceAxis[i] = ndFloat32(1.0f);
+		const ndFloat32 dist0 = Separation(faceAxis);
+		if (dist0 > separation)
+		{
+			axis = faceAxis;
+			separation = dist0;
+		}
+		const ndFloat32 dist1 = Separation(matrix[i] & ndVector::m_triplexMask);
+		if (dist1 > separation)
+		{
+			axis = matrix[i] & ndVector::m_triplexMask;
+			separation = dist1;
+		}
+	}
+
+	const ndFloat32 faceSeparation = separation;
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		ndVector edge0(ndVector::m_zero);
+		edge0[i] = ndFloat32(1.0f);
+		for (ndInt32 j = 0; j < 3; ++j)
+		{
+			const ndVector edgeAxis(edge0.CrossProduct(matrix[j]) & ndVector::m_triplexMask);
+			const ndFloat32 mag2 = edgeAxis.DotProduct(edgeAxis).GetScalar();
+			if (mag2 > ndFloat32(1.0e-6f))
+			{
+				const ndVector unitAxis(edgeAxis.Scale(ndRsqrt(mag2)));
+				const ndFloat32 dist = Separation(unitAxis);
+				if ((dist > separation) && (dist > (faceSeparation + D_PENETRATION_TOL)))
+				{
+					axis = unitAxis;
+					separation = dist;
+				}
+			}
+		}
+	}
+
+	if (axis.DotProduct(origin).GetScalar() < ndFloat32(0.0f))
+	{
+		axis = axis * ndVector::m_negOne;
+	}
+
+	// the deepest vertex of each box along the axis
+	const ndVector localAxis1(matrix.UnrotateVector(axis));
+	const ndVector support0(
+		(axis.m_x >= ndFloat32(0.0f)) ? size0.m_x : -size0.m_x,
+		(axis.m_y >= ndFloat32(0.0f)) ? size0.m_y : -size0.m_y,
+		(axis.m_z >= ndFloat32(0.0f)) ? size0.m_z : -size0.m_z, ndFloat32(1.0f));
+	const ndVector support1(
+		(localAxis1.m_x >= ndFloat32(0.0f)) ? -size1.m_x : size1.m_x,
+		(localAxis1.m_y >= ndFloat32(0.0f)) ? -size1.m_y : size1.m_y,
+		(localAxis1.m_z >= ndFloat32(0.0f)) ? -size1.m_z : size1.m_z, ndFloat32(1.0f));
+
+	m_separatingVector = matrix0.RotateVector(axis);
+	m_closestPoint0 = matrix0.TransformVector(support0);
+	m_closestPoint1 = m_instance1.m_globalMatrix.TransformVector(support1);
+	return true;
+}
+
 ndInt32 ndContactSolver::CompoundContactsDiscrete()
 {
 	if (!m_instance1.GetShape()->GetAsShapeCompound())
@@ -29,6 +29,7 @@
 class ndPlane;
 class ndBodyKinematic;
 class ndContactNotify;
+class ndContactSimplexCache;
 class ndPolygonMeshDesc;
 
 D_MSV_NEWTON_ALIGN_32
@@ -51,6 +52,8 @@ class ndMinkFace
 #define D_PENETRATION_TOL				ndFloat32 (1.0f / 1024.0f)
 #define D_MINK_VERTEX_ERR				ndFloat32 (1.0e-3f)
 #define D_MINK_VERTEX_ERR2				(D_MINK_VERTEX_ERR * D_MINK_VERTEX_ERR)
+#define D_FEATURE_CACHE_MAX_DRIFT		ndFloat32 (1.0f / 32.0f)
+#define D_FEATURE_CACHE_MAX_TILT		ndFloat32 (0.9998f)
 
 class ndContact;
 class dCollisionParamProxy;
@@ -69,7 +72,47 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 		const ndShapeInstance* const shapeB, const ndMatrix& matrixB, const ndVector& velocB,
 		ndFixSizeArray<ndContactPoint, 16>& contactOut, ndContactNotify* const notification);
 
+	/// Closed form contacts for the common primitive pairs.
+	/// \brief sphere, capsule and box pairs skip the gjk and epa search,
+	/// all other pairs use it. This is for debugging and testing, it must 
+	/// not be changed while a world is updating.
+	D_COLLISION_API static bool GetAnalyticContacts();
+	D_COLLISION_API static void SetAnalyticContacts(bool state);
+
+	/// Warm start the gjk of a contact joint from its last update.
+	/// \brief penetrating polytopes also skip the epa while the same
+	/// vertex pair supports the last normal. This is for debugging and 
+	/// testing, it must not be changed while a world is updating.
+	D_COLLISION_API static bool GetWarmStart();
+	D_COLLISION_API static void SetWarmStart(bool state);
+
+	// a pair of the batched narrow phase, the kernels 
+	// calculate the closest points of four pairs at once.
+	class ndBatchedPair
+	{
+		public:
+		ndVector m_separatingVector;
+		ndVector m_closestPoint0;
+		ndVector m_closestPoint1;
+		const ndShapeInstance* m_instance0;
+		const ndShapeInstance* m_instance1;
+		bool m_valid;
+	};
+
+	/// Closest points of one to four unit scale sphere pairs, or sphere and box pairs.
+	/// \brief all the pairs must be of the same kind, with the sphere first. 
+	/// They are solved at once by the four wide kernels, pairs that are not
+	/// valid must be solved by the gjk.
+	D_COLLISION_API static void CalculateBatchedClosestPoints(ndBatchedPair* const pairs, ndInt32 count);
+
+	/// Closest points of a pair by the scalar closed form kernels, in the batched format.
+	/// \brief returns false if the pair has no closed form or needs the gjk.
+	/// This is for testing the batched kernels against.
+	D_COLLISION_API static bool CalculateAnalyticClosestPoints(ndBatchedPair& pair);
+
 	private:
+	typedef bool (ndContactSolver::*ndAnalyticClosestPoints)();
+
 	ndContactSolver(ndContact* const contact, ndContactNotify* const notification, ndFloat32 timestep, ndInt32 threadId);
 	ndContactSolver(ndShapeInstance* const instance, ndContactNotify* const notification, ndFloat32 timestep, ndInt32 threadId);
 	ndContactSolver(const ndContactSolver& src, const ndShapeInstance& instance0, const ndShapeInstance& instance1);
@@ -91,6 +134,18 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 	ndInt32 CalculatePolySoupToHullContactsDescrete(ndPolygonMeshDesc& data); // done
 	ndInt32 ConvexToSaticStaticBvhContactsNodeDescrete(const ndAabbPolygonSoup::ndNode* const node); // done
 
+	bool BoxToBoxClosestPoints();
+	bool BoxToSphereClosestPoints();
+	bool SphereToBoxClosestPoints();
+	bool SphereToSphereClosestPoints();
+	bool SphereToCapsuleClosestPoints();
+	bool CapsuleToSphereClosestPoints();
+	bool CapsuleToCapsuleClosestPoints();
+	bool SphereToBoxClosestPoints(const ndShapeInstance& sphere, const ndShapeInstance& box, ndVector& pointOnSphere, ndVector& pointOnBox, ndVector& dir) const;
+	bool SetSpheresClosestPoints(const ndVector& center0, ndFloat32 radius0, const ndVector& center1, ndFloat32 radius1);
+	static void SphereToSphereClosestPoints(ndBatchedPair* const pairs);
+	static void SphereToBoxClosestPoints(ndBatchedPair* const pairs);
+
 	ndInt32 ConvexContactsContinue(); // done
 	ndInt32 CompoundContactsContinue(); // done
 	ndInt32 ConvexToConvexContactsContinue(); // done
@@ -118,6 +173,10 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 	inline ndMinkFace* AddFace(ndInt32 v0, ndInt32 v1, ndInt32 v2);
 
 	bool CalculateClosestPoints();
+	bool CalculateCachedClosestPoints();
+	bool CalculateFeatureClosestPoints(const ndContactSimplexCache& cache);
+	void RestoreSimplex(const ndContactSimplexCache& cache);
+	void SaveSimplex(ndContactSimplexCache& cache);
 	ndInt32 CalculateClosestSimplex();
 	
 	ndInt32 CalculateIntersectingPlane(ndInt32 count);
@@ -166,6 +225,7 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 	ndInt32 m_vertexIndex;
 	ndUnsigned32 m_pruneContacts		: 1;
 	ndUnsigned32 m_intersectionTestOnly	: 1;
+	ndUnsigned32 m_warmStart			: 1;
 	
 	ndMinkFace* m_faceStack[D_CONVEX_MINK_STACK_SIZE];
 	ndMinkFace* m_coneFaceList[D_CONVEX_MINK_STACK_SIZE];
@@ -178,6 +238,9 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 
 	static ndVector m_hullDirs[14]; 
 	static ndInt32 m_rayCastSimplex[4][4];
+	static ndAnalyticClosestPoints m_analyticClosestPoints[m_convexHull + 1][m_convexHull + 1];
+	static bool m_analyticContacts;
+	static bool m_simplexWarmStart;
 
 	friend class ndScene;
 	friend class ndShapeConvex;
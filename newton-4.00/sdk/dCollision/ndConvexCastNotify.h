@@ -29,6 +29,16 @@ class ndBody;
 class ndScene;
 class ndShapeInstance;
 
+/// One shape sweep of a batched convex cast query, see ndScene::ConvexCast.
+D_MSV_NEWTON_ALIGN_32
+class ndConvexCastQuery
+{
+	public:
+	ndMatrix m_origin;
+	ndVector m_dest;
+	const ndShapeInstance* m_shape;
+} D_GCC_NEWTON_ALIGN_32;
+
 D_MSV_NEWTON_ALIGN_32
 class ndConvexCastNotify : public ndClassAlloc
 {
@@ -162,8 +162,10 @@ class ndJointBilateralConstraint : public ndConstraint
 	friend class ndIkSolver;
 	friend class ndDynamicsUpdate;
 	friend class ndSkeletonContainer;
+	friend class ndWorldSnapshot;
 	friend class ndDynamicsUpdateSoa;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateCuda;
 	friend class ndDynamicsUpdateOpencl;
 };
@@ -26,6 +26,26 @@
 #include "ndBody.h"
 #include "ndContact.h"
 
+/// One segment of a batched ray cast query, see ndScene::RayCast.
+D_MSV_NEWTON_ALIGN_32
+class ndRayCastQuery
+{
+	public:
+	ndVector m_origin;
+	ndVector m_dest;
+} D_GCC_NEWTON_ALIGN_32;
+
+/// Closest hit of one batched ray or convex cast query.
+/// \brief m_param is the fraction of the segment at the hit, 
+/// a value larger than or equal to one means that the query hit nothing.
+D_MSV_NEWTON_ALIGN_32
+class ndRayCastHit
+{
+	public:
+	ndContactPoint m_contact;
+	ndFloat32 m_param;
+} D_GCC_NEWTON_ALIGN_32;
+
 D_MSV_NEWTON_ALIGN_32
 class ndRayCastNotify : public ndClassAlloc
 {
@@ -49,13 +49,16 @@ ndScene::ndScene()
 	,m_bodyList()
 	,m_contactArray()
 	,m_bvhSceneManager()
-	,m_scratchBuffer(1024 * sizeof (void*))
+	,m_frameArena()
 	,m_sceneBodyArray(1024)
 	,m_activeConstraintArray(1024)
 	,m_specialUpdateList()
 	,m_backgroundThread()
 	,m_newPairs(1024)
 	,m_lock()
+	,m_queryLock()
+	,m_contactScratchMark()
+	,m_contactScratch(nullptr)
 	,m_rootNode(nullptr)
 	,m_sentinelBody(nullptr)
 	,m_contactNotifyCallback(new ndContactNotify())
@@ -79,13 +82,16 @@ ndScene::ndScene(const ndScene& src)
 	,m_bodyList(src.m_bodyList)
 	,m_contactArray(src.m_contactArray)
 	,m_bvhSceneManager(src.m_bvhSceneManager)
-	,m_scratchBuffer()
+	,m_frameArena()
 	,m_sceneBodyArray()
 	,m_activeConstraintArray()
 	,m_specialUpdateList()
 	,m_backgroundThread()
 	,m_newPairs(1024)
 	,m_lock()
+	,m_queryLock()
+	,m_contactScratchMark()
+	,m_contactScratch(nullptr)
 	,m_rootNode(nullptr)
 	,m_sentinelBody(nullptr)
 	,m_contactNotifyCallback(nullptr)
@@ -100,7 +106,6 @@ ndScene::ndScene(const ndScene& src)
 	SetThreadCount(src.GetThreadCount());
 	m_backgroundThread.SetThreadCount(m_backgroundThread.GetThreadCount());
 
-	m_scratchBuffer.Swap(stealData->m_scratchBuffer);
 	m_sceneBodyArray.Swap(stealData->m_sceneBodyArray);
 	m_activeConstraintArray.Swap(stealData->m_activeConstraintArray);
 
@@ -225,9 +230,11 @@ bool ndScene::RemoveBody(ndSharedPtr<ndBodyKinematic>& body)
 	m_bvhSceneManager.RemoveBody(*body);
 
 	ndBodyKinematic::ndContactMap& contactMap = body->GetContactMap();
-	while (contactMap.GetRoot())
+	while (contactMap.GetCount())
 	{
-		ndContact* const contact = contactMap.GetRoot()->GetInfo();
+		ndBodyKinematic::ndContactMap::Iterator it(contactMap);
+		it.Begin();
+		ndContact* const contact = *it;
 		m_contactArray.DetachContact(contact);
 	}
 
@@ -254,11 +261,26 @@ void ndScene::BalanceScene()
 	UpdateBodyList();
 	if (m_bvhSceneManager.GetNodeArray().GetCount() > 2)
 	{
+		const ndInt32 sceneUpdatePeriod = 64;
 		if (!m_forceBalanceSceneCounter)
 		{
 			m_rootNode = m_bvhSceneManager.BuildBvhTree(*this);
 		}
-		const ndInt32 sceneUpdatePeriod = 64;
+		else if (m_bvhSceneManager.GetBackgroundBuild())
+		{
+			ndBvhNode* const root = m_bvhSceneManager.EndBackgroundBuild(*this);
+			if (root)
+			{
+				m_rootNode = root;
+			}
+			if ((m_forceBalanceSceneCounter >= sceneUpdatePeriod) && m_bvhSceneManager.BeginBackgroundBuild(m_backgroundThread))
+			{
+				// the tree is now built in the background, so skip the 
+				// rebuild on the update thread. If the build can not be 
+				// started the counter wraps to zero and forces it instead.
+				m_forceBalanceSceneCounter = 0;
+			}
+		}
 		m_forceBalanceSceneCounter = (m_forceBalanceSceneCounter < sceneUpdatePeriod) ? m_forceBalanceSceneCounter + 1 : 0;
 		ndAssert(!m_rootNode || !m_rootNode->m_parent);
 	}
@@ -337,6 +359,7 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 		ndContactSolver contactSolver(contact, m_contactNotifyCallback, m_timestep, threadIndex);
 		contactSolver.m_separatingVector = contact->m_separatingVector;
 		contactSolver.m_contactBuffer = contactBuffer;
+		contactSolver.m_warmStart = 1;
 		contactSolver.m_intersectionTestOnly = body0->m_contactTestOnly | body1->m_contactTestOnly;
 		
 		ndInt32 count = contactSolver.CalculateContactsDiscrete ();
@@ -358,7 +381,7 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 			else
 			{
 				ndAssert(count <= (D_CONSTRAINT_MAX_ROWS / 3));
-				ProcessContacts(threadIndex, count, &contactSolver);
+				ProcessContacts(threadIndex, contact, count, contactBuffer);
 				ndAssert(contact->m_maxDOF);
 				contact->m_isIntersetionTestOnly = 0;
 			}
@@ -379,9 +402,8 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 	}
 }
 
-void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* const contactSolver)
+void ndScene::ProcessContacts(ndInt32, ndContact* const contact, ndInt32 contactCount, const ndContactPoint* const contactArray)
 {
-	ndContact* const contact = contactSolver->m_contact;
 	contact->m_positAcc = ndVector::m_zero;
 	contact->m_rotationAcc = ndQuaternion();
 
@@ -392,18 +414,25 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 	ndAssert(body0 != body1);
 
 	contact->m_material = m_contactNotifyCallback->GetMaterial(contact, body0->GetCollisionShape(), body1->GetCollisionShape());
-	const ndContactPoint* const contactArray = contactSolver->m_contactBuffer;
 	
+	// save the position and the forces of the old points, the new points 
+	// overwrite the array in place, and inherit the forces of the closest 
+	// old point so that the solver still get a good initial guess.
 	ndInt32 count = 0;
-	ndVector cachePosition[D_MAX_CONTATCS];
-	ndContactPointList::ndNode* nodes[D_MAX_CONTATCS];
+	ndVector cachePosition[D_MAX_CONTACT_POINTS];
+	ndForceImpactPair cacheForces[D_MAX_CONTACT_POINTS][3];
 	ndContactPointList& contactPointList = contact->m_contacPointsList;
-	for (ndContactPointList::ndNode* contactNode = contactPointList.GetFirst(); contactNode; contactNode = contactNode->GetNext()) 
+	for (ndInt32 i = 0; i < contactPointList.GetCount(); ++i)
 	{
-		nodes[count] = contactNode;
-		cachePosition[count] = contactNode->GetInfo().m_point;
+		const ndContactMaterial& contactPoint = contactPointList[i];
+		cachePosition[count] = contactPoint.m_point;
+		cacheForces[count][0] = contactPoint.m_normal_Force;
+		cacheForces[count][1] = contactPoint.m_dir0_Force;
+		cacheForces[count][2] = contactPoint.m_dir1_Force;
 		count++;
 	}
+	ndAssert(contactCount <= contactPointList.GetCapacity());
+	contactPointList.SetCount(contactCount);
 	
 	const ndVector& v0 = body0->m_veloc;
 	const ndVector& w0 = body0->m_omega;
@@ -449,7 +478,6 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 	{
 		ndInt32 index = -1;
 		ndFloat32 min = ndFloat32(1.0e20f);
-		ndContactPointList::ndNode* contactNode = nullptr;
 		for (ndInt32 j = 0; j < count; ++j) 
 		{
 			ndVector v(ndVector::m_triplexMask & (cachePosition[j] - contactArray[i].m_point));
@@ -459,23 +487,27 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 			{
 				index = j;
 				min = diff;
-				contactNode = nodes[j];
 			}
 		}
-	
-		if (contactNode) 
+
+		ndContactMaterial* const contactPoint = &contactPointList[i];
+		if (index != -1) 
 		{
 			count--;
-			ndAssert(index != -1);
-			nodes[index] = nodes[count];
+			contactPoint->m_normal_Force = cacheForces[index][0];
+			contactPoint->m_dir0_Force = cacheForces[index][1];
+			contactPoint->m_dir1_Force = cacheForces[index][2];
 			cachePosition[index] = cachePosition[count];
+			cacheForces[index][0] = cacheForces[count][0];
+			cacheForces[index][1] = cacheForces[count][1];
+			cacheForces[index][2] = cacheForces[count][2];
 		}
 		else 
 		{
-			contactNode = contactPointList.Append();
+			contactPoint->m_normal_Force.Clear();
+			contactPoint->m_dir0_Force.Clear();
+			contactPoint->m_dir1_Force.Clear();
 		}
-
-		ndContactMaterial* const contactPoint = &contactNode->GetInfo();
 	
 		ndAssert(ndCheckFloat(contactArray[i].m_point.m_x));
 		ndAssert(ndCheckFloat(contactArray[i].m_point.m_y));
@@ -566,11 +598,6 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 		ndAssert(contactPoint->m_normal.m_w == ndFloat32(0.0f));
 	}
 	
-	for (ndInt32 i = 0; i < count; ++i) 
-	{
-		contactPointList.Remove(nodes[i]);
-	}
-	
 	contact->m_maxDOF = ndUnsigned32(3 * contactPointList.GetCount());
 	m_contactNotifyCallback->OnContactCallback(contact, m_timestep);
 }
@@ -726,88 +753,92 @@ void ndScene::UpdateTransform()
 	ParallelExecute(TransformUpdate);
 }
 
-void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
+bool ndScene::BeginContactUpdate(ndContact* const contact)
 {
-	const ndUnsigned32 lru = m_lru - D_CONTACT_DELAY_FRAMES;
-
-	ndVector deltaTime(m_timestep);
 	ndBodyKinematic* const body0 = contact->GetBody0();
 	ndBodyKinematic* const body1 = contact->GetBody1();
 
 	ndAssert(!contact->m_isDead);
-	if (!(body0->m_equilibrium & body1->m_equilibrium))
+	if (body0->m_equilibrium & body1->m_equilibrium)
 	{
-		bool active = contact->IsActive();
-		if (ValidateContactCache(contact, deltaTime))
-		{
-			contact->m_sceneLru = m_lru;
-			contact->m_timeOfImpact = ndFloat32(1.0e10f);
-		}
-		else
-		{
-			contact->SetActive(false);
-			contact->m_positAcc = ndVector::m_zero;
-			contact->m_rotationAcc = ndQuaternion();
+		contact->m_sceneLru = m_lru;
+		return false;
+	}
 
-			ndFloat32 distance = contact->m_separationDistance;
-			if (distance >= D_NARROW_PHASE_DIST)
-			{
-				const ndVector veloc0(body0->GetVelocity());
-				const ndVector veloc1(body1->GetVelocity());
+	const ndVector deltaTime(m_timestep);
+	if (ValidateContactCache(contact, deltaTime))
+	{
+		contact->m_sceneLru = m_lru;
+		contact->m_timeOfImpact = ndFloat32(1.0e10f);
+		return false;
+	}
+
+	contact->SetActive(false);
+	contact->m_positAcc = ndVector::m_zero;
+	contact->m_rotationAcc = ndQuaternion();
+
+	ndFloat32 distance = contact->m_separationDistance;
+	if (distance >= D_NARROW_PHASE_DIST)
+	{
+		const ndVector veloc0(body0->GetVelocity());
+		const ndVector veloc1(body1->GetVelocity());
 				
-				const ndVector veloc(veloc1 - veloc0);
-				const ndVector omega0(body0->GetOmega());
-				const ndVector omega1(body1->GetOmega());
-				const ndShapeInstance* const collision0 = &body0->GetCollisionShape();
-				const ndShapeInstance* const collision1 = &body1->GetCollisionShape();
-				const ndVector scale(ndFloat32(1.0f), ndFloat32(3.5f) * collision0->GetBoxMaxRadius(), ndFloat32(3.5f) * collision1->GetBoxMaxRadius(), ndFloat32(0.0f));
-				const ndVector velocMag2(veloc.DotProduct(veloc).GetScalar(), omega0.DotProduct(omega0).GetScalar(), omega1.DotProduct(omega1).GetScalar(), ndFloat32(0.0f));
-				const ndVector velocMag(velocMag2.GetMax(ndVector::m_epsilon).InvSqrt() * velocMag2 * scale);
-				const ndFloat32 speed = velocMag.AddHorizontal().GetScalar() + ndFloat32(0.5f);
+		const ndVector veloc(veloc1 - veloc0);
+		const ndVector omega0(body0->GetOmega());
+		const ndVector omega1(body1->GetOmega());
+		const ndShapeInstance* const collision0 = &body0->GetCollisionShape();
+		const ndShapeInstance* const collision1 = &body1->GetCollisionShape();
+		const ndVector scale(ndFloat32(1.0f), ndFloat32(3.5f) * collision0->GetBoxMaxRadius(), ndFloat32(3.5f) * collision1->GetBoxMaxRadius(), ndFloat32(0.0f));
+		const ndVector velocMag2(veloc.DotProduct(veloc).GetScalar(), omega0.DotProduct(omega0).GetScalar(), omega1.DotProduct(omega1).GetScalar(), ndFloat32(0.0f));
+		const ndVector velocMag(velocMag2.GetMax(ndVector::m_epsilon).InvSqrt() * velocMag2 * scale);
+		const ndFloat32 speed = velocMag.AddHorizontal().GetScalar() + ndFloat32(0.5f);
 				
-				distance -= speed * m_timestep;
-				contact->m_separationDistance = distance;
-			}
-			if (distance < D_NARROW_PHASE_DIST)
-			{
-				CalculateJointContacts(threadIndex, contact);
-				if (contact->m_maxDOF || contact->m_isIntersetionTestOnly)
-				{
-					contact->SetActive(true);
-					contact->m_timeOfImpact = ndFloat32(1.0e10f);
-				}
-				contact->m_sceneLru = m_lru;
-			}
-			else
-			{
-				const ndBvhLeafNode* const bodyNode0 = m_bvhSceneManager.GetLeafNode(contact->GetBody0());
-				const ndBvhLeafNode* const bodyNode1 = m_bvhSceneManager.GetLeafNode(contact->GetBody1());
-				ndAssert(bodyNode0 && bodyNode0->GetAsSceneBodyNode());
-				ndAssert(bodyNode1 && bodyNode1->GetAsSceneBodyNode());
-				if (ndOverlapTest(bodyNode0->m_minBox, bodyNode0->m_maxBox, bodyNode1->m_minBox, bodyNode1->m_maxBox)) 
-				{
-					contact->m_sceneLru = m_lru;
-				}
-				else if (contact->m_sceneLru < lru) 
-				{
-					contact->m_isDead = 1;
-				}
-			}
-		}
+		distance -= speed * m_timestep;
+		contact->m_separationDistance = distance;
+	}
+	if (distance < D_NARROW_PHASE_DIST)
+	{
+		return true;
+	}
+
+	const ndBvhLeafNode* const bodyNode0 = m_bvhSceneManager.GetLeafNode(contact->GetBody0());
+	const ndBvhLeafNode* const bodyNode1 = m_bvhSceneManager.GetLeafNode(contact->GetBody1());
+	ndAssert(bodyNode0 && bodyNode0->GetAsSceneBodyNode());
+	ndAssert(bodyNode1 && bodyNode1->GetAsSceneBodyNode());
+	if (ndOverlapTest(bodyNode0->m_minBox, bodyNode0->m_maxBox, bodyNode1->m_minBox, bodyNode1->m_maxBox)) 
+	{
+		contact->m_sceneLru = m_lru;
+	}
+	else if (contact->m_sceneLru < (m_lru - D_CONTACT_DELAY_FRAMES))
+	{
+		contact->m_isDead = 1;
+	}
+	return false;
+}
 
-		if (active ^ contact->IsActive())
+void ndScene::EndContactUpdate(ndContact* const contact, bool active, bool narrowPhase)
+{
+	ndBodyKinematic* const body0 = contact->GetBody0();
+	ndBodyKinematic* const body1 = contact->GetBody1();
+
+	if (narrowPhase)
+	{
+		if (contact->m_maxDOF || contact->m_isIntersetionTestOnly)
 		{
-			ndAssert(body0->GetInvMass() > ndFloat32(0.0f));
-			body0->m_equilibrium = 0;
-			if (body1->GetInvMass() > ndFloat32(0.0f))
-			{
-				body1->m_equilibrium = 0;
-			}
+			contact->SetActive(true);
+			contact->m_timeOfImpact = ndFloat32(1.0e10f);
 		}
+		contact->m_sceneLru = m_lru;
 	}
-	else
+
+	if (active ^ contact->IsActive())
 	{
-		contact->m_sceneLru = m_lru;
+		ndAssert(body0->GetInvMass() > ndFloat32(0.0f));
+		body0->m_equilibrium = 0;
+		if (body1->GetInvMass() > ndFloat32(0.0f))
+		{
+			body1->m_equilibrium = 0;
+		}
 	}
 
 	if (!contact->m_isDead && (body0->m_equilibrium & body1->m_equilibrium & !contact->IsActive()))
@@ -823,6 +854,17 @@ void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
 	}
 }
 
+void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
+{
+	const bool active = contact->IsActive();
+	const bool narrowPhase = BeginContactUpdate(contact);
+	if (narrowPhase)
+	{
+		CalculateJointContacts(threadIndex, contact);
+	}
+	EndContactUpdate(contact, active, narrowPhase);
+}
+
 void ndScene::UpdateSpecial()
 {
 	for (ndSpecialList<ndBodyKinematic>::ndNode* node = m_specialUpdateList.GetFirst(); node; node = node->GetNext())
@@ -972,6 +1014,7 @@ bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndBvhNode** stackPo
 bool ndScene::RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const stackDistance, ndInt32 stack, const ndFastRay& ray) const
 {
 	bool state = false;
+	const ndRayBoxIntersectFunction rayBoxIntersect = ndSimdDispatch::GetRayBoxIntersect();
 	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
 	{
 		stack--;
@@ -1002,8 +1045,13 @@ bool ndScene::RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, nd
 			else
 			{
 				const ndBvhNode* const left = me->GetLeft();
+				const ndBvhNode* const right = me->GetRight();
 				ndAssert(left);
-				ndFloat32 dist1 = ray.BoxIntersect(left->m_minBox, left->m_maxBox);
+				ndAssert(right);
+				ndFloat32 childDist[2];
+				rayBoxIntersect(ray, left->m_minBox, left->m_maxBox, right->m_minBox, right->m_maxBox, childDist);
+
+				ndFloat32 dist1 = childDist[0];
 				if (dist1 < callback.m_param)
 				{
 					ndInt32 j = stack;
@@ -1018,9 +1066,7 @@ bool ndScene::RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, nd
 					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
 				}
 	
-				const ndBvhNode* const right = me->GetRight();
-				ndAssert(right);
-				dist1 = ray.BoxIntersect(right->m_minBox, right->m_maxBox);
+				dist1 = childDist[1];
 				if (dist1 < callback.m_param)
 				{
 					ndInt32 j = stack;
@@ -1091,6 +1137,7 @@ void ndScene::Cleanup()
 	m_frameNumber = 0;
 	m_subStepNumber = 0;
 
+	m_bvhSceneManager.SyncBackgroundBuild();
 	m_backgroundThread.Terminate();
 
 	if (m_sentinelBody)
@@ -1106,10 +1153,10 @@ void ndScene::Cleanup()
 	m_contactArray.Resize(1024);
 	m_sceneBodyArray.Resize(1024);
 	m_activeConstraintArray.Resize(1024);
-	m_scratchBuffer.Resize(1024 * sizeof(void*));
 
 	m_contactArray.SetCount(0);
-	m_scratchBuffer.SetCount(0);
+	m_contactScratch = nullptr;
+	m_frameArena.Release();
 	m_sceneBodyArray.SetCount(0);
 	m_activeConstraintArray.SetCount(0);
 }
@@ -1167,6 +1214,278 @@ bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& co
 	return state;
 }
 
+void ndScene::RayCastPacket(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count) const
+{
+	ndAssert(count <= D_SCENE_RAY_PACKET_SIZE);
+
+	// the packet is stored as a structure of arrays, one ray per lane.
+	ndFloat32 originArray[3][D_SCENE_RAY_PACKET_SIZE];
+	ndFloat32 invDirArray[3][D_SCENE_RAY_PACKET_SIZE];
+	ndFloat32 paramArray[D_SCENE_RAY_PACKET_SIZE];
+	ndRayCastClosestHitCallback callbacks[D_SCENE_RAY_PACKET_SIZE];
+
+	ndInt32 activeMask = 0;
+	for (ndInt32 i = 0; i < D_SCENE_RAY_PACKET_SIZE; ++i)
+	{
+		// inactive lanes have a negative param, so that they never hit a box
+		paramArray[i] = ndFloat32(-1.0f);
+		for (ndInt32 j = 0; j < 3; ++j)
+		{
+			originArray[j][i] = ndFloat32(0.0f);
+			invDirArray[j][i] = ndFloat32(0.0f);
+		}
+		if (i < count)
+		{
+			hits[i].m_param = ndFloat32(1.2f);
+			const ndVector p0(rays[i].m_origin & ndVector::m_triplexMask);
+			const ndVector p1(rays[i].m_dest & ndVector::m_triplexMask);
+			const ndVector segment(p1 - p0);
+			if (segment.DotProduct(segment).GetScalar() > ndFloat32(1.0e-8f))
+			{
+				const ndVector isParallel(segment.Abs() < ndVector(ndFloat32(1.0e-8f)));
+				const ndVector invDir(segment.Select(ndVector(ndFloat32(1.0e-20f)), isParallel).Reciproc());
+				for (ndInt32 j = 0; j < 3; ++j)
+				{
+					originArray[j][i] = p0[j];
+					invDirArray[j][i] = invDir[j];
+				}
+				paramArray[i] = ndFloat32(1.0f);
+				activeMask |= 1 << i;
+			}
+		}
+	}
+
+	if (!activeMask || !m_rootNode)
+	{
+		return;
+	}
+
+	const ndVector originX(originArray[0][0], originArray[0][1], originArray[0][2], originArray[0][3]);
+	const ndVector originY(originArray[1][0], originArray[1][1], originArray[1][2], originArray[1][3]);
+	const ndVector originZ(originArray[2][0], originArray[2][1], originArray[2][2], originArray[2][3]);
+	const ndVector invDirX(invDirArray[0][0], invDirArray[0][1], invDirArray[0][2], invDirArray[0][3]);
+	const ndVector invDirY(invDirArray[1][0], invDirArray[1][1], invDirArray[1][2], invDirArray[1][3]);
+	const ndVector invDirZ(invDirArray[2][0], invDirArray[2][1], invDirArray[2][2], invDirArray[2][3]);
+	ndVector param(paramArray[0], paramArray[1], paramArray[2], paramArray[3]);
+
+	// slab test of one box against all the rays of the packet, 
+	// returns the entry distance of each ray.
+	auto PacketBoxIntersect = [&originX, &originY, &originZ, &invDirX, &invDirY, &invDirZ](const ndBvhNode* const node, const ndVector& maxParam, ndVector& entry)
+	{
+		const ndVector tx0((ndVector(node->m_minBox.m_x) - originX) * invDirX);
+		const ndVector tx1((ndVector(node->m_maxBox.m_x) - originX) * invDirX);
+		const ndVector ty0((ndVector(node->m_minBox.m_y) - originY) * invDirY);
+		const ndVector ty1((ndVector(node->m_maxBox.m_y) - originY) * invDirY);
+		const ndVector tz0((ndVector(node->m_minBox.m_z) - originZ) * invDirZ);
+		const ndVector tz1((ndVector(node->m_maxBox.m_z) - originZ) * invDirZ);
+		const ndVector t0(ndVector::m_zero.GetMax(tx0.GetMin(tx1)).GetMax(ty0.GetMin(ty1)).GetMax(tz0.GetMin(tz1)));
+		const ndVector t1(maxParam.GetMin(tx0.GetMax(tx1)).GetMin(ty0.GetMax(ty1)).GetMin(tz0.GetMax(tz1)));
+		entry = t0;
+		return (t0 <= t1).GetSignMask();
+	};
+
+	auto PacketDistance = [](const ndVector& entry, ndInt32 mask)
+	{
+		ndFloat32 dist = ndFloat32(1.0e10f);
+		for (ndInt32 i = 0; i < D_SCENE_RAY_PACKET_SIZE; ++i)
+		{
+			dist = (mask & (1 << i)) ? ndMin(dist, entry[i]) : dist;
+		}
+		return dist;
+	};
+
+	ndVector entryPool[D_SCENE_MAX_STACK_DEPTH];
+	const ndBvhNode* stackPool[D_SCENE_MAX_STACK_DEPTH];
+
+	ndInt32 stack = 0;
+	if (PacketBoxIntersect(m_rootNode, param, entryPool[0]) & activeMask)
+	{
+		stackPool[0] = m_rootNode;
+		stack = 1;
+	}
+
+	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+	{
+		stack--;
+		const ndBvhNode* const node = stackPool[stack];
+		const ndVector entry(entryPool[stack]);
+
+		// cull the rays that found a closer hit since the node was pushed
+		const ndInt32 laneMask = (entry <= param).GetSignMask() & activeMask;
+		if (!laneMask)
+		{
+			continue;
+		}
+
+		ndBodyKinematic* const body = node->GetBody();
+		if (body)
+		{
+			ndAssert(!node->GetLeft());
+			ndAssert(!node->GetRight());
+			for (ndInt32 i = 0; i < count; ++i)
+			{
+				if (laneMask & (1 << i))
+				{
+					const ndFastRay ray(rays[i].m_origin, rays[i].m_dest);
+					if (body->RayCast(callbacks[i], ray, callbacks[i].m_param))
+					{
+						paramArray[i] = callbacks[i].m_param;
+					}
+				}
+			}
+			param = ndVector(paramArray[0], paramArray[1], paramArray[2], paramArray[3]);
+		}
+		else
+		{
+			ndVector leftEntry;
+			ndVector rightEntry;
+			const ndBvhNode* const left = node->GetLeft();
+			const ndBvhNode* const right = node->GetRight();
+			ndAssert(left);
+			ndAssert(right);
+			const ndInt32 leftMask = PacketBoxIntersect(left, param, leftEntry) & laneMask;
+			const ndInt32 rightMask = PacketBoxIntersect(right, param, rightEntry) & laneMask;
+
+			// push the far node first, so that the near node is visited first.
+			if (leftMask && rightMask)
+			{
+				const bool leftIsNear = PacketDistance(leftEntry, leftMask) <= PacketDistance(rightEntry, rightMask);
+				stackPool[stack] = leftIsNear ? right : left;
+				entryPool[stack] = leftIsNear ? rightEntry : leftEntry;
+				stack++;
+				stackPool[stack] = leftIsNear ? left : right;
+				entryPool[stack] = leftIsNear ? leftEntry : rightEntry;
+				stack++;
+			}
+			else if (leftMask)
+			{
+				stackPool[stack] = left;
+				entryPool[stack] = leftEntry;
+				stack++;
+			}
+			else if (rightMask)
+			{
+				stackPool[stack] = right;
+				entryPool[stack] = rightEntry;
+				stack++;
+			}
+			ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+		}
+	}
+
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		if (callbacks[i].m_param < ndFloat32(1.0f))
+		{
+			hits[i].m_param = callbacks[i].m_param;
+			hits[i].m_contact = callbacks[i].m_contact;
+		}
+	}
+}
+
+void ndScene::RayCast(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count)
+{
+	D_TRACKTIME();
+	Sync();
+	const ndInt32 packetCount = (count + D_SCENE_RAY_PACKET_SIZE - 1) / D_SCENE_RAY_PACKET_SIZE;
+	ndWorkStealingRange range(packetCount, GetThreadCount());
+	auto RayCastPackets = ndMakeObject::ndFunction([this, rays, hits, count, &range](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(RayCastPackets);
+		ndStartEnd startEnd;
+		while (range.GetChunk(threadIndex, startEnd))
+		{
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				const ndInt32 start = i * D_SCENE_RAY_PACKET_SIZE;
+				const ndInt32 packetSize = ndMin(count - start, ndInt32(D_SCENE_RAY_PACKET_SIZE));
+				RayCastPacket(&rays[start], &hits[start], packetSize);
+			}
+		}
+	});
+
+	// the workers are parked outside of an update, and they are shared by 
+	// the queries of all the application threads, a batch that finds them 
+	// busy with the batch of another thread runs on the calling thread. 
+	// the pool is woken up directly, a query does not advance the frame.
+	if (m_queryLock.TryLock())
+	{
+		ndThreadPool::Begin();
+		ParallelExecute(RayCastPackets);
+		ndThreadPool::End();
+		m_queryLock.Unlock();
+	}
+	else
+	{
+		RayCastPackets(0, 1);
+	}
+}
+
+void ndScene::ConvexCast(const ndConvexCastQuery* const casts, ndRayCastHit* const hits, ndInt32 count)
+{
+	D_TRACKTIME();
+	class ndClosestConvexCastNotify : public ndConvexCastNotify
+	{
+		public:
+		ndUnsigned32 OnRayPrecastAction(const ndBody* const body, const ndShapeInstance* const)
+		{
+			// same filter as ndRayCastClosestHitCallback
+			return ndUnsigned32(((ndBody*)body)->GetAsBodyPlayerCapsule() ? 0 : 1);
+		}
+	};
+
+	// shapes are different for each query, so there are no packets here, 
+	// but the sweeps are still distributed over the threads.
+	Sync();
+	ndWorkStealingRange range(count, GetThreadCount());
+	auto ConvexCastQueries = ndMakeObject::ndFunction([this, casts, hits, &range](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(ConvexCastQueries);
+		ndStartEnd startEnd;
+		while (range.GetChunk(threadIndex, startEnd))
+		{
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				ndClosestConvexCastNotify callback;
+				const ndConvexCastQuery& query = casts[i];
+				hits[i].m_param = ndFloat32(1.2f);
+				if (ConvexCast(callback, *query.m_shape, query.m_origin, query.m_dest) && (callback.m_param < ndFloat32(1.0f)))
+				{
+					hits[i].m_param = callback.m_param;
+					hits[i].m_contact = callback.m_contacts[0];
+					hits[i].m_contact.m_normal = callback.m_normal;
+				}
+			}
+		}
+	});
+
+	// the workers are parked outside of an update, and they are shared by 
+	// the queries of all the application threads, a batch that finds them 
+	// busy with the batch of another thread runs on the calling thread. 
+	// the pool is woken up directly, a query does not advance the frame.
+	if (m_queryLock.TryLock())
+	{
+		ndThreadPool::Begin();
+		ParallelExecute(ConvexCastQueries);
+		ndThreadPool::End();
+		m_queryLock.Unlock();
+	}
+	else
+	{
+		ConvexCastQueries(0, 1);
+	}
+}
+
+bool ndScene::GetBackgroundBvhBuild() const
+{
+	return m_bvhSceneManager.GetBackgroundBuild();
+}
+
+void ndScene::SetBackgroundBvhBuild(bool state)
+{
+	m_bvhSceneManager.SetBackgroundBuild(state);
+}
+
 void ndScene::SendBackgroundTask(ndBackgroundTask* const job)
 {
 	m_backgroundThread.SendTask(job);
@@ -1194,39 +1513,53 @@ void ndScene::AddPair(ndBodyKinematic* const body0, ndBodyKinematic* const body1
 void ndScene::FindCollidingPairs()
 {
 	D_TRACKTIME();
-	auto FindPairs = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	// the cost of each body query depends on how crowded the neighborhood is,
+	// so the bodies are distributed with a work stealing range.
+	ndWorkStealingRange bodyRange(GetActiveBodyArray().GetCount() - 1, GetThreadCount());
+	ndWorkStealingRange sceneBodyRange(m_sceneBodyArray.GetCount(), GetThreadCount());
+
+	auto FindPairs = ndMakeObject::ndFunction([this, &bodyRange](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(FindPairs);
 		const ndArray<ndBodyKinematic*>& bodyArray = GetActiveBodyArray();
-		const ndStartEnd startEnd(bodyArray.GetCount() - 1, threadIndex, threadCount);
-		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		ndStartEnd startEnd;
+		while (bodyRange.GetChunk(threadIndex, startEnd))
 		{
-			ndBodyKinematic* const body = bodyArray[i];
-			FindCollidingPairs(body, threadIndex);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				ndBodyKinematic* const body = bodyArray[i];
+				FindCollidingPairs(body, threadIndex);
+			}
 		}
 	});
 
-	auto FindPairsForward = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	auto FindPairsForward = ndMakeObject::ndFunction([this, &sceneBodyRange](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(FindPairsForward);
 		const ndArray<ndBodyKinematic*>& bodyArray = m_sceneBodyArray;
-		const ndStartEnd startEnd(m_sceneBodyArray.GetCount(), threadIndex, threadCount);
-		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		ndStartEnd startEnd;
+		while (sceneBodyRange.GetChunk(threadIndex, startEnd))
 		{
-			ndBodyKinematic* const body = bodyArray[i];
-			FindCollidingPairsForward(body, threadIndex);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				ndBodyKinematic* const body = bodyArray[i];
+				FindCollidingPairsForward(body, threadIndex);
+			}
 		}
 	});
 
-	auto FindPairsBackward = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	auto FindPairsBackward = ndMakeObject::ndFunction([this, &sceneBodyRange](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(FindPairsBackward);
 		const ndArray<ndBodyKinematic*>& bodyArray = m_sceneBodyArray;
-		const ndStartEnd startEnd(m_sceneBodyArray.GetCount(), threadIndex, threadCount);
-		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		ndStartEnd startEnd;
+		while (sceneBodyRange.GetChunk(threadIndex, startEnd))
 		{
-			ndBodyKinematic* const body = bodyArray[i];
-			FindCollidingPairsBackward(body, threadIndex);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				ndBodyKinematic* const body = bodyArray[i];
+				FindCollidingPairsBackward(body, threadIndex);
+			}
 		}
 	});
 
@@ -1274,6 +1607,7 @@ void ndScene::FindCollidingPairs()
 	else
 	{
 		ParallelExecute(FindPairsForward);
+		sceneBodyRange.Reset();
 		ParallelExecute(FindPairsBackward);
 
 		ndUnsigned32 sum = 0;
@@ -1295,6 +1629,32 @@ void ndScene::FindCollidingPairs()
 			sum += count;
 		}
 	}
+
+	if (m_newPairs.GetCount() > 1)
+	{
+		// the threads steal the bodies in any order, the pairs are sorted
+		// so that contacts and joints are created in a deterministic order.
+		D_TRACKTIME_NAMED(SortNewPairs);
+		class ndComparePairs
+		{
+			public:
+			ndInt32 Compare(const ndContactPairs& pairA, const ndContactPairs& pairB, void* const) const
+			{
+				const ndUnsigned64 keyA = (ndUnsigned64(pairA.m_body0) << 32) + pairA.m_body1;
+				const ndUnsigned64 keyB = (ndUnsigned64(pairB.m_body0) << 32) + pairB.m_body1;
+				if (keyA < keyB)
+				{
+					return -1;
+				}
+				if (keyA > keyB)
+				{
+					return 1;
+				}
+				return 0;
+			}
+		};
+		ndSort<ndContactPairs, ndComparePairs>(&m_newPairs[0], m_newPairs.GetCount(), nullptr);
+	}
 }
 
 void ndScene::UpdateBodyList()
@@ -1332,6 +1692,33 @@ void ndScene::ApplyExtForce()
 	ParallelExecute(ApplyForce);
 }
 
+void ndScene::InitBody(ndInt32 index, ndBodyKinematic* const body)
+{
+	body->PrepareStep(index);
+	ndUnsigned8 sceneEquilibrium = 1;
+	ndUnsigned8 sceneForceUpdate = body->m_sceneForceUpdate;
+	if (ndUnsigned8(!body->m_equilibrium) | sceneForceUpdate)
+	{
+		ndBvhNodeArray& array = m_bvhSceneManager.GetNodeArray();
+		ndBvhLeafNode* const bodyNode = (ndBvhLeafNode*)array[body->m_bodyNodeIndex];
+		ndAssert(bodyNode->GetAsSceneBodyNode());
+		ndAssert(bodyNode->m_body == body);
+		ndAssert(!bodyNode->GetLeft());
+		ndAssert(!bodyNode->GetRight());
+		ndAssert(!body->GetCollisionShape().GetShape()->GetAsShapeNull());
+
+		body->UpdateCollisionMatrix();
+		const ndInt32 test = ndBoxInclusionTest(body->m_minAabb, body->m_maxAabb, bodyNode->m_minBox, bodyNode->m_maxBox);
+		if (!test)
+		{
+			bodyNode->SetAabb(body->m_minAabb, body->m_maxAabb);
+		}
+		sceneEquilibrium = ndUnsigned8(!sceneForceUpdate & (test != 0));
+	}
+	body->m_sceneForceUpdate = 0;
+	body->m_sceneEquilibrium = sceneEquilibrium;
+}
+
 void ndScene::InitBodyArray()
 {
 	D_TRACKTIME();
@@ -1340,38 +1727,46 @@ void ndScene::InitBodyArray()
 		D_TRACKTIME_NAMED(BuildBodyArray);
 		const ndArray<ndBodyKinematic*>& view = GetActiveBodyArray();
 
-		ndBvhNodeArray& array = m_bvhSceneManager.GetNodeArray();
 		const ndStartEnd startEnd(view.GetCount() - 1, threadIndex, threadCount);
 		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 		{
 			ndBodyKinematic* const body = view[i];
-			body->PrepareStep(i);
-			ndUnsigned8 sceneEquilibrium = 1;
-			ndUnsigned8 sceneForceUpdate = body->m_sceneForceUpdate;
-			if (ndUnsigned8(!body->m_equilibrium) | sceneForceUpdate)
-			{
-				ndBvhLeafNode* const bodyNode = (ndBvhLeafNode*)array[body->m_bodyNodeIndex];
-				ndAssert(bodyNode->GetAsSceneBodyNode());
-				ndAssert(bodyNode->m_body == body);
-				ndAssert(!bodyNode->GetLeft());
-				ndAssert(!bodyNode->GetRight());
-				ndAssert(!body->GetCollisionShape().GetShape()->GetAsShapeNull());
-
-				body->UpdateCollisionMatrix();
-				const ndInt32 test = ndBoxInclusionTest(body->m_minAabb, body->m_maxAabb, bodyNode->m_minBox, bodyNode->m_maxBox);
-				if (!test)
-				{
-					bodyNode->SetAabb(body->m_minAabb, body->m_maxAabb);
-				}
-				sceneEquilibrium = ndUnsigned8(!sceneForceUpdate & (test != 0));
-			}
-			body->m_sceneForceUpdate = 0;
-			body->m_sceneEquilibrium = sceneEquilibrium;
+			InitBody(i, body);
 		}
 	});
 
 	ParallelExecute(BuildBodyArray);
+	UpdateSceneBodyArray();
+}
 
+void ndScene::ApplyExtForceAndInitBodyArray()
+{
+	D_TRACKTIME();
+	// the external forces and the body step initialization only depend 
+	// on the body itself, so both stages are pipelined in one pass 
+	// without a barrier in between.
+	auto ApplyForceAndBuildBodyArray = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(ApplyForceAndBuildBodyArray);
+		const ndArray<ndBodyKinematic*>& view = GetActiveBodyArray();
+
+		const ndFloat32 timestep = m_timestep;
+		const ndStartEnd startEnd(view.GetCount() - 1, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBodyKinematic* const body = view[i];
+			body->ApplyExternalForces(threadIndex, timestep);
+			InitBody(i, body);
+		}
+	});
+
+	ParallelExecute(ApplyForceAndBuildBodyArray);
+	UpdateSceneBodyArray();
+}
+
+void ndScene::UpdateSceneBodyArray()
+{
+	D_TRACKTIME();
 	//ndInt32 scans[D_MAX_THREADS_COUNT][2];
 	//auto CountMovingBodies = ndMakeObject::ndFunction([this, &scans](ndInt32 threadIndex, ndInt32 threadCount)
 	//{
@@ -1514,35 +1909,37 @@ void ndScene::InitBodyArray()
 	sentinelBody->m_weigh = ndFloat32(0.0f);
 }
 
+ndContact* ndScene::CreateContact(const ndContactPairs& pair)
+{
+	ndBodyKinematic** const bodyArray = &GetActiveBodyArray()[0];
+	ndBodyKinematic* const body0 = bodyArray[pair.m_body0];
+	ndBodyKinematic* const body1 = bodyArray[pair.m_body1];
+	ndAssert(ndUnsigned32(body0->m_index) == pair.m_body0);
+	ndAssert(ndUnsigned32(body1->m_index) == pair.m_body1);
+
+	ndContact* const contact = new ndContact;
+	contact->SetBodies(body0, body1);
+	contact->AttachToBodies();
+
+	ndAssert(contact->m_body0->GetInvMass() != ndFloat32(0.0f));
+	contact->m_material = m_contactNotifyCallback->GetMaterial(contact, body0->GetCollisionShape(), body1->GetCollisionShape());
+	return contact;
+}
+
 void ndScene::CreateNewContacts()
 {
 	D_TRACKTIME();
 	const ndInt32 contactCount = m_contactArray.GetCount();
-	m_scratchBuffer.SetCount(ndInt32((contactCount + m_newPairs.GetCount() + 16) * sizeof(ndContact*)));
-
-	ndContact** const tmpJointsArray = (ndContact**)&m_scratchBuffer[0];
+	ndContact** const tmpJointsArray = AllocContactScratch(contactCount + m_newPairs.GetCount());
 	auto CreateNewContacts = ndMakeObject::ndFunction([this, tmpJointsArray](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(CreateNewContacts);
 		const ndArray<ndContactPairs>& newPairs = m_newPairs;
-		ndBodyKinematic** const bodyArray = &GetActiveBodyArray()[0];
 		const ndInt32 count = newPairs.GetCount();
 		const ndStartEnd startEnd(count, threadIndex, threadCount);
 		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 		{
-			const ndContactPairs& pair = newPairs[i];
-			ndBodyKinematic* const body0 = bodyArray[pair.m_body0];
-			ndBodyKinematic* const body1 = bodyArray[pair.m_body1];
-			ndAssert(ndUnsigned32(body0->m_index) == pair.m_body0);
-			ndAssert(ndUnsigned32(body1->m_index) == pair.m_body1);
-
-			ndContact* const contact = new ndContact;
-			contact->SetBodies(body0, body1);
-			contact->AttachToBodies();
-
-			ndAssert(contact->m_body0->GetInvMass() != ndFloat32(0.0f));
-			contact->m_material = m_contactNotifyCallback->GetMaterial(contact, body0->GetCollisionShape(), body1->GetCollisionShape());
-			tmpJointsArray[i] = contact;
+			tmpJointsArray[i] = CreateContact(newPairs[i]);
 		}
 	});
 	ParallelExecute(CreateNewContacts);
@@ -1560,54 +1957,290 @@ void ndScene::CreateNewContacts()
 	}
 }
 
+ndScene::ndNarrowPhaseBucket ndScene::GetNarrowPhaseBucket(ndContact* const contact) const
+{
+	ndBodyKinematic* const body0 = contact->GetBody0();
+	ndBodyKinematic* const body1 = contact->GetBody1();
+	ndShapeInstance& instance0 = body0->GetCollisionShape();
+	ndShapeInstance& instance1 = body1->GetCollisionShape();
+	ndShape* const shape0 = instance0.GetShape();
+	ndShape* const shape1 = instance1.GetShape();
+	if (!(shape0->GetAsShapeConvex() && shape1->GetAsShapeConvex()))
+	{
+		// compounds and static meshes
+		return m_complexPairs;
+	}
+
+	const bool sphere0 = shape0->GetAsShapeSphere() ? true : false;
+	const bool sphere1 = shape1->GetAsShapeSphere() ? true : false;
+	const bool box0 = shape0->GetAsShapeBox() ? true : false;
+	const bool box1 = shape1->GetAsShapeBox() ? true : false;
+	const bool capsule0 = shape0->GetAsShapeCapsule() ? true : false;
+	const bool capsule1 = shape1->GetAsShapeCapsule() ? true : false;
+	if ((sphere0 || box0 || capsule0) && (sphere1 || box1 || capsule1))
+	{
+		const bool batched = ndContactSolver::GetAnalyticContacts() && 
+			!(body0->m_contactTestOnly | body1->m_contactTestOnly) &&
+			(instance0.GetScaleType() == ndShapeInstance::m_unit) && 
+			(instance1.GetScaleType() == ndShapeInstance::m_unit);
+		// only the sphere pairs have four wide kernels. box pairs and pairs with 
+		// a capsule have no batched buckets, they go to the primitive pairs and 
+		// use the scalar closed form kernels one pair at a time.
+		if (batched && sphere0 && sphere1)
+		{
+			return m_sphereSpherePairs;
+		}
+		if (batched && ((sphere0 && box1) || (box0 && sphere1)))
+		{
+			return m_sphereBoxPairs;
+		}
+		return m_primitivePairs;
+	}
+	return m_convexPairs;
+}
+
+void ndScene::CalculateBatchedContacts(ndInt32 threadIndex, ndNarrowPhasePair* const pairs, ndInt32 count, ndNarrowPhaseBucket bucket)
+{
+	ndAssert(count && (count <= 4));
+	ndAssert((bucket == m_sphereSpherePairs) || (bucket == m_sphereBoxPairs));
+	ndContactSolver::ndBatchedPair batch[4];
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		const ndContact* const contact = pairs[i].m_contact;
+		const ndShapeInstance* instance0 = &contact->GetBody0()->GetCollisionShape();
+		const ndShapeInstance* instance1 = &contact->GetBody1()->GetCollisionShape();
+		if ((bucket == m_sphereBoxPairs) && !((ndShape*)instance0->GetShape())->GetAsShapeSphere())
+		{
+			ndSwap(instance0, instance1);
+		}
+		batch[i].m_instance0 = instance0;
+		batch[i].m_instance1 = instance1;
+	}
+	ndContactSolver::CalculateBatchedClosestPoints(batch, count);
+
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		ndContact* const contact = pairs[i].m_contact;
+		const ndContactSolver::ndBatchedPair& pair = batch[i];
+		if (!pair.m_valid)
+		{
+			CalculateJointContacts(threadIndex, contact);
+		}
+		else if (m_contactNotifyCallback->OnAabbOverlap(contact, m_timestep))
+		{
+			ndBodyKinematic* const body0 = contact->GetBody0();
+			ndBodyKinematic* const body1 = contact->GetBody1();
+			ndShapeInstance* const instance0 = &body0->GetCollisionShape();
+			ndShapeInstance* const instance1 = &body1->GetCollisionShape();
+
+			ndVector separatingVector(pair.m_separatingVector);
+			ndVector closestPoint0(pair.m_closestPoint0);
+			ndVector closestPoint1(pair.m_closestPoint1);
+			if (pair.m_instance0 != instance0)
+			{
+				separatingVector = separatingVector * ndVector::m_negOne;
+				ndSwap(closestPoint0, closestPoint1);
+			}
+
+			// the same contact the contact solver makes for a sphere
+			const ndFloat32 penetration = separatingVector.DotProduct(closestPoint1 - closestPoint0).GetScalar() - D_PENETRATION_TOL;
+			contact->m_timeOfImpact = m_timestep;
+			contact->m_separatingVector = separatingVector;
+			contact->m_separationDistance = penetration;
+			if ((penetration <= ndFloat32(1.0e-5f)) && (ndInt8(instance0->GetCollisionMode()) & ndInt8(instance1->GetCollisionMode())))
+			{
+				ndContactPoint contactPoint;
+				contactPoint.m_point = ndVector::m_half * (closestPoint0 + closestPoint1);
+				contactPoint.m_normal = separatingVector * ndVector::m_negOne;
+				contactPoint.m_body0 = body0;
+				contactPoint.m_body1 = body1;
+				contactPoint.m_shapeInstance0 = instance0;
+				contactPoint.m_shapeInstance1 = instance1;
+				contactPoint.m_shapeId0 = 0;
+				contactPoint.m_shapeId1 = 0;
+				contactPoint.m_penetration = -penetration;
+
+				contact->SetActive(true);
+				ProcessContacts(threadIndex, contact, 1, &contactPoint);
+				ndAssert(contact->m_maxDOF);
+				contact->m_isIntersetionTestOnly = 0;
+			}
+			else
+			{
+				contact->m_maxDOF = 0;
+			}
+		}
+		EndContactUpdate(contact, pairs[i].m_active ? true : false, true);
+	}
+}
+
 void ndScene::CalculateContacts()
 {
 	D_TRACKTIME();
+	CalculateNarrowPhase(false);
+}
+
+void ndScene::CalculateNarrowPhase(bool createNewContacts)
+{
 	m_activeConstraintArray.SetCount(0);
-	const ndInt32 contactCount = m_contactArray.GetCount() + m_newPairs.GetCount();
+	const ndInt32 newPairsCount = m_newPairs.GetCount();
+	const ndInt32 contactCount = m_contactArray.GetCount() + newPairsCount;
 	m_contactArray.SetCount(contactCount);
 	if (contactCount)
 	{
-		ndAtomic<ndInt32> count(0);
-		ndContact** const tmpJointsArray = (ndContact**)&m_scratchBuffer[0];
-		auto CalculateContactPoints = ndMakeObject::ndFunction([this, &count, tmpJointsArray](ndInt32 threadIndex, ndInt32 threadCount)
+		class ndEvaluateBucket
 		{
-			D_TRACKTIME_NAMED(CalculateContactPoints);
-			const ndInt32 jointCount = m_contactArray.GetCount();
-			#if 0
-			const ndInt32 span = 16;
-			for (ndInt32 i = count.fetch_add(span); i < jointCount; i = count.fetch_add(span))
+			public:
+			ndEvaluateBucket(void* const)
+			{
+			}
+
+			ndInt32 GetKey(const ndNarrowPhasePair& pair) const
 			{
-				const ndInt32 run = (i + span) <= jointCount ? i + span : jointCount;
-				for (ndInt32 j = i; j < run; j++)
+				return ndInt32(pair.m_bucket);
+			}
+		};
+
+		ndFrameArenaScope arenaScope(m_frameArena);
+		ndContact** const tmpJointsArray = m_contactScratch;
+		ndAssert(tmpJointsArray);
+		ndNarrowPhasePair* const pairs = m_frameArena.Alloc<ndNarrowPhasePair>(contactCount);
+		ndNarrowPhasePair* const sortedPairs = m_frameArena.Alloc<ndNarrowPhasePair>(contactCount);
+
+		// the pairs that do not need new contact points are done here
+		ndWorkStealingRange contactRange(contactCount, GetThreadCount());
+		auto ClassifyContacts = ndMakeObject::ndFunction([this, &contactRange, tmpJointsArray, pairs, newPairsCount, createNewContacts](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(ClassifyContacts);
+			ndStartEnd startEnd;
+			while (contactRange.GetChunk(threadIndex, startEnd))
+			{
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 				{
-					ndContact* const contact = tmpJointsArray[j];
+					if (createNewContacts)
+					{
+						tmpJointsArray[i] = (i < newPairsCount) ? CreateContact(m_newPairs[i]) : m_contactArray[i - newPairsCount];
+					}
+					ndContact* const contact = tmpJointsArray[i];
 					ndAssert(contact);
+					ndNarrowPhasePair& pair = pairs[i];
+					pair.m_contact = contact;
+					pair.m_bucket = m_skipPairs;
+					pair.m_active = 0;
 					if (!contact->m_isDead)
 					{
-						CalculateContacts(threadIndex, contact);
+						const bool active = contact->IsActive();
+						if (BeginContactUpdate(contact))
+						{
+							pair.m_bucket = GetNarrowPhaseBucket(contact);
+							pair.m_active = active ? 1 : 0;
+						}
+						else
+						{
+							EndContactUpdate(contact, active, false);
+						}
 					}
 				}
 			}
+		});
+		ParallelExecute(ClassifyContacts);
+
+		ndUnsigned32 prefixScan[(1 << 3) + 1];
+		ndCountingSort<ndNarrowPhasePair, ndEvaluateBucket, 3>(*this, pairs, sortedPairs, contactCount, prefixScan, nullptr);
+
+		const ndInt32 complexStart = ndInt32(prefixScan[m_complexPairs]);
+		const ndInt32 sphereSphereStart = ndInt32(prefixScan[m_sphereSpherePairs]);
+		const ndInt32 sphereBoxStart = ndInt32(prefixScan[m_sphereBoxPairs]);
+		const ndInt32 genericStart = ndInt32(prefixScan[m_primitivePairs]);
+		const ndInt32 genericEnd = ndInt32(prefixScan[m_skipPairs]);
+		const ndInt32 sphereSphereCount = sphereBoxStart - sphereSphereStart;
+		const ndInt32 sphereBoxCount = genericStart - sphereBoxStart;
+
+		// the compound and mesh pairs are the most expensive and the 
+		// less predictable, they go one at the time, and before the others.
+		ndWorkStealingRange complexRange(sphereSphereStart - complexStart, GetThreadCount(), 1);
+		ndWorkStealingRange sphereSphereRange((sphereSphereCount + 3) / 4, GetThreadCount());
+		ndWorkStealingRange sphereBoxRange((sphereBoxCount + 3) / 4, GetThreadCount());
+		ndWorkStealingRange genericRange(genericEnd - genericStart, GetThreadCount());
+		auto CalculateContactPoints = ndMakeObject::ndFunction([this, sortedPairs, &complexRange, &sphereSphereRange, &sphereBoxRange, &genericRange, 
+			complexStart, sphereSphereStart, sphereBoxStart, genericStart, sphereSphereCount, sphereBoxCount](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(CalculateContactPoints);
+			ndStartEnd startEnd;
+			while (complexRange.GetChunk(threadIndex, startEnd))
+			{
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+				{
+					const ndNarrowPhasePair& pair = sortedPairs[complexStart + i];
+					CalculateJointContacts(threadIndex, pair.m_contact);
+					EndContactUpdate(pair.m_contact, pair.m_active ? true : false, true);
+				}
+			}
 
-			#else
-			const ndStartEnd startEnd(jointCount, threadIndex, threadCount);
-			//for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
-			for (ndInt32 i = count.fetch_add(1); i < jointCount; i = count.fetch_add(1))
+			while (sphereSphereRange.GetChunk(threadIndex, startEnd))
 			{
-				ndContact* const contact = tmpJointsArray[i];
-				ndAssert(contact);
-				if (!contact->m_isDead)
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 				{
-					CalculateContacts(threadIndex, contact);
+					const ndInt32 count = ndMin(sphereSphereCount - i * 4, 4);
+					CalculateBatchedContacts(threadIndex, &sortedPairs[sphereSphereStart + i * 4], count, m_sphereSpherePairs);
+				}
+			}
+
+			while (sphereBoxRange.GetChunk(threadIndex, startEnd))
+			{
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+				{
+					const ndInt32 count = ndMin(sphereBoxCount - i * 4, 4);
+					CalculateBatchedContacts(threadIndex, &sortedPairs[sphereBoxStart + i * 4], count, m_sphereBoxPairs);
+				}
+			}
+
+			while (genericRange.GetChunk(threadIndex, startEnd))
+			{
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+				{
+					const ndNarrowPhasePair& pair = sortedPairs[genericStart + i];
+					CalculateJointContacts(threadIndex, pair.m_contact);
+					EndContactUpdate(pair.m_contact, pair.m_active ? true : false, true);
 				}
 			}
-			#endif
 		});
 		ParallelExecute(CalculateContactPoints);
 	}
 }
 
+void ndScene::CreateAndCalculateContacts()
+{
+	D_TRACKTIME();
+	// the new contacts are created in the same pass that classifies the 
+	// old ones, without waiting for all the new contacts to be created. 
+	// but attaching a contact wakes up its bodies, and the classification 
+	// of the other contacts reads that flag, so the bodies of the new pairs 
+	// are woken up before the fused pass, as the standard update does.
+	const ndInt32 newPairsCount = m_newPairs.GetCount();
+	AllocContactScratch(m_contactArray.GetCount() + newPairsCount);
+	if (newPairsCount)
+	{
+		D_TRACKTIME_NAMED(WakeUpNewPairs);
+		ndBodyKinematic** const bodyArray = &GetActiveBodyArray()[0];
+		for (ndInt32 i = 0; i < newPairsCount; ++i)
+		{
+			const ndContactPairs& pair = m_newPairs[i];
+			ndBodyKinematic* const body0 = bodyArray[pair.m_body0];
+			ndBodyKinematic* const body1 = bodyArray[pair.m_body1];
+			if (body0->GetInvMass() > ndFloat32(0.0f))
+			{
+				body0->m_equilibrium = 0;
+			}
+			if (body1->GetInvMass() > ndFloat32(0.0f))
+			{
+				body1->m_equilibrium = 0;
+			}
+		}
+	}
+	CalculateNarrowPhase(true);
+}
+
 void ndScene::DeleteDeadContacts()
 {
 	enum ndPairGroup
@@ -1641,7 +2274,8 @@ void ndScene::DeleteDeadContacts()
 	if (m_contactArray.GetCount())
 	{
 		D_TRACKTIME();
-		ndContact** const tmpJointsArray = (ndContact**)&m_scratchBuffer[0];
+		ndContact** const tmpJointsArray = m_contactScratch;
+		ndAssert(tmpJointsArray);
 		ndCountingSort<ndContact*, ndJointActive, 2>(*this, tmpJointsArray, &m_contactArray[0], m_contactArray.GetCount(), prefixScan, nullptr);
 		if (prefixScan[m_dead + 1] != prefixScan[m_dead])
 		{
@@ -1687,4 +2321,18 @@ void ndScene::DeleteDeadContacts()
 			ParallelExecute(CopyActiveContact);
 		}
 	}
-}
\ No newline at end of file
+
+	// the contact scratch array lives from the contact creation to here.
+	if (m_contactScratch)
+	{
+		m_frameArena.Rewind(m_contactScratchMark);
+		m_contactScratch = nullptr;
+	}
+}
+
+ndContact** ndScene::AllocContactScratch(ndInt32 count)
+{
+	m_contactScratchMark = m_frameArena.GetMark();
+	m_contactScratch = m_frameArena.Alloc<ndContact*>(count + 16);
+	return m_contactScratch;
+}
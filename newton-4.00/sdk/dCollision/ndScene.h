@@ -30,11 +30,18 @@
 
 #define D_SCENE_MAX_STACK_DEPTH		256
 
+// number of rays traversing the scene tree together in a batched ray cast, 
+// one ray per lane of a ndVector.
+#define D_SCENE_RAY_PACKET_SIZE		4
+
 class ndWorld;
 class ndScene;
 class ndContact;
+class ndRayCastHit;
+class ndRayCastQuery;
 class ndRayCastNotify;
 class ndContactNotify;
+class ndConvexCastQuery;
 class ndConvexCastNotify;
 class ndBodiesInAabbNotify;
 class ndJointBilateralConstraint;
@@ -71,6 +78,27 @@ class ndScene : public ndThreadPool
 		ndUnsigned32 m_body1;
 	};
 
+	// the narrow phase sorts the pairs by shape type, the pairs of the 
+	// common primitives are calculated by batched kernels, and the 
+	// expensive pairs are distributed to the threads first.
+	enum ndNarrowPhaseBucket
+	{
+		m_complexPairs,
+		m_sphereSpherePairs,
+		m_sphereBoxPairs,
+		m_primitivePairs,
+		m_convexPairs,
+		m_skipPairs,
+	};
+
+	class ndNarrowPhasePair
+	{
+		public:
+		ndContact* m_contact;
+		ndUnsigned32 m_bucket;
+		ndUnsigned32 m_active;
+	};
+
 	public:
 	D_COLLISION_API virtual ~ndScene();
 	D_COLLISION_API virtual bool AddBody(ndSharedPtr<ndBodyKinematic>& body);
@@ -94,8 +122,20 @@ class ndScene : public ndThreadPool
 	D_COLLISION_API virtual bool RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const;
 	D_COLLISION_API virtual bool ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
 
+	// batched queries, the closest hit of each query is written to the hits array. 
+	// the work is distributed over the scene threads, so they can not be called 
+	// while the scene is updating, the functions wait for the update to complete.
+	D_COLLISION_API virtual void RayCast(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count);
+	D_COLLISION_API virtual void ConvexCast(const ndConvexCastQuery* const casts, ndRayCastHit* const hits, ndInt32 count);
+
 	D_COLLISION_API void SendBackgroundTask(ndBackgroundTask* const job);
 
+	// the periodic rebuild of the broad phase tree runs on the background 
+	// thread and the new tree is swapped in a few updates later, 
+	// when disabled the tree is rebuilt on the update thread.
+	D_COLLISION_API bool GetBackgroundBvhBuild() const;
+	D_COLLISION_API void SetBackgroundBvhBuild(bool state);
+
 	ndInt32 GetThreadCount() const;
 
 	virtual ndWorld* GetWorld() const;
@@ -107,7 +147,7 @@ class ndScene : public ndThreadPool
 	ndArray<ndConstraint*>& GetActiveContactArray();
 	const ndArray<ndConstraint*>& GetActiveContactArray() const;
 
-	ndArray<ndUnsigned8>& GetScratchBuffer();
+	ndFrameArena& GetFrameArena();
 
 	ndFloat32 GetTimestep() const;
 	void SetTimestep(ndFloat32 timestep);
@@ -125,11 +165,21 @@ class ndScene : public ndThreadPool
 	void AddPair(ndBodyKinematic* const body0, ndBodyKinematic* const body1, ndInt32 threadId);
 	void SubmitPairs(ndBvhLeafNode* const bodyNode, ndBvhNode* const node, bool forward, ndInt32 threadId);
 
+	void UpdateSceneBodyArray();
+	ndContact* CreateContact(const ndContactPairs& pair);
+	ndContact** AllocContactScratch(ndInt32 count);
+	void InitBody(ndInt32 index, ndBodyKinematic* const body);
+	bool BeginContactUpdate(ndContact* const contact);
+	void EndContactUpdate(ndContact* const contact, bool active, bool narrowPhase);
+	ndNarrowPhaseBucket GetNarrowPhaseBucket(ndContact* const contact) const;
+	void CalculateNarrowPhase(bool createNewContacts);
 	void CalculateJointContacts(ndInt32 threadIndex, ndContact* const contact);
-	void ProcessContacts(ndInt32 threadIndex, ndInt32 contactCount, ndContactSolver* const contactSolver);
+	void CalculateBatchedContacts(ndInt32 threadIndex, ndNarrowPhasePair* const pairs, ndInt32 count, ndNarrowPhaseBucket bucket);
+	void ProcessContacts(ndInt32 threadIndex, ndContact* const contact, ndInt32 contactCount, const ndContactPoint* const contactArray);
 
 	ndJointBilateralConstraint* FindBilateralJoint(ndBodyKinematic* const body0, ndBodyKinematic* const body1) const;
 	bool RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const distance, ndInt32 stack, const ndFastRay& ray) const;
+	void RayCastPacket(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count) const;
 	bool ConvexCast(ndConvexCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const distance, ndInt32 stack, const ndFastRay& ray, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
 
 	// call from sub steps update
@@ -144,13 +194,17 @@ class ndScene : public ndThreadPool
 	D_COLLISION_API virtual void FindCollidingPairs();
 	D_COLLISION_API virtual void DeleteDeadContacts();
 
+	// pipelined stages, call from sub steps update in pipelined mode
+	D_COLLISION_API virtual void CreateAndCalculateContacts();
+	D_COLLISION_API virtual void ApplyExtForceAndInitBodyArray();
+
 	D_COLLISION_API virtual void CalculateContacts(ndInt32 threadIndex, ndContact* const contact);
 	D_COLLISION_API virtual void UpdateTransformNotify(ndInt32 threadIndex, ndBodyKinematic* const body);
 
 	ndBodyList m_bodyList;
 	ndContactArray m_contactArray;
 	ndBvhSceneManager m_bvhSceneManager;
-	ndArray<ndUnsigned8> m_scratchBuffer;
+	ndFrameArena m_frameArena;
 	ndArray<ndBodyKinematic*> m_sceneBodyArray;
 	ndArray<ndConstraint*> m_activeConstraintArray;
 	ndSpecialList<ndBodyKinematic> m_specialUpdateList;
@@ -161,6 +215,9 @@ class ndScene : public ndThreadPool
 	ndPolygonMeshDesc::ndProceduralStaticMeshFaceQuery m_proceduralStaticMeshQuery[D_MAX_THREADS_COUNT];
 
 	ndSpinLock m_lock;
+	ndSpinLock m_queryLock;
+	ndFrameArena::ndMark m_contactScratchMark;
+	ndContact** m_contactScratch;
 	ndBvhNode* m_rootNode;
 	ndBodyKinematic* m_sentinelBody;
 	ndContactNotify* m_contactNotifyCallback;
@@ -209,9 +266,9 @@ inline ndInt32 ndScene::GetThreadCount() const
 	return pool.GetThreadCount();
 }
 
-inline ndArray<ndUnsigned8>& ndScene::GetScratchBuffer()
+inline ndFrameArena& ndScene::GetFrameArena()
 {
-	return m_scratchBuffer;
+	return m_frameArena;
 }
 
 inline const ndBodyList& ndScene::GetBodyList() const
@@ -61,6 +61,7 @@ class ndShapeBox: public ndShapeConvex
 	static ndConvexSimplexEdge* m_edgeEdgeMap[];
 	static ndConvexSimplexEdge* m_vertexToEdgeMap[];
 
+	friend class ndContactSolver;
 } D_GCC_NEWTON_ALIGN_32;
 
 #endif 
@@ -827,30 +827,7 @@ bool ndShapeConvexHull::RemoveCoplanarEdge(ndPolyhedra& polyhedra, const ndBigVe
 
 inline ndVector ndShapeConvexHull::SupportVertexBruteForce(const ndVector& dir, ndInt32* const vertexIndex) const
 {
-	const ndVector dirX(dir.m_x);
-	const ndVector dirY(dir.m_y);
-	const ndVector dirZ(dir.m_z);
-	//ndVector support(ndVector::m_negOne);
-	//ndVector maxProj(ndFloat32(-1.0e20f));
-	ndVector support(m_soa_index[0]);
-	ndVector maxProj(m_soa_x[0] * dirX + m_soa_y[0] * dirY + m_soa_z[0] * dirZ);
-	for (ndInt32 i = 1; i < m_soaVertexCount; ++i)
-	{
-		ndVector dot(m_soa_x[i] * dirX + m_soa_y[i] * dirY + m_soa_z[i] * dirZ);
-		support = support.Select(m_soa_index[i], dot > maxProj);
-		maxProj = maxProj.GetMax(dot);
-	}
-
-	ndVector dot(maxProj.ShiftRight().ShiftRight());
-	ndVector support1(support.ShiftRight().ShiftRight());
-	support = support.Select(support1, dot > maxProj);
-	maxProj = maxProj.GetMax(dot);
-		
-	dot = maxProj.ShiftRight();
-	support1 = support.ShiftRight();
-	support = support.Select(support1, dot > maxProj);
-
-	const ndInt32 index = ndInt32(support.GetScalar());
+	const ndInt32 index = ndSimdDispatch::SupportVertex(m_soa_x, m_soa_y, m_soa_z, m_soa_index, m_soaVertexCount, dir);
 	if (vertexIndex)
 	{
 		*vertexIndex = index;
@@ -61,6 +61,7 @@ class ndShapeSphere: public ndShapeConvex
 	static ndVector m_unitSphere[];
 	static ndConvexSimplexEdge m_edgeArray[];
 
+	friend class ndContactSolver;
 } D_GCC_NEWTON_ALIGN_32;
 
 
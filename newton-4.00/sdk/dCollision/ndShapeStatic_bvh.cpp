@@ -108,6 +108,23 @@ ndShapeStatic_bvh::ndShapeStatic_bvh(const ndLoadSaveBase::ndLoadDescriptor& des
 	m_trianglesCount = data.m_triangleCount;
 }
 
+ndShapeStatic_bvh::ndShapeStatic_bvh(const char* const cachePath, ndUnsigned64 contentHash, bool verify)
+	:ndShapeStaticMesh(m_boundingBoxHierachy)
+	,ndAabbPolygonSoup()
+	,m_trianglesCount(0)
+{
+	// the cache already has the hierarchy and the adjacency, 
+	// so there is nothing to build and nothing to walk here.
+	MapCache(cachePath, contentHash, verify);
+
+	ndVector p0;
+	ndVector p1;
+	GetAABB(p0, p1);
+	m_boxSize = (p1 - p0) * ndVector::m_half;
+	m_boxOrigin = (p1 + p0) * ndVector::m_half;
+	m_trianglesCount = ndAabbPolygonSoup::GetTriangleCount();
+}
+
 ndShapeStatic_bvh::~ndShapeStatic_bvh(void)
 {
 }
@@ -31,6 +31,12 @@ class ndShapeStatic_bvh: public ndShapeStaticMesh, public ndAabbPolygonSoup
 	D_CLASS_REFLECTION(ndShapeStatic_bvh);
 	D_COLLISION_API ndShapeStatic_bvh(const ndPolygonSoupBuilder& builder);
 	D_COLLISION_API ndShapeStatic_bvh(const ndLoadSaveBase::ndLoadDescriptor& desc);
+
+	/// Create the shape from a memory mapped cache file written by SerializeCache.
+	/// \brief the mesh is used in place from the file, check IsMapped to know 
+	/// if the file was valid, otherwise the shape is an empty mesh. 
+	/// see ndAabbPolygonSoup::MapCache for contentHash and verify.
+	D_COLLISION_API ndShapeStatic_bvh(const char* const cachePath, ndUnsigned64 contentHash = 0, bool verify = false);
 	D_COLLISION_API virtual ~ndShapeStatic_bvh();
 
 	void *operator new (size_t size);
@@ -21,16 +21,41 @@
 
 #include "ndCoreStdafx.h"
 #include "ndTypes.h"
+#include "ndCRC.h"
 #include "ndHeap.h"
 #include "ndStack.h"
 #include "ndList.h"
 #include "ndMatrix.h"
 #include "ndPolyhedra.h"
+#include "ndFileMapping.h"
 #include "ndAabbPolygonSoup.h"
 #include "ndPolygonSoupBuilder.h"
 
 #define DG_STACK_DEPTH 512
 
+// the cache file is a header followed by the vertex, index and node arrays. 
+// all the links in the arrays are indices, so the file is relocatable and 
+// it is used in place from the memory mapped view.
+#define D_AABB_CACHE_ALIGNMENT	64
+
+class ndAabbPolygonSoupCacheHeader
+{
+	public:
+	char m_magic[4];
+	ndInt32 m_version;
+	ndInt32 m_floatSize;
+	ndInt32 m_vertexCount;
+	ndInt32 m_indexCount;
+	ndInt32 m_nodesCount;
+	ndInt32 m_triangleCount;
+	ndInt32 m_padding;
+	ndUnsigned64 m_contentHash;
+	ndUnsigned64 m_vertexOffset;
+	ndUnsigned64 m_indexOffset;
+	ndUnsigned64 m_nodeOffset;
+	ndUnsigned64 m_size;
+};
+
 D_MSV_NEWTON_ALIGN_32
 class ndAabbPolygonSoup::ndNodeBuilder: public ndAabbPolygonSoup::ndNode
 {
@@ -231,19 +256,65 @@ class ndAabbPolygonSoup::ndSplitInfo
 ndAabbPolygonSoup::ndAabbPolygonSoup ()
 	:ndPolygonSoupDatabase()
 	,m_aabb(nullptr)
+	,m_wideNodes(nullptr)
 	,m_indices(nullptr)
+	,m_mapping(nullptr)
 	,m_nodesCount(0)
 	,m_indexCount(0)
+	,m_wideNodesCount(0)
+	,m_triangleCount(0)
 {
 }
 
 ndAabbPolygonSoup::~ndAabbPolygonSoup ()
 {
-	if (m_aabb) 
+	ReleaseData();
+}
+
+void ndAabbPolygonSoup::ReleaseData()
+{
+	SetWideNodeLayout(false);
+	if (m_mapping)
+	{
+		// the arrays are part of the file view
+		delete m_mapping;
+		m_mapping = nullptr;
+		m_localVertex = nullptr;
+	}
+	else if (m_aabb)
 	{
 		ndMemory::Free(m_aabb);
 		ndMemory::Free(m_indices);
 	}
+	if (m_localVertex)
+	{
+		ndMemory::Free(m_localVertex);
+	}
+
+	m_aabb = nullptr;
+	m_indices = nullptr;
+	m_localVertex = nullptr;
+	m_vertexCount = 0;
+	m_nodesCount = 0;
+	m_indexCount = 0;
+	m_triangleCount = 0;
+}
+
+void ndAabbPolygonSoup::CalculateTriangleCount()
+{
+	m_triangleCount = 0;
+	for (ndInt32 i = 0; i < m_nodesCount; ++i)
+	{
+		const ndNode& node = m_aabb[i];
+		if (node.m_left.IsLeaf() && node.m_left.GetCount())
+		{
+			m_triangleCount += ndInt32(node.m_left.GetCount()) - 2;
+		}
+		if (node.m_right.IsLeaf() && node.m_right.GetCount())
+		{
+			m_triangleCount += ndInt32(node.m_right.GetCount()) - 2;
+		}
+	}
 }
 
 ndFloat32 ndAabbPolygonSoup::CalculateFaceMaxDiagonal (const ndVector* const vertex, ndInt32 indexCount, const ndInt32* const indexArray) const
@@ -760,6 +831,7 @@ void ndAabbPolygonSoup::Create (const ndPolygonSoupBuilder& builder)
 	{
 		m_aabb[0].m_right = ndNode::ndLeafNodePtr (0, 0);
 	}
+	CalculateTriangleCount();
 }
 
 void ndAabbPolygonSoup::Serialize (const char* const path) const
@@ -782,6 +854,7 @@ void ndAabbPolygonSoup::Serialize (const char* const path) const
 
 void ndAabbPolygonSoup::Deserialize (const char* const path)
 {
+	ReleaseData();
 	FILE* const file = fopen(path, "rb");
 	if (file)
 	{
@@ -801,6 +874,7 @@ void ndAabbPolygonSoup::Deserialize (const char* const path)
 			readValues = fread(m_localVertex, sizeof(ndTriplex) * m_vertexCount, 1, file);
 			readValues = fread(m_indices, sizeof(ndInt32) * m_indexCount, 1, file);
 			readValues = fread(m_aabb, sizeof(ndNode) * m_nodesCount, 1, file);
+			CalculateTriangleCount();
 		}
 		else 
 		{
@@ -813,6 +887,205 @@ void ndAabbPolygonSoup::Deserialize (const char* const path)
 	}
 }
 
+ndUnsigned64 ndAabbPolygonSoup::CalculateContentHash() const
+{
+	class ndHash
+	{
+		public:
+		// dCRC64 takes a 32 bit size, large arrays are hashed in chunks
+		static ndUnsigned64 Array(const void* const buffer, ndUnsigned64 size, ndUnsigned64 hash)
+		{
+			const ndUnsigned64 chunkSize = ndUnsigned64(1) << 30;
+			const char* const ptr = (const char*)buffer;
+			for (ndUnsigned64 offset = 0; offset < size; offset += chunkSize)
+			{
+				hash = dCRC64(ptr + offset, ndInt32(ndMin(size - offset, chunkSize)), hash);
+			}
+			return hash;
+		}
+	};
+
+	ndUnsigned64 hash = 0;
+	if (m_aabb)
+	{
+		hash = ndHash::Array(m_localVertex, sizeof(ndTriplex) * ndUnsigned64(m_vertexCount), hash);
+		hash = ndHash::Array(m_indices, sizeof(ndInt32) * ndUnsigned64(m_indexCount), hash);
+		hash = ndHash::Array(m_aabb, sizeof(ndNode) * ndUnsigned64(m_nodesCount), hash);
+	}
+	return hash;
+}
+
+bool ndAabbPolygonSoup::ValidateHierarchy() const
+{
+	// the queries follow the links without any check, so every box, child 
+	// and face index must be in range. the children come after their parent, 
+	// so there are no cycles, and the depth must fit the traversal stacks.
+	auto IsVertex = [this](ndInt32 index)
+	{
+		return (index >= 0) && (index < m_vertexCount);
+	};
+
+	if (!m_nodesCount)
+	{
+		return true;
+	}
+
+	ndStack<ndInt32> depth(m_nodesCount);
+	for (ndInt32 i = 0; i < m_nodesCount; ++i)
+	{
+		depth[i] = 0;
+	}
+	depth[0] = 1;
+
+	for (ndInt32 i = 0; i < m_nodesCount; ++i)
+	{
+		const ndNode& node = m_aabb[i];
+		if (!IsVertex(node.m_indexBox0) || !IsVertex(node.m_indexBox1))
+		{
+			return false;
+		}
+
+		const ndNode::ndLeafNodePtr children[] = { node.m_left, node.m_right };
+		for (ndInt32 j = 0; j < 2; ++j)
+		{
+			const ndNode::ndLeafNodePtr& child = children[j];
+			if (child.IsLeaf())
+			{
+				const ndInt32 count = ndInt32(child.GetCount());
+				const ndUnsigned64 start = child.GetIndex();
+				if (count && ((start + ndUnsigned64(2 * count + 3)) > ndUnsigned64(m_indexCount)))
+				{
+					return false;
+				}
+
+				// vertices, face normal and edge normals
+				const ndInt32* const face = &m_indices[count ? start : 0];
+				bool valid = !count || IsVertex(face[count + 1]);
+				for (ndInt32 k = 0; valid && (k < count); ++k)
+				{
+					valid = IsVertex(face[k]) && IsVertex(face[count + 2 + k] & (~D_CONCAVE_EDGE_MASK));
+				}
+				if (!valid)
+				{
+					return false;
+				}
+			}
+			else
+			{
+				const ndInt32 index = ndInt32(child.m_node);
+				if ((index <= i) || (index >= m_nodesCount))
+				{
+					return false;
+				}
+				depth[index] = ndMax(depth[index], depth[i] + 1);
+				if (depth[index] >= DG_STACK_DEPTH)
+				{
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+ndUnsigned64 ndAabbPolygonSoup::SerializeCache(const char* const path) const
+{
+	class ndAlign
+	{
+		public:
+		static ndUnsigned64 Offset(ndUnsigned64 offset)
+		{
+			return (offset + D_AABB_CACHE_ALIGNMENT - 1) & ~ndUnsigned64(D_AABB_CACHE_ALIGNMENT - 1);
+		}
+	};
+
+	if (!m_aabb)
+	{
+		return 0;
+	}
+
+	ndAabbPolygonSoupCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.m_magic, "ndBV", 4);
+	header.m_version = D_AABB_POLYGON_SOUP_CACHE_VERSION;
+	header.m_floatSize = ndInt32(sizeof(ndFloat32));
+	header.m_vertexCount = m_vertexCount;
+	header.m_indexCount = m_indexCount;
+	header.m_nodesCount = m_nodesCount;
+	header.m_triangleCount = m_triangleCount;
+	header.m_contentHash = CalculateContentHash();
+	header.m_vertexOffset = ndAlign::Offset(sizeof(header));
+	header.m_indexOffset = ndAlign::Offset(header.m_vertexOffset + sizeof(ndTriplex) * m_vertexCount);
+	header.m_nodeOffset = ndAlign::Offset(header.m_indexOffset + sizeof(ndInt32) * m_indexCount);
+	header.m_size = header.m_nodeOffset + sizeof(ndNode) * m_nodesCount;
+
+	FILE* const file = fopen(path, "wb");
+	if (!file)
+	{
+		return 0;
+	}
+
+	const char padding[D_AABB_CACHE_ALIGNMENT] = {};
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	ok = ok && (fwrite(padding, size_t(header.m_vertexOffset - sizeof(header)), 1, file) == 1);
+	ok = ok && (fwrite(m_localVertex, sizeof(ndTriplex) * m_vertexCount, 1, file) == 1);
+	const size_t indexPadding = size_t(header.m_indexOffset - header.m_vertexOffset - sizeof(ndTriplex) * m_vertexCount);
+	ok = ok && (!indexPadding || (fwrite(padding, indexPadding, 1, file) == 1));
+	ok = ok && (fwrite(m_indices, sizeof(ndInt32) * m_indexCount, 1, file) == 1);
+	const size_t nodePadding = size_t(header.m_nodeOffset - header.m_indexOffset - sizeof(ndInt32) * m_indexCount);
+	ok = ok && (!nodePadding || (fwrite(padding, nodePadding, 1, file) == 1));
+	ok = ok && (fwrite(m_aabb, sizeof(ndNode) * m_nodesCount, 1, file) == 1);
+	fclose(file);
+	return ok ? header.m_contentHash : 0;
+}
+
+bool ndAabbPolygonSoup::MapCache(const char* const path, ndUnsigned64 contentHash, bool verify)
+{
+	ReleaseData();
+
+	ndFileMapping* const mapping = new ndFileMapping(path);
+	if (!mapping->IsValid() || (mapping->GetSize() < sizeof(ndAabbPolygonSoupCacheHeader)))
+	{
+		delete mapping;
+		return false;
+	}
+
+	const char* const data = (const char*)mapping->GetData();
+	const ndAabbPolygonSoupCacheHeader& header = *(const ndAabbPolygonSoupCacheHeader*)data;
+	bool valid = !memcmp(header.m_magic, "ndBV", 4);
+	valid = valid && (header.m_version == D_AABB_POLYGON_SOUP_CACHE_VERSION);
+	valid = valid && (header.m_floatSize == ndInt32(sizeof(ndFloat32)));
+	valid = valid && (header.m_size == mapping->GetSize());
+	valid = valid && (header.m_vertexCount > 0) && (header.m_indexCount > 0) && (header.m_nodesCount > 0);
+	valid = valid && (header.m_vertexOffset >= sizeof(header));
+	valid = valid && (header.m_indexOffset >= header.m_vertexOffset + sizeof(ndTriplex) * ndUnsigned64(header.m_vertexCount));
+	valid = valid && (header.m_nodeOffset >= header.m_indexOffset + sizeof(ndInt32) * ndUnsigned64(header.m_indexCount));
+	valid = valid && (header.m_size >= header.m_nodeOffset + sizeof(ndNode) * ndUnsigned64(header.m_nodesCount));
+	valid = valid && (!contentHash || (header.m_contentHash == contentHash));
+	if (!valid)
+	{
+		delete mapping;
+		return false;
+	}
+
+	m_mapping = mapping;
+	m_strideInBytes = sizeof(ndTriplex);
+	m_vertexCount = header.m_vertexCount;
+	m_indexCount = header.m_indexCount;
+	m_nodesCount = header.m_nodesCount;
+	m_triangleCount = header.m_triangleCount;
+	m_localVertex = (ndFloat32*)(data + header.m_vertexOffset);
+	m_indices = (ndInt32*)(data + header.m_indexOffset);
+	m_aabb = (ndNode*)(data + header.m_nodeOffset);
+
+	if (verify && ((CalculateContentHash() != header.m_contentHash) || !ValidateHierarchy()))
+	{
+		ReleaseData();
+		return false;
+	}
+	return true;
+}
+
 ndVector ndAabbPolygonSoup::ForAllSectorsSupportVertex (const ndVector& dir) const
 {
 	ndVector supportVertex (ndFloat32 (0.0f));
@@ -963,6 +1236,16 @@ ndVector ndAabbPolygonSoup::ForAllSectorsSupportVertex (const ndVector& dir) con
 
 void ndAabbPolygonSoup::ForAllSectorsRayHit (const ndFastRay& raySrc, ndFloat32 maxParam, ndRayIntersectCallback callback, void* const context) const
 {
+	if (!m_aabb)
+	{
+		return;
+	}
+	if (m_wideNodes)
+	{
+		ForAllSectorsRayHitWide(raySrc, maxParam, callback, context);
+		return;
+	}
+
 	const ndNode *stackPool[DG_STACK_DEPTH];
 	ndFloat32 distance[DG_STACK_DEPTH];
 	ndFastRay ray (raySrc);
@@ -1071,7 +1354,11 @@ void ndAabbPolygonSoup::ForAllSectors (const ndFastAabb& obbAabbInfo, const ndVe
 	ndAssert (ndAbs(ndAbs(obbAabbInfo[0][2]) - obbAabbInfo.m_absDir[2][0]) < ndFloat32 (1.0e-4f));
 	ndAssert (ndAbs(ndAbs(obbAabbInfo[1][2]) - obbAabbInfo.m_absDir[2][1]) < ndFloat32 (1.0e-4f));
 
-	if (m_aabb) 
+	if (m_wideNodes)
+	{
+		ForAllSectorsWide(obbAabbInfo, boxDistanceTravel, callback, context);
+	}
+	else if (m_aabb) 
 	{
 		ndFloat32 distance[DG_STACK_DEPTH];
 		const ndNode* stackPool[DG_STACK_DEPTH];
@@ -1460,3 +1747,462 @@ void ndAabbPolygonSoup::ForThisSector(const ndAabbPolygonSoup::ndNode* const nod
 		}
 	}
 }
+
+// slab test of one ray against the four boxes of a wide node, 
+// same as ndFastRay::BoxIntersect but one box per lane.
+inline ndVector ndAabbPolygonSoup::WideRayBoxDistance(const ndFastRay& ray, 
+	const ndVector& minX, const ndVector& minY, const ndVector& minZ,
+	const ndVector& maxX, const ndVector& maxY, const ndVector& maxZ)
+{
+	const ndVector p0x(ray.m_p0.BroadcastX());
+	const ndVector p0y(ray.m_p0.BroadcastY());
+	const ndVector p0z(ray.m_p0.BroadcastZ());
+
+	const ndVector parallelMiss(
+		(((p0x <= minX) | (p0x >= maxX)) & ray.m_isParallel.BroadcastX()) |
+		(((p0y <= minY) | (p0y >= maxY)) & ray.m_isParallel.BroadcastY()) |
+		(((p0z <= minZ) | (p0z >= maxZ)) & ray.m_isParallel.BroadcastZ()));
+
+	const ndVector invX(ray.m_dpInv.BroadcastX());
+	const ndVector invY(ray.m_dpInv.BroadcastY());
+	const ndVector invZ(ray.m_dpInv.BroadcastZ());
+	const ndVector tt0x(invX * (minX - p0x));
+	const ndVector tt1x(invX * (maxX - p0x));
+	const ndVector tt0y(invY * (minY - p0y));
+	const ndVector tt1y(invY * (maxY - p0y));
+	const ndVector tt0z(invZ * (minZ - p0z));
+	const ndVector tt1z(invZ * (maxZ - p0z));
+
+	ndVector t0(ray.m_minT.GetMax(tt0x.GetMin(tt1x)));
+	ndVector t1(ray.m_maxT.GetMin(tt0x.GetMax(tt1x)));
+	t0 = t0.GetMax(tt0y.GetMin(tt1y)).GetMax(tt0z.GetMin(tt1z));
+	t1 = t1.GetMin(tt0y.GetMax(tt1y)).GetMin(tt0z.GetMax(tt1z));
+
+	const ndVector mask((t0 < t1).AndNot(parallelMiss));
+	return ndVector(ndFloat32(1.2f)).Select(t0, mask);
+}
+
+// bring the four boxes of a wide node to the space of the obb, 
+// and expand them by the obb size, like ndNode::BoxPenetration does one box at a time.
+inline void ndAabbPolygonSoup::WideObbBoxes(const ndFastAabb& obb, const ndWideNode* const node,
+	ndVector& minX, ndVector& minY, ndVector& minZ, ndVector& maxX, ndVector& maxY, ndVector& maxZ)
+{
+	const ndVector dx(ndVector::m_half * (node->m_maxX + node->m_minX) - obb.m_posit.BroadcastX());
+	const ndVector dy(ndVector::m_half * (node->m_maxY + node->m_minY) - obb.m_posit.BroadcastY());
+	const ndVector dz(ndVector::m_half * (node->m_maxZ + node->m_minZ) - obb.m_posit.BroadcastZ());
+	const ndVector sx(ndVector::m_half * (node->m_maxX - node->m_minX));
+	const ndVector sy(ndVector::m_half * (node->m_maxY - node->m_minY));
+	const ndVector sz(ndVector::m_half * (node->m_maxZ - node->m_minZ));
+
+	const ndVector originX(obb.m_front.BroadcastX() * dx + obb.m_front.BroadcastY() * dy + obb.m_front.BroadcastZ() * dz);
+	const ndVector originY(obb.m_up.BroadcastX() * dx + obb.m_up.BroadcastY() * dy + obb.m_up.BroadcastZ() * dz);
+	const ndVector originZ(obb.m_right.BroadcastX() * dx + obb.m_right.BroadcastY() * dy + obb.m_right.BroadcastZ() * dz);
+
+	const ndVector sizeX(obb.m_absDir[0].BroadcastX() * sx + obb.m_absDir[1].BroadcastX() * sy + obb.m_absDir[2].BroadcastX() * sz + obb.m_size.BroadcastX());
+	const ndVector sizeY(obb.m_absDir[0].BroadcastY() * sx + obb.m_absDir[1].BroadcastY() * sy + obb.m_absDir[2].BroadcastY() * sz + obb.m_size.BroadcastY());
+	const ndVector sizeZ(obb.m_absDir[0].BroadcastZ() * sx + obb.m_absDir[1].BroadcastZ() * sy + obb.m_absDir[2].BroadcastZ() * sz + obb.m_size.BroadcastZ());
+
+	minX = originX - sizeX;
+	minY = originY - sizeY;
+	minZ = originZ - sizeZ;
+	maxX = originX + sizeX;
+	maxY = originY + sizeY;
+	maxZ = originZ + sizeZ;
+}
+
+// penetration of the four boxes of a wide node with an obb, 
+// the result is the same as calling ndNode::BoxPenetration for each box.
+inline ndVector ndAabbPolygonSoup::WideBoxPenetration(const ndFastAabb& obb, const ndWideNode* const node)
+{
+	const ndVector minX(node->m_minX - obb.m_p1.BroadcastX());
+	const ndVector minY(node->m_minY - obb.m_p1.BroadcastY());
+	const ndVector minZ(node->m_minZ - obb.m_p1.BroadcastZ());
+	const ndVector maxX(node->m_maxX - obb.m_p0.BroadcastX());
+	const ndVector maxY(node->m_maxY - obb.m_p0.BroadcastY());
+	const ndVector maxZ(node->m_maxZ - obb.m_p0.BroadcastZ());
+
+	const ndVector maskX((minX * maxX) < ndVector::m_zero);
+	const ndVector maskY((minY * maxY) < ndVector::m_zero);
+	const ndVector maskZ((minZ * maxZ) < ndVector::m_zero);
+	ndVector dist((maxX.GetMin(minX.Abs()) & maskX).GetMin(maxY.GetMin(minY.Abs()) & maskY).GetMin(maxZ.GetMin(minZ.Abs()) & maskZ));
+
+	const ndVector overlap(dist > ndVector::m_zero);
+	if (overlap.GetSignMask())
+	{
+		ndVector minX1;
+		ndVector minY1;
+		ndVector minZ1;
+		ndVector maxX1;
+		ndVector maxY1;
+		ndVector maxZ1;
+		WideObbBoxes(obb, node, minX1, minY1, minZ1, maxX1, maxY1, maxZ1);
+		const ndVector mask1X((minX1 * maxX1) < ndVector::m_zero);
+		const ndVector mask1Y((minY1 * maxY1) < ndVector::m_zero);
+		const ndVector mask1Z((minZ1 * maxZ1) < ndVector::m_zero);
+		const ndVector dist1((maxX1.GetMin(minX1.Abs()) & mask1X).GetMin(maxY1.GetMin(minY1.Abs()) & mask1Y).GetMin(maxZ1.GetMin(minZ1.Abs()) & mask1Z));
+		dist = dist.GetMin(dist1);
+	}
+
+	const ndVector gapX(minX.Abs().GetMin(maxX.Abs()).AndNot(maskX));
+	const ndVector gapY(minY.Abs().GetMin(maxY.Abs()).AndNot(maskY));
+	const ndVector gapZ(minZ.Abs().GetMin(maxZ.Abs()).AndNot(maskZ));
+	const ndVector separation((gapX * gapX + gapY * gapY + gapZ * gapZ).Sqrt() * ndVector::m_negOne);
+	return separation.Select(dist, overlap);
+}
+
+// time of impact of an obb moving along ray with the four boxes of a wide node, 
+// the result is the same as calling ndNode::BoxIntersect for each box.
+inline ndVector ndAabbPolygonSoup::WideBoxIntersect(const ndFastRay& ray, const ndFastRay& obbRay, const ndFastAabb& obb, const ndWideNode* const node)
+{
+	ndVector dist(WideRayBoxDistance(ray,
+		node->m_minX - obb.m_p1.BroadcastX(), node->m_minY - obb.m_p1.BroadcastY(), node->m_minZ - obb.m_p1.BroadcastZ(),
+		node->m_maxX - obb.m_p0.BroadcastX(), node->m_maxY - obb.m_p0.BroadcastY(), node->m_maxZ - obb.m_p0.BroadcastZ()));
+
+	const ndVector mask(dist < ndVector::m_one);
+	if (mask.GetSignMask())
+	{
+		ndVector minX1;
+		ndVector minY1;
+		ndVector minZ1;
+		ndVector maxX1;
+		ndVector maxY1;
+		ndVector maxZ1;
+		WideObbBoxes(obb, node, minX1, minY1, minZ1, maxX1, maxY1, maxZ1);
+		const ndVector dist1(WideRayBoxDistance(obbRay, minX1, minY1, minZ1, maxX1, maxY1, maxZ1));
+		const ndVector hit(dist1.GetMax(dist).Select(dist1, dist1 > ndVector::m_one));
+		dist = dist.Select(hit, mask);
+	}
+	return dist;
+}
+
+void ndAabbPolygonSoup::SetWideNodeLayout(bool state)
+{
+	if (m_wideNodes)
+	{
+		ndMemory::Free(m_wideNodes);
+		m_wideNodes = nullptr;
+		m_wideNodesCount = 0;
+	}
+	if (state && m_aabb)
+	{
+		BuildWideNodes();
+	}
+}
+
+void ndAabbPolygonSoup::BuildWideNodes()
+{
+	class ndStackEntry
+	{
+		public:
+		const ndNode* m_node;
+		ndInt32 m_wideIndex;
+	};
+
+	const ndTriplex* const vertexArray = (ndTriplex*)m_localVertex;
+
+	// every wide node collapses at least one binary node, 
+	// so there are never more wide nodes than binary nodes.
+	ndWideNode* const wideNodes = (ndWideNode*)ndMemory::Malloc(sizeof(ndWideNode) * m_nodesCount);
+	ndStack<ndStackEntry> stackPool(m_nodesCount + 1);
+
+	ndInt32 stack = 1;
+	ndInt32 wideCount = 1;
+	stackPool[0].m_node = m_aabb;
+	stackPool[0].m_wideIndex = 0;
+	while (stack)
+	{
+		stack--;
+		const ndNode* const node = stackPool[stack].m_node;
+		ndWideNode& wideNode = wideNodes[stackPool[stack].m_wideIndex];
+
+		// open the child with the largest surface, until the node is full 
+		// or all children are leaves.
+		ndNode::ndLeafNodePtr children[D_AABB_WIDE_NODE_WIDTH] = { node->m_left, node->m_right, node->m_left, node->m_left };
+		ndInt32 childCount = 2;
+		while (childCount < D_AABB_WIDE_NODE_WIDTH)
+		{
+			ndInt32 bestIndex = -1;
+			ndFloat32 bestArea = ndFloat32(-1.0f);
+			for (ndInt32 i = 0; i < childCount; ++i)
+			{
+				if (!children[i].IsLeaf())
+				{
+					ndVector p0;
+					ndVector p1;
+					GetNodeAabb(children[i].GetNode(m_aabb), p0, p1);
+					const ndVector size(p1 - p0);
+					const ndFloat32 area = size.DotProduct(size.ShiftTripleRight()).GetScalar();
+					if (area > bestArea)
+					{
+						bestArea = area;
+						bestIndex = i;
+					}
+				}
+			}
+			if (bestIndex < 0)
+			{
+				break;
+			}
+			const ndNode* const child = children[bestIndex].GetNode(m_aabb);
+			children[bestIndex] = child->m_left;
+			children[childCount] = child->m_right;
+			childCount++;
+		}
+
+		for (ndInt32 i = 0; i < D_AABB_WIDE_NODE_WIDTH; ++i)
+		{
+			ndVector p0(ndVector::m_zero);
+			ndVector p1(ndVector::m_zero);
+			wideNode.m_child[i] = ndNode::ndLeafNodePtr(0, 0);
+			if (i < childCount)
+			{
+				const ndNode::ndLeafNodePtr& child = children[i];
+				if (child.IsLeaf())
+				{
+					const ndInt32 vCount = ndInt32(child.GetCount());
+					if (vCount)
+					{
+						// leaf faces do not have a box in the binary tree, 
+						// make one with the same padding the builder uses.
+						const ndInt32* const indices = &m_indices[child.GetIndex()];
+						p0 = ndVector(ndFloat32(1.0e15f));
+						p1 = ndVector(ndFloat32(-1.0e15f));
+						for (ndInt32 j = 0; j < vCount; ++j)
+						{
+							const ndVector point(ndVector(&vertexArray[indices[j]].m_x) & ndVector::m_triplexMask);
+							p0 = p0.GetMin(point);
+							p1 = p1.GetMax(point);
+						}
+						p0 = (p0 - ndVector(ndFloat32(1.0e-3f))) & ndVector::m_triplexMask;
+						p1 = (p1 + ndVector(ndFloat32(1.0e-3f))) & ndVector::m_triplexMask;
+						wideNode.m_child[i] = child;
+					}
+				}
+				else
+				{
+					const ndNode* const childNode = child.GetNode(m_aabb);
+					GetNodeAabb(childNode, p0, p1);
+					ndAssert(wideCount < m_nodesCount);
+					wideNode.m_child[i] = ndNode::ndLeafNodePtr(ndUnsigned32(wideCount));
+					stackPool[stack].m_node = childNode;
+					stackPool[stack].m_wideIndex = wideCount;
+					wideCount++;
+					stack++;
+				}
+			}
+			wideNode.m_minX[i] = p0.m_x;
+			wideNode.m_minY[i] = p0.m_y;
+			wideNode.m_minZ[i] = p0.m_z;
+			wideNode.m_maxX[i] = p1.m_x;
+			wideNode.m_maxY[i] = p1.m_y;
+			wideNode.m_maxZ[i] = p1.m_z;
+		}
+	}
+
+	m_wideNodesCount = wideCount;
+	m_wideNodes = (ndWideNode*)ndMemory::Malloc(sizeof(ndWideNode) * wideCount);
+	memcpy(m_wideNodes, wideNodes, sizeof(ndWideNode) * wideCount);
+	ndMemory::Free(wideNodes);
+}
+
+void ndAabbPolygonSoup::ForAllSectorsRayHitWide(const ndFastRay& raySrc, ndFloat32 maxParam, ndRayIntersectCallback callback, void* const context) const
+{
+	const ndWideNode* stackPool[DG_STACK_DEPTH];
+	ndFloat32 distance[DG_STACK_DEPTH];
+	ndFastRay ray(raySrc);
+
+	ndInt32 stack = 1;
+	const ndTriplex* const vertexArray = (ndTriplex*)m_localVertex;
+
+	stackPool[0] = m_wideNodes;
+	distance[0] = m_aabb->RayDistance(ray, vertexArray);
+	while (stack)
+	{
+		stack--;
+		if (distance[stack] > maxParam)
+		{
+			break;
+		}
+
+		const ndWideNode* const me = stackPool[stack];
+		const ndVector dist(WideRayBoxDistance(ray, me->m_minX, me->m_minY, me->m_minZ, me->m_maxX, me->m_maxY, me->m_maxZ));
+		const ndInt32 hitMask = (dist < ndVector(maxParam)).GetSignMask();
+		for (ndInt32 i = 0; i < D_AABB_WIDE_NODE_WIDTH; ++i)
+		{
+			const ndFloat32 dist1 = dist[i];
+			if ((hitMask & (1 << i)) && (dist1 < maxParam))
+			{
+				const ndNode::ndLeafNodePtr& child = me->m_child[i];
+				if (child.IsLeaf())
+				{
+					ndInt32 vCount = ndInt32(child.GetCount());
+					if (vCount > 0)
+					{
+						ndInt32 index = ndInt32(child.GetIndex());
+						ndFloat32 param = callback(context, &vertexArray[0].m_x, sizeof(ndTriplex), &m_indices[index], vCount);
+						ndAssert(param >= ndFloat32(0.0f));
+						if (param < maxParam)
+						{
+							maxParam = param;
+							if (maxParam == ndFloat32(0.0f))
+							{
+								return;
+							}
+						}
+					}
+				}
+				else
+				{
+					ndInt32 j = stack;
+					for (; j && (dist1 > distance[j - 1]); j--)
+					{
+						stackPool[j] = stackPool[j - 1];
+						distance[j] = distance[j - 1];
+					}
+					ndAssert(stack < DG_STACK_DEPTH);
+					stackPool[j] = &m_wideNodes[child.m_node];
+					distance[j] = dist1;
+					stack++;
+				}
+			}
+		}
+	}
+}
+
+void ndAabbPolygonSoup::ForAllSectorsWide(const ndFastAabb& obbAabbInfo, const ndVector& boxDistanceTravel, ndAaabbIntersectCallback callback, void* const context) const
+{
+	ndFloat32 distance[DG_STACK_DEPTH];
+	const ndWideNode* stackPool[DG_STACK_DEPTH];
+
+	const ndInt32 stride = sizeof(ndTriplex) / sizeof(ndFloat32);
+	const ndTriplex* const vertexArray = (ndTriplex*)m_localVertex;
+
+	ndAssert(boxDistanceTravel.m_w == ndFloat32(0.0f));
+	if (boxDistanceTravel.DotProduct(boxDistanceTravel).GetScalar() < ndFloat32(1.0e-8f))
+	{
+		ndInt32 stack = 1;
+		stackPool[0] = m_wideNodes;
+		distance[0] = m_aabb->BoxPenetration(obbAabbInfo, vertexArray);
+		if (distance[0] <= ndFloat32(0.0f))
+		{
+			obbAabbInfo.m_separationDistance = ndMin(obbAabbInfo.m_separationDistance[0], -distance[0]);
+		}
+		while (stack)
+		{
+			stack--;
+			if (distance[stack] > ndFloat32(0.0f))
+			{
+				const ndWideNode* const me = stackPool[stack];
+				const ndVector dist(WideBoxPenetration(obbAabbInfo, me));
+				for (ndInt32 i = 0; i < D_AABB_WIDE_NODE_WIDTH; ++i)
+				{
+					const ndNode::ndLeafNodePtr& child = me->m_child[i];
+					const ndFloat32 dist1 = dist[i];
+					if (child.IsLeaf() && !child.GetCount())
+					{
+						continue;
+					}
+					if (dist1 <= ndFloat32(0.0f))
+					{
+						obbAabbInfo.m_separationDistance = ndMin(obbAabbInfo.m_separationDistance[0], -dist1);
+					}
+					else if (child.IsLeaf())
+					{
+						ndInt32 vCount = ndInt32(child.GetCount());
+						const ndInt32* const indices = &m_indices[child.GetIndex()];
+						ndInt32 normalIndex = indices[vCount + 1];
+						ndVector faceNormal(&vertexArray[normalIndex].m_x);
+						faceNormal = faceNormal & ndVector::m_triplexMask;
+						ndFloat32 dist2 = obbAabbInfo.PolygonBoxDistance(faceNormal, vCount, indices, stride, &vertexArray[0].m_x);
+						if (dist2 > ndFloat32(0.0f))
+						{
+							obbAabbInfo.m_separationDistance = ndFloat32(0.0f);
+							ndAssert(vCount >= 3);
+							if (callback(context, &vertexArray[0].m_x, sizeof(ndTriplex), indices, vCount, dist2) == m_stopSearch)
+							{
+								return;
+							}
+						}
+						else
+						{
+							obbAabbInfo.m_separationDistance = ndMin(obbAabbInfo.m_separationDistance[0], -dist2);
+						}
+					}
+					else
+					{
+						ndInt32 j = stack;
+						for (; j && (dist1 > distance[j - 1]); j--)
+						{
+							stackPool[j] = stackPool[j - 1];
+							distance[j] = distance[j - 1];
+						}
+						ndAssert(stack < DG_STACK_DEPTH);
+						stackPool[j] = &m_wideNodes[child.m_node];
+						distance[j] = dist1;
+						stack++;
+					}
+				}
+			}
+		}
+	}
+	else
+	{
+		ndFastRay ray(ndVector::m_zero, boxDistanceTravel);
+		ndFastRay obbRay(ndVector::m_zero, obbAabbInfo.UnrotateVector(boxDistanceTravel));
+		ndInt32 stack = 1;
+		stackPool[0] = m_wideNodes;
+		distance[0] = m_aabb->BoxIntersect(ray, obbRay, obbAabbInfo, vertexArray);
+
+		while (stack)
+		{
+			stack--;
+			if (distance[stack] < ndFloat32(1.0f))
+			{
+				const ndWideNode* const me = stackPool[stack];
+				const ndVector dist(WideBoxIntersect(ray, obbRay, obbAabbInfo, me));
+				const ndInt32 hitMask = (dist < ndVector::m_one).GetSignMask();
+				for (ndInt32 i = 0; i < D_AABB_WIDE_NODE_WIDTH; ++i)
+				{
+					if (hitMask & (1 << i))
+					{
+						const ndNode::ndLeafNodePtr& child = me->m_child[i];
+						if (child.IsLeaf())
+						{
+							ndInt32 vCount = ndInt32(child.GetCount());
+							if (vCount > 0)
+							{
+								const ndInt32* const indices = &m_indices[child.GetIndex()];
+								ndInt32 normalIndex = indices[vCount + 1];
+								ndVector faceNormal(&vertexArray[normalIndex].m_x);
+								faceNormal = faceNormal & ndVector::m_triplexMask;
+								ndFloat32 hitDistance = obbAabbInfo.PolygonBoxRayDistance(faceNormal, vCount, indices, stride, &vertexArray[0].m_x, ray);
+								if (hitDistance < ndFloat32(1.0f))
+								{
+									ndAssert(vCount >= 3);
+									if (callback(context, &vertexArray[0].m_x, sizeof(ndTriplex), indices, vCount, hitDistance) == m_stopSearch)
+									{
+										return;
+									}
+								}
+							}
+						}
+						else
+						{
+							const ndFloat32 dist1 = dist[i];
+							ndInt32 j = stack;
+							for (; j && (dist1 > distance[j - 1]); j--)
+							{
+								stackPool[j] = stackPool[j - 1];
+								distance[j] = distance[j - 1];
+							}
+							ndAssert(stack < DG_STACK_DEPTH);
+							stackPool[j] = &m_wideNodes[child.m_node];
+							distance[j] = dist1;
+							stack++;
+						}
+					}
+				}
+			}
+		}
+	}
+}
@@ -30,12 +30,19 @@
 #include "ndIntersections.h"
 #include "ndPolygonSoupDatabase.h"
 
+class ndFileMapping;
 class ndPolygonSoupBuilder;
 
 // index format: i0, i1, i2, ... , id, normal, e0Normal, e1Normal, e2Normal, ..., faceSize
 #define D_CONCAVE_EDGE_MASK			(1<<31)
 #define D_FACE_CLIP_DIAGONAL_SCALE	ndFloat32 (0.25f)
 
+// version of the memory mapped cache file layout
+#define D_AABB_POLYGON_SOUP_CACHE_VERSION	1
+
+// children per node of the wide hierarchy, one per lane of a ndVector
+#define D_AABB_WIDE_NODE_WIDTH		4
+
 enum ndIntersectStatus
 {
 	m_stopSearch,
@@ -207,6 +214,23 @@ class ndAabbPolygonSoup: public ndPolygonSoupDatabase
 		ndLeafNodePtr m_right;
 	};
 
+	/// Four wide node of the optional wide hierarchy.
+	/// \brief the bounding boxes of the children are stored in SoA form, 
+	/// so that the four boxes are tested at once with vector instructions. 
+	/// a child is either a leaf face, or the index of another wide node. 
+	D_MSV_NEWTON_ALIGN_32
+	class ndWideNode
+	{
+		public:
+		ndVector m_minX;
+		ndVector m_minY;
+		ndVector m_minZ;
+		ndVector m_maxX;
+		ndVector m_maxY;
+		ndVector m_maxZ;
+		ndNode::ndLeafNodePtr m_child[D_AABB_WIDE_NODE_WIDTH];
+	} D_GCC_NEWTON_ALIGN_32;
+
 	class ndSplitInfo;
 	class ndNodeBuilder;
 
@@ -219,6 +243,39 @@ class ndAabbPolygonSoup: public ndPolygonSoupDatabase
 	/// Reads a previously saved database binary file named path.
 	D_CORE_API virtual void Deserialize (const char* const path);
 
+	/// writes the database to a relocatable binary cache file named path.
+	/// \brief the file can be memory mapped with MapCache and used in place, 
+	/// returns the content hash stored in the file, or zero if it failed.
+	D_CORE_API ndUnsigned64 SerializeCache(const char* const path) const;
+
+	/// Memory map a cache file written by SerializeCache and use it in place.
+	/// \brief nothing is copied or rebuilt, so many processes mapping the 
+	/// same file share the same physical pages. If contentHash is not zero, 
+	/// the file is rejected unless it has the same hash. 
+	/// Only the header is checked by default, a corrupt file turns into out 
+	/// of bounds reads in the queries. With verify, the arrays are hashed 
+	/// again and every node and face index is checked, this reads the whole 
+	/// file once. A mapped database is read only, so SetTagId can not be used on it.
+	D_CORE_API bool MapCache(const char* const path, ndUnsigned64 contentHash = 0, bool verify = false);
+
+	/// Returns true if the database is a memory mapped cache file.
+	bool IsMapped() const;
+
+	/// Returns the hash of the vertex, index and node arrays.
+	D_CORE_API ndUnsigned64 CalculateContentHash() const;
+
+	/// Returns the number of triangles of all the faces.
+	ndInt32 GetTriangleCount() const;
+
+	/// Build or release the four wide copy of the hierarchy.
+	/// \brief when enabled, ForAllSectors and ForAllSectorsRayHit walk the wide 
+	/// nodes instead of the binary tree. The binary tree is kept, since 
+	/// ForThisSector and the contact solver still walk it node by node.
+	D_CORE_API void SetWideNodeLayout(bool state);
+
+	/// Return true if the four wide hierarchy was built.
+	bool GetWideNodeLayout() const;
+
 	protected:
 	D_CORE_API ndAabbPolygonSoup ();
 	D_CORE_API virtual ~ndAabbPolygonSoup ();
@@ -264,14 +321,44 @@ class ndAabbPolygonSoup: public ndPolygonSoupDatabase
 	ndNodeBuilder* BuildTopDown (ndNodeBuilder* const leafArray, ndInt32 firstBox, ndInt32 lastBox, ndNodeBuilder** const allocator) const;
 	ndFloat32 CalculateFaceMaxDiagonal (const ndVector* const vertex, ndInt32 indexCount, const ndInt32* const indexArray) const;
 	static ndIntersectStatus CalculateAllFaceEdgeNormals(void* const context, const ndFloat32* const polygon, ndInt32 strideInBytes, const ndInt32* const indexArray, ndInt32 indexCount, ndFloat32 hitDistance);
+
+	void ReleaseData();
+	bool ValidateHierarchy() const;
+	void CalculateTriangleCount();
+	void BuildWideNodes();
+	static ndVector WideRayBoxDistance(const ndFastRay& ray, const ndVector& minX, const ndVector& minY, const ndVector& minZ, const ndVector& maxX, const ndVector& maxY, const ndVector& maxZ);
+	static void WideObbBoxes(const ndFastAabb& obb, const ndWideNode* const node, ndVector& minX, ndVector& minY, ndVector& minZ, ndVector& maxX, ndVector& maxY, ndVector& maxZ);
+	static ndVector WideBoxPenetration(const ndFastAabb& obb, const ndWideNode* const node);
+	static ndVector WideBoxIntersect(const ndFastRay& ray, const ndFastRay& obbRay, const ndFastAabb& obb, const ndWideNode* const node);
+	void ForAllSectorsRayHitWide(const ndFastRay& ray, ndFloat32 maxT, ndRayIntersectCallback callback, void* const context) const;
+	void ForAllSectorsWide(const ndFastAabb& obbAabb, const ndVector& boxDistanceTravel, ndAaabbIntersectCallback callback, void* const context) const;
 	
 	ndNode* m_aabb;
+	ndWideNode* m_wideNodes;
 	ndInt32* m_indices;
+	ndFileMapping* m_mapping;
 	ndInt32 m_nodesCount;
 	ndInt32 m_indexCount;
+	ndInt32 m_wideNodesCount;
+	ndInt32 m_triangleCount;
 	friend class ndContactSolver;
 };
 
+inline bool ndAabbPolygonSoup::IsMapped() const
+{
+	return m_mapping ? true : false;
+}
+
+inline ndInt32 ndAabbPolygonSoup::GetTriangleCount() const
+{
+	return m_triangleCount;
+}
+
+inline bool ndAabbPolygonSoup::GetWideNodeLayout() const
+{
+	return m_wideNodes ? true : false;
+}
+
 #endif
 
 
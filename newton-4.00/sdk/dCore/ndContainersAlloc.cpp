@@ -26,7 +26,13 @@
 #include "ndFixSizeArray.h"
 #include "ndContainersAlloc.h"
 
-#define D_FREELIST_DICTIONARY_SIZE 64
+#define D_FREELIST_DICTIONARY_SIZE	64
+
+// each thread keeps a small magazine of free blocks per size class in front 
+// of the shared lists, so that most allocations never touch the shared lock.
+// when a magazine runs empty it is refilled with half its capacity from the 
+// shared list, when it is full half of it is returned to the shared list.
+#define D_FREELIST_MAGAZINE_SIZE	32
 
 class ndFreeListEntry
 {
@@ -42,13 +48,62 @@ class ndFreeListHeader
 	ndFreeListEntry* m_headPointer;
 };
 
+class ndFreeListMagazine
+{
+	public:
+	ndInt32 m_count;
+	ndInt32 m_schunkSize;
+	void* m_entries[D_FREELIST_MAGAZINE_SIZE];
+};
+
+class ndFreeListDictionary;
+
+class ndFreeListThreadCache
+{
+	public:
+	ndFreeListThreadCache();
+	~ndFreeListThreadCache();
+
+	static ndFreeListThreadCache* GetCache();
+
+	void* Malloc(ndInt32 size);
+	bool Free(void* const ptr);
+
+	private:
+	ndFreeListMagazine* FindMagazine(ndInt32 size);
+
+	ndFixSizeArray<ndFreeListMagazine, D_FREELIST_DICTIONARY_SIZE> m_magazines;
+	ndFreeListThreadCache* m_next;
+	ndFreeListThreadCache* m_prev;
+	ndUnsigned64 m_cacheHits;
+	ndUnsigned64 m_sharedHits;
+	ndUnsigned64 m_systemAllocations;
+	ndUnsigned64 m_sharedReturns;
+	ndSpinLock m_lock;
+
+	friend class ndFreeListDictionary;
+};
+
+// set when the calling thread cache was destroyed, memory released 
+// after that point, (ex: during static destruction) goes to the shared lists.
+static thread_local bool m_threadCacheReleased = false;
+
 class ndFreeListDictionary: public ndFixSizeArray<ndFreeListHeader, D_FREELIST_DICTIONARY_SIZE>
 {
 	public:
 	ndFreeListDictionary()
 		:ndFixSizeArray<ndFreeListHeader, D_FREELIST_DICTIONARY_SIZE>()
+		,m_caches(nullptr)
+		,m_retired()
 		,m_lock()
 	{
+		m_retired.m_threadCaches = 0;
+		m_retired.m_cacheHits = 0;
+		m_retired.m_sharedHits = 0;
+		m_retired.m_systemAllocations = 0;
+		m_retired.m_sharedReturns = 0;
+		m_retired.m_sharedBlocks = 0;
+		m_retired.m_cachedBlocks = 0;
 	}
 
 	~ndFreeListDictionary()
@@ -105,9 +160,33 @@ class ndFreeListDictionary: public ndFixSizeArray<ndFreeListHeader, D_FREELIST_D
 		header->m_headPointer = self;
 	}
 
+	// move up to count blocks of the size class to the buffer, 
+	// return the number of blocks moved.
+	ndInt32 PopBlocks(ndInt32 bufferSize, void** const blocks, ndInt32 count)
+	{
+		ndScopeSpinLock lock(m_lock);
+		ndFreeListHeader* const header = FindEntry(bufferSize);
+		count = ndMin(count, header->m_count);
+		for (ndInt32 i = 0; i < count; ++i)
+		{
+			ndFreeListEntry* const self = header->m_headPointer;
+			header->m_headPointer = self->m_next;
+			blocks[i] = self;
+		}
+		header->m_count -= count;
+		return count;
+	}
+
+	void PushBlocks(ndInt32 bufferSize, void** const blocks, ndInt32 count)
+	{
+		ndScopeSpinLock lock(m_lock);
+		PushBlocksUnsafe(FindEntry(bufferSize), blocks, count);
+	}
+
 	void Flush()
 	{
 		ndScopeSpinLock lock(m_lock);
+		DrainCaches(0);
 		ndFreeListDictionary& me = *this;
 		for (ndInt32 i = 0; i < GetCount(); ++i)
 		{
@@ -120,11 +199,109 @@ class ndFreeListDictionary: public ndFixSizeArray<ndFreeListHeader, D_FREELIST_D
 	void Flush(ndInt32 size)
 	{
 		ndScopeSpinLock lock(m_lock);
-		ndFreeListHeader* const header = FindEntry(ndMemory::CalculateBufferSize(size_t(size)));
+		const ndInt32 bufferSize = ndMemory::CalculateBufferSize(size_t(size));
+		DrainCaches(bufferSize);
+		ndFreeListHeader* const header = FindEntry(bufferSize);
 		Flush(header);
 	}
 
+	void AddCache(ndFreeListThreadCache* const cache)
+	{
+		ndScopeSpinLock lock(m_lock);
+		cache->m_next = m_caches;
+		cache->m_prev = nullptr;
+		if (m_caches)
+		{
+			m_caches->m_prev = cache;
+		}
+		m_caches = cache;
+	}
+
+	void RemoveCache(ndFreeListThreadCache* const cache)
+	{
+		ndScopeSpinLock lock(m_lock);
+		{
+			ndScopeSpinLock cacheLock(cache->m_lock);
+			DrainCache(cache, 0);
+			m_retired.m_cacheHits += cache->m_cacheHits;
+			m_retired.m_sharedHits += cache->m_sharedHits;
+			m_retired.m_systemAllocations += cache->m_systemAllocations;
+			m_retired.m_sharedReturns += cache->m_sharedReturns;
+		}
+		if (cache->m_prev)
+		{
+			cache->m_prev->m_next = cache->m_next;
+		}
+		else
+		{
+			m_caches = cache->m_next;
+		}
+		if (cache->m_next)
+		{
+			cache->m_next->m_prev = cache->m_prev;
+		}
+	}
+
+	void GetStatistics(ndFreeListStatistics& statistics)
+	{
+		ndScopeSpinLock lock(m_lock);
+		statistics = m_retired;
+		ndFreeListDictionary& me = *this;
+		for (ndInt32 i = 0; i < GetCount(); ++i)
+		{
+			statistics.m_sharedBlocks += ndUnsigned64(me[i].m_count);
+		}
+		for (ndFreeListThreadCache* cache = m_caches; cache; cache = cache->m_next)
+		{
+			ndScopeSpinLock cacheLock(cache->m_lock);
+			statistics.m_threadCaches++;
+			statistics.m_cacheHits += cache->m_cacheHits;
+			statistics.m_sharedHits += cache->m_sharedHits;
+			statistics.m_systemAllocations += cache->m_systemAllocations;
+			statistics.m_sharedReturns += cache->m_sharedReturns;
+			for (ndInt32 i = 0; i < cache->m_magazines.GetCount(); ++i)
+			{
+				statistics.m_cachedBlocks += ndUnsigned64(cache->m_magazines[i].m_count);
+			}
+		}
+	}
+
 	private:
+	void PushBlocksUnsafe(ndFreeListHeader* const header, void** const blocks, ndInt32 count)
+	{
+		for (ndInt32 i = 0; i < count; ++i)
+		{
+			ndFreeListEntry* const self = (ndFreeListEntry*)blocks[i];
+			self->m_next = header->m_headPointer;
+			header->m_headPointer = self;
+		}
+		header->m_count += count;
+	}
+
+	// return the blocks of a thread cache to the shared lists, 
+	// a zero size drains all size classes.
+	void DrainCache(ndFreeListThreadCache* const cache, ndInt32 bufferSize)
+	{
+		for (ndInt32 i = 0; i < cache->m_magazines.GetCount(); ++i)
+		{
+			ndFreeListMagazine& magazine = cache->m_magazines[i];
+			if (magazine.m_count && (!bufferSize || (magazine.m_schunkSize == bufferSize)))
+			{
+				PushBlocksUnsafe(FindEntry(magazine.m_schunkSize), magazine.m_entries, magazine.m_count);
+				magazine.m_count = 0;
+			}
+		}
+	}
+
+	void DrainCaches(ndInt32 bufferSize)
+	{
+		for (ndFreeListThreadCache* cache = m_caches; cache; cache = cache->m_next)
+		{
+			ndScopeSpinLock cacheLock(cache->m_lock);
+			DrainCache(cache, bufferSize);
+		}
+	}
+
 	ndFreeListHeader* FindEntry(ndInt32 size)
 	{
 		ndInt32 i0 = 0;
@@ -180,9 +357,146 @@ class ndFreeListDictionary: public ndFixSizeArray<ndFreeListHeader, D_FREELIST_D
 		return &me[index];
 	}
 
+	ndFreeListThreadCache* m_caches;
+	ndFreeListStatistics m_retired;
 	ndSpinLock m_lock;
 };
 
+ndFreeListThreadCache::ndFreeListThreadCache()
+	:m_magazines()
+	,m_next(nullptr)
+	,m_prev(nullptr)
+	,m_cacheHits(0)
+	,m_sharedHits(0)
+	,m_systemAllocations(0)
+	,m_sharedReturns(0)
+	,m_lock()
+{
+	// the dictionary is created before the cache, so that it outlives it.
+	ndFreeListDictionary::GetHeader().AddCache(this);
+}
+
+ndFreeListThreadCache::~ndFreeListThreadCache()
+{
+	ndFreeListDictionary::GetHeader().RemoveCache(this);
+	m_threadCacheReleased = true;
+}
+
+ndFreeListThreadCache* ndFreeListThreadCache::GetCache()
+{
+	if (m_threadCacheReleased)
+	{
+		return nullptr;
+	}
+	static thread_local ndFreeListThreadCache cache;
+	return &cache;
+}
+
+ndFreeListMagazine* ndFreeListThreadCache::FindMagazine(ndInt32 size)
+{
+	// a thread only sees a handful of size classes, a linear search is fine.
+	for (ndInt32 i = 0; i < m_magazines.GetCount(); ++i)
+	{
+		if (m_magazines[i].m_schunkSize == size)
+		{
+			return &m_magazines[i];
+		}
+	}
+	if (m_magazines.GetCount() >= m_magazines.GetCapacity())
+	{
+		return nullptr;
+	}
+	ndFreeListMagazine magazine;
+	magazine.m_count = 0;
+	magazine.m_schunkSize = size;
+	m_magazines.PushBack(magazine);
+	return &m_magazines[m_magazines.GetCount() - 1];
+}
+
+void* ndFreeListThreadCache::Malloc(ndInt32 size)
+{
+	const ndInt32 bufferSize = ndMemory::CalculateBufferSize(size_t(size));
+	{
+		ndScopeSpinLock lock(m_lock);
+		ndFreeListMagazine* const magazine = FindMagazine(bufferSize);
+		if (magazine && magazine->m_count)
+		{
+			m_cacheHits++;
+			magazine->m_count--;
+			return magazine->m_entries[magazine->m_count];
+		}
+	}
+
+	// the cache lock is never held while taking the shared lock, 
+	// since a flush takes them in the opposite order.
+	void* blocks[D_FREELIST_MAGAZINE_SIZE / 2];
+	const ndInt32 count = ndFreeListDictionary::GetHeader().PopBlocks(bufferSize, blocks, D_FREELIST_MAGAZINE_SIZE / 2);
+	if (!count)
+	{
+		{
+			ndScopeSpinLock lock(m_lock);
+			m_systemAllocations++;
+		}
+		void* const ptr = ndMemory::Malloc(size_t(size));
+		ndAssert(ndMemory::GetSize(ptr) == bufferSize);
+		return ptr;
+	}
+
+	{
+		ndScopeSpinLock lock(m_lock);
+		m_sharedHits++;
+		ndFreeListMagazine* const magazine = FindMagazine(bufferSize);
+		if (magazine)
+		{
+			// the magazine was empty and can only have been drained while unlocked.
+			ndAssert((magazine->m_count + count - 1) <= D_FREELIST_MAGAZINE_SIZE);
+			for (ndInt32 i = 1; i < count; ++i)
+			{
+				magazine->m_entries[magazine->m_count] = blocks[i];
+				magazine->m_count++;
+			}
+			return blocks[0];
+		}
+	}
+
+	// out of size classes, keep only one block.
+	ndFreeListDictionary::GetHeader().PushBlocks(bufferSize, &blocks[1], count - 1);
+	return blocks[0];
+}
+
+bool ndFreeListThreadCache::Free(void* const ptr)
+{
+	// blocks freed by a thread other than the one that allocated them 
+	// simply go to the magazine of the freeing thread, when producer and 
+	// consumer threads differ the magazine overflows and the blocks find 
+	// their way back to the allocating threads through the shared lists.
+	const ndInt32 bufferSize = ndMemory::GetSize(ptr);
+	void* blocks[D_FREELIST_MAGAZINE_SIZE / 2 + 1];
+	{
+		ndScopeSpinLock lock(m_lock);
+		ndFreeListMagazine* const magazine = FindMagazine(bufferSize);
+		if (!magazine)
+		{
+			return false;
+		}
+		if (magazine->m_count < D_FREELIST_MAGAZINE_SIZE)
+		{
+			magazine->m_entries[magazine->m_count] = ptr;
+			magazine->m_count++;
+			return true;
+		}
+		m_sharedReturns++;
+		magazine->m_count -= D_FREELIST_MAGAZINE_SIZE / 2;
+		for (ndInt32 i = 0; i < D_FREELIST_MAGAZINE_SIZE / 2; ++i)
+		{
+			blocks[i] = magazine->m_entries[magazine->m_count + i];
+		}
+	}
+	blocks[D_FREELIST_MAGAZINE_SIZE / 2] = ptr;
+	ndFreeListDictionary::GetHeader().PushBlocks(bufferSize, blocks, D_FREELIST_MAGAZINE_SIZE / 2 + 1);
+	return true;
+}
+
 void ndFreeListAlloc::Flush()
 {
 	ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
@@ -191,14 +505,23 @@ void ndFreeListAlloc::Flush()
 
 void* ndFreeListAlloc::operator new (size_t size)
 {
+	ndFreeListThreadCache* const cache = ndFreeListThreadCache::GetCache();
+	if (cache)
+	{
+		return cache->Malloc(ndInt32(size));
+	}
 	ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
 	return dictionary.Malloc(ndInt32 (size));
 }
 
 void ndFreeListAlloc::operator delete (void* ptr)
 {
-	ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
-	dictionary.Free(ptr);
+	ndFreeListThreadCache* const cache = ndFreeListThreadCache::GetCache();
+	if (!(cache && cache->Free(ptr)))
+	{
+		ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
+		dictionary.Free(ptr);
+	}
 }
 
 void ndFreeListAlloc::Flush(ndInt32 size)
@@ -207,3 +530,8 @@ void ndFreeListAlloc::Flush(ndInt32 size)
 	dictionary.Flush(size);
 }
 
+void ndFreeListAlloc::GetStatistics(ndFreeListStatistics& statistics)
+{
+	ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
+	dictionary.GetStatistics(statistics);
+}
@@ -24,6 +24,8 @@
 
 #include "ndCoreStdafx.h"
 
+class ndFreeListStatistics;
+
 template<class T>
 class ndContainersAlloc: public ndClassAlloc
 {
@@ -47,6 +49,7 @@ class ndFreeListAlloc
 	ndFreeListAlloc();
 	D_CORE_API static void Flush();
 	D_CORE_API static void Flush(ndInt32 size);
+	D_CORE_API static void GetStatistics(ndFreeListStatistics& statistics);
 	D_CORE_API void *operator new (size_t size);
 	D_CORE_API void operator delete (void* ptr);
 };
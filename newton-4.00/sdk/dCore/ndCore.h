@@ -52,8 +52,11 @@
 #include <ndThreadPool.h>
 #include <ndIsoSurface.h>
 #include <ndQuaternion.h>
+#include <ndFileMapping.h>
+#include <ndFrameArena.h>
 #include <ndPerlinNoise.h>
 #include <ndTinyXmlGlue.h>
+#include <ndSimdDispatch.h>
 #include <ndFixSizeArray.h>
 #include <ndConvexHull2d.h>
 #include <ndConvexHull3d.h>
@@ -0,0 +1,107 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndFileMapping.h"
+
+#if !(defined (WIN32) || defined(_WIN32))
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#if (defined (WIN32) || defined(_WIN32))
+ndFileMapping::ndFileMapping(const char* const path)
+	:ndClassAlloc()
+	,m_data(nullptr)
+	,m_size(0)
+	,m_file(INVALID_HANDLE_VALUE)
+	,m_mapping(nullptr)
+{
+	m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER size;
+		if (GetFileSizeEx(m_file, &size) && size.QuadPart)
+		{
+			m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (m_mapping)
+			{
+				m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+				m_size = m_data ? size_t(size.QuadPart) : 0;
+			}
+		}
+	}
+}
+
+ndFileMapping::~ndFileMapping()
+{
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+	}
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_file);
+	}
+}
+
+#else
+
+ndFileMapping::ndFileMapping(const char* const path)
+	:ndClassAlloc()
+	,m_data(nullptr)
+	,m_size(0)
+	,m_file(-1)
+{
+	m_file = open(path, O_RDONLY);
+	if (m_file != -1)
+	{
+		struct stat info;
+		if ((fstat(m_file, &info) == 0) && info.st_size)
+		{
+			void* const data = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, m_file, 0);
+			if (data != MAP_FAILED)
+			{
+				m_data = data;
+				m_size = size_t(info.st_size);
+			}
+		}
+	}
+}
+
+ndFileMapping::~ndFileMapping()
+{
+	if (m_data)
+	{
+		munmap((void*)m_data, m_size);
+	}
+	if (m_file != -1)
+	{
+		close(m_file);
+	}
+}
+#endif
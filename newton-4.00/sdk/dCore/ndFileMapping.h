@@ -0,0 +1,77 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_FILE_MAPPING_H_
+#define __ND_FILE_MAPPING_H_
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndClassAlloc.h"
+
+/// Read only memory mapped view of an entire file.
+/// \brief the content of the file is paged in by the operating system 
+/// on demand, so large binary files can be read without copying them 
+/// into a user buffer first.
+class ndFileMapping: public ndClassAlloc
+{
+	public:
+	/// Map the file, check IsValid to know if the operation succeeded.
+	D_CORE_API ndFileMapping(const char* const path);
+
+	/// Unmap the file view and close the file.
+	D_CORE_API ~ndFileMapping();
+
+	/// Returns true if the file was opened and mapped.
+	bool IsValid() const;
+
+	/// Returns the pointer to the first byte of the file.
+	const void* GetData() const;
+
+	/// Returns the size of the file in bytes.
+	size_t GetSize() const;
+
+	private:
+	const void* m_data;
+	size_t m_size;
+#if (defined (WIN32) || defined(_WIN32))
+	HANDLE m_file;
+	HANDLE m_mapping;
+#else
+	ndInt32 m_file;
+#endif
+};
+
+inline bool ndFileMapping::IsValid() const
+{
+	return m_data ? true : false;
+}
+
+inline const void* ndFileMapping::GetData() const
+{
+	return m_data;
+}
+
+inline size_t ndFileMapping::GetSize() const
+{
+	return m_size;
+}
+
+#endif
@@ -0,0 +1,127 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndUtils.h"
+#include "ndMemory.h"
+#include "ndFrameArena.h"
+
+ndFrameArena::ndFrameArena()
+	:ndClassAlloc()
+	,m_page(nullptr)
+	,m_used(0)
+	,m_capacity(0)
+	,m_stepPeak(0)
+	,m_framePeak(0)
+	,m_peak(0)
+{
+}
+
+ndFrameArena::~ndFrameArena()
+{
+	Release();
+}
+
+void ndFrameArena::AddPage(size_t size)
+{
+	// pages grow geometrically, so a step that spills only adds a few pages.
+	size = ndMax(ndMax(size, m_capacity), size_t(D_FRAME_ARENA_MIN_PAGE_SIZE));
+	size = (size + D_FRAME_ARENA_ALIGNMENT - 1) & ~size_t(D_FRAME_ARENA_ALIGNMENT - 1);
+
+	ndUnsigned8* const memory = (ndUnsigned8*)ndMemory::Malloc(sizeof(ndPage) + D_FRAME_ARENA_ALIGNMENT + size);
+	ndPage* const page = (ndPage*)memory;
+	const ndUnsigned64 data = (ndUnsigned64(memory + sizeof(ndPage)) + D_FRAME_ARENA_ALIGNMENT - 1) & ~ndUnsigned64(D_FRAME_ARENA_ALIGNMENT - 1);
+	page->m_prev = m_page;
+	page->m_data = (ndUnsigned8*)data;
+	page->m_size = size;
+	page->m_offset = 0;
+	m_page = page;
+	m_capacity += size;
+}
+
+void ndFrameArena::FreePage()
+{
+	ndPage* const page = m_page;
+	ndAssert(page);
+	m_page = page->m_prev;
+	m_capacity -= page->m_size;
+	ndMemory::Free(page);
+}
+
+void* ndFrameArena::Alloc(size_t size)
+{
+	size = (size + D_FRAME_ARENA_ALIGNMENT - 1) & ~size_t(D_FRAME_ARENA_ALIGNMENT - 1);
+	if (!m_page || ((m_page->m_offset + size) > m_page->m_size))
+	{
+		AddPage(size);
+	}
+
+	void* const ptr = &m_page->m_data[m_page->m_offset];
+	m_page->m_offset += size;
+	m_used += size;
+	m_stepPeak = ndMax(m_stepPeak, m_used);
+	return ptr;
+}
+
+void ndFrameArena::Rewind(const ndMark& mark)
+{
+	// pages added after the mark are freed, except the first page 
+	// which is kept for the next allocations.
+	while (m_page && (m_page != mark.m_page) && m_page->m_prev)
+	{
+		FreePage();
+	}
+	if (m_page)
+	{
+		m_page->m_offset = (m_page == mark.m_page) ? mark.m_offset : 0;
+	}
+	m_used = mark.m_used;
+}
+
+void ndFrameArena::Reset()
+{
+	m_framePeak = m_stepPeak;
+	m_peak = ndMax(m_peak, m_stepPeak);
+	m_stepPeak = 0;
+	m_used = 0;
+
+	if (m_page && (m_page->m_prev || (m_page->m_size < m_framePeak)))
+	{
+		// the last step did not fit in one page, 
+		// replace all the pages by one of the peak size.
+		Release();
+		AddPage(m_framePeak);
+	}
+	else if (m_page)
+	{
+		m_page->m_offset = 0;
+	}
+}
+
+void ndFrameArena::Release()
+{
+	while (m_page)
+	{
+		FreePage();
+	}
+	m_used = 0;
+	ndAssert(m_capacity == 0);
+}
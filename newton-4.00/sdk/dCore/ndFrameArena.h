@@ -0,0 +1,168 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_FRAME_ARENA_H_
+#define __ND_FRAME_ARENA_H_
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndClassAlloc.h"
+
+#define D_FRAME_ARENA_ALIGNMENT		64
+#define D_FRAME_ARENA_MIN_PAGE_SIZE	(1024 * 64)
+
+/// Linear allocator for the transient buffers of a simulation step.
+/// \brief memory is carved from a page by bumping an offset, and it is 
+/// given back in bulk by rewinding to a mark or by resetting the arena.
+/// when a step needs more than one page, the pages are merged into a single 
+/// page of the peak size at the next reset, so after a few steps the arena 
+/// settles in one page and no more system allocations are made.
+/// allocations are not thread safe, they must be made by the thread that 
+/// runs the update, outside the parallel loops that use the buffers.
+class ndFrameArena: public ndClassAlloc
+{
+	class ndPage
+	{
+		public:
+		ndPage* m_prev;
+		ndUnsigned8* m_data;
+		size_t m_size;
+		size_t m_offset;
+	};
+
+	public:
+	/// A position in the arena to rewind to.
+	class ndMark
+	{
+		public:
+		ndPage* m_page;
+		size_t m_offset;
+		size_t m_used;
+	};
+
+	D_CORE_API ndFrameArena();
+	D_CORE_API ~ndFrameArena();
+
+	/// Allocate a buffer aligned to D_FRAME_ARENA_ALIGNMENT bytes.
+	D_CORE_API void* Alloc(size_t size);
+
+	/// Allocate an uninitialized array of count items.
+	template <class T>
+	T* Alloc(ndInt32 count);
+
+	/// Get the current position of the arena.
+	ndMark GetMark() const;
+
+	/// Release all the buffers allocated after the mark was taken.
+	D_CORE_API void Rewind(const ndMark& mark);
+
+	/// Release all the buffers, called once per sub step.
+	/// \brief if the last step spilled to more than one page, 
+	/// the pages are replaced by one page of the peak size.
+	D_CORE_API void Reset();
+
+	/// Free all the memory of the arena.
+	D_CORE_API void Release();
+
+	/// Bytes currently allocated from the arena.
+	size_t GetUsed() const;
+
+	/// Bytes reserved by all the pages of the arena.
+	size_t GetCapacity() const;
+
+	/// Largest number of bytes used during the last completed step.
+	size_t GetFramePeakUsage() const;
+
+	/// Largest number of bytes used since the arena was created.
+	size_t GetPeakUsage() const;
+
+	private:
+	void AddPage(size_t size);
+	void FreePage();
+
+	ndPage* m_page;
+	size_t m_used;
+	size_t m_capacity;
+	size_t m_stepPeak;
+	size_t m_framePeak;
+	size_t m_peak;
+};
+
+/// Rewind an arena to its position at construction when going out of scope.
+class ndFrameArenaScope
+{
+	public:
+	ndFrameArenaScope(ndFrameArena& arena);
+	~ndFrameArenaScope();
+
+	private:
+	ndFrameArena& m_arena;
+	ndFrameArena::ndMark m_mark;
+};
+
+template <class T>
+inline T* ndFrameArena::Alloc(ndInt32 count)
+{
+	ndAssert(count >= 0);
+	return (T*)Alloc(size_t(count) * sizeof(T));
+}
+
+inline ndFrameArena::ndMark ndFrameArena::GetMark() const
+{
+	ndMark mark;
+	mark.m_page = m_page;
+	mark.m_offset = m_page ? m_page->m_offset : 0;
+	mark.m_used = m_used;
+	return mark;
+}
+
+inline size_t ndFrameArena::GetUsed() const
+{
+	return m_used;
+}
+
+inline size_t ndFrameArena::GetCapacity() const
+{
+	return m_capacity;
+}
+
+inline size_t ndFrameArena::GetFramePeakUsage() const
+{
+	return m_framePeak;
+}
+
+inline size_t ndFrameArena::GetPeakUsage() const
+{
+	return m_peak;
+}
+
+inline ndFrameArenaScope::ndFrameArenaScope(ndFrameArena& arena)
+	:m_arena(arena)
+	,m_mark(arena.GetMark())
+{
+}
+
+inline ndFrameArenaScope::~ndFrameArenaScope()
+{
+	m_arena.Rewind(m_mark);
+}
+
+#endif
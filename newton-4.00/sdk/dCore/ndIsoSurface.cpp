@@ -166,7 +166,9 @@ class ndIsoSurface::ndImplementation : public ndClassAlloc
 	void ClearBuffers();
 	void SortCellBuckects();
 	void GenerateLowResIsoSurface();
-	void ProcessLowResCell(ndIsoCell& cell);
+	ndInt32 GetCellEnd(ndInt32 start) const;
+	ndInt32 GetCellTableIndex(ndInt32 start, ndInt32 end) const;
+	void ProcessLowResCell(const ndGridHash& grid, ndInt32 tableIndex, ndInt32 index);
 	void MakeTriangleList(ndIsoSurface* const me);
 	void CalculateNormals(ndIsoSurface* const me);
 	
@@ -178,6 +180,12 @@ class ndIsoSurface::ndImplementation : public ndClassAlloc
 	ndVector InterpolateLowResVertex(const ndVector& p1, const ndVector& p2) const;
 	ndVector InterpolateHighResVertex(ndFloat32 isolevel, const ndVector& p1, const ndVector& p2) const;
 
+	ndInt32 GetThreadCount() const;
+	template <typename Function>
+	void ParallelExecute(const Function& callback);
+	template <class T, class ndEvaluateKey>
+	void CountingSort(ndArray<T>& array, ndArray<T>& scratchBuffer);
+
 	ndVector m_boxP0;
 	ndVector m_boxP1;
 	ndVector m_gridSize;
@@ -192,6 +200,7 @@ class ndIsoSurface::ndImplementation : public ndClassAlloc
 	ndInt32 m_volumeSizeY;
 	ndInt32 m_volumeSizeZ;
 	ndUpperDigit m_upperDigitsIsValid;
+	ndThreadPool* m_threadPool;
 	
 	static ndEdge m_edges[];
 	static ndInt32 m_faces[][3];
@@ -2598,6 +2607,7 @@ inline ndIsoSurface::ndImplementation::ndImplementation()
 	,m_volumeSizeY(1)
 	,m_volumeSizeZ(1)
 	,m_upperDigitsIsValid()
+	,m_threadPool(nullptr)
 {
 }
 
@@ -2610,6 +2620,38 @@ ndVector ndIsoSurface::ndImplementation::GetOrigin() const
 	return m_boxP0;
 }
 
+// without a thread pool the passes run on the calling thread.
+ndInt32 ndIsoSurface::ndImplementation::GetThreadCount() const
+{
+	return m_threadPool ? m_threadPool->GetThreadCount() : 1;
+}
+
+template <typename Function>
+void ndIsoSurface::ndImplementation::ParallelExecute(const Function& callback)
+{
+	if (m_threadPool)
+	{
+		m_threadPool->ParallelExecute(callback);
+	}
+	else
+	{
+		callback(0, 1);
+	}
+}
+
+template <class T, class ndEvaluateKey>
+void ndIsoSurface::ndImplementation::CountingSort(ndArray<T>& array, ndArray<T>& scratchBuffer)
+{
+	if (m_threadPool)
+	{
+		ndCountingSort<T, ndEvaluateKey, 8>(*m_threadPool, array, scratchBuffer, nullptr, nullptr);
+	}
+	else
+	{
+		ndCountingSort<T, ndEvaluateKey, 8>(array, scratchBuffer, nullptr, nullptr);
+	}
+}
+
 void ndIsoSurface::ndImplementation::Clear()
 {
 	m_triangles.Resize(256);
@@ -2626,12 +2668,30 @@ void ndIsoSurface::ndImplementation::CalculateAabb(const ndArray<ndVector>& poin
 	m_gridSize = ndVector::m_triplexMask & ndVector(gridSize);
 	m_invGridSize = ndVector::m_triplexMask & ndVector(ndFloat32(1.0f) / gridSize);
 
-	ndVector boxP0(ndFloat32(1.0e10f));
-	ndVector boxP1(ndFloat32(-1.0e10f));
-	for (ndInt32 i = 0; i < points.GetCount(); ++i)
+	ndVector boxP0Array[D_MAX_THREADS_COUNT];
+	ndVector boxP1Array[D_MAX_THREADS_COUNT];
+	auto CalculateAabb = ndMakeObject::ndFunction([&points, &boxP0Array, &boxP1Array](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateAabb);
+		ndVector boxP0(ndFloat32(1.0e10f));
+		ndVector boxP1(ndFloat32(-1.0e10f));
+		const ndStartEnd startEnd(points.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			boxP0 = boxP0.GetMin(points[i]);
+			boxP1 = boxP1.GetMax(points[i]);
+		}
+		boxP0Array[threadIndex] = boxP0;
+		boxP1Array[threadIndex] = boxP1;
+	});
+	ParallelExecute(CalculateAabb);
+
+	ndVector boxP0(boxP0Array[0]);
+	ndVector boxP1(boxP1Array[0]);
+	for (ndInt32 i = 1; i < GetThreadCount(); ++i)
 	{
-		boxP0 = boxP0.GetMin(points[i]);
-		boxP1 = boxP1.GetMax(points[i]);
+		boxP0 = boxP0.GetMin(boxP0Array[i]);
+		boxP1 = boxP1.GetMax(boxP1Array[i]);
 	}
 	boxP0 -= m_gridSize;
 	boxP1 += (m_gridSize + m_gridSize);
@@ -2676,12 +2736,36 @@ ndVector ndIsoSurface::ndImplementation::InterpolateHighResVertex(ndFloat32, con
 	return ndVector(p0 + p1p0 * ndVector::m_half);
 }
 
-void ndIsoSurface::ndImplementation::ProcessLowResCell(ndIsoCell& cell)
+ndInt32 ndIsoSurface::ndImplementation::GetCellEnd(ndInt32 start) const
+{
+	ndInt32 end = start + 1;
+	const ndUnsigned64 cellHash = m_hashGridMap[start].m_gridCellHash;
+	while (cellHash == m_hashGridMap[end].m_gridCellHash)
+	{
+		end++;
+	}
+	return end;
+}
+
+ndInt32 ndIsoSurface::ndImplementation::GetCellTableIndex(ndInt32 start, ndInt32 end) const
 {
+	// the corners touched by a particle are inside the surface
 	ndInt32 tableIndex = 0;
+	for (ndInt32 i = start; i < end; ++i)
+	{
+		tableIndex |= 1 << m_hashGridMap[i].m_cellType;
+	}
+	return tableIndex;
+}
+
+void ndIsoSurface::ndImplementation::ProcessLowResCell(const ndGridHash& grid, ndInt32 tableIndex, ndInt32 index)
+{
+	ndIsoCell cell;
+	const ndVector origin(ndFloat32(grid.m_x + 1), ndFloat32(grid.m_y + 1), ndFloat32(grid.m_z + 1), ndFloat32(0.0f));
 	for (ndInt32 i = 0; i < 8; ++i)
 	{
-		tableIndex |= (cell.m_isoValues[i].m_w > m_isoValue) << i;
+		cell.m_isoValues[i] = origin + m_gridCorners[i];
+		cell.m_isoValues[i].m_w = ndFloat32((tableIndex >> i) & 1);
 	}
 
 	ndVector vertlist[12];
@@ -2696,11 +2780,9 @@ void ndIsoSurface::ndImplementation::ProcessLowResCell(ndIsoCell& cell)
 		vertlist[midPoint] = InterpolateLowResVertex(cell.m_isoValues[p0], cell.m_isoValues[p1]);
 	}
 	
-	const ndInt32 index = m_triangles.GetCount();
 	const ndInt32 faceStart = m_facesScan[tableIndex];
 	const ndInt32 faceVertexCount = m_facesScan[tableIndex + 1] - faceStart;
 	
-	m_triangles.SetCount(index + faceVertexCount * 3);
 	ndVector* const triangle = &m_triangles[index];
 	for (ndInt32 i = 0; i < faceVertexCount; ++i)
 	{
@@ -2861,22 +2943,22 @@ void ndIsoSurface::ndImplementation::SortCellBuckects()
 		}
 	};
 
-	ndCountingSort<ndGridHash, ndKey_xlow, 8>(m_hashGridMap, m_hashGridMapScratchBuffer, nullptr, nullptr);
+	CountingSort<ndGridHash, ndKey_xlow>(m_hashGridMap, m_hashGridMapScratchBuffer);
 	if (m_upperDigitsIsValid.m_x)
 	{
-		ndCountingSort<ndGridHash, ndKey_xhigh, 8>(m_hashGridMap, m_hashGridMapScratchBuffer, nullptr, nullptr);
+		CountingSort<ndGridHash, ndKey_xhigh>(m_hashGridMap, m_hashGridMapScratchBuffer);
 	}
 
-	ndCountingSort<ndGridHash, ndKey_ylow, 8>(m_hashGridMap, m_hashGridMapScratchBuffer, nullptr, nullptr);
+	CountingSort<ndGridHash, ndKey_ylow>(m_hashGridMap, m_hashGridMapScratchBuffer);
 	if (m_upperDigitsIsValid.m_y)
 	{
-		ndCountingSort<ndGridHash, ndKey_yhigh, 8>(m_hashGridMap, m_hashGridMapScratchBuffer, nullptr, nullptr);
+		CountingSort<ndGridHash, ndKey_yhigh>(m_hashGridMap, m_hashGridMapScratchBuffer);
 	}
 
-	ndCountingSort<ndGridHash, ndKey_zlow, 8>(m_hashGridMap, m_hashGridMapScratchBuffer, nullptr, nullptr);
+	CountingSort<ndGridHash, ndKey_zlow>(m_hashGridMap, m_hashGridMapScratchBuffer);
 	if (m_upperDigitsIsValid.m_z)
 	{
-		ndCountingSort<ndGridHash, ndKey_zhigh, 8>(m_hashGridMap, m_hashGridMapScratchBuffer, nullptr, nullptr);
+		CountingSort<ndGridHash, ndKey_zhigh>(m_hashGridMap, m_hashGridMapScratchBuffer);
 	}
 }
 
@@ -2943,90 +3025,167 @@ void ndIsoSurface::ndImplementation::RemoveDuplicates(const ndArray<ndVector>& p
 		}
 	};
 
-	const ndVector origin(m_boxP0);
-	const ndVector invGridSize(m_invGridSize);
-
-	const ndVector rounding(ndVector::m_zero);
-	ndUpperDigit upperDigits;
-	const ndGridHashSteps steps;
+	ndUpperDigit upperDigitsArray[D_MAX_THREADS_COUNT];
 	m_hashGridMapScratchBuffer.SetCount(points.GetCount());
-	for (ndInt32 i = 0; i < points.GetCount(); ++i)
+	auto CalculateHashes = ndMakeObject::ndFunction([this, &points, &upperDigitsArray](ndInt32 threadIndex, ndInt32 threadCount)
 	{
-		const ndVector r(points[i] - origin);
-		const ndVector p(r * invGridSize + rounding);
-		const ndGridHash hashKey(p);
-		m_hashGridMapScratchBuffer[i] = hashKey;
+		D_TRACKTIME_NAMED(CalculateHashes);
+		const ndVector origin(m_boxP0);
+		const ndVector invGridSize(m_invGridSize);
 
-		upperDigits.m_x = ndMax(upperDigits.m_x, ndInt32(hashKey.m_xHigh));
-		upperDigits.m_y = ndMax(upperDigits.m_y, ndInt32(hashKey.m_yHigh));
-		upperDigits.m_z = ndMax(upperDigits.m_z, ndInt32(hashKey.m_zHigh));
+		ndUpperDigit upperDigits;
+		const ndStartEnd startEnd(points.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndVector r(points[i] - origin);
+			const ndVector p(r * invGridSize);
+			const ndGridHash hashKey(p);
+			m_hashGridMapScratchBuffer[i] = hashKey;
+
+			upperDigits.m_x = ndMax(upperDigits.m_x, ndInt32(hashKey.m_xHigh));
+			upperDigits.m_y = ndMax(upperDigits.m_y, ndInt32(hashKey.m_yHigh));
+			upperDigits.m_z = ndMax(upperDigits.m_z, ndInt32(hashKey.m_zHigh));
+		}
+		upperDigitsArray[threadIndex] = upperDigits;
+	});
+	ParallelExecute(CalculateHashes);
+
+	ndUpperDigit upperDigits;
+	for (ndInt32 i = 0; i < GetThreadCount(); ++i)
+	{
+		upperDigits.m_x = ndMax(upperDigits.m_x, upperDigitsArray[i].m_x);
+		upperDigits.m_y = ndMax(upperDigits.m_y, upperDigitsArray[i].m_y);
+		upperDigits.m_z = ndMax(upperDigits.m_z, upperDigitsArray[i].m_z);
 	}
 	m_upperDigitsIsValid = upperDigits;
 
-	ndCountingSort<ndGridHash, ndKey_xlow, 8>(m_hashGridMapScratchBuffer, m_hashGridMap, nullptr, nullptr);
+	CountingSort<ndGridHash, ndKey_xlow>(m_hashGridMapScratchBuffer, m_hashGridMap);
 	if (m_upperDigitsIsValid.m_x)
 	{
-		ndCountingSort<ndGridHash, ndKey_xhigh, 8>(m_hashGridMapScratchBuffer, m_hashGridMap, nullptr, nullptr);
+		CountingSort<ndGridHash, ndKey_xhigh>(m_hashGridMapScratchBuffer, m_hashGridMap);
 	}
 
-	ndCountingSort<ndGridHash, ndKey_ylow, 8>(m_hashGridMapScratchBuffer, m_hashGridMap, nullptr, nullptr);
+	CountingSort<ndGridHash, ndKey_ylow>(m_hashGridMapScratchBuffer, m_hashGridMap);
 	if (m_upperDigitsIsValid.m_y)
 	{
-		ndCountingSort<ndGridHash, ndKey_yhigh, 8>(m_hashGridMapScratchBuffer, m_hashGridMap, nullptr, nullptr);
+		CountingSort<ndGridHash, ndKey_yhigh>(m_hashGridMapScratchBuffer, m_hashGridMap);
 	}
 
-	ndCountingSort<ndGridHash, ndKey_zlow, 8>(m_hashGridMapScratchBuffer, m_hashGridMap, nullptr, nullptr);
+	CountingSort<ndGridHash, ndKey_zlow>(m_hashGridMapScratchBuffer, m_hashGridMap);
 	if (m_upperDigitsIsValid.m_z)
 	{
-		ndCountingSort<ndGridHash, ndKey_zhigh, 8>(m_hashGridMapScratchBuffer, m_hashGridMap, nullptr, nullptr);
+		CountingSort<ndGridHash, ndKey_zhigh>(m_hashGridMapScratchBuffer, m_hashGridMap);
 	}
 
+	// compact the sorted hashes, each thread counts the first entry of
+	// the runs in its range and copies them after the runs of the threads before it.
+	ndInt32 uniqueStart[D_MAX_THREADS_COUNT + 1];
+	const ndInt32 hashCount = m_hashGridMapScratchBuffer.GetCount();
+	auto CountUniqueHashes = ndMakeObject::ndFunction([this, hashCount, &uniqueStart](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CountUniqueHashes);
+		ndInt32 count = 0;
+		const ndStartEnd startEnd(hashCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			count += (i == 0) || (m_hashGridMapScratchBuffer[i].m_gridCellHash != m_hashGridMapScratchBuffer[i - 1].m_gridCellHash);
+		}
+		uniqueStart[threadIndex] = count;
+	});
+
+	auto CopyUniqueHashes = ndMakeObject::ndFunction([this, hashCount, &uniqueStart](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CopyUniqueHashes);
+		ndInt32 index = uniqueStart[threadIndex];
+		const ndStartEnd startEnd(hashCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndGridHash cell(m_hashGridMapScratchBuffer[i]);
+			if ((i == 0) || (cell.m_gridCellHash != m_hashGridMapScratchBuffer[i - 1].m_gridCellHash))
+			{
+				m_hashGridMap[index] = cell;
+				index++;
+			}
+		}
+	});
+
+	ParallelExecute(CountUniqueHashes);
 	ndInt32 gridCount = 0;
-	for (ndInt32 i = 1; i < m_hashGridMapScratchBuffer.GetCount(); ++i)
+	for (ndInt32 i = 0; i < GetThreadCount(); ++i)
 	{
-		const ndGridHash cell(m_hashGridMapScratchBuffer[i]);
-		gridCount += (cell.m_gridFullHash != m_hashGridMapScratchBuffer[i - 1].m_gridFullHash);
-		m_hashGridMapScratchBuffer[gridCount] = cell;
+		const ndInt32 count = uniqueStart[i];
+		uniqueStart[i] = gridCount;
+		gridCount += count;
 	}
-	gridCount++;
-	m_hashGridMapScratchBuffer.SetCount(gridCount);
+	m_hashGridMap.SetCount(gridCount);
+	ParallelExecute(CopyUniqueHashes);
+	m_hashGridMap.Swap(m_hashGridMapScratchBuffer);
 }
 	
 void ndIsoSurface::ndImplementation::GenerateLowResIsoSurface()
 {
 	D_TRACKTIME();
-	ndInt32 end = 0;
 	const ndInt32 gridCount = m_hashGridMap.GetCount();
 	m_hashGridMap.PushBack(ndGridHash(0xffff, 0xffff, 0xffff));
 
-	m_triangles.SetCount(0);
-	for (ndInt32 i = 0; i < gridCount; i = end)
+	// a cell is a run of entries with the same hash, each thread processes
+	// the cells that start in its range, even when they end past the range.
+	auto GetFirstCell = [this, gridCount](ndInt32 start)
 	{
-		end = i + 1;
-		ndInt32 start = i;
-		const ndGridHash startGrid(m_hashGridMap[start], 0);
-		while (startGrid.m_gridCellHash == ndGridHash(m_hashGridMap[end], 0).m_gridCellHash)
+		while ((start > 0) && (start < gridCount) && (m_hashGridMap[start].m_gridCellHash == m_hashGridMap[start - 1].m_gridCellHash))
 		{
-			end++;
+			start++;
 		}
-		ndInt32 count = end - start;
-		if (count < 8)
+		return start;
+	};
+
+	ndInt32 vertexStart[D_MAX_THREADS_COUNT + 1];
+	auto CountVertices = ndMakeObject::ndFunction([this, gridCount, &GetFirstCell, &vertexStart](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CountVertices);
+		ndInt32 vertexCount = 0;
+		const ndStartEnd startEnd(gridCount, threadIndex, threadCount);
+		for (ndInt32 i = GetFirstCell(startEnd.m_start); i < startEnd.m_end;)
 		{
-			ndIsoCell cell;
-			ndVector* const isoValue = &cell.m_isoValues[0];
-			ndVector origin(ndFloat32(startGrid.m_x + 1), ndFloat32(startGrid.m_y + 1), ndFloat32(startGrid.m_z + 1), ndFloat32(0.0f));
-			for (ndInt32 j = 0; j < 8; ++j)
+			const ndInt32 end = GetCellEnd(i);
+			if ((end - i) < 8)
 			{
-				isoValue[j] = origin + m_gridCorners[j];
+				const ndInt32 tableIndex = GetCellTableIndex(i, end);
+				vertexCount += (m_facesScan[tableIndex + 1] - m_facesScan[tableIndex]) * 3;
 			}
-			for (ndInt32 j = 0; j < count; ++j)
+			i = end;
+		}
+		vertexStart[threadIndex] = vertexCount;
+	});
+
+	auto GenerateTriangles = ndMakeObject::ndFunction([this, gridCount, &GetFirstCell, &vertexStart](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(GenerateTriangles);
+		ndInt32 index = vertexStart[threadIndex];
+		const ndStartEnd startEnd(gridCount, threadIndex, threadCount);
+		for (ndInt32 i = GetFirstCell(startEnd.m_start); i < startEnd.m_end;)
+		{
+			const ndInt32 end = GetCellEnd(i);
+			if ((end - i) < 8)
 			{
-				ndInt32 index = m_hashGridMap[start + j].m_cellType;
-				isoValue[index].m_w = ndFloat32(1.0f);
+				const ndInt32 tableIndex = GetCellTableIndex(i, end);
+				ProcessLowResCell(m_hashGridMap[i], tableIndex, index);
+				index += (m_facesScan[tableIndex + 1] - m_facesScan[tableIndex]) * 3;
 			}
-			ProcessLowResCell(cell);
+			i = end;
 		}
+	});
+
+	ParallelExecute(CountVertices);
+	ndInt32 vertexCount = 0;
+	for (ndInt32 i = 0; i < GetThreadCount(); ++i)
+	{
+		const ndInt32 count = vertexStart[i];
+		vertexStart[i] = vertexCount;
+		vertexCount += count;
 	}
+	m_triangles.SetCount(vertexCount);
+	ParallelExecute(GenerateTriangles);
 }
 
 void ndIsoSurface::ndImplementation::GenerateHighResIsoSurface(ndCalculateIsoValue* const computeIsoValue)
@@ -3200,46 +3359,52 @@ ndInt32 ndIsoSurface::ndImplementation::GenerateLowResIndexList(
 		ndVector m_base;
 	};
 
-	const ndVector invGrid(ndFloat32(1.0f) / me->m_gridSize);
 	const ndArray<ndVector>& points = me->m_points;
 	m_triangles.SetCount(points.GetCount());
-	for (ndInt32 i = 0; i < points.GetCount(); ++i)
+	auto ScalePoints = ndMakeObject::ndFunction([this, me, &points](ndInt32 threadIndex, ndInt32 threadCount)
 	{
-		m_triangles[i] = points[i] * invGrid;
-		m_triangles[i].m_w = ndFloat32(i);
-	}
+		D_TRACKTIME_NAMED(ScalePoints);
+		const ndVector invGrid(ndFloat32(1.0f) / me->m_gridSize);
+		const ndStartEnd startEnd(points.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			m_triangles[i] = points[i] * invGrid;
+			m_triangles[i].m_w = ndFloat32(i);
+		}
+	});
+	ParallelExecute(ScalePoints);
 
 	const ndInt32 xDimSize = me->m_volumeSizeX * D_LOW_RES_FRACTION;
-	ndCountingSort<ndVector, ndKey_lowX, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+	CountingSort<ndVector, ndKey_lowX>(m_triangles, m_trianglesScratchBuffer);
 	if (xDimSize >= 256)
 	{
-		ndCountingSort<ndVector, ndKey_midleX, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+		CountingSort<ndVector, ndKey_midleX>(m_triangles, m_trianglesScratchBuffer);
 	}
 	if (xDimSize >= 256 * 256)
 	{
-		ndCountingSort<ndVector, ndKey_highX, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+		CountingSort<ndVector, ndKey_highX>(m_triangles, m_trianglesScratchBuffer);
 	} 
 	
 	const ndInt32 yDimSize = me->m_volumeSizeY * D_LOW_RES_FRACTION;
-	ndCountingSort<ndVector, ndKey_lowY, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+	CountingSort<ndVector, ndKey_lowY>(m_triangles, m_trianglesScratchBuffer);
 	if (yDimSize >= 256)
 	{
-		ndCountingSort<ndVector, ndKey_midleY, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+		CountingSort<ndVector, ndKey_midleY>(m_triangles, m_trianglesScratchBuffer);
 	}
 	if (yDimSize >= 256 * 256)
 	{
-		ndCountingSort<ndVector, ndKey_highY, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+		CountingSort<ndVector, ndKey_highY>(m_triangles, m_trianglesScratchBuffer);
 	}
 	
 	const ndInt32 zDimSize = me->m_volumeSizeZ * D_LOW_RES_FRACTION;
-	ndCountingSort<ndVector, ndKey_lowZ, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+	CountingSort<ndVector, ndKey_lowZ>(m_triangles, m_trianglesScratchBuffer);
 	if (zDimSize >= 256)
 	{
-		ndCountingSort<ndVector, ndKey_midleZ, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+		CountingSort<ndVector, ndKey_midleZ>(m_triangles, m_trianglesScratchBuffer);
 	}
 	if (zDimSize >= 256 * 256)
 	{
-		ndCountingSort<ndVector, ndKey_highZ, 8>(m_triangles, m_trianglesScratchBuffer, nullptr, nullptr);
+		CountingSort<ndVector, ndKey_highZ>(m_triangles, m_trianglesScratchBuffer);
 	}
 	
 	const ndInt32 count = m_triangles.GetCount();
@@ -3292,14 +3457,20 @@ ndInt32 ndIsoSurface::ndImplementation::GenerateLowResIndexList(
 	}
 
 	// Normalize normals.
-	for (ndInt32 i = 0; i < vertexCount; ++i)
+	auto NormalizeNormals = ndMakeObject::ndFunction([this, vertexCount, strideInFloats, normals](ndInt32 threadIndex, ndInt32 threadCount)
 	{
-		ndVector normal(m_triangles[i] * m_triangles[i].InvMagSqrt());
-		ndInt32 j = strideInFloats * i;
-		normals[j + 0] = ndReal (normal.m_x);
-		normals[j + 1] = ndReal (normal.m_y);
-		normals[j + 2] = ndReal (normal.m_z);
-	}
+		D_TRACKTIME_NAMED(NormalizeNormals);
+		const ndStartEnd startEnd(vertexCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndVector normal(m_triangles[i] * m_triangles[i].InvMagSqrt());
+			ndInt32 j = strideInFloats * i;
+			normals[j + 0] = ndReal (normal.m_x);
+			normals[j + 1] = ndReal (normal.m_y);
+			normals[j + 2] = ndReal (normal.m_z);
+		}
+	});
+	ParallelExecute(NormalizeNormals);
 
 	return vertexCount;
 }
@@ -3310,10 +3481,17 @@ void ndIsoSurface::ndImplementation::MakeTriangleList(ndIsoSurface* const me)
 	ndArray<ndVector>& points = me->m_points;
 	points.SetCount(m_triangles.GetCount());
 
-	for (ndInt32 i = 0; i < m_triangles.GetCount(); ++i)
+	auto MakeTriangleList = ndMakeObject::ndFunction([this, &points](ndInt32 threadIndex, ndInt32 threadCount)
 	{
-		points[i] = m_triangles[i] * m_gridSize;
-	}
+		D_TRACKTIME_NAMED(MakeTriangleList);
+		const ndVector gridSize(m_gridSize);
+		const ndStartEnd startEnd(points.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			points[i] = m_triangles[i] * gridSize;
+		}
+	});
+	ParallelExecute(MakeTriangleList);
 }
 
 //void ndIsoSurface::ndImplementation::GenerateHighResIndexList(ndIsoSurface* const me)
@@ -3326,21 +3504,27 @@ void ndIsoSurface::ndImplementation::GenerateHighResIndexList(ndIsoSurface* cons
 void ndIsoSurface::ndImplementation::CreateGrids()
 {
 	D_TRACKTIME();
-	const ndGridHashSteps steps;
 	m_hashGridMap.SetCount(m_hashGridMapScratchBuffer.GetCount() * 8);
-	for (ndInt32 i = 0; i < m_hashGridMapScratchBuffer.GetCount(); ++i)
+	auto CreateGrids = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
 	{
-		const ndGridHash hashKey(m_hashGridMapScratchBuffer[i]);
-		for (ndInt32 j = 0; j < 8; ++j)
+		D_TRACKTIME_NAMED(CreateGrids);
+		const ndGridHashSteps steps;
+		const ndStartEnd startEnd(m_hashGridMapScratchBuffer.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 		{
-			ndGridHash cell(hashKey);
-			cell.m_x += steps.m_steps[j].m_x;
-			cell.m_y += steps.m_steps[j].m_y;
-			cell.m_z += steps.m_steps[j].m_z;
-			cell.m_cellType = steps.m_cellType[j];
-			m_hashGridMap[i * 8 + j] = cell;
+			const ndGridHash hashKey(m_hashGridMapScratchBuffer[i]);
+			for (ndInt32 j = 0; j < 8; ++j)
+			{
+				ndGridHash cell(hashKey);
+				cell.m_x += steps.m_steps[j].m_x;
+				cell.m_y += steps.m_steps[j].m_y;
+				cell.m_z += steps.m_steps[j].m_z;
+				cell.m_cellType = steps.m_cellType[j];
+				m_hashGridMap[i * 8 + j] = cell;
+			}
 		}
-	}
+	});
+	ParallelExecute(CreateGrids);
 }
 
 void ndIsoSurface::ndImplementation::ClearBuffers()
@@ -3403,9 +3587,19 @@ ndIsoSurface::~ndIsoSurface()
 }
 
 void ndIsoSurface::GenerateMesh(const ndArray<ndVector>& pointCloud, ndFloat32 gridSize, ndCalculateIsoValue* const computeIsoValue)
+{
+	GenerateMesh(nullptr, pointCloud, gridSize, computeIsoValue);
+}
+
+void ndIsoSurface::GenerateMesh(ndThreadPool* const threadPool, const ndArray<ndVector>& pointCloud, ndFloat32 gridSize, ndCalculateIsoValue* const computeIsoValue)
 {
 	if (pointCloud.GetCount())
 	{
+		if (threadPool)
+		{
+			threadPool->Begin();
+		}
+		m_implementation->m_threadPool = threadPool;
 		if (!computeIsoValue)
 		{
 			m_isLowRes = true;
@@ -3417,6 +3611,11 @@ void ndIsoSurface::GenerateMesh(const ndArray<ndVector>& pointCloud, ndFloat32 g
 			m_isLowRes = false;
 			m_implementation->BuildHighResolutionMesh(this, pointCloud, gridSize, computeIsoValue);
 		}
+		m_implementation->m_threadPool = nullptr;
+		if (threadPool)
+		{
+			threadPool->End();
+		}
 		m_gridSize = gridSize;
 		m_origin = m_implementation->GetOrigin();
 		m_volumeSizeX = m_implementation->m_volumeSizeX;
@@ -3426,15 +3625,30 @@ void ndIsoSurface::GenerateMesh(const ndArray<ndVector>& pointCloud, ndFloat32 g
 }
 
 ndInt32 ndIsoSurface::GenerateListIndexList(ndInt32* const indexList, ndInt32 strideInFloats, ndReal* const posit, ndReal* const normals) const
+{
+	return GenerateListIndexList(nullptr, indexList, strideInFloats, posit, normals);
+}
+
+ndInt32 ndIsoSurface::GenerateListIndexList(ndThreadPool* const threadPool, ndInt32* const indexList, ndInt32 strideInFloats, ndReal* const posit, ndReal* const normals) const
 {
 	ndInt32 vertexCount = 0;
 	if (m_isLowRes)
 	{
+		if (threadPool)
+		{
+			threadPool->Begin();
+		}
+		m_implementation->m_threadPool = threadPool;
 		vertexCount = m_implementation->GenerateLowResIndexList(this, indexList, strideInFloats, posit, normals);
+		m_implementation->m_threadPool = nullptr;
+		if (threadPool)
+		{
+			threadPool->End();
+		}
 	}
 	else
 	{
 		ndAssert(0);
 	}
 	return vertexCount;
-}
\ No newline at end of file
+}
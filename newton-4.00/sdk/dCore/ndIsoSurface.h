@@ -27,6 +27,8 @@
 #include "ndArray.h"
 #include "ndTree.h"
 
+class ndThreadPool;
+
 class ndIsoSurface: public ndClassAlloc
 {
 	public:
@@ -55,6 +57,14 @@ class ndIsoSurface: public ndClassAlloc
 	D_CORE_API void GenerateMesh(const ndArray<ndVector>& pointCloud, ndFloat32 gridSize, ndCalculateIsoValue* const computeIsoValue = nullptr);
 	D_CORE_API ndInt32 GenerateListIndexList(ndInt32 * const indexList, ndInt32 strideInFloat32, ndReal* const posit, ndReal* const normals) const;
 
+	/// Same as GenerateMesh, but the passes are split across the threads of the pool.
+	/// \brief threadPool must not be executing an update, the surface calls 
+	/// Begin and End on it. The mesh is the same as the single thread one.
+	D_CORE_API void GenerateMesh(ndThreadPool* const threadPool, const ndArray<ndVector>& pointCloud, ndFloat32 gridSize, ndCalculateIsoValue* const computeIsoValue = nullptr);
+
+	/// Same as GenerateListIndexList, but the sorts are split across the threads of the pool.
+	D_CORE_API ndInt32 GenerateListIndexList(ndThreadPool* const threadPool, ndInt32 * const indexList, ndInt32 strideInFloat32, ndReal* const posit, ndReal* const normals) const;
+
 	private:
 	ndVector m_origin;
 	ndArray<ndVector> m_points;
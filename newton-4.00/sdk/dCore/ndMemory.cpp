@@ -22,6 +22,8 @@
 #include "ndCoreStdafx.h"
 #include "ndTypes.h"
 #include "ndMemory.h"
+#include "ndClassAlloc.h"
+#include "ndContainersAlloc.h"
 
 ndAtomic<ndUnsigned64> ndMemory::m_memoryUsed(0);
 
@@ -79,6 +81,11 @@ ndUnsigned64 ndMemory::GetMemoryUsed()
 	return m_memoryUsed.load();
 }
 
+void ndMemory::GetFreeListStatistics(ndFreeListStatistics& statistics)
+{
+	ndFreeListAlloc::GetStatistics(statistics);
+}
+
 void ndMemory::SetMemoryAllocators(ndMemAllocCallback alloc, ndMemFreeCallback free)
 {
 	m_allocMemory = alloc;
@@ -28,6 +28,19 @@
 typedef void* (*ndMemAllocCallback) (size_t size);
 typedef void (*ndMemFreeCallback) (void* const ptr);
 
+/// Counters of the free list allocator used by the engine containers.
+class ndFreeListStatistics
+{
+	public:
+	ndUnsigned64 m_threadCaches;		// live thread caches
+	ndUnsigned64 m_cacheHits;			// allocations served by the thread caches
+	ndUnsigned64 m_sharedHits;			// thread cache refills from the shared lists
+	ndUnsigned64 m_systemAllocations;	// allocations that reached the system allocator
+	ndUnsigned64 m_sharedReturns;		// thread cache overflows returned to the shared lists
+	ndUnsigned64 m_sharedBlocks;		// free blocks in the shared lists
+	ndUnsigned64 m_cachedBlocks;		// free blocks in the thread caches
+};
+
 class ndMemory
 {
 	public:
@@ -48,6 +61,11 @@ class ndMemory
 	/// Return the total memory allocated by the newton engine and tools.
 	D_CORE_API static ndUnsigned64 GetMemoryUsed();
 
+	/// Read the counters of the free list allocator.
+	/// \brief the counters are accumulated since the start of the 
+	/// application, including the ones of threads that already exited.
+	D_CORE_API static void GetFreeListStatistics(ndFreeListStatistics& statistics);
+
 	/// Install low level system memory allocation functions.
 	/// \param ndMemAllocCallback alloc: is a function pointer callback to allocate a memory chunk.
 	/// \param ndMemFreeCallback free: is a function pointer callback to free a memory chunk.
@@ -27,9 +27,12 @@
 #include "ndCoreStdafx.h"
 #include "ndTypes.h"
 #include "ndList.h"
+#include "ndCRC.h"
 #include "ndTree.h"
 #include "ndStack.h"
+#include "ndProfiler.h"
 #include "ndPolyhedra.h"
+#include "ndThreadPool.h"
 #include "ndPolygonSoupBuilder.h"
 
 #define ND_POINTS_RUN (512 * 1024)
@@ -41,6 +44,61 @@ class ndPolygonSoupBuilder::dgFaceInfo
 	ndInt32 indexStart;
 };
 
+class ndPolygonSoupBuilder::dgSector
+{
+	public:
+	ndUnsigned64 m_hash;
+	ndPolygonSoupBuilder* m_faces;
+	ndInt32 m_faceId;
+	ndInt32 m_faceStart;
+	ndInt32 m_faceCount;
+};
+
+class ndPolygonSoupBuilder::dgCachedSector
+{
+	public:
+	ndPolygonSoupBuilder* m_faces;
+	bool m_used;
+};
+
+// optimized faces of each sector, indexed by the hash of the sector input faces.
+class ndPolygonSoupBuilder::dgSectorCache: public ndTree<dgCachedSector, ndUnsigned64>
+{
+	public:
+	dgSectorCache()
+		:ndTree<dgCachedSector, ndUnsigned64>()
+	{
+	}
+
+	~dgSectorCache()
+	{
+		Iterator iter(*this);
+		for (iter.Begin(); iter; iter++)
+		{
+			delete iter.GetNode()->GetInfo().m_faces;
+		}
+	}
+
+	void RemoveUnused()
+	{
+		Iterator iter(*this);
+		for (iter.Begin(); iter; )
+		{
+			ndNode* const node = iter.GetNode();
+			iter++;
+			if (node->GetInfo().m_used)
+			{
+				node->GetInfo().m_used = false;
+			}
+			else
+			{
+				delete node->GetInfo().m_faces;
+				Remove(node);
+			}
+		}
+	}
+};
+
 class ndPolygonSoupBuilder::dgFaceBucket: public ndList<dgFaceInfo>
 {
 	public: 
@@ -133,6 +191,7 @@ ndPolygonSoupBuilder::ndPolygonSoupBuilder ()
 	,m_normalIndex()
 	,m_vertexPoints()
 	,m_normalPoints()
+	,m_sectorCache(nullptr)
 {
 	m_run = ND_POINTS_RUN;
 }
@@ -143,6 +202,7 @@ ndPolygonSoupBuilder::ndPolygonSoupBuilder (const ndPolygonSoupBuilder& source)
 	,m_normalIndex()
 	,m_vertexPoints(source.m_vertexPoints.GetCount())
 	,m_normalPoints()
+	,m_sectorCache(nullptr)
 {
 	m_run = ND_POINTS_RUN;
 	m_faceVertexCount.SetCount(source.m_faceVertexCount.GetCount());
@@ -167,6 +227,7 @@ ndPolygonSoupBuilder::ndPolygonSoupBuilder (const ndPolygonSoupBuilder& source)
 
 ndPolygonSoupBuilder::~ndPolygonSoupBuilder ()
 {
+	SetIncremental(false);
 }
 
 void ndPolygonSoupBuilder::Begin()
@@ -579,52 +640,86 @@ void ndPolygonSoupBuilder::OptimizeByIndividualFaces()
 
 void ndPolygonSoupBuilder::End(bool optimize)
 {
+	End(optimize, nullptr);
+}
+
+void ndPolygonSoupBuilder::End(bool optimize, ndThreadPool* const threadPool)
+{
+	if (threadPool)
+	{
+		threadPool->Begin();
+	}
+
 	if (optimize) 
 	{
 		ndPolygonSoupBuilder copy (*this);
 		dgFaceMap faceMap (copy);
 
-		Begin();
+		ndArray<dgFaceInfo> faceArray;
+		ndArray<dgSector> sectors;
 		dgFaceMap::Iterator iter (faceMap);
 		for (iter.Begin(); iter; iter ++) 
 		{
 			const dgFaceBucket& bucket = iter.GetNode()->GetInfo();
-			Optimize(iter.GetNode()->GetKey(), bucket, copy);
+			CalculateSectors(iter.GetNode()->GetKey(), bucket, copy, faceArray, sectors);
 		}
+
+		Begin();
+		OptimizeSectors(copy, faceArray, sectors, threadPool);
 	}
 	Finalize();
 
 	// build the normal array and adjacency array
-	ndInt32 indexCount = 0;
 	const ndInt32 faceCount = m_faceVertexCount.GetCount();
 	if (faceCount)
 	{
+		ndArray<ndInt32> faceStart(faceCount);
+		faceStart.SetCount(faceCount);
+		ndInt32 indexCount = 0;
+		for (ndInt32 i = 0; i < faceCount; ++i)
+		{
+			faceStart[i] = indexCount;
+			indexCount += m_faceVertexCount[i];
+		}
+
 		// calculate all face the normals
 		m_normalPoints.Resize(faceCount);
 		m_normalPoints.SetCount(faceCount);
-		for (ndInt32 i = 0; i < faceCount; ++i)
+		auto CalculateNormals = ndMakeObject::ndFunction([this, &faceStart](ndInt32 threadIndex, ndInt32 threadCount)
 		{
-			ndInt32 faceIndexCount = m_faceVertexCount[i];
-
-			const ndInt32* const ptr = &m_vertexIndex[indexCount];
-			ndBigVector v0(&m_vertexPoints[ptr[0]].m_x);
-			ndBigVector v1(&m_vertexPoints[ptr[1]].m_x);
-			ndBigVector e0(v1 - v0);
-			ndBigVector normal0(ndBigVector::m_zero);
-			for (ndInt32 j = 2; j < faceIndexCount - 1; ++j)
+			D_TRACKTIME_NAMED(CalculateNormals);
+			const ndStartEnd startEnd(m_faceVertexCount.GetCount(), threadIndex, threadCount);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 			{
-				ndBigVector v2(&m_vertexPoints[ptr[j]].m_x);
-				ndBigVector e1(v2 - v0);
-				normal0 += e0.CrossProduct(e1);
-				e0 = e1;
-			}
-			ndBigVector normal(normal0.Normalize());
+				ndInt32 faceIndexCount = m_faceVertexCount[i];
+
+				const ndInt32* const ptr = &m_vertexIndex[faceStart[i]];
+				ndBigVector v0(&m_vertexPoints[ptr[0]].m_x);
+				ndBigVector v1(&m_vertexPoints[ptr[1]].m_x);
+				ndBigVector e0(v1 - v0);
+				ndBigVector normal0(ndBigVector::m_zero);
+				for (ndInt32 j = 2; j < faceIndexCount - 1; ++j)
+				{
+					ndBigVector v2(&m_vertexPoints[ptr[j]].m_x);
+					ndBigVector e1(v2 - v0);
+					normal0 += e0.CrossProduct(e1);
+					e0 = e1;
+				}
+				ndBigVector normal(normal0.Normalize());
 
-			m_normalPoints[i].m_x = normal.m_x;
-			m_normalPoints[i].m_y = normal.m_y;
-			m_normalPoints[i].m_z = normal.m_z;
-			m_normalPoints[i].m_w = ndFloat32(0.0f);
-			indexCount += faceIndexCount;
+				m_normalPoints[i].m_x = normal.m_x;
+				m_normalPoints[i].m_y = normal.m_y;
+				m_normalPoints[i].m_z = normal.m_z;
+				m_normalPoints[i].m_w = ndFloat32(0.0f);
+			}
+		});
+		if (threadPool)
+		{
+			threadPool->ParallelExecute(CalculateNormals);
+		}
+		else
+		{
+			CalculateNormals(0, 1);
 		}
 
 		m_normalIndex.Resize(faceCount);;
@@ -633,192 +728,277 @@ void ndPolygonSoupBuilder::End(bool optimize)
 		ndAssert(normalCount <= m_normalPoints.GetCount());
 		m_normalPoints.SetCount(normalCount);
 	}
+
+	if (threadPool)
+	{
+		threadPool->End();
+	}
+}
+
+void ndPolygonSoupBuilder::SetIncremental(bool state)
+{
+	if (state && !m_sectorCache)
+	{
+		m_sectorCache = new dgSectorCache();
+	}
+	else if (!state && m_sectorCache)
+	{
+		delete m_sectorCache;
+		m_sectorCache = nullptr;
+	}
 }
 
-void ndPolygonSoupBuilder::Optimize(ndInt32 faceId, const dgFaceBucket& faceBucket, const ndPolygonSoupBuilder& source)
+void ndPolygonSoupBuilder::CalculateSectors(ndInt32 faceId, const dgFaceBucket& faceBucket, const ndPolygonSoupBuilder& source, ndArray<dgFaceInfo>& faceArray, ndArray<dgSector>& sectors) const
 {
 	#define DG_MESH_PARTITION_SIZE (1024 * 4)
 
 	const ndInt32* const indexArray = &source.m_vertexIndex[0];
 	const ndBigVector* const points = &source.m_vertexPoints[0];
 
-	ndVector face[256];
-	ndInt32 faceIndex[256];
-	if (faceBucket.GetCount() >= DG_MESH_PARTITION_SIZE) 
+	const ndInt32 base = faceArray.GetCount();
+	for (dgFaceBucket::ndNode* node = faceBucket.GetFirst(); node; node = node->GetNext()) 
 	{
-		ndStack<dgFaceBucket::ndNode*> array(faceBucket.GetCount());
-		ndInt32 count = 0;
-		for (dgFaceBucket::ndNode* node = faceBucket.GetFirst(); node; node = node->GetNext()) 
-		{
-			array[count] = node;
-			count ++;
-		}
+		faceArray.PushBack(node->GetInfo());
+	}
+	dgFaceInfo* const array = &faceArray[base];
+	const ndInt32 count = faceArray.GetCount() - base;
 
-		ndInt32 stack = 1;
-		ndInt32 segments[32][2];
-			
-		segments[0][0] = 0;
-		segments[0][1] = count;
-	
-		while (stack) 
-		{
-			stack --;
-			ndInt32 faceStart = segments[stack][0];
-			ndInt32 faceCount = segments[stack][1];
+	ndInt32 stack = 1;
+	ndInt32 segments[32][2];
+	segments[0][0] = 0;
+	segments[0][1] = count;
+
+	// big buckets are split in sectors of nearby faces, 
+	// so that each sector can be optimized independently.
+	while (stack) 
+	{
+		stack --;
+		ndInt32 faceStart = segments[stack][0];
+		ndInt32 faceCount = segments[stack][1];
 
-			if (faceCount <= DG_MESH_PARTITION_SIZE) 
+		if (faceCount <= DG_MESH_PARTITION_SIZE) 
+		{
+			dgSector sector;
+			sector.m_faceId = faceId;
+			sector.m_faceStart = base + faceStart;
+			sector.m_faceCount = faceCount;
+			sector.m_hash = dCRC64(&faceId, sizeof(faceId), ndUnsigned64(faceCount));
+			for (ndInt32 i = 0; i < faceCount; ++i) 
 			{
-				ndPolygonSoupBuilder tmpBuilder;
-				for (ndInt32 i = 0; i < faceCount; ++i) 
+				const dgFaceInfo& faceInfo = array[faceStart + i];
+				ndInt32 count1 = faceInfo.indexCount - 1;
+				ndInt32 start1 = faceInfo.indexStart;
+				sector.m_hash = dCRC64(&count1, sizeof(count1), sector.m_hash);
+				for (ndInt32 j = 0; j < count1; ++j) 
 				{
-					const dgFaceInfo& faceInfo = array[faceStart + i]->GetInfo();
-
-					ndInt32 count1 = faceInfo.indexCount - 1;
-					ndInt32 start1 = faceInfo.indexStart;
-					ndAssert (faceId == indexArray[start1 + count1]);
-					for (ndInt32 j = 0; j < count1; ++j) 
-					{
-						ndInt32 index = indexArray[start1 + j];
-						face[j] = points[index];
-						faceIndex[j] = j;
-					}
-					tmpBuilder.AddFaceIndirect(&face[0].m_x, sizeof(ndVector), faceId, faceIndex, count1);
+					sector.m_hash = dCRC64(&points[indexArray[start1 + j]], sizeof(ndBigVector), sector.m_hash);
 				}
-				tmpBuilder.FinalizeAndOptimize (faceId);
-
-				ndInt32 faceIndexNumber = 0;
-				for (ndInt32 i = 0; i < tmpBuilder.m_faceVertexCount.GetCount(); ++i)
+			}
+			sector.m_faces = nullptr;
+			sectors.PushBack(sector);
+		} 
+		else 
+		{
+			ndBigVector median (ndBigVector::m_zero);
+			ndBigVector varian (ndBigVector::m_zero);
+			for (ndInt32 i = 0; i < faceCount; ++i) 
+			{
+				const dgFaceInfo& faceInfo = array[faceStart + i];
+				ndInt32 count1 = faceInfo.indexCount - 1;
+				ndInt32 start1 = faceInfo.indexStart;
+				ndBigVector p0 (ndFloat32 ( 1.0e10f), ndFloat32 ( 1.0e10f), ndFloat32 ( 1.0e10f), ndFloat32 (0.0f));
+				ndBigVector p1 (ndFloat32 (-1.0e10f), ndFloat32 (-1.0e10f), ndFloat32 (-1.0e10f), ndFloat32 (0.0f));
+				for (ndInt32 j = 0; j < count1; ++j) 
 				{
-					ndInt32 indexCount = tmpBuilder.m_faceVertexCount[i] - 1;
-					for (ndInt32 j = 0; j < indexCount; ++j) 
-					{
-						ndInt32 index = tmpBuilder.m_vertexIndex[faceIndexNumber + j];
-						face[j] = tmpBuilder.m_vertexPoints[index];
-						faceIndex[j] = j;
-					}
-					AddFaceIndirect(&face[0].m_x, sizeof(ndVector), faceId, faceIndex, indexCount);
-					faceIndexNumber += (indexCount + 1); 
+					ndInt32 index = indexArray[start1 + j];
+					const ndBigVector& p = points[index];
+					ndAssert(p.m_w == ndFloat32(0.0f));
+					p0 = p0.GetMin(p);
+					p1 = p1.GetMax(p);
 				}
-			} 
-			else 
+				ndBigVector p ((p0 + p1).Scale (0.5f));
+				median += p;
+				varian += p * p;
+			}
+
+			varian = varian.Scale (ndFloat32 (faceCount)) - median * median;
+
+			ndInt32 axis = 0;
+			ndFloat32 maxVarian = ndFloat32 (-1.0e10f);
+			for (ndInt32 i = 0; i < 3; ++i) 
 			{
-				ndBigVector median (ndBigVector::m_zero);
-				ndBigVector varian (ndBigVector::m_zero);
-				for (ndInt32 i = 0; i < faceCount; ++i) 
+				if (varian[i] > maxVarian) 
 				{
-					const dgFaceInfo& faceInfo = array[faceStart + i]->GetInfo();
-					ndInt32 count1 = faceInfo.indexCount - 1;
-					ndInt32 start1 = faceInfo.indexStart;
-					ndBigVector p0 (ndFloat32 ( 1.0e10f), ndFloat32 ( 1.0e10f), ndFloat32 ( 1.0e10f), ndFloat32 (0.0f));
-					ndBigVector p1 (ndFloat32 (-1.0e10f), ndFloat32 (-1.0e10f), ndFloat32 (-1.0e10f), ndFloat32 (0.0f));
-					for (ndInt32 j = 0; j < count1; ++j) 
-					{
-						ndInt32 index = indexArray[start1 + j];
-						const ndBigVector& p = points[index];
-						ndAssert(p.m_w == ndFloat32(0.0f));
-						p0 = p0.GetMin(p);
-						p1 = p1.GetMax(p);
-					}
-					ndBigVector p ((p0 + p1).Scale (0.5f));
-					median += p;
-					varian += p * p;
+					axis = i;
+					maxVarian = ndFloat32 (varian[i]);
 				}
+			}
+			ndBigVector center = median.Scale (ndFloat32 (1.0f) / ndFloat32 (faceCount));
+			ndFloat64 axisVal = center[axis];
 
-				varian = varian.Scale (ndFloat32 (faceCount)) - median * median;
+			ndInt32 leftCount = 0;
+			ndInt32 lastFace = faceCount;
 
-				ndInt32 axis = 0;
-				ndFloat32 maxVarian = ndFloat32 (-1.0e10f);
-				for (ndInt32 i = 0; i < 3; ++i) 
+			for (ndInt32 i = 0; i < lastFace; ++i) 
+			{
+				ndInt32 side = 0;
+				const dgFaceInfo& faceInfo = array[faceStart + i];
+
+				ndInt32 start1 = faceInfo.indexStart;
+				ndInt32 count1 = faceInfo.indexCount - 1;
+				for (ndInt32 j = 0; j < count1; ++j) 
 				{
-					if (varian[i] > maxVarian) 
+					ndInt32 index = indexArray[start1 + j];
+					const ndBigVector& p = points[index];
+					if (p[axis] > axisVal) 
 					{
-						axis = i;
-						maxVarian = ndFloat32 (varian[i]);
+						side = 1;
+						break;
 					}
 				}
-				ndBigVector center = median.Scale (ndFloat32 (1.0f) / ndFloat32 (faceCount));
-				ndFloat64 axisVal = center[axis];
 
-				ndInt32 leftCount = 0;
-				ndInt32 lastFace = faceCount;
-
-				for (ndInt32 i = 0; i < lastFace; ++i) 
+				if (side) 
+				{
+					ndSwap (array[faceStart + i], array[faceStart + lastFace - 1]);
+					lastFace --;
+					i --;
+				} 
+				else 
 				{
-					ndInt32 side = 0;
-					const dgFaceInfo& faceInfo = array[faceStart + i]->GetInfo();
+					leftCount ++;
+				}
+			}
+			ndAssert (leftCount);
+			ndAssert (leftCount < faceCount);
 
-					ndInt32 start1 = faceInfo.indexStart;
-					ndInt32 count1 = faceInfo.indexCount - 1;
-					for (ndInt32 j = 0; j < count1; ++j) 
-					{
-						ndInt32 index = indexArray[start1 + j];
-						const ndBigVector& p = points[index];
-						if (p[axis] > axisVal) 
-						{
-							side = 1;
-							break;
-						}
-					}
+			segments[stack][0] = faceStart;
+			segments[stack][1] = leftCount;
+			stack ++;
 
-					if (side) 
-					{
-						ndSwap (array[faceStart + i], array[faceStart + lastFace - 1]);
-						lastFace --;
-						i --;
-					} 
-					else 
-					{
-						leftCount ++;
-					}
-				}
-				ndAssert (leftCount);
-				ndAssert (leftCount < faceCount);
+			segments[stack][0] = faceStart + leftCount;
+			segments[stack][1] = faceCount - leftCount;
+			stack ++;
+		}
+	}
+}
 
-				segments[stack][0] = faceStart;
-				segments[stack][1] = leftCount;
-				stack ++;
+void ndPolygonSoupBuilder::OptimizeSector(const dgSector& sector, const dgFaceInfo* const faceArray, const ndPolygonSoupBuilder& source, ndPolygonSoupBuilder& output)
+{
+	const ndInt32* const indexArray = &source.m_vertexIndex[0];
+	const ndBigVector* const points = &source.m_vertexPoints[0];
 
-				segments[stack][0] = faceStart + leftCount;
-				segments[stack][1] = faceCount - leftCount;
-				stack ++;
-			}
+	ndVector face[256];
+	ndInt32 faceIndex[256];
+	for (ndInt32 i = 0; i < sector.m_faceCount; ++i) 
+	{
+		const dgFaceInfo& faceInfo = faceArray[sector.m_faceStart + i];
+
+		ndInt32 count = faceInfo.indexCount - 1;
+		ndInt32 start = faceInfo.indexStart;
+		ndAssert (sector.m_faceId == indexArray[start + count]);
+		for (ndInt32 j = 0; j < count; ++j) 
+		{
+			ndInt32 index = indexArray[start + j];
+			face[j] = points[index];
+			faceIndex[j] = j;
 		}
-	} 
-	else 
+		output.AddFaceIndirect(&face[0].m_x, sizeof(ndVector), sector.m_faceId, faceIndex, count);
+	}
+	output.FinalizeAndOptimize (sector.m_faceId);
+}
+
+void ndPolygonSoupBuilder::OptimizeSectors(const ndPolygonSoupBuilder& source, const ndArray<dgFaceInfo>& faceArray, ndArray<dgSector>& sectors, ndThreadPool* const threadPool)
+{
+	// in incremental mode, the sectors that did not change since 
+	// the last call reuse the faces that were optimized back then.
+	ndArray<ndInt32> pending;
+	ndArray<ndPolygonSoupBuilder*> optimized;
+	for (ndInt32 i = 0; i < sectors.GetCount(); ++i)
 	{
-		ndPolygonSoupBuilder tmpBuilder;
-		for (dgFaceBucket::ndNode* node = faceBucket.GetFirst(); node; node = node->GetNext()) 
+		dgSector& sector = sectors[i];
+		dgSectorCache::ndNode* const node = m_sectorCache ? m_sectorCache->Find(sector.m_hash) : nullptr;
+		if (node)
+		{
+			node->GetInfo().m_used = true;
+			sector.m_faces = node->GetInfo().m_faces;
+		}
+		else
 		{
-			const dgFaceInfo& faceInfo = node->GetInfo();
+			sector.m_faces = new ndPolygonSoupBuilder();
+			optimized.PushBack(sector.m_faces);
+			pending.PushBack(i);
+			if (m_sectorCache)
+			{
+				dgCachedSector entry;
+				entry.m_faces = sector.m_faces;
+				entry.m_used = true;
+				m_sectorCache->Insert(entry, sector.m_hash);
+			}
+		}
+	}
 
-			ndInt32 count = faceInfo.indexCount - 1;
-			ndInt32 start = faceInfo.indexStart;
-			ndAssert (faceId == indexArray[start + count]);
-			for (ndInt32 j = 0; j < count; ++j) 
+	const dgFaceInfo* const faces = faceArray.GetCount() ? &faceArray[0] : nullptr;
+	if (threadPool && (pending.GetCount() > 1))
+	{
+		// sectors have very different cost, so they are handed out one at a time.
+		ndWorkStealingRange range(pending.GetCount(), threadPool->GetThreadCount(), 1);
+		auto OptimizeSectors = ndMakeObject::ndFunction([&range, &pending, &sectors, &source, faces](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(OptimizeSectors);
+			ndStartEnd startEnd;
+			while (range.GetChunk(threadIndex, startEnd))
 			{
-				ndInt32 index = indexArray[start + j];
-				face[j] = points[index];
-				faceIndex[j] = j;
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+				{
+					const dgSector& sector = sectors[pending[i]];
+					OptimizeSector(sector, faces, source, *sector.m_faces);
+				}
 			}
-			tmpBuilder.AddFaceIndirect(&face[0].m_x, sizeof(ndVector), faceId, faceIndex, count);
+		});
+		threadPool->ParallelExecute(OptimizeSectors);
+	}
+	else
+	{
+		for (ndInt32 i = 0; i < pending.GetCount(); ++i)
+		{
+			const dgSector& sector = sectors[pending[i]];
+			OptimizeSector(sector, faces, source, *sector.m_faces);
 		}
-		tmpBuilder.FinalizeAndOptimize (faceId);
+	}
 
+	// add the faces in sector order, so the result does not depend on the threads
+	ndVector face[256];
+	ndInt32 faceIndex[256];
+	for (ndInt32 i = 0; i < sectors.GetCount(); ++i)
+	{
+		const dgSector& sector = sectors[i];
+		const ndPolygonSoupBuilder& tmpBuilder = *sector.m_faces;
 		ndInt32 faceIndexNumber = 0;
-		for (ndInt32 i = 0; i < tmpBuilder.m_faceVertexCount.GetCount(); ++i)
+		for (ndInt32 j = 0; j < tmpBuilder.m_faceVertexCount.GetCount(); ++j)
 		{
-			ndInt32 indexCount = tmpBuilder.m_faceVertexCount[i] - 1;
-			for (ndInt32 j = 0; j < indexCount; ++j) 
+			ndInt32 indexCount = tmpBuilder.m_faceVertexCount[j] - 1;
+			for (ndInt32 k = 0; k < indexCount; ++k) 
 			{
-				ndInt32 index = tmpBuilder.m_vertexIndex[faceIndexNumber + j];
-				face[j] = tmpBuilder.m_vertexPoints[index];
-				faceIndex[j] = j;
+				ndInt32 index = tmpBuilder.m_vertexIndex[faceIndexNumber + k];
+				face[k] = tmpBuilder.m_vertexPoints[index];
+				faceIndex[k] = k;
 			}
-			AddFaceIndirect(&face[0].m_x, sizeof(ndVector), faceId, faceIndex, indexCount);
-		
+			AddFaceIndirect(&face[0].m_x, sizeof(ndVector), sector.m_faceId, faceIndex, indexCount);
 			faceIndexNumber += (indexCount + 1); 
 		}
 	}
+
+	if (m_sectorCache)
+	{
+		m_sectorCache->RemoveUnused();
+	}
+	else
+	{
+		for (ndInt32 i = 0; i < optimized.GetCount(); ++i)
+		{
+			delete optimized[i];
+		}
+	}
 }
 
 ndInt32 ndPolygonSoupBuilder::FilterFace (ndInt32 count, ndInt32* const pool)
@@ -34,6 +34,8 @@
 #include "ndVector.h"
 #include "ndMatrix.h"
 
+class ndThreadPool;
+
 /// Helper intermediate class for encoding a face adjacent face to an edge of a face.
 class ndAdjacentFace
 {
@@ -46,9 +48,12 @@ class ndAdjacentFace
 
 class ndPolygonSoupBuilder: public ndClassAlloc 
 {
+	class dgSector;
 	class dgFaceMap;
 	class dgFaceInfo;
 	class dgFaceBucket;
+	class dgSectorCache;
+	class dgCachedSector;
 	class dgPolySoupFilterAllocator;
 
 	public:
@@ -58,6 +63,17 @@ class ndPolygonSoupBuilder: public ndClassAlloc
 
 	D_CORE_API virtual void Begin();
 	D_CORE_API virtual void End(bool optimize);
+
+	/// Same as End, but the sectors of the mesh are optimized in parallel.
+	/// \brief threadPool must not be executing an update, the builder 
+	/// calls Begin and End on it. The result is the same as End(optimize). 
+	D_CORE_API void End(bool optimize, ndThreadPool* const threadPool);
+
+	/// Enable the incremental mode of the optimizer.
+	/// \brief the builder remembers the optimized faces of each sector, so 
+	/// that after a local edit, End only optimizes the sectors that changed.
+	D_CORE_API void SetIncremental(bool state);
+	bool GetIncremental() const;
 	D_CORE_API virtual void AddFace(const ndFloat32* const vertex, ndInt32 strideInBytes, ndInt32 vertexCount, const ndInt32 faceId);
 	D_CORE_API virtual void AddFaceIndirect(const ndFloat32* const vertex, ndInt32 strideInBytes, ndInt32 faceId, const ndInt32* const indexArray, ndInt32 indexCount);
 
@@ -65,7 +81,9 @@ class ndPolygonSoupBuilder: public ndClassAlloc
 	D_CORE_API void SavePLY(const char* const fileName) const;
 
 	private:
-	void Optimize(ndInt32 faceId, const dgFaceBucket& faceBucket, const ndPolygonSoupBuilder& source);
+	void CalculateSectors(ndInt32 faceId, const dgFaceBucket& faceBucket, const ndPolygonSoupBuilder& source, ndArray<dgFaceInfo>& faceArray, ndArray<dgSector>& sectors) const;
+	void OptimizeSectors(const ndPolygonSoupBuilder& source, const ndArray<dgFaceInfo>& faceArray, ndArray<dgSector>& sectors, ndThreadPool* const threadPool);
+	static void OptimizeSector(const dgSector& sector, const dgFaceInfo* const faceArray, const ndPolygonSoupBuilder& source, ndPolygonSoupBuilder& output);
 
 	void Finalize();
 	void OptimizeByIndividualFaces();
@@ -109,7 +127,15 @@ class ndPolygonSoupBuilder: public ndClassAlloc
 	ndVertexArray m_vertexPoints;
 	ndVertexArray m_normalPoints;
 	ndInt32 m_run;
+
+	private:
+	dgSectorCache* m_sectorCache;
 };
 
+inline bool ndPolygonSoupBuilder::GetIncremental() const
+{
+	return m_sectorCache ? true : false;
+}
+
 #endif
 
@@ -0,0 +1,471 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndFastRay.h"
+#include "ndSimdDispatch.h"
+
+// the wide kernels read ndVector arrays as floats,
+// so they only exist in single precision x86 builds.
+#if (defined (__x86_64) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)) && !defined(D_NEWTON_USE_DOUBLE) && !defined(D_SCALAR_VECTOR_CLASS)
+	#define D_SIMD_DISPATCH_X86
+
+	// msvc can emit any intrinsic without changing the target,
+	// gcc and clang need the function to be compiled for the target.
+	#if defined(_MSC_VER)
+		#define D_TARGET_AVX2
+		#define D_TARGET_AVX512
+	#else
+		#define D_TARGET_AVX2 __attribute__((target("avx2,fma")))
+		#define D_TARGET_AVX512 __attribute__((target("avx2,fma,avx512f,avx512dq,avx512vl")))
+	#endif
+#endif
+
+typedef ndInt32 (*ndSupportVertexFunction)(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 groupCount, const ndVector& dir);
+typedef void (*ndHistogramScanFunction)(ndUnsigned32* const scans, ndUnsigned32* const sum, ndInt32 histogramCount, ndInt32 size);
+
+static ndInt32 ndSupportVertexGeneric(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 groupCount, const ndVector& dir)
+{
+	const ndVector dirX(dir.m_x);
+	const ndVector dirY(dir.m_y);
+	const ndVector dirZ(dir.m_z);
+	ndVector support(index[0]);
+	ndVector maxProj(x[0] * dirX + y[0] * dirY + z[0] * dirZ);
+	for (ndInt32 i = 1; i < groupCount; ++i)
+	{
+		ndVector dot(x[i] * dirX + y[i] * dirY + z[i] * dirZ);
+		support = support.Select(index[i], dot > maxProj);
+		maxProj = maxProj.GetMax(dot);
+	}
+
+	ndVector dot(maxProj.ShiftRight().ShiftRight());
+	ndVector support1(support.ShiftRight().ShiftRight());
+	support = support.Select(support1, dot > maxProj);
+	maxProj = maxProj.GetMax(dot);
+
+	dot = maxProj.ShiftRight();
+	support1 = support.ShiftRight();
+	support = support.Select(support1, dot > maxProj);
+	return ndInt32(support.GetScalar());
+}
+
+static void ndRayBoxIntersectGeneric(const ndFastRay& ray, const ndVector& minBox0, const ndVector& maxBox0, const ndVector& minBox1, const ndVector& maxBox1, ndFloat32* const distOut)
+{
+	distOut[0] = ray.BoxIntersect(minBox0, maxBox0);
+	distOut[1] = ray.BoxIntersect(minBox1, maxBox1);
+}
+
+static void ndHistogramScanGeneric(ndUnsigned32* const scans, ndUnsigned32* const sum, ndInt32 histogramCount, ndInt32 size)
+{
+	for (ndInt32 i = 0; i < size; ++i)
+	{
+		sum[i] = 0;
+	}
+	for (ndInt32 j = 0; j < histogramCount; ++j)
+	{
+		ndUnsigned32* const scan = &scans[j * size];
+		for (ndInt32 i = 0; i < size; ++i)
+		{
+			ndUnsigned32 partialSum = scan[i];
+			scan[i] = sum[i];
+			sum[i] += partialSum;
+		}
+	}
+}
+
+#ifdef D_SIMD_DISPATCH_X86
+
+static inline ndInt32 ndFirstLane(ndInt32 mask)
+{
+	// an empty mask comes from a nan projection, 
+	// the first lane is what the generic kernel returns.
+	ndInt32 lane = 0;
+	for (; mask && !(mask & 1); mask >>= 1)
+	{
+		lane++;
+	}
+	return mask ? lane : 0;
+}
+
+D_TARGET_AVX2 static ndInt32 ndSupportVertexAvx2(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 groupCount, const ndVector& dir)
+{
+	const ndFloat32* const px = &x[0].m_x;
+	const ndFloat32* const py = &y[0].m_x;
+	const ndFloat32* const pz = &z[0].m_x;
+	const ndFloat32* const pIndex = &index[0].m_x;
+
+	const __m256 dirX(_mm256_set1_ps(dir.m_x));
+	const __m256 dirY(_mm256_set1_ps(dir.m_y));
+	const __m256 dirZ(_mm256_set1_ps(dir.m_z));
+
+	// seed both halves with the first group, like the generic kernel
+	const __m128 dot0(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&px[0]), _mm256_castps256_ps128(dirX)), _mm_mul_ps(_mm_loadu_ps(&py[0]), _mm256_castps256_ps128(dirY))), _mm_mul_ps(_mm_loadu_ps(&pz[0]), _mm256_castps256_ps128(dirZ))));
+	__m256 support(_mm256_broadcast_ps((const __m128*)&pIndex[0]));
+	__m256 maxProj(_mm256_insertf128_ps(_mm256_castps128_ps256(dot0), dot0, 1));
+
+	const ndInt32 count = groupCount * 4;
+	ndInt32 i = 0;
+	for (; i <= count - 8; i += 8)
+	{
+		const __m256 dot(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&px[i]), dirX), _mm256_mul_ps(_mm256_loadu_ps(&py[i]), dirY)), _mm256_mul_ps(_mm256_loadu_ps(&pz[i]), dirZ)));
+		const __m256 mask(_mm256_cmp_ps(dot, maxProj, _CMP_GT_OQ));
+		support = _mm256_blendv_ps(support, _mm256_loadu_ps(&pIndex[i]), mask);
+		maxProj = _mm256_max_ps(maxProj, dot);
+	}
+
+	if (i < count)
+	{
+		// one group of four left, run it in the lower half
+		const __m128 dot(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&px[i]), _mm256_castps256_ps128(dirX)), _mm_mul_ps(_mm_loadu_ps(&py[i]), _mm256_castps256_ps128(dirY))), _mm_mul_ps(_mm_loadu_ps(&pz[i]), _mm256_castps256_ps128(dirZ))));
+		const __m128 maxProj0(_mm256_castps256_ps128(maxProj));
+		const __m128 mask(_mm_cmpgt_ps(dot, maxProj0));
+		const __m128 support0(_mm_blendv_ps(_mm256_castps256_ps128(support), _mm_loadu_ps(&pIndex[i]), mask));
+		support = _mm256_insertf128_ps(support, support0, 0);
+		maxProj = _mm256_insertf128_ps(maxProj, _mm_max_ps(maxProj0, dot), 0);
+	}
+
+	__m256 maxDot(_mm256_max_ps(maxProj, _mm256_permute2f128_ps(maxProj, maxProj, 0x01)));
+	maxDot = _mm256_max_ps(maxDot, _mm256_permute_ps(maxDot, PERMUTE_MASK(1, 0, 3, 2)));
+	maxDot = _mm256_max_ps(maxDot, _mm256_permute_ps(maxDot, PERMUTE_MASK(2, 3, 0, 1)));
+	const ndInt32 lane = ndFirstLane(_mm256_movemask_ps(_mm256_cmp_ps(maxProj, maxDot, _CMP_EQ_OQ)));
+
+	D_MSV_NEWTON_ALIGN_32 ndFloat32 supportLanes[8] D_GCC_NEWTON_ALIGN_32;
+	_mm256_store_ps(supportLanes, support);
+	return ndInt32(supportLanes[lane]);
+}
+
+D_TARGET_AVX512 static ndInt32 ndSupportVertexAvx512(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 groupCount, const ndVector& dir)
+{
+	const ndFloat32* const px = &x[0].m_x;
+	const ndFloat32* const py = &y[0].m_x;
+	const ndFloat32* const pz = &z[0].m_x;
+	const ndFloat32* const pIndex = &index[0].m_x;
+
+	const __m512 dirX(_mm512_set1_ps(dir.m_x));
+	const __m512 dirY(_mm512_set1_ps(dir.m_y));
+	const __m512 dirZ(_mm512_set1_ps(dir.m_z));
+
+	// seed all the lanes with the first group, like the generic kernel
+	const __m128 dot0(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&px[0]), _mm512_castps512_ps128(dirX)), _mm_mul_ps(_mm_loadu_ps(&py[0]), _mm512_castps512_ps128(dirY))), _mm_mul_ps(_mm_loadu_ps(&pz[0]), _mm512_castps512_ps128(dirZ))));
+	__m512 support(_mm512_broadcast_f32x4(_mm_loadu_ps(&pIndex[0])));
+	__m512 maxProj(_mm512_broadcast_f32x4(dot0));
+
+	const ndInt32 count = groupCount * 4;
+	for (ndInt32 i = 0; i < count; i += 16)
+	{
+		// the tail is read with a partial mask
+		const ndInt32 lanes = ndMin(count - i, 16);
+		const __mmask16 laneMask = __mmask16((1 << lanes) - 1);
+		const __m512 dot(_mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_maskz_loadu_ps(laneMask, &px[i]), dirX), _mm512_mul_ps(_mm512_maskz_loadu_ps(laneMask, &py[i]), dirY)), _mm512_mul_ps(_mm512_maskz_loadu_ps(laneMask, &pz[i]), dirZ)));
+		const __mmask16 mask = _mm512_mask_cmp_ps_mask(laneMask, dot, maxProj, _CMP_GT_OQ);
+		support = _mm512_mask_mov_ps(support, mask, _mm512_maskz_loadu_ps(laneMask, &pIndex[i]));
+		maxProj = _mm512_mask_mov_ps(maxProj, mask, dot);
+	}
+
+	const __m512 maxDot(_mm512_set1_ps(_mm512_reduce_max_ps(maxProj)));
+	const ndInt32 lane = ndFirstLane(ndInt32(_mm512_cmp_ps_mask(maxProj, maxDot, _CMP_EQ_OQ)));
+
+	D_MSV_NEWTON_ALIGN_32 ndFloat32 supportLanes[16] D_GCC_NEWTON_ALIGN_32;
+	_mm512_storeu_ps(supportLanes, support);
+	return ndInt32(supportLanes[lane]);
+}
+
+D_TARGET_AVX2 static void ndRayBoxIntersectAvx2(const ndFastRay& ray, const ndVector& minBox0, const ndVector& maxBox0, const ndVector& minBox1, const ndVector& maxBox1, ndFloat32* const distOut)
+{
+	// both boxes are tested at once, one in each half of the register.
+	const __m128 p0Half(_mm_loadu_ps(&ray.m_p0.m_x));
+	const __m128 dpInvHalf(_mm_loadu_ps(&ray.m_dpInv.m_x));
+	const __m128 minTHalf(_mm_loadu_ps(&ray.m_minT.m_x));
+	const __m128 maxTHalf(_mm_loadu_ps(&ray.m_maxT.m_x));
+	const __m128 isParallelHalf(_mm_loadu_ps(&ray.m_isParallel.m_x));
+
+	const __m256 p0(_mm256_insertf128_ps(_mm256_castps128_ps256(p0Half), p0Half, 1));
+	const __m256 dpInv(_mm256_insertf128_ps(_mm256_castps128_ps256(dpInvHalf), dpInvHalf, 1));
+	const __m256 minT(_mm256_insertf128_ps(_mm256_castps128_ps256(minTHalf), minTHalf, 1));
+	const __m256 maxT(_mm256_insertf128_ps(_mm256_castps128_ps256(maxTHalf), maxTHalf, 1));
+	const __m256 isParallel(_mm256_insertf128_ps(_mm256_castps128_ps256(isParallelHalf), isParallelHalf, 1));
+	const __m256 minBox(_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&minBox0.m_x)), _mm_loadu_ps(&minBox1.m_x), 1));
+	const __m256 maxBox(_mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&maxBox0.m_x)), _mm_loadu_ps(&maxBox1.m_x), 1));
+
+	const __m256 test(_mm256_and_ps(_mm256_or_ps(_mm256_cmp_ps(p0, minBox, _CMP_LE_OQ), _mm256_cmp_ps(p0, maxBox, _CMP_GE_OQ)), isParallel));
+	const ndInt32 testMask = _mm256_movemask_ps(test);
+
+	const __m256 tt0(_mm256_mul_ps(dpInv, _mm256_sub_ps(minBox, p0)));
+	const __m256 tt1(_mm256_mul_ps(dpInv, _mm256_sub_ps(maxBox, p0)));
+	__m256 t0(_mm256_max_ps(minT, _mm256_min_ps(tt0, tt1)));
+	__m256 t1(_mm256_min_ps(maxT, _mm256_max_ps(tt0, tt1)));
+	t0 = _mm256_max_ps(t0, _mm256_permute_ps(t0, PERMUTE_MASK(3, 1, 0, 2)));
+	t1 = _mm256_min_ps(t1, _mm256_permute_ps(t1, PERMUTE_MASK(3, 1, 0, 2)));
+	t0 = _mm256_max_ps(t0, _mm256_permute_ps(t0, PERMUTE_MASK(3, 1, 0, 2)));
+	t1 = _mm256_min_ps(t1, _mm256_permute_ps(t1, PERMUTE_MASK(3, 1, 0, 2)));
+	const __m256 maxDist(_mm256_set1_ps(ndFloat32(1.2f)));
+	t0 = _mm256_blendv_ps(maxDist, t0, _mm256_cmp_ps(t0, t1, _CMP_LT_OQ));
+
+	D_MSV_NEWTON_ALIGN_32 ndFloat32 dist[8] D_GCC_NEWTON_ALIGN_32;
+	_mm256_store_ps(dist, t0);
+	distOut[0] = (testMask & 0x07) ? ndFloat32(1.2f) : dist[0];
+	distOut[1] = (testMask & 0x70) ? ndFloat32(1.2f) : dist[4];
+}
+
+D_TARGET_AVX2 static void ndHistogramScanAvx2(ndUnsigned32* const scans, ndUnsigned32* const sum, ndInt32 histogramCount, ndInt32 size)
+{
+	ndInt32 i = 0;
+	for (; i <= size - 8; i += 8)
+	{
+		__m256i acc(_mm256_setzero_si256());
+		for (ndInt32 j = 0; j < histogramCount; ++j)
+		{
+			__m256i* const scan = (__m256i*)&scans[j * size + i];
+			const __m256i partialSum(_mm256_loadu_si256(scan));
+			_mm256_storeu_si256(scan, acc);
+			acc = _mm256_add_epi32(acc, partialSum);
+		}
+		_mm256_storeu_si256((__m256i*)&sum[i], acc);
+	}
+
+	for (; i < size; ++i)
+	{
+		ndUnsigned32 acc = 0;
+		for (ndInt32 j = 0; j < histogramCount; ++j)
+		{
+			const ndUnsigned32 partialSum = scans[j * size + i];
+			scans[j * size + i] = acc;
+			acc += partialSum;
+		}
+		sum[i] = acc;
+	}
+}
+
+D_TARGET_AVX512 static void ndHistogramScanAvx512(ndUnsigned32* const scans, ndUnsigned32* const sum, ndInt32 histogramCount, ndInt32 size)
+{
+	for (ndInt32 i = 0; i < size; i += 16)
+	{
+		const ndInt32 lanes = ndMin(size - i, 16);
+		const __mmask16 laneMask = __mmask16((1 << lanes) - 1);
+		__m512i acc(_mm512_setzero_si512());
+		for (ndInt32 j = 0; j < histogramCount; ++j)
+		{
+			ndUnsigned32* const scan = &scans[j * size + i];
+			const __m512i partialSum(_mm512_maskz_loadu_epi32(laneMask, scan));
+			_mm512_mask_storeu_epi32(scan, laneMask, acc);
+			acc = _mm512_add_epi32(acc, partialSum);
+		}
+		_mm512_mask_storeu_epi32(&sum[i], laneMask, acc);
+	}
+}
+
+#if defined(_MSC_VER)
+static bool ndCpuSupportsXsaveState(ndUnsigned64 stateMask)
+{
+	int info[4];
+	__cpuid(info, 1);
+	const bool osxsave = (info[2] & (1 << 27)) ? true : false;
+	return osxsave && ((_xgetbv(0) & stateMask) == stateMask);
+}
+#endif
+
+#endif
+
+// the kernels are switched one at a time while other threads may be calling 
+// them, so each entry is atomic. the generic kernels are installed before 
+// the cpu is checked.
+class ndSimdKernels
+{
+	public:
+	ndSimdKernels()
+		:m_isa(ndSimdGeneric)
+		,m_supportVertex(ndSupportVertexGeneric)
+		,m_rayBoxIntersect(ndRayBoxIntersectGeneric)
+		,m_histogramScan(ndHistogramScanGeneric)
+	{
+		for (ndInt32 i = 0; i < ndSimdKernelCount; ++i)
+		{
+			m_kernelIsa[i].store(ndSimdGeneric);
+		}
+	}
+
+	ndAtomic<ndSimdIsa> m_isa;
+	ndAtomic<ndSimdIsa> m_kernelIsa[ndSimdKernelCount];
+	ndAtomic<ndSupportVertexFunction> m_supportVertex;
+	ndAtomic<ndRayBoxIntersectFunction> m_rayBoxIntersect;
+	ndAtomic<ndHistogramScanFunction> m_histogramScan;
+};
+
+static ndSimdKernels ndKernels;
+
+bool ndSimdDispatch::CpuSupportsAvx2()
+{
+	#ifdef D_SIMD_DISPATCH_X86
+		#if defined(_MSC_VER)
+			int info1[4];
+			int info7[4];
+			__cpuid(info1, 1);
+			__cpuidex(info7, 7, 0);
+			const bool fma = (info1[2] & (1 << 12)) ? true : false;
+			const bool avx2 = (info7[1] & (1 << 5)) ? true : false;
+			return fma && avx2 && ndCpuSupportsXsaveState(0x06);
+		#else
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		#endif
+	#else
+		return false;
+	#endif
+}
+
+bool ndSimdDispatch::CpuSupportsAvx512()
+{
+	#ifdef D_SIMD_DISPATCH_X86
+		#if defined(_MSC_VER)
+			int info7[4];
+			__cpuidex(info7, 7, 0);
+			const bool avx512f = (info7[1] & (1 << 16)) ? true : false;
+			const bool avx512dq = (info7[1] & (1 << 17)) ? true : false;
+			const bool avx512vl = (info7[1] & (1 << 31)) ? true : false;
+			return avx512f && avx512dq && avx512vl && CpuSupportsAvx2() && ndCpuSupportsXsaveState(0xe6);
+		#else
+			return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl") && CpuSupportsAvx2();
+		#endif
+	#else
+		return false;
+	#endif
+}
+
+ndSimdIsa ndSimdDispatch::GetCpuIsa()
+{
+	static const ndSimdIsa isa = CpuSupportsAvx512() ? ndSimdAvx512 : (CpuSupportsAvx2() ? ndSimdAvx2 : ndSimdGeneric);
+	return isa;
+}
+
+void ndSimdDispatch::Initialize()
+{
+	// every world calls this, the cpu kernels are only installed by the first one
+	static const ndSimdIsa isa = SetActiveIsa(GetCpuIsa());
+	ndAssert(isa <= GetCpuIsa());
+	(void)isa;
+}
+
+ndSimdIsa ndSimdDispatch::GetActiveIsa()
+{
+	return ndKernels.m_isa.load();
+}
+
+ndSimdIsa ndSimdDispatch::SetActiveIsa(ndSimdIsa isa)
+{
+	isa = ndMin(isa, GetCpuIsa());
+
+	ndSimdIsa kernelIsa[ndSimdKernelCount];
+	kernelIsa[ndSimdSupportVertexKernel] = ndSimdGeneric;
+	kernelIsa[ndSimdRayBoxKernel] = ndSimdGeneric;
+	kernelIsa[ndSimdHistogramKernel] = ndSimdGeneric;
+	ndSupportVertexFunction supportVertex = ndSupportVertexGeneric;
+	ndRayBoxIntersectFunction rayBoxIntersect = ndRayBoxIntersectGeneric;
+	ndHistogramScanFunction histogramScan = ndHistogramScanGeneric;
+
+	#ifdef D_SIMD_DISPATCH_X86
+	if (isa >= ndSimdAvx2)
+	{
+		kernelIsa[ndSimdSupportVertexKernel] = ndSimdAvx2;
+		kernelIsa[ndSimdRayBoxKernel] = ndSimdAvx2;
+		kernelIsa[ndSimdHistogramKernel] = ndSimdAvx2;
+		supportVertex = ndSupportVertexAvx2;
+		rayBoxIntersect = ndRayBoxIntersectAvx2;
+		histogramScan = ndHistogramScanAvx2;
+	}
+
+	if (isa >= ndSimdAvx512)
+	{
+		// two boxes fill an avx2 register, so the ray box test stays on avx2
+		kernelIsa[ndSimdSupportVertexKernel] = ndSimdAvx512;
+		kernelIsa[ndSimdHistogramKernel] = ndSimdAvx512;
+		supportVertex = ndSupportVertexAvx512;
+		histogramScan = ndHistogramScanAvx512;
+	}
+	#endif
+
+	// a thread calling a kernel meanwhile runs either the old or the new 
+	// version, all of them give the same results.
+	ndKernels.m_supportVertex.store(supportVertex);
+	ndKernels.m_rayBoxIntersect.store(rayBoxIntersect);
+	ndKernels.m_histogramScan.store(histogramScan);
+	for (ndInt32 i = 0; i < ndSimdKernelCount; ++i)
+	{
+		ndKernels.m_kernelIsa[i].store(kernelIsa[i]);
+	}
+	ndKernels.m_isa.store(isa);
+	return isa;
+}
+
+ndSimdIsa ndSimdDispatch::GetKernelIsa(ndSimdKernel kernel)
+{
+	ndAssert((kernel >= 0) && (kernel < ndSimdKernelCount));
+	return ndKernels.m_kernelIsa[kernel].load();
+}
+
+const char* ndSimdDispatch::GetIsaString(ndSimdIsa isa)
+{
+	switch (isa)
+	{
+		case ndSimdAvx2:
+			return "avx2";
+		case ndSimdAvx512:
+			return "avx512";
+		case ndSimdGeneric:
+		default:
+			return "generic";
+	}
+}
+
+const char* ndSimdDispatch::GetKernelString(ndSimdKernel kernel)
+{
+	switch (kernel)
+	{
+		case ndSimdSupportVertexKernel:
+			return "convex support vertex";
+		case ndSimdRayBoxKernel:
+			return "ray box intersect";
+		case ndSimdHistogramKernel:
+			return "sort histogram scan";
+		default:
+			return "unknown";
+	}
+}
+
+ndInt32 ndSimdDispatch::SupportVertex(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 groupCount, const ndVector& dir)
+{
+	ndAssert(groupCount > 0);
+	return ndKernels.m_supportVertex.load()(x, y, z, index, groupCount, dir);
+}
+
+void ndSimdDispatch::RayBoxIntersect(const ndFastRay& ray, const ndVector& minBox0, const ndVector& maxBox0, const ndVector& minBox1, const ndVector& maxBox1, ndFloat32* const distOut)
+{
+	ndKernels.m_rayBoxIntersect.load()(ray, minBox0, maxBox0, minBox1, maxBox1, distOut);
+}
+
+void ndSimdDispatch::HistogramScan(ndUnsigned32* const scans, ndUnsigned32* const sum, ndInt32 histogramCount, ndInt32 size)
+{
+	ndKernels.m_histogramScan.load()(scans, sum, histogramCount, size);
+}
+
+ndRayBoxIntersectFunction ndSimdDispatch::GetRayBoxIntersect()
+{
+	return ndKernels.m_rayBoxIntersect.load();
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_SIMD_DISPATCH_H__
+#define __ND_SIMD_DISPATCH_H__
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndVector.h"
+
+class ndFastRay;
+
+/// Instruction sets the hot kernels can be dispatched to.
+enum ndSimdIsa
+{
+	ndSimdGeneric,
+	ndSimdAvx2,
+	ndSimdAvx512,
+};
+
+/// Kernels that have instruction set specific versions.
+enum ndSimdKernel
+{
+	ndSimdSupportVertexKernel,
+	ndSimdRayBoxKernel,
+	ndSimdHistogramKernel,
+	ndSimdKernelCount,
+};
+
+typedef void (*ndRayBoxIntersectFunction)(const ndFastRay& ray, const ndVector& minBox0, const ndVector& maxBox0, const ndVector& minBox1, const ndVector& maxBox1, ndFloat32* const distOut);
+
+/// Runtime selection of the instruction set of a few hot kernels.
+/// \brief ndVector is fixed at compile time, but some inner loops
+/// have wider versions compiled for avx2 and avx512 in the same binary.
+/// The cpu is checked with cpuid when the first world is created, and
+/// the widest version the cpu can run is installed. Until then, and
+/// in double precision or non x86 builds, the generic version is used.
+class ndSimdDispatch
+{
+	public:
+	/// Check the cpu and install the widest kernels it can run.
+	/// \brief only the first call does anything, it is safe to call from many threads.
+	D_CORE_API static void Initialize();
+
+	/// Widest instruction set supported by the cpu and the build.
+	D_CORE_API static ndSimdIsa GetCpuIsa();
+
+	/// Instruction set the kernels are currently dispatched to.
+	D_CORE_API static ndSimdIsa GetActiveIsa();
+
+	/// Dispatch the kernels to an instruction set, clamped to GetCpuIsa.
+	/// \brief this is for debugging and testing, threads calling the kernels 
+	/// meanwhile run either the old or the new version. 
+	/// Returns the instruction set installed.
+	D_CORE_API static ndSimdIsa SetActiveIsa(ndSimdIsa isa);
+
+	/// Instruction set of the version installed for a kernel.
+	/// \brief kernels that have no version for the active instruction
+	/// set run the next narrower one.
+	D_CORE_API static ndSimdIsa GetKernelIsa(ndSimdKernel kernel);
+
+	D_CORE_API static const char* GetIsaString(ndSimdIsa isa);
+	D_CORE_API static const char* GetKernelString(ndSimdKernel kernel);
+
+	D_CORE_API static bool CpuSupportsAvx2();
+	D_CORE_API static bool CpuSupportsAvx512();
+
+	/// Index of the vertex with the largest projection over dir.
+	/// \brief the vertices are in groups of four in structure of arrays
+	/// format, the last group must be padded with copies of a vertex.
+	D_CORE_API static ndInt32 SupportVertex(const ndVector* const x, const ndVector* const y, const ndVector* const z, const ndVector* const index, ndInt32 groupCount, const ndVector& dir);
+
+	/// Ray intersection parameter of two boxes, the same as two calls to ndFastRay::BoxIntersect.
+	D_CORE_API static void RayBoxIntersect(const ndFastRay& ray, const ndVector& minBox0, const ndVector& maxBox0, const ndVector& minBox1, const ndVector& maxBox1, ndFloat32* const distOut);
+
+	/// The ray box kernel currently installed.
+	/// \brief tree traversals call it once per node, so they read it once 
+	/// before the loop instead of going through RayBoxIntersect every time.
+	D_CORE_API static ndRayBoxIntersectFunction GetRayBoxIntersect();
+
+	/// Column scan of the per thread histograms of a counting sort.
+	/// \brief each entry of the histograms is replaced by the sum of the
+	/// same entry of the histograms before it, and sum gets the totals.
+	D_CORE_API static void HistogramScan(ndUnsigned32* const scans, ndUnsigned32* const sum, ndInt32 histogramCount, ndInt32 size);
+};
+
+#endif
+
@@ -26,6 +26,7 @@
 #include "ndArray.h"
 #include "ndProfiler.h"
 #include "ndThreadPool.h"
+#include "ndSimdDispatch.h"
 
 template <class T, class dCompareKey>
 void ndSort(T* const array, ndInt32 elements, void* const context)
@@ -246,20 +247,7 @@ void ndCountingSortInPlace(ndThreadPool& threadPool, T* const array, T* const sc
 	ndInt32 bits = keyBitSize;
 	if (bits < 11)
 	{
-		for (ndInt32 i = 0; i < (1 << keyBitSize); ++i)
-		{
-			sum[i] = 0;
-		}
-		for (ndInt32 j = 0; j < threadCount; ++j)
-		{
-			ndUnsigned32* const scan = &scans[j * (1 << keyBitSize)];
-			for (ndInt32 i = 0; i < (1 << keyBitSize); ++i)
-			{
-				ndUnsigned32 partialSum = scan[i];
-				scan[i] = sum[i];
-				sum[i] += partialSum;
-			}
-		}
+		ndSimdDispatch::HistogramScan(scans, sum, threadCount, 1 << keyBitSize);
 
 		ndUnsigned32 accSum = 0;
 		for (ndInt32 i = 0; i < (1 << keyBitSize); ++i)
@@ -411,20 +399,7 @@ void ndCountingSort(ndThreadPool& threadPool, const T* const srcArray, T* const
 	ndInt32 bits = keyBitSize;
 	if (bits < 11)
 	{
-		for (ndInt32 i = 0; i < (1 << keyBitSize); ++i)
-		{
-			sum[i] = 0;
-		}
-		for (ndInt32 j = 0; j < threadCount; ++j)
-		{
-			ndUnsigned32* const scan = &scans[j * (1 << keyBitSize)];
-			for (ndInt32 i = 0; i < (1 << keyBitSize); ++i)
-			{
-				ndUnsigned32 partialSum = scan[i];
-				scan[i] = sum[i];
-				sum[i] += partialSum;
-			}
-		}
+		ndSimdDispatch::HistogramScan(scans, sum, threadCount, 1 << keyBitSize);
 
 		ndUnsigned32 accSum = 0;
 		for (ndInt32 i = 0; i < (1 << keyBitSize); ++i)
@@ -70,6 +70,9 @@ class ndThreadBackgroundWorker: public ndThreadPool, public ndList<ndBackgroundT
 
 	D_CORE_API void Terminate();
 	D_CORE_API void SendTask(ndBackgroundTask* const job);
+
+	/// Returns true after Terminate, tasks sent from then on never run.
+	bool IsTerminated() const;
 	
 	private:
 	virtual void ThreadFunction();
@@ -80,4 +83,9 @@ class ndThreadBackgroundWorker: public ndThreadPool, public ndList<ndBackgroundT
 	ndSemaphore m_queueSemaphore;
 };
 
+inline bool ndThreadBackgroundWorker::IsTerminated() const
+{
+	return m_teminate.load();
+}
+
 #endif
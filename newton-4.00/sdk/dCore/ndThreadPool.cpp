@@ -28,7 +28,9 @@
 ndThreadPool::ndWorker::ndWorker()
 	:ndThread()
 	,m_owner(nullptr)
+	,m_park()
 	,m_begin(false)
+	,m_parked(false)
 	,m_stillLooping(true)
 	,m_task(nullptr)
 	,m_threadIndex(0)
@@ -45,6 +47,7 @@ void ndThreadPool::ndWorker::ThreadFunction()
 #ifndef	D_USE_THREAD_EMULATION
 	m_begin.store(true);
 	m_stillLooping.store(true);
+	ndInt32 spinCount = 0;
 	while (m_begin.load())
 	{
 		ndTask* const task = m_task.load();
@@ -53,8 +56,37 @@ void ndThreadPool::ndWorker::ThreadFunction()
 			//D_TRACKTIME();
 			task->Execute();
 			m_task.store(nullptr);
+			spinCount = 0;
+		}
+		else
+		{
+			const ndInt32 spinBudget = m_owner->m_spinBudget.load();
+			if ((spinBudget < 0) || (spinCount < spinBudget))
+			{
+				spinCount++;
+				ndThreadYield();
+			}
+			else
+			{
+				// spin budget exhausted, park the worker until 
+				// the pool sends a new task or ends the update.
+				m_parked.store(true);
+				if (m_task.load() || !m_begin.load())
+				{
+					// work arrived while parking, if the pool already 
+					// took the flag, consume the signal it is sending.
+					if (!m_parked.exchange(false))
+					{
+						m_park.Wait();
+					}
+				}
+				else
+				{
+					m_park.Wait();
+				}
+				spinCount = 0;
+			}
 		}
-		ndThreadYield();
 	}
 	m_stillLooping.store(false);
 #endif
@@ -65,6 +97,7 @@ ndThreadPool::ndThreadPool(const char* const baseName)
 	,ndThread()
 	,m_workers(nullptr)
 	,m_count(0)
+	,m_spinBudget(D_DEFAULT_THREAD_SPIN_BUDGET)
 {
 	char name[256];
 	strncpy(m_baseName, baseName, sizeof (m_baseName));
@@ -118,6 +151,11 @@ void ndThreadPool::SetThreadCount(ndInt32 count)
 #endif
 }
 
+void ndThreadPool::SetSpinBudget(ndInt32 spinCount)
+{
+	m_spinBudget.store(spinCount);
+}
+
 void ndThreadPool::Begin()
 {
 	D_TRACKTIME();
@@ -139,6 +177,7 @@ void ndThreadPool::End()
 	for (ndInt32 i = 0; i < m_count; ++i)
 	{
 		m_workers[i].m_begin.store(false);
+		m_workers[i].WakeUp();
 	}
 
 	bool stillLooping = true;
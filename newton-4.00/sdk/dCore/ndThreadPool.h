@@ -24,6 +24,7 @@
 
 #include "ndCoreStdafx.h"
 #include "ndTypes.h"
+#include "ndUtils.h"
 #include "ndArray.h"
 #include "ndThread.h"
 #include "ndSyncMutex.h"
@@ -33,11 +34,21 @@
 //#define	D_MAX_THREADS_COUNT	16
 #define	D_MAX_THREADS_COUNT	32
 
+// number of yield loops an idle worker spins waiting for a new task, 
+// before it parks on its semaphore until the pool wakes it up again. 
+#define	D_DEFAULT_THREAD_SPIN_BUDGET	4096
+
 class ndThreadPool;
 
 class ndStartEnd
 {
 	public:
+	ndStartEnd()
+		:m_start(0)
+		,m_end(0)
+	{
+	}
+
 	ndStartEnd(ndInt32 count, ndInt32 threadIndex, ndInt32 threads)
 	{
 		ndInt32 stride = count / threads;
@@ -52,6 +63,124 @@ class ndStartEnd
 	ndInt32 m_end;
 };
 
+// work stealing range scheduler.
+// the range is cut in small chunks, and each thread gets a contiguous
+// deque of chunks. Threads pop chunks from the front of their own deque,
+// and when they run out of work they steal chunks from the back of the
+// other threads deques. This is for loops with very uneven cost per item,
+// for loops with uniform cost ndStartEnd is still the better choice.
+#define D_WORK_STEALING_CHUNKS_PER_THREAD	16
+
+class ndWorkStealingRange
+{
+	class ndDeque
+	{
+		public:
+		ndAtomic<ndUnsigned64> m_frontBack;
+		char m_padding[64 - sizeof(ndAtomic<ndUnsigned64>)];
+	};
+
+	public:
+	ndWorkStealingRange(ndInt32 count, ndInt32 threadCount, ndInt32 chunkSize = 0)
+		:m_count((count > 0) ? count : 0)
+		,m_threadCount(threadCount)
+	{
+		ndAssert(threadCount >= 1);
+		ndAssert(threadCount <= D_MAX_THREADS_COUNT);
+		if (chunkSize <= 0)
+		{
+			chunkSize = m_count / (threadCount * D_WORK_STEALING_CHUNKS_PER_THREAD);
+		}
+		m_chunkSize = (chunkSize > 1) ? chunkSize : 1;
+		Reset();
+	}
+
+	// refill the deques, so that the same range can be executed again.
+	void Reset()
+	{
+		const ndInt32 chunkCount = (m_count + m_chunkSize - 1) / m_chunkSize;
+		for (ndInt32 i = 0; i < m_threadCount; ++i)
+		{
+			const ndStartEnd startEnd(chunkCount, i, m_threadCount);
+			m_deques[i].m_frontBack.store(Pack(startEnd.m_start, startEnd.m_end));
+		}
+	}
+
+	// get the next range of items for this thread, return false when all work is done.
+	bool GetChunk(ndInt32 threadIndex, ndStartEnd& chunk)
+	{
+		ndInt32 chunkIndex;
+		if (!PopFront(threadIndex, chunkIndex))
+		{
+			bool found = false;
+			for (ndInt32 i = 1; !found && (i < m_threadCount); ++i)
+			{
+				ndInt32 victim = threadIndex + i;
+				victim = (victim >= m_threadCount) ? victim - m_threadCount : victim;
+				found = PopBack(victim, chunkIndex);
+			}
+			if (!found)
+			{
+				return false;
+			}
+		}
+		chunk.m_start = chunkIndex * m_chunkSize;
+		chunk.m_end = ndMin(chunk.m_start + m_chunkSize, m_count);
+		return true;
+	}
+
+	private:
+	static ndUnsigned64 Pack(ndInt32 front, ndInt32 back)
+	{
+		return (ndUnsigned64(ndUnsigned32(back)) << 32) | ndUnsigned64(ndUnsigned32(front));
+	}
+
+	bool PopFront(ndInt32 threadIndex, ndInt32& chunkIndex)
+	{
+		ndAtomic<ndUnsigned64>& frontBack = m_deques[threadIndex].m_frontBack;
+		for (ndUnsigned64 value = frontBack.load(); ; value = frontBack.load())
+		{
+			const ndInt32 front = ndInt32(value & 0xffffffff);
+			const ndInt32 back = ndInt32(value >> 32);
+			if (front >= back)
+			{
+				return false;
+			}
+			ndUnsigned64 expected = value;
+			if (frontBack.compare_exchange_weak(expected, Pack(front + 1, back)))
+			{
+				chunkIndex = front;
+				return true;
+			}
+		}
+	}
+
+	bool PopBack(ndInt32 threadIndex, ndInt32& chunkIndex)
+	{
+		ndAtomic<ndUnsigned64>& frontBack = m_deques[threadIndex].m_frontBack;
+		for (ndUnsigned64 value = frontBack.load(); ; value = frontBack.load())
+		{
+			const ndInt32 front = ndInt32(value & 0xffffffff);
+			const ndInt32 back = ndInt32(value >> 32);
+			if (front >= back)
+			{
+				return false;
+			}
+			ndUnsigned64 expected = value;
+			if (frontBack.compare_exchange_weak(expected, Pack(front, back - 1)))
+			{
+				chunkIndex = back - 1;
+				return true;
+			}
+		}
+	}
+
+	ndDeque m_deques[D_MAX_THREADS_COUNT];
+	ndInt32 m_count;
+	ndInt32 m_chunkSize;
+	ndInt32 m_threadCount;
+};
+
 class ndTask
 {
 	public:
@@ -71,9 +200,13 @@ class ndThreadPool: public ndSyncMutex, public ndThread
 
 		private:
 		virtual void ThreadFunction();
+		void SetTask(ndTask* const task);
+		void WakeUp();
 
 		ndThreadPool* m_owner;
+		ndSemaphore m_park;
 		ndAtomic<bool> m_begin;
+		ndAtomic<bool> m_parked;
 		ndAtomic<bool> m_stillLooping;
 		ndAtomic<ndTask*> m_task;
 		ndInt32 m_threadIndex;
@@ -88,6 +221,13 @@ class ndThreadPool: public ndSyncMutex, public ndThread
 	D_CORE_API static ndInt32 GetMaxThreads();
 	D_CORE_API void SetThreadCount(ndInt32 count);
 
+	/// Number of yield loops an idle worker spins before parking.
+	/// \brief zero makes idle workers park right away, which is the best 
+	/// choice when many pools share the same cores. A negative value makes 
+	/// idle workers spin for the entire update, like in old versions.
+	ndInt32 GetSpinBudget() const;
+	D_CORE_API void SetSpinBudget(ndInt32 spinCount);
+
 	D_CORE_API void TickOne();
 	D_CORE_API void Begin();
 	D_CORE_API void End();
@@ -100,6 +240,7 @@ class ndThreadPool: public ndSyncMutex, public ndThread
 
 	ndWorker* m_workers;
 	ndInt32 m_count;
+	ndAtomic<ndInt32> m_spinBudget;
 	char m_baseName[32];
 };
 
@@ -108,6 +249,27 @@ inline ndInt32 ndThreadPool::GetThreadCount() const
 	return m_count + 1;
 }
 
+inline ndInt32 ndThreadPool::GetSpinBudget() const
+{
+	return m_spinBudget.load();
+}
+
+inline void ndThreadPool::ndWorker::WakeUp()
+{
+	// only signal the semaphore if the worker is parked on it, 
+	// the flag exchange guarantees one signal per wait.
+	if (m_parked.exchange(false))
+	{
+		m_park.Signal();
+	}
+}
+
+inline void ndThreadPool::ndWorker::SetTask(ndTask* const task)
+{
+	m_task.store(task);
+	WakeUp();
+}
+
 template <typename Type, typename ... Args>
 class ndFunction
 	:public ndFunction<decltype(&Type::operator())(Args...)>
@@ -194,7 +356,7 @@ void ndThreadPool::ParallelExecute(const Function& callback)
 		for (ndInt32 i = 0; i < m_count; ++i)
 		{
 			ndTaskImplement<Function>* const job = &jobsArray[i];
-			m_workers[i].m_task.store(job);
+			m_workers[i].SetTask(job);
 		}
 	
 		ndTaskImplement<Function>* const job = &jobsArray[m_count];
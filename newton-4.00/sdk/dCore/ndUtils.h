@@ -229,6 +229,16 @@ class ndSpinLock
 		#endif
 	}
 
+	bool TryLock()
+	{
+		#ifndef D_USE_THREAD_EMULATION	
+			ndUnsigned32 test = 0;
+			return m_lock.compare_exchange_strong(test, 1);
+		#else
+			return true;
+		#endif
+	}
+
 	void Unlock()
 	{
 		#ifndef D_USE_THREAD_EMULATION	
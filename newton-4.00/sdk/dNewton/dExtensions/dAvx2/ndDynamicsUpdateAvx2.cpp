@@ -1556,6 +1556,7 @@ void ndDynamicsUpdateAvx2::InitSkeletons()
 	{
 		scene->ParallelExecute(InitSkeletons);
 	}
+	InitParallelSkeletons();
 }
 
 void ndDynamicsUpdateAvx2::UpdateSkeletons()
@@ -1580,6 +1581,7 @@ void ndDynamicsUpdateAvx2::UpdateSkeletons()
 	{
 		scene->ParallelExecute(UpdateSkeletons);
 	}
+	UpdateParallelSkeletons();
 }
 
 void ndDynamicsUpdateAvx2::CalculateJointsAcceleration()
@@ -0,0 +1,1795 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndDynamicsUpdateAvx512.h"
+
+#define D_AVX_WORK_GROUP			16
+#define D_AVX_DEFAULT_BUFFER_SIZE	1024
+
+// all the classes of this file have their own names, so that they
+// do not collide with the ones of the avx2 solver when both are loaded.
+D_MSV_NEWTON_ALIGN_32
+class ndAvx512Float
+{
+	public:
+	inline ndAvx512Float()
+	{
+	}
+
+	inline ndAvx512Float(const ndFloat32 val)
+		:m_type(_mm512_set1_ps(val))
+	{
+	}
+
+	inline ndAvx512Float(const ndInt32 val)
+		:m_type(_mm512_castsi512_ps(_mm512_set1_epi32(val)))
+	{
+	}
+
+	inline ndAvx512Float(const __m512 type)
+		:m_type(type)
+	{
+	}
+
+	inline ndAvx512Float(const ndAvx512Float& copy)
+		:m_type(copy.m_type)
+	{
+	}
+
+	inline ndAvx512Float(const ndVector& v0, const ndVector& v1, const ndVector& v2, const ndVector& v3)
+	{
+		m_vector4[0] = v0;
+		m_vector4[1] = v1;
+		m_vector4[2] = v2;
+		m_vector4[3] = v3;
+	}
+
+	// load two consecutive jacobians, the memory is only 32 bytes aligned
+	inline ndAvx512Float(const ndJacobian* const pair)
+		:m_type(_mm512_loadu_ps(&pair->m_linear.m_x))
+	{
+	}
+
+	inline ndAvx512Float(const ndAvx512Float* const baseAddr, const ndAvx512Float& index)
+		:m_type(_mm512_i32gather_ps(index.m_typeInt, &(*baseAddr)[0], 4))
+	{
+	}
+
+	// lanes not in the mask are set to zero, and their index is never read.
+	inline ndAvx512Float(const ndFloat32* const baseAddr, const ndAvx512Float& index, __mmask16 mask)
+		:m_type(_mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, index.m_typeInt, baseAddr, 4))
+	{
+	}
+
+	inline void Store(ndJacobian* const pair) const
+	{
+		_mm512_storeu_ps(&pair->m_linear.m_x, m_type);
+	}
+
+	inline ndFloat32& operator[] (ndInt32 i)
+	{
+		ndAssert(i >= 0);
+		ndAssert(i < D_AVX_WORK_GROUP);
+		ndFloat32* const ptr = (ndFloat32*)&m_type;
+		return ptr[i];
+	}
+
+	inline const ndFloat32& operator[] (ndInt32 i) const
+	{
+		ndAssert(i >= 0);
+		ndAssert(i < D_AVX_WORK_GROUP);
+		const ndFloat32* const ptr = (ndFloat32*)&m_type;
+		return ptr[i];
+	}
+
+	inline ndAvx512Float operator+ (const ndAvx512Float& A) const
+	{
+		return _mm512_add_ps(m_type, A.m_type);
+	}
+
+	inline ndAvx512Float operator- (const ndAvx512Float& A) const
+	{
+		return _mm512_sub_ps(m_type, A.m_type);
+	}
+
+	inline ndAvx512Float operator* (const ndAvx512Float& A) const
+	{
+		return _mm512_mul_ps(m_type, A.m_type);
+	}
+
+	inline ndAvx512Float MulAdd(const ndAvx512Float& A, const ndAvx512Float& B) const
+	{
+		return _mm512_fmadd_ps(A.m_type, B.m_type, m_type);
+	}
+
+	inline ndAvx512Float MulSub(const ndAvx512Float& A, const ndAvx512Float& B) const
+	{
+		return _mm512_fnmadd_ps(A.m_type, B.m_type, m_type);
+	}
+
+	// comparisons go to a mask register, not to a vector register.
+	inline __mmask16 operator> (const ndAvx512Float& A) const
+	{
+		return _mm512_cmp_ps_mask(m_type, A.m_type, _CMP_GT_OQ);
+	}
+
+	inline __mmask16 operator< (const ndAvx512Float& A) const
+	{
+		return _mm512_cmp_ps_mask(m_type, A.m_type, _CMP_LT_OQ);
+	}
+
+	inline ndAvx512Float operator& (const __mmask16 mask) const
+	{
+		return _mm512_maskz_mov_ps(mask, m_type);
+	}
+
+	inline ndAvx512Float GetMin(const ndAvx512Float& A) const
+	{
+		return _mm512_min_ps(m_type, A.m_type);
+	}
+
+	inline ndAvx512Float GetMax(const ndAvx512Float& A) const
+	{
+		return _mm512_max_ps(m_type, A.m_type);
+	}
+
+	inline ndAvx512Float Select(const ndAvx512Float& data, const __mmask16 mask) const
+	{
+		return _mm512_mask_mov_ps(m_type, mask, data.m_type);
+	}
+
+	inline ndFloat32 GetMax() const
+	{
+		return _mm512_reduce_max_ps(m_type);
+	}
+
+	inline ndFloat32 AddHorizontal() const
+	{
+		return _mm512_reduce_add_ps(m_type);
+	}
+
+	union
+	{
+		__m512 m_type;
+		__m512i m_typeInt;
+		ndVector m_vector4[4];
+		ndInt32 m_int[D_AVX_WORK_GROUP];
+	};
+
+	static ndAvx512Float m_one;
+	static ndAvx512Float m_zero;
+	static ndAvx512Float m_ordinals;
+} D_GCC_NEWTON_ALIGN_32;
+
+ndAvx512Float ndAvx512Float::m_one(ndFloat32(1.0f));
+ndAvx512Float ndAvx512Float::m_zero(ndFloat32(0.0f));
+ndAvx512Float ndAvx512Float::m_ordinals(ndVector(0, 1, 2, 3), ndVector(4, 5, 6, 7), ndVector(8, 9, 10, 11), ndVector(12, 13, 14, 15));
+
+D_MSV_NEWTON_ALIGN_32
+class ndAvx512Vector3
+{
+	public:
+	ndAvx512Float m_x;
+	ndAvx512Float m_y;
+	ndAvx512Float m_z;
+} D_GCC_NEWTON_ALIGN_32;
+
+D_MSV_NEWTON_ALIGN_32
+class ndAvx512Vector6
+{
+	public:
+	// transpose one jacobian of each of the sixteen joints of a group,
+	// each half goes through an 8 x 8 transpose and the halves are merged.
+	inline void Transpose(const ndJacobian* const* const src)
+	{
+		__m256 low[8];
+		__m256 high[8];
+		Transpose8x8(low, &src[0]);
+		Transpose8x8(high, &src[8]);
+
+		m_linear.m_x.m_type = _mm512_insertf32x8(_mm512_castps256_ps512(low[0]), high[0], 1);
+		m_linear.m_y.m_type = _mm512_insertf32x8(_mm512_castps256_ps512(low[1]), high[1], 1);
+		m_linear.m_z.m_type = _mm512_insertf32x8(_mm512_castps256_ps512(low[2]), high[2], 1);
+		m_angular.m_x.m_type = _mm512_insertf32x8(_mm512_castps256_ps512(low[4]), high[4], 1);
+		m_angular.m_y.m_type = _mm512_insertf32x8(_mm512_castps256_ps512(low[5]), high[5], 1);
+		m_angular.m_z.m_type = _mm512_insertf32x8(_mm512_castps256_ps512(low[6]), high[6], 1);
+	}
+
+	ndAvx512Vector3 m_linear;
+	ndAvx512Vector3 m_angular;
+
+	private:
+	static inline void Transpose8x8(__m256* const dst, const ndJacobian* const* const src)
+	{
+		__m256 rows[8];
+		for (ndInt32 i = 0; i < 8; ++i)
+		{
+			rows[i] = _mm256_loadu_ps(&src[i]->m_linear.m_x);
+		}
+
+		__m256 blocks4x4[8];
+		blocks4x4[0] = _mm256_permute2f128_ps(rows[0], rows[4], 0x20);
+		blocks4x4[1] = _mm256_permute2f128_ps(rows[0], rows[4], 0x31);
+		blocks4x4[2] = _mm256_permute2f128_ps(rows[1], rows[5], 0x20);
+		blocks4x4[3] = _mm256_permute2f128_ps(rows[1], rows[5], 0x31);
+		blocks4x4[4] = _mm256_permute2f128_ps(rows[2], rows[6], 0x20);
+		blocks4x4[5] = _mm256_permute2f128_ps(rows[2], rows[6], 0x31);
+		blocks4x4[6] = _mm256_permute2f128_ps(rows[3], rows[7], 0x20);
+		blocks4x4[7] = _mm256_permute2f128_ps(rows[3], rows[7], 0x31);
+
+		__m256 blocks2x2[8];
+		blocks2x2[0] = _mm256_unpacklo_ps(blocks4x4[0], blocks4x4[4]);
+		blocks2x2[1] = _mm256_unpackhi_ps(blocks4x4[0], blocks4x4[4]);
+		blocks2x2[2] = _mm256_unpacklo_ps(blocks4x4[1], blocks4x4[5]);
+		blocks2x2[3] = _mm256_unpackhi_ps(blocks4x4[1], blocks4x4[5]);
+		blocks2x2[4] = _mm256_unpacklo_ps(blocks4x4[2], blocks4x4[6]);
+		blocks2x2[5] = _mm256_unpackhi_ps(blocks4x4[2], blocks4x4[6]);
+		blocks2x2[6] = _mm256_unpacklo_ps(blocks4x4[3], blocks4x4[7]);
+		blocks2x2[7] = _mm256_unpackhi_ps(blocks4x4[3], blocks4x4[7]);
+
+		dst[0] = _mm256_unpacklo_ps(blocks2x2[0], blocks2x2[4]);
+		dst[1] = _mm256_unpackhi_ps(blocks2x2[0], blocks2x2[4]);
+		dst[2] = _mm256_unpacklo_ps(blocks2x2[1], blocks2x2[5]);
+		dst[3] = _mm256_unpackhi_ps(blocks2x2[1], blocks2x2[5]);
+		dst[4] = _mm256_unpacklo_ps(blocks2x2[2], blocks2x2[6]);
+		dst[5] = _mm256_unpackhi_ps(blocks2x2[2], blocks2x2[6]);
+		dst[6] = _mm256_unpacklo_ps(blocks2x2[3], blocks2x2[7]);
+		dst[7] = _mm256_unpackhi_ps(blocks2x2[3], blocks2x2[7]);
+	}
+} D_GCC_NEWTON_ALIGN_32;
+
+D_MSV_NEWTON_ALIGN_32
+class ndAvx512JacobianPair
+{
+	public:
+	ndAvx512Vector6 m_jacobianM0;
+	ndAvx512Vector6 m_jacobianM1;
+} D_GCC_NEWTON_ALIGN_32;
+
+D_MSV_NEWTON_ALIGN_32
+class ndAvx512MatrixElement
+{
+	public:
+	ndAvx512JacobianPair m_Jt;
+	ndAvx512JacobianPair m_JMinv;
+
+	ndAvx512Float m_force;
+	ndAvx512Float m_diagDamp;
+	ndAvx512Float m_invJinvMJt;
+	ndAvx512Float m_coordenateAccel;
+	ndAvx512Float m_normalForceIndex;
+	ndAvx512Float m_lowerBoundFrictionCoefficent;
+	ndAvx512Float m_upperBoundFrictionCoefficent;
+} D_GCC_NEWTON_ALIGN_32;
+
+// the engine allocator only aligns memory to 32 bytes,
+// so the rows are placed at the first 64 bytes boundary of the buffer.
+class ndAvx512MatrixArray
+{
+	public:
+	ndAvx512MatrixArray()
+		:m_buffer(D_AVX_DEFAULT_BUFFER_SIZE)
+		,m_rows(nullptr)
+		,m_count(0)
+	{
+	}
+
+	void SetCount(ndInt32 count)
+	{
+		m_buffer.SetCount(ndInt32(count * sizeof(ndAvx512MatrixElement) + 64));
+		const ndUnsigned64 address = (ndUnsigned64(&m_buffer[0]) + 63) & ~ndUnsigned64(63);
+		m_rows = (ndAvx512MatrixElement*)address;
+		m_count = count;
+	}
+
+	ndAvx512MatrixElement& operator[] (ndInt32 i)
+	{
+		ndAssert(i >= 0);
+		ndAssert(i < m_count);
+		return m_rows[i];
+	}
+
+	ndArray<ndUnsigned8> m_buffer;
+	ndAvx512MatrixElement* m_rows;
+	ndInt32 m_count;
+};
+
+ndDynamicsUpdateAvx512::ndDynamicsUpdateAvx512(ndWorld* const world)
+	:ndDynamicsUpdate(world)
+	,m_groupType(D_AVX_DEFAULT_BUFFER_SIZE)
+	,m_jointMask(D_AVX_DEFAULT_BUFFER_SIZE)
+	,m_avxJointRows(D_AVX_DEFAULT_BUFFER_SIZE)
+	,m_avxMassMatrixArray(new ndAvx512MatrixArray)
+{
+}
+
+ndDynamicsUpdateAvx512::~ndDynamicsUpdateAvx512()
+{
+	Clear();
+	m_jointMask.Resize(D_AVX_DEFAULT_BUFFER_SIZE);
+	m_groupType.Resize(D_AVX_DEFAULT_BUFFER_SIZE);
+	m_avxJointRows.Resize(D_AVX_DEFAULT_BUFFER_SIZE);
+	delete m_avxMassMatrixArray;
+}
+
+const char* ndDynamicsUpdateAvx512::GetStringId() const
+{
+	return "avx512";
+}
+
+void ndDynamicsUpdateAvx512::DetermineSleepStates()
+{
+	D_TRACKTIME();
+	auto CalculateSleepState = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateSleepState);
+		ndScene* const scene = m_world->GetScene();
+		const ndArray<ndInt32>& bodyIndex = GetJointForceIndexBuffer();
+		const ndJointBodyPairIndex* const jointBodyPairIndexBuffer = &GetJointBodyPairIndexBuffer()[0];
+		ndConstraint** const jointArray = &scene->GetActiveContactArray()[0];
+		ndBodyKinematic** const bodyArray = &scene->GetActiveBodyArray()[0];
+
+		const ndVector zero(ndVector::m_zero);
+		const ndStartEnd startEnd(bodyIndex.GetCount() - 1, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndInt32 index = bodyIndex[i];
+			ndBodyKinematic* const body = bodyArray[jointBodyPairIndexBuffer[index].m_body];
+			ndAssert(body->m_isStatic <= 1);
+			ndAssert(body->m_index == jointBodyPairIndexBuffer[index].m_body);
+			const ndInt32 mask = ndInt32(body->m_isStatic) - 1;
+			const ndInt32 count = mask & (bodyIndex[i + 1] - index);
+			if (count)
+			{
+				ndUnsigned8 equilibrium = body->m_isJointFence0;
+				if (equilibrium & body->m_autoSleep)
+				{
+					for (ndInt32 j = 0; j < count; ++j)
+					{
+						const ndJointBodyPairIndex& scan = jointBodyPairIndexBuffer[index + j];
+						ndConstraint* const joint = jointArray[scan.m_joint >> 1];
+						ndBodyKinematic* const body1 = (joint->GetBody0() == body) ? joint->GetBody1() : joint->GetBody0();
+						ndAssert(body1 != body);
+						equilibrium = ndUnsigned8(equilibrium & body1->m_isJointFence0);
+					}
+				}
+				body->m_equilibrium = ndUnsigned8(equilibrium & body->m_autoSleep);
+				if (body->m_equilibrium)
+				{
+					body->m_veloc = zero;
+					body->m_omega = zero;
+				}
+			}
+		}
+	});
+
+	ndScene* const scene = m_world->GetScene();
+	if (scene->GetActiveContactArray().GetCount())
+	{
+		scene->ParallelExecute(CalculateSleepState);
+	}
+}
+
+void ndDynamicsUpdateAvx512::SortJoints()
+{
+	D_TRACKTIME();
+	SortJointsScan();
+	if (!m_activeJointCount)
+	{
+		return;
+	}
+
+	ndScene* const scene = m_world->GetScene();
+	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	#ifdef _DEBUG
+		for (ndInt32 i = 1; i < m_activeJointCount; ++i)
+		{
+			ndConstraint* const joint0 = jointArray[i - 1];
+			ndConstraint* const joint1 = jointArray[i - 0];
+			ndAssert(!joint0->m_resting);
+			ndAssert(!joint1->m_resting);
+			ndAssert(joint0->m_rowCount >= joint1->m_rowCount);
+			ndAssert(!(joint0->GetBody0()->m_equilibrium0 & joint0->GetBody1()->m_equilibrium0));
+			ndAssert(!(joint1->GetBody0()->m_equilibrium0 & joint1->GetBody1()->m_equilibrium0));
+		}
+
+		for (ndInt32 i = m_activeJointCount + 1; i < jointArray.GetCount(); ++i)
+		{
+			ndConstraint* const joint0 = jointArray[i - 1];
+			ndConstraint* const joint1 = jointArray[i - 0];
+			ndAssert(joint0->m_resting);
+			ndAssert(joint1->m_resting);
+			ndAssert(joint0->m_rowCount >= joint1->m_rowCount);
+			ndAssert(joint0->GetBody0()->m_equilibrium0 & joint0->GetBody1()->m_equilibrium0);
+			ndAssert(joint1->GetBody0()->m_equilibrium0 & joint1->GetBody1()->m_equilibrium0);
+		}
+	#endif
+
+	const ndInt32 mask = -ndInt32(D_AVX_WORK_GROUP);
+	const ndInt32 jointCount = jointArray.GetCount();
+	const ndInt32 soaJointCount = (jointCount + D_AVX_WORK_GROUP - 1) & mask;
+	ndAssert(jointArray.GetCapacity() > soaJointCount);
+	ndConstraint** const jointArrayPtr = &jointArray[0];
+	for (ndInt32 i = jointCount; i < soaJointCount; ++i)
+	{
+		jointArrayPtr[i] = nullptr;
+	}
+
+	if (m_activeJointCount - jointArray.GetCount())
+	{
+		const ndInt32 base = m_activeJointCount & mask;
+		const ndInt32 count = jointArrayPtr[base + D_AVX_WORK_GROUP - 1] ? D_AVX_WORK_GROUP : jointArray.GetCount() - base;
+		ndAssert(count <= D_AVX_WORK_GROUP);
+		ndConstraint** const array = &jointArrayPtr[base];
+		for (ndInt32 j = 1; j < count; ++j)
+		{
+			ndInt32 slot = j;
+			ndConstraint* const joint = array[slot];
+			for (; (slot > 0) && (array[slot - 1]->m_rowCount < joint->m_rowCount); slot--)
+			{
+				array[slot] = array[slot - 1];
+			}
+			array[slot] = joint;
+		}
+	}
+
+	const ndInt32 soaJointCountBatches = soaJointCount / D_AVX_WORK_GROUP;
+	m_jointMask.SetCount(soaJointCountBatches);
+	m_groupType.SetCount(soaJointCountBatches);
+	m_avxJointRows.SetCount(soaJointCountBatches);
+	
+	ndInt32 rowsCount = 0;
+	ndInt32 soaJointRowCount = 0;
+	auto SetRowStarts = ndMakeObject::ndFunction([this, &jointArray, &rowsCount, &soaJointRowCount](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(SetRowStarts);
+		auto SetRowsCount = [&jointArray, &rowsCount]()
+		{
+			ndInt32 rowCount = 1;
+			const ndInt32 count = jointArray.GetCount();
+			for (ndInt32 i = 0; i < count; ++i)
+			{
+				ndConstraint* const joint = jointArray[i];
+				joint->m_rowStart = rowCount;
+				rowCount += joint->m_rowCount;
+			}
+			rowsCount = rowCount;
+		};
+
+		auto SetSoaRowsCount = [this, &jointArray, &soaJointRowCount]()
+		{
+			ndInt32 rowCount = 0;
+			ndArray<ndInt32>& soaJointRows = m_avxJointRows;
+			const ndInt32 count = soaJointRows.GetCount();
+			for (ndInt32 i = 0; i < count; ++i)
+			{
+				const ndConstraint* const joint = jointArray[i * D_AVX_WORK_GROUP];
+				soaJointRows[i] = rowCount;
+				rowCount += joint->m_rowCount;
+			}
+			soaJointRowCount = rowCount;
+		};
+
+		if (threadCount == 1)
+		{
+			SetRowsCount();
+			SetSoaRowsCount();
+		}
+		else if (threadIndex == 0)
+		{
+			SetRowsCount();
+		}
+		else if (threadIndex == (threadCount - 1))
+		{
+			SetSoaRowsCount();
+		}
+	});
+	scene->ParallelExecute(SetRowStarts);
+
+	m_leftHandSide.SetCount(rowsCount);
+	m_rightHandSide.SetCount(rowsCount);
+	m_avxMassMatrixArray->SetCount(soaJointRowCount);
+
+	#ifdef _DEBUG
+		ndAssert(m_activeJointCount <= jointArray.GetCount());
+		const ndInt32 maxRowCount = m_leftHandSide.GetCount();
+		for (ndInt32 i = 0; i < jointArray.GetCount(); ++i)
+		{
+			ndConstraint* const joint = jointArray[i];
+			ndAssert(joint->m_rowStart < m_leftHandSide.GetCount());
+			ndAssert((joint->m_rowStart + joint->m_rowCount) <= maxRowCount);
+		}
+
+		for (ndInt32 i = 0; i < jointCount; i += D_AVX_WORK_GROUP)
+		{
+			const ndInt32 count = jointArrayPtr[i + D_AVX_WORK_GROUP - 1] ? D_AVX_WORK_GROUP : jointCount - i;
+			for (ndInt32 j = 1; j < count; ++j)
+			{
+				ndConstraint* const joint0 = jointArrayPtr[i + j - 1];
+				ndConstraint* const joint1 = jointArrayPtr[i + j - 0];
+				ndAssert(joint0->m_rowCount >= joint1->m_rowCount);
+			}
+		}
+	#endif
+	SortBodyJointScan();
+}
+
+void ndDynamicsUpdateAvx512::SortIslands()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	ndArray<ndBodyKinematic*>& activeBodyArray = GetBodyIslandOrder();
+	GetInternalForces().SetCount(bodyArray.GetCount());
+	activeBodyArray.SetCount(bodyArray.GetCount());
+
+	ndInt32 histogram[D_MAX_THREADS_COUNT][3];
+	auto Scan0 = ndMakeObject::ndFunction([&bodyArray, &histogram](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(Scan0);
+		ndInt32* const hist = &histogram[threadIndex][0];
+		hist[0] = 0;
+		hist[1] = 0;
+		hist[2] = 0;
+
+		ndInt32 map[4];
+		map[0] = 0;
+		map[1] = 1;
+		map[2] = 2;
+		map[3] = 2;
+		const ndStartEnd startEnd(bodyArray.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBodyKinematic* const body = bodyArray[i];
+			ndInt32 key = map[body->m_equilibrium0 * 2 + 1 - body->m_isConstrained];
+			ndAssert(key < 3);
+			hist[key] = hist[key] + 1;
+		}
+	});
+
+	auto Sort0 = ndMakeObject::ndFunction([&bodyArray, &activeBodyArray, &histogram](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(Sort0);
+		ndInt32* const hist = &histogram[threadIndex][0];
+		const ndStartEnd startEnd(bodyArray.GetCount(), threadIndex, threadCount);
+
+		ndInt32 map[4];
+		map[0] = 0;
+		map[1] = 1;
+		map[2] = 2;
+		map[3] = 2;
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBodyKinematic* const body = bodyArray[i];
+			ndInt32 key = map[body->m_equilibrium0 * 2 + 1 - body->m_isConstrained];
+			ndAssert(key < 3);
+			const ndInt32 entry = hist[key];
+			activeBodyArray[entry] = body;
+			hist[key] = entry + 1;
+		}
+	});
+
+	scene->ParallelExecute(Scan0);
+
+	ndInt32 scan[3];
+	scan[0] = 0;
+	scan[1] = 0;
+	scan[2] = 0;
+	const ndInt32 threadCount = scene->GetThreadCount();
+
+	ndInt32 sum = 0;
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			ndInt32 partialSum = histogram[j][i];
+			histogram[j][i] = sum;
+			sum += partialSum;
+		}
+		scan[i] = sum;
+	}
+
+	scene->ParallelExecute(Sort0);
+	activeBodyArray.SetCount(scan[1]);
+	m_unConstrainedBodyCount = scan[1] - scan[0];
+}
+
+void ndDynamicsUpdateAvx512::BuildIsland()
+{
+	m_unConstrainedBodyCount = 0;
+	GetBodyIslandOrder().SetCount(0);
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	ndAssert(bodyArray.GetCount() >= 1);
+	if (bodyArray.GetCount() - 1)
+	{
+		D_TRACKTIME();
+		SortJoints();
+		SortIslands();
+	}
+}
+
+void ndDynamicsUpdateAvx512::IntegrateUnconstrainedBodies()
+{
+	ndScene* const scene = m_world->GetScene();
+	auto IntegrateUnconstrainedBodies = ndMakeObject::ndFunction([this, &scene](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(IntegrateUnconstrainedBodies);
+		ndArray<ndBodyKinematic*>& bodyArray = GetBodyIslandOrder();
+
+		const ndFloat32 timestep = scene->GetTimestep();
+		const ndInt32 base = bodyArray.GetCount() - GetUnconstrainedBodyCount();
+
+		const ndStartEnd startEnd(GetUnconstrainedBodyCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBodyKinematic* const body = bodyArray[base + i];
+			ndAssert(body);
+			body->UpdateInvInertiaMatrix();
+			body->AddDampingAcceleration(timestep);
+			body->IntegrateExternalForce(timestep);
+		}
+	});
+
+	if (GetUnconstrainedBodyCount())
+	{
+		D_TRACKTIME();
+		scene->ParallelExecute(IntegrateUnconstrainedBodies);
+	}
+}
+
+void ndDynamicsUpdateAvx512::IntegrateBodies()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndVector invTime(m_invTimestep);
+	const ndFloat32 timestep = scene->GetTimestep();
+
+	auto IntegrateBodies = ndMakeObject::ndFunction([this, timestep, invTime](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(IntegrateBodies);
+		const ndWorld* const world = m_world;
+		const ndArray<ndBodyKinematic*>& bodyArray = GetBodyIslandOrder();
+		const ndStartEnd startEnd(bodyArray.GetCount(), threadIndex, threadCount);
+
+		const ndFloat32 speedFreeze2 = world->m_freezeSpeed2;
+		const ndFloat32 accelFreeze2 = world->m_freezeAccel2;
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBodyKinematic* const body = bodyArray[i];
+			if (!body->m_equilibrium)
+			{
+				body->m_accel = invTime * (body->m_veloc - body->m_accel);
+				body->m_alpha = invTime * (body->m_omega - body->m_alpha);
+				body->IntegrateVelocity(timestep);
+			}
+			body->EvaluateSleepState(speedFreeze2, accelFreeze2);
+		}
+	});
+	scene->ParallelExecute(IntegrateBodies);
+}
+
+void ndDynamicsUpdateAvx512::InitWeights()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	m_invTimestep = ndFloat32(1.0f) / m_timestep;
+	m_invStepRK = ndFloat32(0.25f);
+	m_timestepRK = m_timestep * m_invStepRK;
+	m_invTimestepRK = m_invTimestep * ndFloat32(4.0f);
+
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	const ndInt32 bodyCount = bodyArray.GetCount();
+	GetInternalForces().SetCount(bodyCount);
+
+	ndInt32 extraPassesArray[D_MAX_THREADS_COUNT];
+
+	auto InitWeights = ndMakeObject::ndFunction([this, &bodyArray, &extraPassesArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(InitWeights);
+		const ndArray<ndInt32>& jointForceIndexBuffer = GetJointForceIndexBuffer();
+		const ndArray<ndJointBodyPairIndex>& jointBodyPairIndex = GetJointBodyPairIndexBuffer();
+
+		ndInt32 maxExtraPasses = 1;
+		const ndStartEnd startEnd(jointForceIndexBuffer.GetCount() - 1, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndInt32 index = jointForceIndexBuffer[i];
+			const ndJointBodyPairIndex& scan = jointBodyPairIndex[index];
+			ndBodyKinematic* const body = bodyArray[scan.m_body];
+			ndAssert(body->m_index == scan.m_body);
+			ndAssert(body->m_isConstrained <= 1);
+			const ndInt32 count = jointForceIndexBuffer[i + 1] - index - 1;
+			const ndInt32 mask = -ndInt32(body->m_isConstrained & ~body->m_isStatic);
+			const ndInt32 weigh = 1 + (mask & count);
+			ndAssert(weigh >= 0);
+			if (weigh)
+			{
+				body->m_weigh = ndFloat32(weigh);
+			}
+			maxExtraPasses = ndMax(weigh, maxExtraPasses);
+		}
+		extraPassesArray[threadIndex] = maxExtraPasses;
+	});
+
+	if (scene->GetActiveContactArray().GetCount())
+	{
+
+		scene->ParallelExecute(InitWeights);
+
+		ndInt32 extraPasses = 0;
+		const ndInt32 threadCount = scene->GetThreadCount();
+		for (ndInt32 i = 0; i < threadCount; ++i)
+		{
+			extraPasses = ndMax(extraPasses, extraPassesArray[i]);
+		}
+
+		const ndInt32 conectivity = 7;
+		m_solverPasses = ndUnsigned32(m_world->GetSolverIterations() + 2 * extraPasses / conectivity + 2);
+	}
+}
+
+void ndDynamicsUpdateAvx512::InitBodyArray()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndFloat32 timestep = scene->GetTimestep();
+
+	auto InitBodyArray = ndMakeObject::ndFunction([this, timestep](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(InitBodyArray);
+		const ndArray<ndBodyKinematic*>& bodyArray = GetBodyIslandOrder();
+		const ndStartEnd startEnd(bodyArray.GetCount() - GetUnconstrainedBodyCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBodyKinematic* const body = bodyArray[i];
+			ndAssert(body);
+			ndAssert(body->m_isConstrained | body->m_isStatic);
+
+			body->UpdateInvInertiaMatrix();
+			body->AddDampingAcceleration(timestep);
+			const ndVector angularMomentum(body->CalculateAngularMomentum());
+			body->m_gyroTorque = body->m_omega.CrossProduct(angularMomentum);
+			body->m_gyroAlpha = body->m_invWorldInertiaMatrix.RotateVector(body->m_gyroTorque);
+
+			body->m_accel = body->m_veloc;
+			body->m_alpha = body->m_omega;
+			body->m_gyroRotation = body->m_rotation;
+		}
+	});
+	scene->ParallelExecute(InitBodyArray);
+}
+
+void ndDynamicsUpdateAvx512::GetJacobianDerivatives(ndConstraint* const joint)
+{
+	ndConstraintDescritor constraintParam;
+	ndAssert(joint->GetRowsCount() <= D_CONSTRAINT_MAX_ROWS);
+	for (ndInt32 i = ndInt32(joint->GetRowsCount() - 1); i >= 0; i--)
+	{
+		constraintParam.m_forceBounds[i].m_low = D_MIN_BOUND;
+		constraintParam.m_forceBounds[i].m_upper = D_MAX_BOUND;
+		constraintParam.m_forceBounds[i].m_jointForce = nullptr;
+		constraintParam.m_forceBounds[i].m_normalIndex = D_INDEPENDENT_ROW;
+	}
+
+	constraintParam.m_rowsCount = 0;
+	constraintParam.m_timestep = m_timestep;
+	constraintParam.m_invTimestep = m_invTimestep;
+	joint->JacobianDerivative(constraintParam);
+	const ndInt32 dof = constraintParam.m_rowsCount;
+	ndAssert(dof <= joint->m_rowCount);
+
+	if (joint->GetAsContact())
+	{
+		ndContact* const contactJoint = joint->GetAsContact();
+		contactJoint->m_isInSkeletonLoop = 0;
+		ndSkeletonContainer* const skeleton0 = contactJoint->GetBody0()->GetSkeleton();
+		ndSkeletonContainer* const skeleton1 = contactJoint->GetBody1()->GetSkeleton();
+		if (skeleton0 && (skeleton0 == skeleton1))
+		{
+			if (contactJoint->IsSkeletonSelftCollision())
+			{
+				contactJoint->m_isInSkeletonLoop = 1;
+				skeleton0->AddCloseLoopJoint(contactJoint);
+			}
+		}
+		else if (contactJoint->IsSkeletonIntraCollision())
+		{
+			if (skeleton0 && !skeleton1)
+			{
+				contactJoint->m_isInSkeletonLoop = 1;
+				skeleton0->AddCloseLoopJoint(contactJoint);
+			}
+			else if (skeleton1 && !skeleton0)
+			{
+				contactJoint->m_isInSkeletonLoop = 1;
+				skeleton1->AddCloseLoopJoint(contactJoint);
+			}
+		}
+	}
+	else
+	{
+		ndJointBilateralConstraint* const bilareral = joint->GetAsBilateral();
+		ndAssert(bilareral);
+		if (!bilareral->m_isInSkeleton && (bilareral->GetSolverModel() == m_jointkinematicAttachment))
+		{
+			ndSkeletonContainer* const skeleton0 = bilareral->m_body0->GetSkeleton();
+			ndSkeletonContainer* const skeleton1 = bilareral->m_body1->GetSkeleton();
+			if (skeleton0 || skeleton1)
+			{
+				if (skeleton0 && !skeleton1)
+				{
+					bilareral->m_isInSkeletonLoop = 1;
+					skeleton0->AddCloseLoopJoint(bilareral);
+				}
+				else if (skeleton1 && !skeleton0)
+				{
+					bilareral->m_isInSkeletonLoop = 1;
+					skeleton1->AddCloseLoopJoint(bilareral);
+				}
+			}
+		}
+	}
+
+	joint->m_rowCount = dof;
+	const ndInt32 baseIndex = joint->m_rowStart;
+	for (ndInt32 i = 0; i < dof; ++i)
+	{
+		ndAssert(constraintParam.m_forceBounds[i].m_jointForce);
+
+		ndLeftHandSide* const row = &m_leftHandSide[baseIndex + i];
+		ndRightHandSide* const rhs = &m_rightHandSide[baseIndex + i];
+
+		row->m_Jt = constraintParam.m_jacobian[i];
+		rhs->m_diagDamp = ndFloat32(0.0f);
+		rhs->m_diagonalRegularizer = ndMax(constraintParam.m_diagonalRegularizer[i], ndFloat32(1.0e-5f));
+
+		rhs->m_coordenateAccel = constraintParam.m_jointAccel[i];
+		rhs->m_restitution = constraintParam.m_restitution[i];
+		rhs->m_penetration = constraintParam.m_penetration[i];
+		rhs->m_penetrationStiffness = constraintParam.m_penetrationStiffness[i];
+		rhs->m_lowerBoundFrictionCoefficent = constraintParam.m_forceBounds[i].m_low;
+		rhs->m_upperBoundFrictionCoefficent = constraintParam.m_forceBounds[i].m_upper;
+		rhs->m_jointFeebackForce = constraintParam.m_forceBounds[i].m_jointForce;
+
+		ndAssert(constraintParam.m_forceBounds[i].m_normalIndex >= -1);
+		rhs->m_normalForceIndex = constraintParam.m_forceBounds[i].m_normalIndex;
+	}
+}
+
+void ndDynamicsUpdateAvx512::InitJacobianMatrix()
+{
+	ndScene* const scene = m_world->GetScene();
+	ndBodyKinematic** const bodyArray = &scene->GetActiveBodyArray()[0];
+	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(InitJacobianMatrix);
+		ndJacobian* const internalForces = &GetTempInternalForces()[0];
+		auto BuildJacobianMatrix = [this, &internalForces](ndConstraint* const joint, ndInt32 jointIndex)
+		{
+			ndAssert(joint->GetBody0());
+			ndAssert(joint->GetBody1());
+			const ndBodyKinematic* const body0 = joint->GetBody0();
+			const ndBodyKinematic* const body1 = joint->GetBody1();
+
+			// the two jacobians of a row fit in one register,
+			// so each row is one multiply and one reduction.
+			const ndAvx512Float force(body0->GetForce(), body0->GetTorque(), body1->GetForce(), body1->GetTorque());
+
+			const ndInt32 index = joint->m_rowStart;
+			const ndInt32 count = joint->m_rowCount;
+
+			const bool isBilateral = joint->IsBilateral();
+
+			const ndMatrix& invInertia0 = body0->m_invWorldInertiaMatrix;
+			const ndMatrix& invInertia1 = body1->m_invWorldInertiaMatrix;
+			const ndVector invMass0(body0->m_invMass[3]);
+			const ndVector invMass1(body1->m_invMass[3]);
+
+			ndAvx512Float forceAcc(ndAvx512Float::m_zero);
+			const ndVector weigh0(body0->m_weigh);
+			const ndVector weigh1(body1->m_weigh);
+			const ndAvx512Float weigh(weigh0, weigh0, weigh1, weigh1);
+
+			for (ndInt32 i = 0; i < count; ++i)
+			{
+				ndLeftHandSide* const row = &m_leftHandSide[index + i];
+				ndRightHandSide* const rhs = &m_rightHandSide[index + i];
+
+				row->m_JMinv.m_jacobianM0.m_linear = row->m_Jt.m_jacobianM0.m_linear * invMass0;
+				row->m_JMinv.m_jacobianM0.m_angular = invInertia0.RotateVector(row->m_Jt.m_jacobianM0.m_angular);
+				row->m_JMinv.m_jacobianM1.m_linear = row->m_Jt.m_jacobianM1.m_linear * invMass1;
+				row->m_JMinv.m_jacobianM1.m_angular = invInertia1.RotateVector(row->m_Jt.m_jacobianM1.m_angular);
+
+				const ndAvx512Float JMinv(&row->m_JMinv.m_jacobianM0);
+				const ndAvx512Float tmpAccel(JMinv * force);
+
+				ndFloat32 extenalAcceleration = -tmpAccel.AddHorizontal();
+				rhs->m_deltaAccel = extenalAcceleration;
+				rhs->m_coordenateAccel += extenalAcceleration;
+				ndAssert(rhs->m_jointFeebackForce);
+				const ndFloat32 jointForce = rhs->m_jointFeebackForce->GetInitialGuess();
+
+				rhs->m_force = isBilateral ? ndClamp(jointForce, rhs->m_lowerBoundFrictionCoefficent, rhs->m_upperBoundFrictionCoefficent) : jointForce;
+				rhs->m_maxImpact = ndFloat32(0.0f);
+
+				const ndAvx512Float Jt(&row->m_Jt.m_jacobianM0);
+				const ndAvx512Float tmpDiag(weigh * JMinv * Jt);
+
+				ndFloat32 diag = tmpDiag.AddHorizontal();
+				ndAssert(diag > ndFloat32(0.0f));
+				rhs->m_diagDamp = diag * rhs->m_diagonalRegularizer;
+
+				diag *= (ndFloat32(1.0f) + rhs->m_diagonalRegularizer);
+				rhs->m_invJinvMJt = ndFloat32(1.0f) / diag;
+
+				forceAcc = forceAcc.MulAdd(Jt, ndAvx512Float(rhs->m_force));
+			}
+
+			// the partial forces of body0 and body1 are next to each other
+			forceAcc.Store(&internalForces[jointIndex * 2]);
+		};
+
+		const ndInt32 jointCount = jointArray.GetCount();
+		for (ndInt32 i = threadIndex; i < jointCount; i += threadCount)
+		{
+			ndConstraint* const joint = jointArray[i];
+			GetJacobianDerivatives(joint);
+			BuildJacobianMatrix(joint, i);
+		}
+	});
+
+	auto InitJacobianAccumulatePartialForces = ndMakeObject::ndFunction([this, &bodyArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(InitJacobianAccumulatePartialForces);
+		const ndVector zero(ndVector::m_zero);
+		ndJacobian* const internalForces = &GetInternalForces()[0];
+		const ndArray<ndInt32>& bodyIndex = GetJointForceIndexBuffer();
+
+		const ndJacobian* const jointInternalForces = &GetTempInternalForces()[0];
+		const ndJointBodyPairIndex* const jointBodyPairIndexBuffer = &GetJointBodyPairIndexBuffer()[0];
+
+		const ndStartEnd startEnd(bodyIndex.GetCount() - 1, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndVector force(zero);
+			ndVector torque(zero);
+
+			const ndInt32 index = bodyIndex[i];
+			const ndJointBodyPairIndex& scan = jointBodyPairIndexBuffer[index];
+			ndBodyKinematic* const body = bodyArray[scan.m_body];
+
+			ndAssert(body->m_isStatic <= 1);
+			ndAssert(body->m_index == scan.m_body);
+			const ndInt32 mask = ndInt32(body->m_isStatic) - 1;
+			const ndInt32 count = mask & (bodyIndex[i + 1] - index);
+
+			for (ndInt32 j = 0; j < count; ++j)
+			{
+				const ndInt32 jointIndex = jointBodyPairIndexBuffer[index + j].m_joint;
+				force += jointInternalForces[jointIndex].m_linear;
+				torque += jointInternalForces[jointIndex].m_angular;
+			}
+			internalForces[i].m_linear = force;
+			internalForces[i].m_angular = torque;
+		}
+	});
+
+	auto TransposeMassMatrix = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(TransposeMassMatrix);
+		const ndInt32 jointCount = jointArray.GetCount();
+
+		const ndLeftHandSide* const leftHandSide = &GetLeftHandSide()[0];
+		const ndRightHandSide* const rightHandSide = &GetRightHandSide()[0];
+		ndAvx512MatrixArray& massMatrix = *m_avxMassMatrixArray;
+
+		const ndAvx512Float zero(ndAvx512Float::m_zero);
+		const ndAvx512Float ordinals(ndAvx512Float::m_ordinals);
+		const ndInt32 mask = -ndInt32(D_AVX_WORK_GROUP);
+		const ndInt32 soaJointCount = ((jointCount + D_AVX_WORK_GROUP - 1) & mask) / D_AVX_WORK_GROUP;
+
+		ndInt8* const groupType = &m_groupType[0];
+		ndUnsigned16* const jointMask = &m_jointMask[0];
+		const ndInt32* const soaJointRows = &m_avxJointRows[0];
+
+		ndConstraint** const jointsPtr = &jointArray[0];
+		for (ndInt32 i = threadIndex; i < soaJointCount; i += threadCount)
+		{
+			const ndInt32 index = i * D_AVX_WORK_GROUP;
+			ndInt32 maxRow = 0;
+			ndInt32 minRow = 255;
+			ndUnsigned16 selectMask = 0;
+			for (ndInt32 j = 0; j < D_AVX_WORK_GROUP; ++j)
+			{
+				ndConstraint* const joint = jointsPtr[index + j];
+				if (joint)
+				{
+					const ndInt32 maxMask = (maxRow - joint->m_rowCount) >> 8;
+					const ndInt32 minMask = (minRow - joint->m_rowCount) >> 8;
+					maxRow = ( maxMask & joint->m_rowCount) | (~maxMask & maxRow);
+					minRow = (~minMask & joint->m_rowCount) | ( minMask & minRow);
+					if (joint->m_rowCount)
+					{
+						selectMask = ndUnsigned16(selectMask | (1 << j));
+					}
+				}
+				else
+				{
+					minRow = 0;
+				}
+			}
+			ndAssert(maxRow >= 0);
+			ndAssert(minRow < 255);
+			jointMask[i] = selectMask;
+
+			const ndInt8 isUniformGroup = (maxRow == minRow) & (maxRow > 0);
+			groupType[i] = isUniformGroup;
+
+			const ndInt32 soaRowBase = soaJointRows[i];
+			if (isUniformGroup)
+			{
+				const ndJacobian* JtM0[D_AVX_WORK_GROUP];
+				const ndJacobian* JtM1[D_AVX_WORK_GROUP];
+				const ndJacobian* JMinvM0[D_AVX_WORK_GROUP];
+				const ndJacobian* JMinvM1[D_AVX_WORK_GROUP];
+
+				const ndInt32 rowCount = jointsPtr[index]->m_rowCount;
+				for (ndInt32 j = 0; j < rowCount; ++j)
+				{
+					ndAvx512MatrixElement& row = massMatrix[soaRowBase + j];
+					ndInt32* const normalIndex = (ndInt32*)&row.m_normalForceIndex[0];
+					for (ndInt32 k = 0; k < D_AVX_WORK_GROUP; ++k)
+					{
+						const ndConstraint* const soaJoint = jointsPtr[index + k];
+						const ndLeftHandSide* const lhs = &leftHandSide[soaJoint->m_rowStart + j];
+						JtM0[k] = &lhs->m_Jt.m_jacobianM0;
+						JtM1[k] = &lhs->m_Jt.m_jacobianM1;
+						JMinvM0[k] = &lhs->m_JMinv.m_jacobianM0;
+						JMinvM1[k] = &lhs->m_JMinv.m_jacobianM1;
+
+						const ndRightHandSide* const rhs = &rightHandSide[soaJoint->m_rowStart + j];
+						row.m_force[k] = rhs->m_force;
+						row.m_diagDamp[k] = rhs->m_diagDamp;
+						row.m_invJinvMJt[k] = rhs->m_invJinvMJt;
+						row.m_coordenateAccel[k] = rhs->m_coordenateAccel;
+						normalIndex[k] = (rhs->m_normalForceIndex + 1) * D_AVX_WORK_GROUP + k;
+						row.m_lowerBoundFrictionCoefficent[k] = rhs->m_lowerBoundFrictionCoefficent;
+						row.m_upperBoundFrictionCoefficent[k] = rhs->m_upperBoundFrictionCoefficent;
+					}
+
+					row.m_Jt.m_jacobianM0.Transpose(JtM0);
+					row.m_Jt.m_jacobianM1.Transpose(JtM1);
+					row.m_JMinv.m_jacobianM0.Transpose(JMinvM0);
+					row.m_JMinv.m_jacobianM1.Transpose(JMinvM1);
+				}
+			}
+			else
+			{
+				const ndConstraint* const firstJoint = jointsPtr[index];
+				for (ndInt32 j = 0; j < firstJoint->m_rowCount; ++j)
+				{
+					ndAvx512MatrixElement& row = massMatrix[soaRowBase + j];
+					row.m_Jt.m_jacobianM0.m_linear.m_x = zero;
+					row.m_Jt.m_jacobianM0.m_linear.m_y = zero;
+					row.m_Jt.m_jacobianM0.m_linear.m_z = zero;
+					row.m_Jt.m_jacobianM0.m_angular.m_x = zero;
+					row.m_Jt.m_jacobianM0.m_angular.m_y = zero;
+					row.m_Jt.m_jacobianM0.m_angular.m_z = zero;
+					row.m_Jt.m_jacobianM1.m_linear.m_x = zero;
+					row.m_Jt.m_jacobianM1.m_linear.m_y = zero;
+					row.m_Jt.m_jacobianM1.m_linear.m_z = zero;
+					row.m_Jt.m_jacobianM1.m_angular.m_x = zero;
+					row.m_Jt.m_jacobianM1.m_angular.m_y = zero;
+					row.m_Jt.m_jacobianM1.m_angular.m_z = zero;
+
+					row.m_JMinv.m_jacobianM0.m_linear.m_x = zero;
+					row.m_JMinv.m_jacobianM0.m_linear.m_y = zero;
+					row.m_JMinv.m_jacobianM0.m_linear.m_z = zero;
+					row.m_JMinv.m_jacobianM0.m_angular.m_x = zero;
+					row.m_JMinv.m_jacobianM0.m_angular.m_y = zero;
+					row.m_JMinv.m_jacobianM0.m_angular.m_z = zero;
+					row.m_JMinv.m_jacobianM1.m_linear.m_x = zero;
+					row.m_JMinv.m_jacobianM1.m_linear.m_y = zero;
+					row.m_JMinv.m_jacobianM1.m_linear.m_z = zero;
+					row.m_JMinv.m_jacobianM1.m_angular.m_x = zero;
+					row.m_JMinv.m_jacobianM1.m_angular.m_y = zero;
+					row.m_JMinv.m_jacobianM1.m_angular.m_z = zero;
+
+					row.m_force = zero;
+					row.m_diagDamp = zero;
+					row.m_invJinvMJt = zero;
+					row.m_coordenateAccel = zero;
+					row.m_normalForceIndex = ordinals;
+					row.m_lowerBoundFrictionCoefficent = zero;
+					row.m_upperBoundFrictionCoefficent = zero;
+				}
+
+				for (ndInt32 j = 0; j < D_AVX_WORK_GROUP; ++j)
+				{
+					const ndConstraint* const joint = jointsPtr[index + j];
+					if (joint)
+					{
+						for (ndInt32 k = 0; k < joint->m_rowCount; ++k)
+						{
+							ndAvx512MatrixElement& row = massMatrix[soaRowBase + k];
+							const ndLeftHandSide* const lhs = &leftHandSide[joint->m_rowStart + k];
+
+							row.m_Jt.m_jacobianM0.m_linear.m_x[j] = lhs->m_Jt.m_jacobianM0.m_linear.m_x;
+							row.m_Jt.m_jacobianM0.m_linear.m_y[j] = lhs->m_Jt.m_jacobianM0.m_linear.m_y;
+							row.m_Jt.m_jacobianM0.m_linear.m_z[j] = lhs->m_Jt.m_jacobianM0.m_linear.m_z;
+							row.m_Jt.m_jacobianM0.m_angular.m_x[j] = lhs->m_Jt.m_jacobianM0.m_angular.m_x;
+							row.m_Jt.m_jacobianM0.m_angular.m_y[j] = lhs->m_Jt.m_jacobianM0.m_angular.m_y;
+							row.m_Jt.m_jacobianM0.m_angular.m_z[j] = lhs->m_Jt.m_jacobianM0.m_angular.m_z;
+							row.m_Jt.m_jacobianM1.m_linear.m_x[j] = lhs->m_Jt.m_jacobianM1.m_linear.m_x;
+							row.m_Jt.m_jacobianM1.m_linear.m_y[j] = lhs->m_Jt.m_jacobianM1.m_linear.m_y;
+							row.m_Jt.m_jacobianM1.m_linear.m_z[j] = lhs->m_Jt.m_jacobianM1.m_linear.m_z;
+							row.m_Jt.m_jacobianM1.m_angular.m_x[j] = lhs->m_Jt.m_jacobianM1.m_angular.m_x;
+							row.m_Jt.m_jacobianM1.m_angular.m_y[j] = lhs->m_Jt.m_jacobianM1.m_angular.m_y;
+							row.m_Jt.m_jacobianM1.m_angular.m_z[j] = lhs->m_Jt.m_jacobianM1.m_angular.m_z;
+
+							row.m_JMinv.m_jacobianM0.m_linear.m_x[j] = lhs->m_JMinv.m_jacobianM0.m_linear.m_x;
+							row.m_JMinv.m_jacobianM0.m_linear.m_y[j] = lhs->m_JMinv.m_jacobianM0.m_linear.m_y;
+							row.m_JMinv.m_jacobianM0.m_linear.m_z[j] = lhs->m_JMinv.m_jacobianM0.m_linear.m_z;
+							row.m_JMinv.m_jacobianM0.m_angular.m_x[j] = lhs->m_JMinv.m_jacobianM0.m_angular.m_x;
+							row.m_JMinv.m_jacobianM0.m_angular.m_y[j] = lhs->m_JMinv.m_jacobianM0.m_angular.m_y;
+							row.m_JMinv.m_jacobianM0.m_angular.m_z[j] = lhs->m_JMinv.m_jacobianM0.m_angular.m_z;
+							row.m_JMinv.m_jacobianM1.m_linear.m_x[j] = lhs->m_JMinv.m_jacobianM1.m_linear.m_x;
+							row.m_JMinv.m_jacobianM1.m_linear.m_y[j] = lhs->m_JMinv.m_jacobianM1.m_linear.m_y;
+							row.m_JMinv.m_jacobianM1.m_linear.m_z[j] = lhs->m_JMinv.m_jacobianM1.m_linear.m_z;
+							row.m_JMinv.m_jacobianM1.m_angular.m_x[j] = lhs->m_JMinv.m_jacobianM1.m_angular.m_x;
+							row.m_JMinv.m_jacobianM1.m_angular.m_y[j] = lhs->m_JMinv.m_jacobianM1.m_angular.m_y;
+							row.m_JMinv.m_jacobianM1.m_angular.m_z[j] = lhs->m_JMinv.m_jacobianM1.m_angular.m_z;
+
+							const ndRightHandSide* const rhs = &rightHandSide[joint->m_rowStart + k];
+							row.m_force[j] = rhs->m_force;
+							row.m_diagDamp[j] = rhs->m_diagDamp;
+							row.m_invJinvMJt[j] = rhs->m_invJinvMJt;
+							row.m_coordenateAccel[j] = rhs->m_coordenateAccel;
+
+							ndInt32* const normalIndex = (ndInt32*)&row.m_normalForceIndex[0];
+							normalIndex[j] = (rhs->m_normalForceIndex + 1) * D_AVX_WORK_GROUP + j;
+							row.m_lowerBoundFrictionCoefficent[j] = rhs->m_lowerBoundFrictionCoefficent;
+							row.m_upperBoundFrictionCoefficent[j] = rhs->m_upperBoundFrictionCoefficent;
+						}
+					}
+				}
+			}
+		}
+	});
+
+	if (scene->GetActiveContactArray().GetCount())
+	{
+		D_TRACKTIME();
+		m_rightHandSide[0].m_force = ndFloat32(1.0f);
+
+		scene->ParallelExecute(InitJacobianMatrix);
+		scene->ParallelExecute(InitJacobianAccumulatePartialForces);
+		scene->ParallelExecute(TransposeMassMatrix);
+	}
+}
+
+void ndDynamicsUpdateAvx512::UpdateForceFeedback()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	auto UpdateForceFeedback = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(UpdateForceFeedback);
+		ndArray<ndRightHandSide>& rightHandSide = m_rightHandSide;
+		const ndArray<ndLeftHandSide>& leftHandSide = m_leftHandSide;
+
+		const ndAvx512Float zero(ndFloat32(0.0f));
+		const ndFloat32 timestepRK = GetTimestepRK();
+		const ndStartEnd startEnd(jointArray.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndConstraint* const joint = jointArray[i];
+			const ndInt32 rows = joint->m_rowCount;
+			const ndInt32 first = joint->m_rowStart;
+
+			for (ndInt32 j = 0; j < rows; ++j)
+			{
+				const ndRightHandSide* const rhs = &rightHandSide[j + first];
+				ndAssert(ndCheckFloat(rhs->m_force));
+				rhs->m_jointFeebackForce->Push(rhs->m_force);
+				rhs->m_jointFeebackForce->m_force = rhs->m_force;
+				rhs->m_jointFeebackForce->m_impact = rhs->m_maxImpact * timestepRK;
+			}
+
+			if (joint->GetAsBilateral())
+			{
+				ndAvx512Float force(zero);
+				for (ndInt32 j = 0; j < rows; ++j)
+				{
+					const ndRightHandSide* const rhs = &rightHandSide[j + first];
+					const ndLeftHandSide* const lhs = &leftHandSide[j + first];
+					force = force.MulAdd(ndAvx512Float(&lhs->m_Jt.m_jacobianM0), ndAvx512Float(rhs->m_force));
+				}
+				ndJointBilateralConstraint* const bilateral = (ndJointBilateralConstraint*)joint;
+				bilateral->m_forceBody0 = force.m_vector4[0];
+				bilateral->m_torqueBody0 = force.m_vector4[1];
+				bilateral->m_forceBody1 = force.m_vector4[2];
+				bilateral->m_torqueBody1 = force.m_vector4[3];
+			}
+		}
+	});
+
+	scene->ParallelExecute(UpdateForceFeedback);
+}
+
+void ndDynamicsUpdateAvx512::InitSkeletons()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndSkeletonContainer*>& activeSkeletons = m_world->m_activeSkeletons;
+
+	auto InitSkeletons = ndMakeObject::ndFunction([this, &activeSkeletons](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(InitSkeletons);
+		ndArray<ndRightHandSide>& rightHandSide = m_rightHandSide;
+		const ndArray<ndLeftHandSide>& leftHandSide = m_leftHandSide;
+
+		for (ndInt32 i = threadIndex; i < activeSkeletons.GetCount(); i += threadCount)
+		{
+			ndSkeletonContainer* const skeleton = activeSkeletons[i];
+			skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0]);
+		}
+	});
+
+	if (activeSkeletons.GetCount())
+	{
+		scene->ParallelExecute(InitSkeletons);
+	}
+	InitParallelSkeletons();
+}
+
+void ndDynamicsUpdateAvx512::UpdateSkeletons()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndSkeletonContainer*>& activeSkeletons = m_world->m_activeSkeletons;
+	//const ndBodyKinematic** const bodyArray = (const ndBodyKinematic**)(&scene->GetActiveBodyArray()[0]);
+
+	auto UpdateSkeletons = ndMakeObject::ndFunction([this, &activeSkeletons](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(UpdateSkeletons);
+		ndJacobian* const internalForces = &GetInternalForces()[0];
+		for (ndInt32 i = threadIndex; i < activeSkeletons.GetCount(); i += threadCount)
+		{
+			ndSkeletonContainer* const skeleton = activeSkeletons[i];
+			skeleton->CalculateReactionForces(internalForces);
+		}
+	});
+
+	if (activeSkeletons.GetCount())
+	{
+		scene->ParallelExecute(UpdateSkeletons);
+	}
+	UpdateParallelSkeletons();
+}
+
+void ndDynamicsUpdateAvx512::CalculateJointsAcceleration()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	auto CalculateJointsAcceleration = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateJointsAcceleration);
+		ndJointAccelerationDecriptor joindDesc;
+		joindDesc.m_timestep = m_timestepRK;
+		joindDesc.m_invTimestep = m_invTimestepRK;
+		joindDesc.m_firstPassCoefFlag = m_firstPassCoef;
+		ndArray<ndLeftHandSide>& leftHandSide = m_leftHandSide;
+		ndArray<ndRightHandSide>& rightHandSide = m_rightHandSide;
+
+		const ndStartEnd startEnd(jointArray.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndConstraint* const joint = jointArray[i];
+			const ndInt32 pairStart = joint->m_rowStart;
+			joindDesc.m_rowsCount = joint->m_rowCount;
+			joindDesc.m_leftHandSide = &leftHandSide[pairStart];
+			joindDesc.m_rightHandSide = &rightHandSide[pairStart];
+			joint->JointAccelerations(&joindDesc);
+		}
+	});
+
+	auto UpdateAcceleration = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(UpdateAcceleration);
+		const ndArray<ndRightHandSide>& rightHandSide = m_rightHandSide;
+
+		const ndInt32 jointCount = jointArray.GetCount();
+		const ndInt32 mask = -ndInt32(D_AVX_WORK_GROUP);
+		const ndInt32* const soaJointRows = &m_avxJointRows[0];
+		const ndInt32 soaJointCountBatches = ((jointCount + D_AVX_WORK_GROUP - 1) & mask) / D_AVX_WORK_GROUP;
+		const ndInt8* const groupType = &m_groupType[0];
+
+		const ndConstraint* const * jointArrayPtr = &jointArray[0];
+		ndAvx512MatrixArray& massMatrix = *m_avxMassMatrixArray;
+		for (ndInt32 i = threadIndex; i < soaJointCountBatches; i += threadCount)
+		{
+			if (groupType[i])
+			{
+				const ndInt32 soaRowStartBase = soaJointRows[i];
+				const ndConstraint* const* jointGroup = &jointArrayPtr[i * D_AVX_WORK_GROUP];
+				const ndConstraint* const firstJoint = jointGroup[0];
+				const ndInt32 rowCount = firstJoint->m_rowCount;
+				for (ndInt32 j = 0; j < D_AVX_WORK_GROUP; ++j)
+				{
+					const ndConstraint* const Joint = jointGroup[j];
+					const ndInt32 base = Joint->m_rowStart;
+					for (ndInt32 k = 0; k < rowCount; ++k)
+					{
+						ndAvx512MatrixElement* const row = &massMatrix[soaRowStartBase + k];
+						row->m_coordenateAccel[j] = rightHandSide[base + k].m_coordenateAccel;
+					}
+				}
+			}
+			else
+			{
+				const ndInt32 soaRowStartBase = soaJointRows[i];
+				const ndConstraint* const * jointGroup = &jointArrayPtr[i * D_AVX_WORK_GROUP];
+				for (ndInt32 j = 0; j < D_AVX_WORK_GROUP; ++j)
+				{
+					const ndConstraint* const Joint = jointGroup[j];
+					if (Joint)
+					{
+						const ndInt32 base = Joint->m_rowStart;
+						const ndInt32 rowCount = Joint->m_rowCount;
+						for (ndInt32 k = 0; k < rowCount; ++k)
+						{
+							ndAvx512MatrixElement* const row = &massMatrix[soaRowStartBase + k];
+							row->m_coordenateAccel[j] = rightHandSide[base + k].m_coordenateAccel;
+						}
+					}
+				}
+			}
+		}
+	});
+
+	scene->ParallelExecute(CalculateJointsAcceleration);
+
+	m_firstPassCoef = ndFloat32(1.0f);
+	scene->ParallelExecute(UpdateAcceleration);
+}
+
+void ndDynamicsUpdateAvx512::IntegrateBodiesVelocity()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	auto IntegrateBodiesVelocity = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(IntegrateBodiesVelocity);
+		ndArray<ndBodyKinematic*>& bodyArray = GetBodyIslandOrder();
+		const ndArray<ndJacobian>& internalForces = GetInternalForces();
+
+		const ndVector timestep4(GetTimestepRK());
+		const ndVector speedFreeze2(m_world->m_freezeSpeed2 * ndFloat32(0.1f));
+
+		const ndStartEnd startEnd(bodyArray.GetCount() - GetUnconstrainedBodyCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBodyKinematic* const body = bodyArray[i];
+
+			ndAssert(body);
+			ndAssert(body->GetAsBodyDynamic());
+			ndAssert(body->m_isConstrained);
+			const ndInt32 index = body->m_index;
+			const ndJacobian& forceAndTorque = internalForces[index];
+			const ndVector force(body->GetForce() + forceAndTorque.m_linear);
+			const ndVector torque(body->GetTorque() + forceAndTorque.m_angular - body->GetGyroTorque());
+			const ndJacobian velocStep(body->IntegrateForceAndToque(force, torque, timestep4));
+
+			if (!body->m_equilibrium0)
+			{
+				body->m_veloc += velocStep.m_linear;
+				body->m_omega += velocStep.m_angular;
+				body->IntegrateGyroSubstep(timestep4);
+			}
+			else
+			{
+				const ndVector velocStep2(velocStep.m_linear.DotProduct(velocStep.m_linear));
+				const ndVector omegaStep2(velocStep.m_angular.DotProduct(velocStep.m_angular));
+				const ndVector test(((velocStep2 > speedFreeze2) | (omegaStep2 > speedFreeze2)) & ndVector::m_negOne);
+				const ndUnsigned8 equilibrium = ndUnsigned8(test.GetSignMask() ? 0 : 1);
+				body->m_equilibrium0 = equilibrium;
+			}
+			ndAssert(body->m_veloc.m_w == ndFloat32(0.0f));
+			ndAssert(body->m_omega.m_w == ndFloat32(0.0f));
+		}
+	});
+
+	scene->ParallelExecute(IntegrateBodiesVelocity);
+}
+
+void ndDynamicsUpdateAvx512::CalculateJointsForce()
+{
+	D_TRACKTIME();
+	const ndUnsigned32 passes = m_solverPasses;
+	ndScene* const scene = m_world->GetScene();
+
+	ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateJointsForce);
+		const ndInt32 jointCount = jointArray.GetCount();
+		ndJacobian* const jointPartialForces = &GetTempInternalForces()[0];
+
+		const ndInt32* const soaJointRows = &m_avxJointRows[0];
+		ndAvx512MatrixArray& soaMassMatrixArray = *m_avxMassMatrixArray;
+		ndAvx512MatrixElement* const soaMassMatrix = &soaMassMatrixArray[0];
+
+		auto JointForce = [this, &jointArray, jointPartialForces](ndInt32 group, ndAvx512MatrixElement* const massMatrix)
+		{
+			ndAvx512Vector6 forceM0;
+			ndAvx512Vector6 forceM1;
+			ndAvx512Float preconditioner0;
+			ndAvx512Float preconditioner1;
+			ndAvx512Float bodyIndex0;
+			ndAvx512Float bodyIndex1;
+			ndAvx512Float normalForce[D_CONSTRAINT_MAX_ROWS + 1];
+
+			const ndInt32 block = group * D_AVX_WORK_GROUP;
+			ndConstraint** const jointGroup = &jointArray[block];
+
+			// the lanes of the group tail, and the ones of joints without rows,
+			// are left out of the mask, so they neither read nor write body forces.
+			const ndAvx512Float zero(ndFloat32(0.0f));
+			__mmask16 laneMask = 0;
+			__mmask16 activeMask = 0;
+			preconditioner0 = zero;
+			preconditioner1 = zero;
+			for (ndInt32 i = 0; i < D_AVX_WORK_GROUP; ++i)
+			{
+				const ndConstraint* const joint = jointGroup[i];
+				bodyIndex0.m_int[i] = 0;
+				bodyIndex1.m_int[i] = 0;
+				if (joint && joint->m_rowCount)
+				{
+					const ndBodyKinematic* const body0 = joint->GetBody0();
+					const ndBodyKinematic* const body1 = joint->GetBody1();
+					ndAssert(body0);
+					ndAssert(body1);
+
+					const ndInt32 stride = ndInt32(sizeof(ndJacobian) / sizeof(ndFloat32));
+					bodyIndex0.m_int[i] = body0->m_index * stride;
+					bodyIndex1.m_int[i] = body1->m_index * stride;
+					preconditioner0[i] = body0->m_weigh;
+					preconditioner1[i] = body1->m_weigh;
+
+					const __mmask16 bit = __mmask16(1 << i);
+					laneMask = __mmask16(laneMask | bit);
+					const ndInt32 resting = body0->m_equilibrium0 & body1->m_equilibrium0;
+					activeMask = __mmask16(activeMask | (resting ? 0 : bit));
+				}
+			}
+
+			const ndFloat32* const internalForces = &m_internalForces[0].m_linear.m_x;
+			forceM0.m_linear.m_x = ndAvx512Float(&internalForces[0], bodyIndex0, laneMask);
+			forceM0.m_linear.m_y = ndAvx512Float(&internalForces[1], bodyIndex0, laneMask);
+			forceM0.m_linear.m_z = ndAvx512Float(&internalForces[2], bodyIndex0, laneMask);
+			forceM0.m_angular.m_x = ndAvx512Float(&internalForces[4], bodyIndex0, laneMask);
+			forceM0.m_angular.m_y = ndAvx512Float(&internalForces[5], bodyIndex0, laneMask);
+			forceM0.m_angular.m_z = ndAvx512Float(&internalForces[6], bodyIndex0, laneMask);
+
+			forceM1.m_linear.m_x = ndAvx512Float(&internalForces[0], bodyIndex1, laneMask);
+			forceM1.m_linear.m_y = ndAvx512Float(&internalForces[1], bodyIndex1, laneMask);
+			forceM1.m_linear.m_z = ndAvx512Float(&internalForces[2], bodyIndex1, laneMask);
+			forceM1.m_angular.m_x = ndAvx512Float(&internalForces[4], bodyIndex1, laneMask);
+			forceM1.m_angular.m_y = ndAvx512Float(&internalForces[5], bodyIndex1, laneMask);
+			forceM1.m_angular.m_z = ndAvx512Float(&internalForces[6], bodyIndex1, laneMask);
+
+			ndAvx512Float accNorm(zero);
+			normalForce[0] = ndAvx512Float(ndFloat32(1.0f));
+			const ndInt32 rowsCount = jointGroup[0]->m_rowCount;
+
+			for (ndInt32 j = 0; j < rowsCount; ++j)
+			{
+				ndAvx512MatrixElement* const row = &massMatrix[j];
+
+				ndAvx512Float a0(row->m_JMinv.m_jacobianM0.m_linear.m_x * forceM0.m_linear.m_x);
+				ndAvx512Float a1(row->m_JMinv.m_jacobianM1.m_linear.m_x * forceM1.m_linear.m_x);
+				a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_angular.m_x, forceM0.m_angular.m_x);
+				a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_angular.m_x, forceM1.m_angular.m_x);
+
+				a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_linear.m_y, forceM0.m_linear.m_y);
+				a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_linear.m_y, forceM1.m_linear.m_y);
+				a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_angular.m_y, forceM0.m_angular.m_y);
+				a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_angular.m_y, forceM1.m_angular.m_y);
+
+				a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_linear.m_z, forceM0.m_linear.m_z);
+				a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_linear.m_z, forceM1.m_linear.m_z);
+				a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_angular.m_z, forceM0.m_angular.m_z);
+				a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_angular.m_z, forceM1.m_angular.m_z);
+
+				ndAvx512Float a(a0 + a1);
+				a = row->m_coordenateAccel.MulSub(row->m_force, row->m_diagDamp) - a;
+				ndAvx512Float f(row->m_force.MulAdd(row->m_invJinvMJt, a));
+
+				const ndAvx512Float frictionNormal(normalForce, row->m_normalForceIndex);
+				const ndAvx512Float lowerFrictionForce(frictionNormal * row->m_lowerBoundFrictionCoefficent);
+				const ndAvx512Float upperFrictionForce(frictionNormal * row->m_upperBoundFrictionCoefficent);
+
+				const __mmask16 unclamped = __mmask16((f < upperFrictionForce) & (f > lowerFrictionForce));
+				a = a & unclamped;
+				accNorm = accNorm.MulAdd(a, a);
+
+				f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+				normalForce[j + 1] = f;
+
+				const ndAvx512Float deltaForce(f - row->m_force);
+				const ndAvx512Float deltaForce0(deltaForce * preconditioner0);
+				const ndAvx512Float deltaForce1(deltaForce * preconditioner1);
+				forceM0.m_linear.m_x = forceM0.m_linear.m_x.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_x, deltaForce0);
+				forceM0.m_linear.m_y = forceM0.m_linear.m_y.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_y, deltaForce0);
+				forceM0.m_linear.m_z = forceM0.m_linear.m_z.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_z, deltaForce0);
+				forceM0.m_angular.m_x = forceM0.m_angular.m_x.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_x, deltaForce0);
+				forceM0.m_angular.m_y = forceM0.m_angular.m_y.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_y, deltaForce0);
+				forceM0.m_angular.m_z = forceM0.m_angular.m_z.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_z, deltaForce0);
+
+				forceM1.m_linear.m_x = forceM1.m_linear.m_x.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_x, deltaForce1);
+				forceM1.m_linear.m_y = forceM1.m_linear.m_y.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_y, deltaForce1);
+				forceM1.m_linear.m_z = forceM1.m_linear.m_z.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_z, deltaForce1);
+				forceM1.m_angular.m_x = forceM1.m_angular.m_x.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_x, deltaForce1);
+				forceM1.m_angular.m_y = forceM1.m_angular.m_y.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_y, deltaForce1);
+				forceM1.m_angular.m_z = forceM1.m_angular.m_z.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_z, deltaForce1);
+			}
+
+			const ndFloat32 tol = ndFloat32(0.125f);
+			const ndFloat32 tol2 = tol * tol;
+
+			ndAvx512Float maxAccel(accNorm);
+			for (ndInt32 k = 0; (k < 4) && (maxAccel.GetMax() > tol2); ++k)
+			{
+				maxAccel = zero;
+				for (ndInt32 j = 0; j < rowsCount; ++j)
+				{
+					ndAvx512MatrixElement* const row = &massMatrix[j];
+
+					ndAvx512Float a0(row->m_JMinv.m_jacobianM0.m_linear.m_x * forceM0.m_linear.m_x);
+					ndAvx512Float a1(row->m_JMinv.m_jacobianM1.m_linear.m_x * forceM1.m_linear.m_x);
+					a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_angular.m_x, forceM0.m_angular.m_x);
+					a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_angular.m_x, forceM1.m_angular.m_x);
+
+					a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_linear.m_y, forceM0.m_linear.m_y);
+					a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_linear.m_y, forceM1.m_linear.m_y);
+					a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_angular.m_y, forceM0.m_angular.m_y);
+					a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_angular.m_y, forceM1.m_angular.m_y);
+
+					a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_linear.m_z, forceM0.m_linear.m_z);
+					a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_linear.m_z, forceM1.m_linear.m_z);
+					a0 = a0.MulAdd(row->m_JMinv.m_jacobianM0.m_angular.m_z, forceM0.m_angular.m_z);
+					a1 = a1.MulAdd(row->m_JMinv.m_jacobianM1.m_angular.m_z, forceM1.m_angular.m_z);
+
+					ndAvx512Float a(a0 + a1);
+					const ndAvx512Float force(normalForce[j + 1]);
+					a = row->m_coordenateAccel.MulSub(force, row->m_diagDamp) - a;
+					ndAvx512Float f(force.MulAdd(row->m_invJinvMJt, a));
+
+					const ndAvx512Float frictionNormal(normalForce, row->m_normalForceIndex);
+					const ndAvx512Float lowerFrictionForce(frictionNormal * row->m_lowerBoundFrictionCoefficent);
+					const ndAvx512Float upperFrictionForce(frictionNormal * row->m_upperBoundFrictionCoefficent);
+
+					const __mmask16 unclamped = __mmask16((f < upperFrictionForce) & (f > lowerFrictionForce));
+					a = a & unclamped;
+					maxAccel = maxAccel.MulAdd(a, a);
+
+					f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+					normalForce[j + 1] = f;
+
+					const ndAvx512Float deltaForce(f - force);
+					const ndAvx512Float deltaForce0(deltaForce * preconditioner0);
+					const ndAvx512Float deltaForce1(deltaForce * preconditioner1);
+
+					forceM0.m_linear.m_x = forceM0.m_linear.m_x.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_x, deltaForce0);
+					forceM0.m_linear.m_y = forceM0.m_linear.m_y.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_y, deltaForce0);
+					forceM0.m_linear.m_z = forceM0.m_linear.m_z.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_z, deltaForce0);
+					forceM0.m_angular.m_x = forceM0.m_angular.m_x.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_x, deltaForce0);
+					forceM0.m_angular.m_y = forceM0.m_angular.m_y.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_y, deltaForce0);
+					forceM0.m_angular.m_z = forceM0.m_angular.m_z.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_z, deltaForce0);
+
+					forceM1.m_linear.m_x = forceM1.m_linear.m_x.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_x, deltaForce1);
+					forceM1.m_linear.m_y = forceM1.m_linear.m_y.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_y, deltaForce1);
+					forceM1.m_linear.m_z = forceM1.m_linear.m_z.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_z, deltaForce1);
+					forceM1.m_angular.m_x = forceM1.m_angular.m_x.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_x, deltaForce1);
+					forceM1.m_angular.m_y = forceM1.m_angular.m_y.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_y, deltaForce1);
+					forceM1.m_angular.m_z = forceM1.m_angular.m_z.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_z, deltaForce1);
+				}
+			}
+
+			forceM0.m_linear.m_x = zero;
+			forceM0.m_linear.m_y = zero;
+			forceM0.m_linear.m_z = zero;
+			forceM0.m_angular.m_x = zero;
+			forceM0.m_angular.m_y = zero;
+			forceM0.m_angular.m_z = zero;
+
+			forceM1.m_linear.m_x = zero;
+			forceM1.m_linear.m_y = zero;
+			forceM1.m_linear.m_z = zero;
+			forceM1.m_angular.m_x = zero;
+			forceM1.m_angular.m_y = zero;
+			forceM1.m_angular.m_z = zero;
+			for (ndInt32 i = 0; i < rowsCount; ++i)
+			{
+				// resting joints keep the force of the previous pass
+				ndAvx512MatrixElement* const row = &massMatrix[i];
+				const ndAvx512Float force(row->m_force.Select(normalForce[i + 1], activeMask));
+				row->m_force = force;
+
+				forceM0.m_linear.m_x = forceM0.m_linear.m_x.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_x, force);
+				forceM0.m_linear.m_y = forceM0.m_linear.m_y.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_y, force);
+				forceM0.m_linear.m_z = forceM0.m_linear.m_z.MulAdd(row->m_Jt.m_jacobianM0.m_linear.m_z, force);
+				forceM0.m_angular.m_x = forceM0.m_angular.m_x.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_x, force);
+				forceM0.m_angular.m_y = forceM0.m_angular.m_y.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_y, force);
+				forceM0.m_angular.m_z = forceM0.m_angular.m_z.MulAdd(row->m_Jt.m_jacobianM0.m_angular.m_z, force);
+
+				forceM1.m_linear.m_x = forceM1.m_linear.m_x.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_x, force);
+				forceM1.m_linear.m_y = forceM1.m_linear.m_y.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_y, force);
+				forceM1.m_linear.m_z = forceM1.m_linear.m_z.MulAdd(row->m_Jt.m_jacobianM1.m_linear.m_z, force);
+				forceM1.m_angular.m_x = forceM1.m_angular.m_x.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_x, force);
+				forceM1.m_angular.m_y = forceM1.m_angular.m_y.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_y, force);
+				forceM1.m_angular.m_z = forceM1.m_angular.m_z.MulAdd(row->m_Jt.m_jacobianM1.m_angular.m_z, force);
+			}
+
+			// back to one jacobian per joint, four joints at a time
+			ndJacobian force0[D_AVX_WORK_GROUP];
+			ndJacobian force1[D_AVX_WORK_GROUP];
+			for (ndInt32 i = 0; i < 4; ++i)
+			{
+				ndJacobian* const out0 = &force0[i * 4];
+				ndJacobian* const out1 = &force1[i * 4];
+				ndVector::Transpose4x4(
+					out0[0].m_linear, out0[1].m_linear, out0[2].m_linear, out0[3].m_linear,
+					forceM0.m_linear.m_x.m_vector4[i],
+					forceM0.m_linear.m_y.m_vector4[i],
+					forceM0.m_linear.m_z.m_vector4[i], ndVector::m_zero);
+				ndVector::Transpose4x4(
+					out0[0].m_angular, out0[1].m_angular, out0[2].m_angular, out0[3].m_angular,
+					forceM0.m_angular.m_x.m_vector4[i],
+					forceM0.m_angular.m_y.m_vector4[i],
+					forceM0.m_angular.m_z.m_vector4[i], ndVector::m_zero);
+
+				ndVector::Transpose4x4(
+					out1[0].m_linear, out1[1].m_linear, out1[2].m_linear, out1[3].m_linear,
+					forceM1.m_linear.m_x.m_vector4[i],
+					forceM1.m_linear.m_y.m_vector4[i],
+					forceM1.m_linear.m_z.m_vector4[i], ndVector::m_zero);
+				ndVector::Transpose4x4(
+					out1[0].m_angular, out1[1].m_angular, out1[2].m_angular, out1[3].m_angular,
+					forceM1.m_angular.m_x.m_vector4[i],
+					forceM1.m_angular.m_y.m_vector4[i],
+					forceM1.m_angular.m_z.m_vector4[i], ndVector::m_zero);
+			}
+
+			ndRightHandSide* const rightHandSide = &m_rightHandSide[0];
+			for (ndInt32 i = 0; i < D_AVX_WORK_GROUP; ++i)
+			{
+				const ndConstraint* const joint = jointGroup[i];
+				if (joint)
+				{
+					const ndInt32 rowCount = joint->m_rowCount;
+					const ndInt32 rowStartBase = joint->m_rowStart;
+					for (ndInt32 j = 0; j < rowCount; ++j)
+					{
+						const ndAvx512MatrixElement* const row = &massMatrix[j];
+						rightHandSide[j + rowStartBase].m_force = row->m_force[i];
+						rightHandSide[j + rowStartBase].m_maxImpact = ndMax(ndAbs(row->m_force[i]), rightHandSide[j + rowStartBase].m_maxImpact);
+					}
+
+					const ndInt32 index = (block + i) * 2;
+					jointPartialForces[index + 0] = force0[i];
+					jointPartialForces[index + 1] = force1[i];
+				}
+			}
+		};
+
+		const ndInt32 mask = -ndInt32(D_AVX_WORK_GROUP);
+		const ndInt32 soaJointCount = ((jointCount + D_AVX_WORK_GROUP - 1) & mask) / D_AVX_WORK_GROUP;
+
+		for (ndInt32 i = threadIndex; i < soaJointCount; i += threadCount)
+		{
+			JointForce(i, &soaMassMatrix[soaJointRows[i]]);
+		}
+	});
+
+	auto ApplyJacobianAccumulatePartialForces = ndMakeObject::ndFunction([this, &bodyArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(ApplyJacobianAccumulatePartialForces);
+		const ndVector zero(ndVector::m_zero);
+		const ndInt32* const bodyIndex = &GetJointForceIndexBuffer()[0];
+		ndJacobian* const internalForces = &GetInternalForces()[0];
+		const ndJacobian* const jointInternalForces = &GetTempInternalForces()[0];
+		const ndJointBodyPairIndex* const jointBodyPairIndexBuffer = &GetJointBodyPairIndexBuffer()[0];
+
+		const ndStartEnd startEnd(bodyArray.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndVector force(zero);
+			ndVector torque(zero);
+			const ndBodyKinematic* const body = bodyArray[i];
+
+			const ndInt32 startIndex = bodyIndex[i];
+			const ndInt32 mask = body->m_isStatic - 1;
+			const ndInt32 count = mask & (bodyIndex[i + 1] - startIndex);
+			for (ndInt32 j = 0; j < count; ++j)
+			{
+				const ndInt32 index = jointBodyPairIndexBuffer[startIndex + j].m_joint;
+				force += jointInternalForces[index].m_linear;
+				torque += jointInternalForces[index].m_angular;
+			}
+			internalForces[i].m_linear = force;
+			internalForces[i].m_angular = torque;
+		}
+	});
+
+	for (ndInt32 i = 0; i < ndInt32(passes); ++i)
+	{
+		scene->ParallelExecute(CalculateJointsForce);
+		scene->ParallelExecute(ApplyJacobianAccumulatePartialForces);
+	}
+}
+
+void ndDynamicsUpdateAvx512::CalculateForces()
+{
+	D_TRACKTIME();
+	if (m_world->GetScene()->GetActiveContactArray().GetCount())
+	{
+		m_firstPassCoef = ndFloat32(0.0f);
+
+		InitSkeletons();
+		for (ndInt32 step = 0; step < 4; step++)
+		{
+			CalculateJointsAcceleration();
+			CalculateJointsForce();
+			UpdateSkeletons();
+			IntegrateBodiesVelocity();
+		}
+		
+		UpdateForceFeedback();
+	}
+}
+
+void ndDynamicsUpdateAvx512::Update()
+{
+	D_TRACKTIME();
+	m_timestep = m_world->GetScene()->GetTimestep();
+
+	BuildIsland();
+	IntegrateUnconstrainedBodies();
+	InitWeights();
+	InitBodyArray();
+	InitJacobianMatrix();
+	CalculateForces();
+	IntegrateBodies();
+	DetermineSleepStates();
+}
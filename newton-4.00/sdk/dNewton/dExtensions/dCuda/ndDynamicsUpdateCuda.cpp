@@ -1234,6 +1234,7 @@ void ndDynamicsUpdateCuda::InitSkeletons()
 	{
 		scene->ParallelExecute(InitSkeletons);
 	}
+	InitParallelSkeletons();
 }
 
 void ndDynamicsUpdateCuda::UpdateSkeletons()
@@ -1258,6 +1259,7 @@ void ndDynamicsUpdateCuda::UpdateSkeletons()
 	{
 		scene->ParallelExecute(UpdateSkeletons);
 	}
+	UpdateParallelSkeletons();
 }
 
 void ndDynamicsUpdateCuda::CalculateJointsForce()
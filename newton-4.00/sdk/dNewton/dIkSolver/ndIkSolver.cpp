@@ -276,7 +276,7 @@ void ndIkSolver::BuildMassMatrix()
 		ndBodyKinematic::ndContactMap::Iterator it(contactMap);
 		for (it.Begin(); it; it++)
 		{
-			ndContact* const contact = it.GetNode()->GetInfo();
+			ndContact* const contact = *it;
 			if (contact->IsActive())
 			{
 				bool duplicate = false;
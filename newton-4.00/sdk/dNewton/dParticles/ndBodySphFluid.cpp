@@ -26,6 +26,7 @@
 
 #define D_SPH_HASH_BITS				8
 #define D_SPH_BUFFER_GRANULARITY	4096	
+#define D_SPH_COUPLING_DIRECTIONS	26
 
 class ndBodySphFluid::ndGridHash
 {
@@ -83,16 +84,24 @@ class ndBodySphFluid::ndGridHash
 	};
 };
 
-class ndBodySphFluid::ndParticlePair
+// snapshot of a rigid body overlapping the fluid. the convex shape is 
+// represented by its support distances along a fixed set of directions, 
+// so the particle test does not touch the body while the fluid runs in 
+// the background.
+class ndBodySphFluid::ndBodyProxy
 {
 	public:
-	ndInt32 m_neighborg[32];
-};
-
-class ndBodySphFluid::ndParticleKernelDistance
-{
-	public:
-	ndFloat32 m_dist[32];
+	ndMatrix m_matrix;
+	ndVector m_minBox;
+	ndVector m_maxBox;
+	ndVector m_veloc;
+	ndVector m_omega;
+	ndVector m_com;
+	ndVector m_impulse;
+	ndVector m_angularImpulse;
+	ndFloat32 m_support[D_SPH_COUPLING_DIRECTIONS];
+	ndUnsigned32 m_bodyId;
+	bool m_dynamic;
 };
 
 class ndBodySphFluid::ndWorkingBuffers
@@ -102,22 +111,48 @@ class ndBodySphFluid::ndWorkingBuffers
 	public:
 	ndWorkingBuffers()
 		:m_accel(D_SPH_BUFFER_GRANULARITY)
-		,m_locks(D_SPH_BUFFER_GRANULARITY)
-		,m_pairCount(D_SPH_BUFFER_GRANULARITY)
+		,m_neighborCount(D_SPH_BUFFER_GRANULARITY)
 		,m_gridScans(D_SPH_BUFFER_GRANULARITY)
 		,m_density(D_SPH_BUFFER_GRANULARITY)
 		,m_invDensity(D_SPH_BUFFER_GRANULARITY)
-		,m_pairs(D_SPH_BUFFER_GRANULARITY)
 		,m_hashGridMap(D_SPH_BUFFER_GRANULARITY)
 		,m_hashGridMapScratchBuffer(D_SPH_BUFFER_GRANULARITY)
-		,m_kernelDistance(D_SPH_BUFFER_GRANULARITY)
+		,m_movedGridMap(D_SPH_BUFFER_GRANULARITY)
+		,m_particleCellKeys(D_SPH_BUFFER_GRANULARITY)
+		,m_neighborScans(D_SPH_BUFFER_GRANULARITY)
+		,m_neighbors(D_SPH_BUFFER_GRANULARITY)
+		,m_neighborDistance(D_SPH_BUFFER_GRANULARITY)
+		,m_bodyProxies()
+		,m_proxyImpulses()
+		,m_proxyCellScans()
+		,m_proxyCells()
 		,m_worlToGridOrigin(ndFloat32 (1.0f))
 		,m_worlToGridScale(ndFloat32(1.0f))
+		,m_gridIsValid(false)
 	{
 		for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
 		{
 			m_partialsGridScans[i].Resize(D_SPH_BUFFER_GRANULARITY);
 		}
+
+		// the faces, edges and corners directions of a cube
+		ndInt32 count = 0;
+		for (ndInt32 z = -1; z <= 1; ++z)
+		{
+			for (ndInt32 y = -1; y <= 1; ++y)
+			{
+				for (ndInt32 x = -1; x <= 1; ++x)
+				{
+					if (x || y || z)
+					{
+						const ndVector dir(ndFloat32(x), ndFloat32(y), ndFloat32(z), ndFloat32(0.0f));
+						m_couplingDirections[count] = dir.Normalize();
+						count++;
+					}
+				}
+			}
+		}
+		ndAssert(count == D_SPH_COUPLING_DIRECTIONS);
 	}
 
 	~ndWorkingBuffers()
@@ -138,18 +173,26 @@ class ndBodySphFluid::ndWorkingBuffers
 	}
 
 	ndArray<ndVector> m_accel;
-	ndArray<ndSpinLock> m_locks;
-	ndArray<ndInt8> m_pairCount;
+	ndArray<ndAtomic<ndInt32>> m_neighborCount;
 	ndArray<ndInt32> m_gridScans;
 	ndArray<ndFloat32> m_density;
 	ndArray<ndFloat32> m_invDensity;
-	ndArray<ndParticlePair> m_pairs;
 	ndArray<ndGridHash> m_hashGridMap;
 	ndArray<ndGridHash> m_hashGridMapScratchBuffer;
-	ndArray<ndParticleKernelDistance> m_kernelDistance;
+	ndArray<ndGridHash> m_movedGridMap;
+	ndArray<ndUnsigned64> m_particleCellKeys;
+	ndArray<ndInt32> m_neighborScans;
+	ndArray<ndInt32> m_neighbors;
+	ndArray<ndFloat32> m_neighborDistance;
 	ndArray<ndInt32> m_partialsGridScans[D_MAX_THREADS_COUNT];
+	ndArray<ndBodyProxy> m_bodyProxies;
+	ndArray<ndVector> m_proxyImpulses;
+	ndArray<ndInt32> m_proxyCellScans;
+	ndArray<ndInt32> m_proxyCells;
+	ndVector m_couplingDirections[D_SPH_COUPLING_DIRECTIONS];
 	ndFloat32 m_worlToGridOrigin;
 	ndFloat32 m_worlToGridScale;
+	bool m_gridIsValid;
 };
 
 ndBodySphFluid::ndBodySphFluid()
@@ -159,6 +202,9 @@ ndBodySphFluid::ndBodySphFluid()
 	,m_viscosity(ndFloat32 (1.05f))
 	,m_restDensity(ndFloat32(1000.0f))
 	,m_gasConstant(ndFloat32(1.0f))
+	,m_couplingTests(0)
+	,m_coupleRigidBodies(false)
+	,m_temporalCoherence(false)
 {
 }
 
@@ -169,6 +215,9 @@ ndBodySphFluid::ndBodySphFluid(const ndLoadSaveBase::ndLoadDescriptor& desc)
 	,m_viscosity(ndFloat32(1.0f))
 	,m_restDensity(ndFloat32(1000.0f))
 	,m_gasConstant(ndFloat32(1.0f))
+	,m_couplingTests(0)
+	,m_coupleRigidBodies(false)
+	,m_temporalCoherence(false)
 {
 	// nothing was saved
 	ndAssert(0);
@@ -287,7 +336,7 @@ void ndBodySphFluid::SortXdimension(ndThreadPool* const threadPool)
 #endif
 }
 
-void ndBodySphFluid::SortCellBuckects(ndThreadPool* const threadPool)
+void ndBodySphFluid::SortCellBuckects(ndThreadPool* const threadPool, ndArray<ndGridHash>& grids)
 {
 	D_TRACKTIME();
 	class ndKey_ylow
@@ -333,23 +382,23 @@ void ndBodySphFluid::SortCellBuckects(ndThreadPool* const threadPool)
 	ndWorkingBuffers& data = *m_workingBuffers;
 	const ndVector boxSize((m_box1 - m_box0).Scale(ndFloat32(1.0f) / GetSphGridSize()).GetInt());
 
-	ndCountingSort<ndGridHash, ndKey_ylow, D_SPH_HASH_BITS>(*threadPool, data.m_hashGridMap, data.m_hashGridMapScratchBuffer, nullptr, nullptr);
+	ndCountingSort<ndGridHash, ndKey_ylow, D_SPH_HASH_BITS>(*threadPool, grids, data.m_hashGridMapScratchBuffer, nullptr, nullptr);
 	if (boxSize.m_iy > (1 << D_SPH_HASH_BITS))
 	{
-		ndCountingSort<ndGridHash, ndKey_yhigh, D_SPH_HASH_BITS>(*threadPool, data.m_hashGridMap, data.m_hashGridMapScratchBuffer, nullptr, nullptr);
+		ndCountingSort<ndGridHash, ndKey_yhigh, D_SPH_HASH_BITS>(*threadPool, grids, data.m_hashGridMapScratchBuffer, nullptr, nullptr);
 	}
 	
-	ndCountingSort<ndGridHash, ndKey_zlow, D_SPH_HASH_BITS>(*threadPool, data.m_hashGridMap, data.m_hashGridMapScratchBuffer, nullptr, nullptr);
+	ndCountingSort<ndGridHash, ndKey_zlow, D_SPH_HASH_BITS>(*threadPool, grids, data.m_hashGridMapScratchBuffer, nullptr, nullptr);
 	if (boxSize.m_iz > (1 << D_SPH_HASH_BITS))
 	{
-		ndCountingSort<ndGridHash, ndKey_zhigh, D_SPH_HASH_BITS>(*threadPool, data.m_hashGridMap, data.m_hashGridMapScratchBuffer, nullptr, nullptr);
+		ndCountingSort<ndGridHash, ndKey_zhigh, D_SPH_HASH_BITS>(*threadPool, grids, data.m_hashGridMapScratchBuffer, nullptr, nullptr);
 	}
 
 #ifdef _DEBUG
-	for (int i = 1; i < data.m_hashGridMap.GetCount(); ++i)
+	for (int i = 1; i < grids.GetCount(); ++i)
 	{
-		ndGridHash cell0(data.m_hashGridMap[i - 1]);
-		ndGridHash cell1(data.m_hashGridMap[i + 0]);
+		ndGridHash cell0(grids[i - 1]);
+		ndGridHash cell1(grids[i + 0]);
 		ndUnsigned64 key0 = (cell0.m_z << (D_SPH_HASH_BITS * 2)) + cell0.m_y;
 		ndUnsigned64 key1 = (cell1.m_z << (D_SPH_HASH_BITS * 2)) + cell1.m_y;
 		ndAssert(key0 <= key1);
@@ -442,11 +491,11 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 void ndBodySphFluid::SortGrids(ndThreadPool* const threadPool)
 {
 	D_TRACKTIME();
+	ndWorkingBuffers& data = *m_workingBuffers;
 	SortXdimension(threadPool);
-	SortCellBuckects(threadPool);
+	SortCellBuckects(threadPool, data.m_hashGridMap);
 
 	#ifdef _DEBUG
-	ndWorkingBuffers& data = *m_workingBuffers;
 	for (ndInt32 i = 0; i < (data.m_hashGridMap.GetCount() - 1); ++i)
 	{
 		const ndGridHash& entry0 = data.m_hashGridMap[i + 0];
@@ -458,25 +507,202 @@ void ndBodySphFluid::SortGrids(ndThreadPool* const threadPool)
 	#endif
 }
 
-void ndBodySphFluid::BuildPairs(ndThreadPool* const threadPool)
+bool ndBodySphFluid::UpdateGrids(ndThreadPool* const threadPool)
 {
 	D_TRACKTIME();
 	ndWorkingBuffers& data = *m_workingBuffers;
-	ndInt32 countReset = data.m_locks.GetCount();
-	data.m_pairs.SetCount(m_posit.GetCount());
-	data.m_locks.SetCount(m_posit.GetCount());
-	data.m_pairCount.SetCount(m_posit.GetCount());
-	data.m_kernelDistance.SetCount(m_posit.GetCount());
-	for (ndInt32 i = countReset; i < data.m_locks.GetCount(); ++i)
+	if (!data.m_gridIsValid)
 	{
-		data.m_locks[i].Unlock();
+		return false;
 	}
-	for (ndInt32 i = 0; i < data.m_pairCount.GetCount(); ++i)
+
+	// only the particles that crossed a cell get new grids
+	CreateGrids(threadPool, true);
+	const ndInt32 movedCount = ndInt32(data.m_movedGridMap.GetCount());
+	if (movedCount * 4 > ndInt32(data.m_hashGridMap.GetCount()))
 	{
-		data.m_pairCount[i] = 0;
+		return false;
 	}
+	if (!movedCount)
+	{
+		return true;
+	}
+
+	SortCellBuckects(threadPool, data.m_movedGridMap);
+
+	// remove the old grids of the moved particles, keeping the order of the others.
+	ndInt32 sums[D_MAX_THREADS_COUNT + 1];
+	auto CountKeptGrids = ndMakeObject::ndFunction([&data, &sums](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CountKeptGrids);
+		const ndInt32* const scans = &data.m_gridScans[0];
+		const ndGridHash* const hashGridMap = &data.m_hashGridMap[0];
+
+		ndInt32 count = 0;
+		const ndStartEnd startEnd(data.m_hashGridMap.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndInt32 particle = ndInt32(hashGridMap[i].m_particleIndex);
+			count += (scans[particle + 1] == scans[particle]) ? 1 : 0;
+		}
+		sums[threadIndex] = count;
+	});
 
-	auto AddPairs = ndMakeObject::ndFunction([this, &data](ndInt32 threadIndex, ndInt32 threadCount)
+	auto CopyKeptGrids = ndMakeObject::ndFunction([&data, &sums](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CopyKeptGrids);
+		const ndInt32* const scans = &data.m_gridScans[0];
+		const ndGridHash* const hashGridMap = &data.m_hashGridMap[0];
+		ndGridHash* const dst = &data.m_hashGridMapScratchBuffer[0];
+
+		ndInt32 index = sums[threadIndex];
+		const ndStartEnd startEnd(data.m_hashGridMap.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndInt32 particle = ndInt32(hashGridMap[i].m_particleIndex);
+			if (scans[particle + 1] == scans[particle])
+			{
+				dst[index] = hashGridMap[i];
+				index++;
+			}
+		}
+	});
+
+	threadPool->ParallelExecute(CountKeptGrids);
+	ndInt32 keptCount = 0;
+	const ndInt32 threadCount = threadPool->GetThreadCount();
+	for (ndInt32 i = 0; i < threadCount; ++i)
+	{
+		const ndInt32 count = sums[i];
+		sums[i] = keptCount;
+		keptCount += count;
+	}
+	sums[threadCount] = keptCount;
+	data.m_hashGridMapScratchBuffer.SetCount(ndMax(keptCount, 1));
+	threadPool->ParallelExecute(CopyKeptGrids);
+
+	// merge the kept and the moved grids, each thread finds where its
+	// slice of the output starts in the two inputs by a binary search 
+	// along the merge path. the order of the particles inside a cell 
+	// is restored later by SortGridCells.
+	const ndInt32 totalCount = keptCount + movedCount;
+	data.m_hashGridMap.SetCount(totalCount);
+	auto MergeGrids = ndMakeObject::ndFunction([&data, keptCount, movedCount, totalCount](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(MergeGrids);
+		const ndGridHash* const kept = &data.m_hashGridMapScratchBuffer[0];
+		const ndGridHash* const moved = &data.m_movedGridMap[0];
+		ndGridHash* const dst = &data.m_hashGridMap[0];
+
+		const ndStartEnd startEnd(totalCount, threadIndex, threadCount);
+		ndInt32 lo = ndMax(0, startEnd.m_start - movedCount);
+		ndInt32 hi = ndMin(startEnd.m_start, keptCount);
+		while (lo < hi)
+		{
+			const ndInt32 mid = (lo + hi) >> 1;
+			if (kept[mid].m_gridHash <= moved[startEnd.m_start - mid - 1].m_gridHash)
+			{
+				lo = mid + 1;
+			}
+			else
+			{
+				hi = mid;
+			}
+		}
+
+		ndInt32 i0 = lo;
+		ndInt32 i1 = startEnd.m_start - lo;
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			if ((i0 < keptCount) && ((i1 >= movedCount) || (kept[i0].m_gridHash <= moved[i1].m_gridHash)))
+			{
+				dst[i] = kept[i0];
+				i0++;
+			}
+			else
+			{
+				dst[i] = moved[i1];
+				i1++;
+			}
+		}
+	});
+	threadPool->ParallelExecute(MergeGrids);
+	data.m_hashGridMapScratchBuffer.SetCount(totalCount);
+	return true;
+}
+
+void ndBodySphFluid::SortGridCells(ndThreadPool* const threadPool)
+{
+	D_TRACKTIME();
+	ndWorkingBuffers& data = *m_workingBuffers;
+
+	// particles moved a little since last update, so the cells are 
+	// almost sorted along x, and an insertion sort is close to linear.
+	ndWorkStealingRange cellRange(data.m_gridScans.GetCount() - 1, threadPool->GetThreadCount());
+	auto SortGridCells = ndMakeObject::ndFunction([this, &data, &cellRange](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(SortGridCells);
+		const ndArray<ndInt32>& gridScans = data.m_gridScans;
+		ndGridHash* const hashGridMap = &data.m_hashGridMap[0];
+
+		auto GetKey = [this, &data](const ndGridHash& cell)
+		{
+			const ndUnsigned64 index = cell.m_particleIndex;
+			const ndUnsigned64 x = ndUnsigned64(data.WorldToGrid(m_posit[ndInt32(index)].m_x));
+			return (x << 32) | index;
+		};
+
+		ndStartEnd startEnd;
+		while (cellRange.GetChunk(threadIndex, startEnd))
+		{
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				const ndInt32 start = gridScans[i];
+				const ndInt32 end = gridScans[i + 1];
+				for (ndInt32 j = start + 1; j < end; ++j)
+				{
+					const ndGridHash cell(hashGridMap[j]);
+					const ndUnsigned64 key = GetKey(cell);
+					ndInt32 k = j - 1;
+					for (; (k >= start) && (GetKey(hashGridMap[k]) > key); --k)
+					{
+						hashGridMap[k + 1] = hashGridMap[k];
+					}
+					hashGridMap[k + 1] = cell;
+				}
+			}
+		}
+	});
+	threadPool->ParallelExecute(SortGridCells);
+
+#ifdef _DEBUG
+	for (ndInt32 i = 1; i < data.m_hashGridMap.GetCount(); ++i)
+	{
+		const ndGridHash& cell0 = data.m_hashGridMap[i - 1];
+		const ndGridHash& cell1 = data.m_hashGridMap[i + 0];
+		ndAssert(cell0.m_gridHash <= cell1.m_gridHash);
+		if (cell0.m_gridHash == cell1.m_gridHash)
+		{
+			ndAssert(data.WorldToGrid(m_posit[ndInt32(cell0.m_particleIndex)].m_x) <= data.WorldToGrid(m_posit[ndInt32(cell1.m_particleIndex)].m_x));
+		}
+	}
+#endif
+}
+
+void ndBodySphFluid::BuildPairs(ndThreadPool* const threadPool)
+{
+	D_TRACKTIME();
+	// the neighbors are saved in a compact buffer, so that the kernels 
+	// read them sequentially. the pairs are found twice, first to count 
+	// the neighbors of each particle, and after the scan to save them.
+	ndWorkingBuffers& data = *m_workingBuffers;
+	const ndInt32 particleCount = m_posit.GetCount();
+	data.m_neighborCount.SetCount(particleCount);
+	data.m_neighborScans.SetCount(particleCount + 1);
+
+	bool savePairs = false;
+	ndWorkStealingRange cellRange(data.m_gridScans.GetCount() - 1, threadPool->GetThreadCount());
+	auto AddPairs = ndMakeObject::ndFunction([this, &data, &cellRange, &savePairs](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(AddPairs);
 		const ndArray<ndGridHash>& hashGridMap = data.m_hashGridMap;
@@ -485,12 +711,43 @@ void ndBodySphFluid::BuildPairs(ndThreadPool* const threadPool)
 		const ndFloat32 diameter2 = diameter * diameter;
 		const ndInt32 windowsTest = data.WorldToGrid(data.m_worlToGridOrigin + diameter) + 1;
 
-		ndArray<ndSpinLock>& locks = data.m_locks;
-		ndArray<ndInt8>& pairCount = data.m_pairCount;
-		ndArray<ndParticlePair>& pair = data.m_pairs;
-		ndArray<ndParticleKernelDistance>& distance = data.m_kernelDistance;
+		const ndVector origin(m_box0);
+		const ndVector box(diameter * ndFloat32(0.5f * 0.99f));
+		const ndVector invGridSize(ndFloat32(1.0f) / diameter);
+
+		ndArray<ndAtomic<ndInt32>>& neighborCount = data.m_neighborCount;
+		ndArray<ndInt32>& neighbors = data.m_neighbors;
+		ndArray<ndFloat32>& neighborDistance = data.m_neighborDistance;
+		const bool save = savePairs;
+
+		// a pair of particles with different home cells can be found in the home 
+		// cells of both, when that happens only the one of the lower index adds it.
+		// the cells of a particle are calculated the same way CreateGrids does.
+		auto IsUniquePair = [this, &origin, &box, &invGridSize](ndInt32 homeParticle, ndInt32 adjacentParticle)
+		{
+			if (homeParticle < adjacentParticle)
+			{
+				return true;
+			}
+			const ndVector r(m_posit[homeParticle] - origin);
+			const ndGridHash box0Hash((r - box) * invGridSize, homeParticle);
+			const ndGridHash box1Hash((r + box) * invGridSize, homeParticle);
+			const ndGridHash homeHash((m_posit[adjacentParticle] - origin) * invGridSize, adjacentParticle);
+			const bool overlap = (homeHash.m_y >= box0Hash.m_y) && (homeHash.m_y <= box1Hash.m_y) && (homeHash.m_z >= box0Hash.m_z) && (homeHash.m_z <= box1Hash.m_z);
+			return !overlap;
+		};
 
-		auto ProccessCell = [this, &data, &hashGridMap, &pair, &pairCount, &locks, &distance, windowsTest, diameter2](ndInt32 start, ndInt32 count)
+		auto AddNeighbor = [&neighborCount, &neighbors, &neighborDistance, save](ndInt32 particle, ndInt32 neighbor, ndFloat32 dist)
+		{
+			const ndInt32 index = neighborCount[particle].fetch_add(1);
+			if (save)
+			{
+				neighbors[index] = neighbor;
+				neighborDistance[index] = dist;
+			}
+		};
+
+		auto ProccessCell = [this, &data, &hashGridMap, &IsUniquePair, &AddNeighbor, windowsTest, diameter2](ndInt32 start, ndInt32 count)
 		{
 			const ndInt32 count0 = count - 1;
 			for (ndInt32 i = 0; i < count0; ++i)
@@ -523,40 +780,12 @@ void ndBodySphFluid::BuildPairs(ndThreadPool* const threadPool)
 						if (dist2 < diameter2)
 						{
 							ndAssert(dist2 >= ndFloat32(0.0f));
-							const ndFloat32 dist = ndSqrt(dist2);
-							{
-								ndSpinLock lock(locks[particle0]);
-								ndInt8 neigborCount = pairCount[particle0];
-								if (neigborCount < 32)
-								{
-									ndInt8 isUnique = 1;
-									ndInt32* const neighborg = pair[particle0].m_neighborg;
-									for (ndInt32 k = neigborCount - 1; k >= 0; --k)
-									{
-										isUnique = isUnique & (neighborg[k] != particle1);
-									}
-
-									neighborg[neigborCount] = particle1;
-									distance[particle0].m_dist[neigborCount] = dist;
-									pairCount[particle0] = neigborCount + isUnique;
-								}
-							}
-
+							const bool unique = (homeGridTest0 & homeGridTest1) || (homeGridTest0 ? IsUniquePair(particle0, particle1) : IsUniquePair(particle1, particle0));
+							if (unique)
 							{
-								ndSpinLock lock(locks[particle1]);
-								ndInt8 neigborCount = pairCount[particle1];
-								if (neigborCount < 32)
-								{
-									ndInt8 isUnique = 1;
-									ndInt32* const neighborg = pair[particle1].m_neighborg;
-									for (ndInt32 k = neigborCount - 1; k >= 0; --k)
-									{
-										isUnique = isUnique & (neighborg[k] != particle0);
-									}
-									neighborg[neigborCount] = particle0;
-									distance[particle1].m_dist[neigborCount] = dist;
-									pairCount[particle1] = neigborCount + isUnique;
-								}
+								const ndFloat32 dist = ndSqrt(dist2);
+								AddNeighbor(particle0, particle1, dist);
+								AddNeighbor(particle1, particle0, dist);
 							}
 						}
 					}
@@ -564,21 +793,79 @@ void ndBodySphFluid::BuildPairs(ndThreadPool* const threadPool)
 			}
 		};
 
-		// even step is nor good because the bashes tend to be clustered
-		// a better way is to sort, bu that takes about 1 ms,
-		// we interleaving bashes and has the randomizing 
-		// effect that balance the work load on the thread.
+		// even step is nor good because the bashes tend to be clustered,
+		// work stealing chunks keeps the cells locality and still
+		// balance the work load on the threads.
+		ndStartEnd startEnd;
+		while (cellRange.GetChunk(threadIndex, startEnd))
+		{
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				const ndInt32 start = gridScans[i];
+				const ndInt32 count = gridScans[i + 1] - start;
+				ProccessCell(start, count);
+			}
+		}
+	});
 
-		const ndInt32 scansCount = gridScans.GetCount() - 1;
-		for (ndInt32 i = threadIndex; i < scansCount; i += threadCount)
+	ndInt32 partialSums[D_MAX_THREADS_COUNT + 1];
+	auto SumNeighbors = ndMakeObject::ndFunction([this, &data, &partialSums](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(SumNeighbors);
+		ndInt32 sum = 0;
+		const ndStartEnd startEnd(m_posit.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 		{
-			const ndInt32 start = gridScans[i];
-			const ndInt32 count = gridScans[i + 1] - start;
-			ProccessCell(start, count);
+			sum += data.m_neighborCount[i].load();
 		}
+		partialSums[threadIndex] = sum;
 	});
-	
+
+	auto ScanNeighbors = ndMakeObject::ndFunction([this, &data, &partialSums](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(ScanNeighbors);
+		// the counters become the cursors of the second pass
+		ndInt32 sum = partialSums[threadIndex];
+		const ndStartEnd startEnd(m_posit.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndInt32 count = data.m_neighborCount[i].load();
+			data.m_neighborScans[i] = sum;
+			data.m_neighborCount[i].store(sum);
+			sum += count;
+		}
+	});
+
+	for (ndInt32 i = 0; i < particleCount; ++i)
+	{
+		data.m_neighborCount[i].store(0);
+	}
 	threadPool->ParallelExecute(AddPairs);
+
+	threadPool->ParallelExecute(SumNeighbors);
+	ndInt32 neighborCount = 0;
+	const ndInt32 threadCount = threadPool->GetThreadCount();
+	for (ndInt32 i = 0; i < threadCount; ++i)
+	{
+		const ndInt32 count = partialSums[i];
+		partialSums[i] = neighborCount;
+		neighborCount += count;
+	}
+	threadPool->ParallelExecute(ScanNeighbors);
+	data.m_neighborScans[particleCount] = neighborCount;
+	data.m_neighbors.SetCount(neighborCount);
+	data.m_neighborDistance.SetCount(neighborCount);
+
+	savePairs = true;
+	cellRange.Reset();
+	threadPool->ParallelExecute(AddPairs);
+
+#ifdef _DEBUG
+	for (ndInt32 i = 0; i < particleCount; ++i)
+	{
+		ndAssert(data.m_neighborCount[i].load() == data.m_neighborScans[i + 1]);
+	}
+#endif
 }
 
 void ndBodySphFluid::CalculateParticlesDensity(ndThreadPool* const threadPool)
@@ -602,12 +889,13 @@ void ndBodySphFluid::CalculateParticlesDensity(ndThreadPool* const threadPool)
 		const ndStartEnd startEnd(posit.GetCount(), threadIndex, threadCount);
 		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
 		{
-			const ndInt32 count = data.m_pairCount[i];
-			const ndParticleKernelDistance& distance = data.m_kernelDistance[i];
+			const ndInt32 start = data.m_neighborScans[i];
+			const ndInt32 count = data.m_neighborScans[i + 1] - start;
+			const ndFloat32* const distance = &data.m_neighborDistance[start];
 			ndFloat32 density = selfDensity;
 			for (ndInt32 j = 0; j < count; ++j)
 			{
-				const ndFloat32 d = distance.m_dist[j];
+				const ndFloat32 d = distance[j];
 				const ndFloat32 dist2 = h2 - d * d;
 				ndAssert(dist2 > ndFloat32(0.0f));
 				const ndFloat32 dist6 = dist2 * dist2 * dist2;
@@ -653,15 +941,16 @@ void ndBodySphFluid::CalculateAccelerations(ndThreadPool* const threadPool)
 			const ndVector p0(posit[i0]);
 			const ndVector v0(veloc[i0]);
 
-			const ndInt32 count = data.m_pairCount[i0];
-			const ndParticlePair& pairs = data.m_pairs[i0];
-			ndParticleKernelDistance& distance = data.m_kernelDistance[i0];
+			const ndInt32 start = data.m_neighborScans[i0];
+			const ndInt32 count = data.m_neighborScans[i0 + 1] - start;
+			const ndInt32* const neighbors = &data.m_neighbors[start];
+			const ndFloat32* const distance = &data.m_neighborDistance[start];
 			const ndFloat32 pressureI0 = density[i0] - restDensity;
 
 			ndVector forceAcc(ndVector::m_zero);
 			for (ndInt32 j = 0; j < count; ++j)
 			{
-				const ndInt32 i1 = pairs.m_neighborg[j];
+				const ndInt32 i1 = neighbors[j];
 				const ndVector p10(posit[i1] - p0);
 				const ndVector dot(p10.DotProduct(p10) + epsilon2);
 				const ndVector unitDir(p10 * dot.InvSqrt());
@@ -669,7 +958,7 @@ void ndBodySphFluid::CalculateAccelerations(ndThreadPool* const threadPool)
 				ndAssert(unitDir.m_w == ndFloat32(0.0f));
 
 				// kernel distance
-				const ndFloat32 dist = distance.m_dist[j];
+				const ndFloat32 dist = distance[j];
 				const ndFloat32 kernelDist = h - dist;
 				ndAssert(kernelDist >= ndFloat32(0.0f));
 
@@ -775,16 +1064,27 @@ void ndBodySphFluid::CaculateAabb(ndThreadPool* const threadPool)
 	box.m_min = grid * (box.m_min * invGrid).Floor();
 	box.m_max = grid * (box.m_max * invGrid).Floor();
 
+	ndWorkingBuffers& data = *m_workingBuffers;
+	if (m_temporalCoherence && data.m_gridIsValid && (data.m_particleCellKeys.GetCount() == m_posit.GetCount()))
+	{
+		// keep last update's grids while the fluid fits inside them
+		const ndInt32 outside = ((box.m_min - m_box0).GetSignMask() | (m_box1 - box.m_max).GetSignMask()) & 0x07;
+		if (!outside)
+		{
+			return;
+		}
+	}
+	data.m_gridIsValid = false;
+
 	// make sure the w component is zero.
 	m_box0 = box.m_min & ndVector::m_triplexMask;
 	m_box1 = box.m_max & ndVector::m_triplexMask;
 
-	ndWorkingBuffers& data = *m_workingBuffers;
 	ndInt32 numberOfGrid = ndInt32((box.m_max.m_x - box.m_min.m_x) * invGrid.m_x + ndFloat32(1.0f));
 	data.SetWorldToGridMapping(numberOfGrid, m_box1.m_x, m_box0.m_x);
 }
 
-void ndBodySphFluid::CreateGrids(ndThreadPool* const threadPool)
+void ndBodySphFluid::CreateGrids(ndThreadPool* const threadPool, bool movedParticlesOnly)
 {
 	D_TRACKTIME();
 	class ndGridNeighborInfo
@@ -849,7 +1149,8 @@ void ndBodySphFluid::CreateGrids(ndThreadPool* const threadPool)
 	ndGridNeighborInfo neiborghood;
 	ndWorkingBuffers& data = *m_workingBuffers;
 	
-	auto CountGrids = ndMakeObject::ndFunction([this, &data, &neiborghood](ndInt32 threadIndex, ndInt32 threadCount)
+	const bool saveCellKeys = m_temporalCoherence;
+	auto CountGrids = ndMakeObject::ndFunction([this, &data, &neiborghood, saveCellKeys, movedParticlesOnly](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(CountGrids);
 		const ndVector origin(m_box0);
@@ -858,6 +1159,7 @@ void ndBodySphFluid::CreateGrids(ndThreadPool* const threadPool)
 		const ndVector invGridSize(ndFloat32(1.0f) / gridSize);
 		const ndVector* const posit = &m_posit[0];
 		ndInt32* const scans = &data.m_gridScans[0];
+		ndUnsigned64* const cellKeys = saveCellKeys ? &data.m_particleCellKeys[0] : nullptr;
 
 		const ndStartEnd startEnd(m_posit.GetCount(), threadIndex, threadCount);
 		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
@@ -876,15 +1178,29 @@ void ndBodySphFluid::CreateGrids(ndThreadPool* const threadPool)
 			ndAssert(codeHash.m_z <= 1);
 			const ndUnsigned32 code = ndUnsigned32(codeHash.m_z * 2 + codeHash.m_y);
 			scans[i] = neiborghood.m_counter[code];
+
+			if (saveCellKeys)
+			{
+				// the cells a particle is binned into, and which one is its home.
+				const ndGridHash homeHash(hashKey.m_gridHash - box0Hash.m_gridHash);
+				const ndUnsigned64 homeCode = homeHash.m_z * 2 + homeHash.m_y;
+				const ndUnsigned64 cellKey = ndUnsigned64(box0Hash.m_gridHash) | (ndUnsigned64(code) << 32) | (homeCode << 34);
+				if (movedParticlesOnly && (cellKeys[i] == cellKey))
+				{
+					scans[i] = 0;
+				}
+				cellKeys[i] = cellKey;
+			}
 		}
 	});
 
-	auto CreateGrids = ndMakeObject::ndFunction([this, &data, &neiborghood](ndInt32 threadIndex, ndInt32 threadCount)
+	ndArray<ndGridHash>& grids = movedParticlesOnly ? data.m_movedGridMap : data.m_hashGridMap;
+	auto CreateGrids = ndMakeObject::ndFunction([this, &data, &grids, &neiborghood](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(CreateGrids);
 		const ndVector origin(m_box0);
 		const ndFloat32 gridSize = GetSphGridSize();
-		ndGridHash* const dst = &data.m_hashGridMap[0];
+		ndGridHash* const dst = &grids[0];
 		const ndInt32* const scans = &data.m_gridScans[0];
 		
 		// the 0.99 factor is to make sure the box 
@@ -925,8 +1241,14 @@ void ndBodySphFluid::CreateGrids(ndThreadPool* const threadPool)
 	});
 	ndAssert(sizeof(ndGridHash) <= 16);
 
+	ndAssert(!movedParticlesOnly || saveCellKeys);
+	ndAssert(!movedParticlesOnly || (data.m_particleCellKeys.GetCount() == m_posit.GetCount()));
 	data.m_gridScans.SetCount(m_posit.GetCount() + 1);
 	data.m_gridScans[m_posit.GetCount()] = 0;
+	if (saveCellKeys)
+	{
+		data.m_particleCellKeys.SetCount(m_posit.GetCount());
+	}
 	threadPool->ParallelExecute(CountGrids);
 	
 	ndInt32 gridCount = 0;
@@ -937,9 +1259,274 @@ void ndBodySphFluid::CreateGrids(ndThreadPool* const threadPool)
 		gridCount += count;
 	}
 	
-	data.m_hashGridMap.SetCount(gridCount);
-	threadPool->ParallelExecute(CreateGrids);
-	data.m_hashGridMapScratchBuffer.SetCount(gridCount);
+	grids.SetCount(gridCount);
+	if (gridCount)
+	{
+		threadPool->ParallelExecute(CreateGrids);
+	}
+	if (!movedParticlesOnly)
+	{
+		data.m_hashGridMapScratchBuffer.SetCount(gridCount);
+	}
+}
+
+void ndBodySphFluid::CalculateBodyCoupling(ndThreadPool* const threadPool)
+{
+	D_TRACKTIME();
+	ndWorkingBuffers& data = *m_workingBuffers;
+	const ndInt32 proxyCount = ndInt32(data.m_bodyProxies.GetCount());
+	m_couplingTests = 0;
+	if (!proxyCount)
+	{
+		return;
+	}
+
+	const ndInt32 threadCount = threadPool->GetThreadCount();
+	data.m_proxyImpulses.SetCount(threadCount * proxyCount * 2);
+	for (ndInt32 i = 0; i < ndInt32(data.m_proxyImpulses.GetCount()); ++i)
+	{
+		data.m_proxyImpulses[i] = ndVector::m_zero;
+	}
+
+	// bin the proxies in a grid over the fluid box, no larger than the 
+	// number of particles. particles and proxies outside the box are 
+	// clamped to its border cells, so a particle inside a proxy box 
+	// always finds that proxy in its cell.
+	const ndFloat32 maxCells = ndFloat32(m_posit.GetCount());
+	ndFloat32 cellSize = GetSphGridSize();
+	ndVector cellCount(((m_box1 - m_box0).Scale(ndFloat32(1.0f) / cellSize)).Floor() + ndVector::m_one);
+	while ((cellCount.m_x * cellCount.m_y * cellCount.m_z) > maxCells)
+	{
+		cellSize *= ndFloat32(2.0f);
+		cellCount = ((m_box1 - m_box0).Scale(ndFloat32(1.0f) / cellSize)).Floor() + ndVector::m_one;
+	}
+
+	const ndVector zero(ndVector::m_zero);
+	const ndVector invCellSize(ndFloat32(1.0f) / cellSize);
+	const ndVector maxCell((cellCount - ndVector::m_one) & ndVector::m_triplexMask);
+	const ndVector cellOrigin(m_box0);
+	auto GetCell = [&zero, &invCellSize, &maxCell, &cellOrigin](const ndVector& p)
+	{
+		return (((p - cellOrigin) * invCellSize).Floor().GetMax(zero).GetMin(maxCell)).GetInt();
+	};
+
+	const ndInt32 cellCountX = ndInt32(cellCount.m_x);
+	const ndInt32 cellCountY = ndInt32(cellCount.m_y);
+	const ndInt32 gridCells = cellCountX * cellCountY * ndInt32(cellCount.m_z);
+	ndArray<ndInt32>& proxyCellScans = data.m_proxyCellScans;
+	proxyCellScans.SetCount(gridCells + 1);
+	for (ndInt32 i = 0; i <= gridCells; ++i)
+	{
+		proxyCellScans[i] = 0;
+	}
+
+	for (ndInt32 i = 0; i < proxyCount; ++i)
+	{
+		const ndBodyProxy& proxy = data.m_bodyProxies[i];
+		const ndVector cell0(GetCell(proxy.m_minBox));
+		const ndVector cell1(GetCell(proxy.m_maxBox));
+		for (ndInt32 z = cell0.m_iz; z <= cell1.m_iz; ++z)
+		{
+			for (ndInt32 y = cell0.m_iy; y <= cell1.m_iy; ++y)
+			{
+				for (ndInt32 x = cell0.m_ix; x <= cell1.m_ix; ++x)
+				{
+					proxyCellScans[(z * cellCountY + y) * cellCountX + x]++;
+				}
+			}
+		}
+	}
+
+	ndInt32 cellSum = 0;
+	for (ndInt32 i = 0; i < gridCells; ++i)
+	{
+		cellSum += proxyCellScans[i];
+		proxyCellScans[i] = cellSum;
+	}
+	proxyCellScans[gridCells] = cellSum;
+
+	// filled backward, so each cell ends up with its start offset
+	data.m_proxyCells.SetCount(cellSum);
+	for (ndInt32 i = proxyCount - 1; i >= 0; --i)
+	{
+		const ndBodyProxy& proxy = data.m_bodyProxies[i];
+		const ndVector cell0(GetCell(proxy.m_minBox));
+		const ndVector cell1(GetCell(proxy.m_maxBox));
+		for (ndInt32 z = cell0.m_iz; z <= cell1.m_iz; ++z)
+		{
+			for (ndInt32 y = cell0.m_iy; y <= cell1.m_iy; ++y)
+			{
+				for (ndInt32 x = cell0.m_ix; x <= cell1.m_ix; ++x)
+				{
+					const ndInt32 index = --proxyCellScans[(z * cellCountY + y) * cellCountX + x];
+					data.m_proxyCells[index] = i;
+				}
+			}
+		}
+	}
+
+	ndInt32 couplingTests[D_MAX_THREADS_COUNT];
+	auto CalculateBodyCoupling = ndMakeObject::ndFunction([this, &data, &GetCell, &couplingTests, proxyCount, cellCountX, cellCountY](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateBodyCoupling);
+		ndArray<ndVector>& veloc = m_veloc;
+		ndArray<ndVector>& posit = m_posit;
+		const ndBodyProxy* const proxies = &data.m_bodyProxies[0];
+		const ndInt32* const proxyCellScans = &data.m_proxyCellScans[0];
+		const ndInt32* const proxyCells = &data.m_proxyCells[0];
+		const ndVector* const directions = data.m_couplingDirections;
+		ndVector* const impulses = &data.m_proxyImpulses[threadIndex * proxyCount * 2];
+
+		ndInt32 tests = 0;
+		const ndFloat32 radius = GetParticleRadius();
+		const ndVector mass(m_mass);
+		const ndStartEnd startEnd(posit.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndVector cell(GetCell(posit[i]));
+			const ndInt32 cellIndex = (cell.m_iz * cellCountY + cell.m_iy) * cellCountX + cell.m_ix;
+			const ndInt32 start = proxyCellScans[cellIndex];
+			const ndInt32 count = proxyCellScans[cellIndex + 1] - start;
+			tests += count;
+			for (ndInt32 n = 0; n < count; ++n)
+			{
+				const ndInt32 j = proxyCells[start + n];
+				const ndBodyProxy& proxy = proxies[j];
+				const ndVector p(posit[i]);
+				if (!ndOverlapTest(proxy.m_minBox, proxy.m_maxBox, p, p))
+				{
+					continue;
+				}
+
+				// the separation is the largest distance to the support planes
+				const ndVector localPoint(proxy.m_matrix.UntransformVector(p));
+				ndInt32 face = 0;
+				ndFloat32 dist = ndFloat32(-1.0e10f);
+				for (ndInt32 k = 0; k < D_SPH_COUPLING_DIRECTIONS; ++k)
+				{
+					const ndFloat32 side = directions[k].DotProduct(localPoint).GetScalar() - proxy.m_support[k];
+					if (side > dist)
+					{
+						face = k;
+						dist = side;
+					}
+				}
+
+				const ndFloat32 penetration = radius - dist;
+				if (penetration > ndFloat32(0.0f))
+				{
+					const ndVector normal(proxy.m_matrix.RotateVector(directions[face]));
+					const ndVector r(p - proxy.m_com);
+					const ndVector bodyVeloc(proxy.m_veloc + proxy.m_omega.CrossProduct(r));
+					const ndFloat32 normalSpeed = (veloc[i] - bodyVeloc).DotProduct(normal).GetScalar();
+
+					posit[i] += normal.Scale(penetration);
+					if (normalSpeed < ndFloat32(0.0f))
+					{
+						const ndVector deltaVeloc(normal.Scale(-normalSpeed));
+						veloc[i] += deltaVeloc;
+						if (proxy.m_dynamic)
+						{
+							const ndVector impulse(mass * deltaVeloc);
+							impulses[j * 2 + 0] -= impulse;
+							impulses[j * 2 + 1] -= r.CrossProduct(impulse);
+						}
+					}
+				}
+			}
+		}
+		couplingTests[threadIndex] = tests;
+	});
+
+	threadPool->ParallelExecute(CalculateBodyCoupling);
+	for (ndInt32 i = 0; i < threadCount; ++i)
+	{
+		m_couplingTests += couplingTests[i];
+	}
+
+	for (ndInt32 i = 0; i < proxyCount; ++i)
+	{
+		ndVector impulse(ndVector::m_zero);
+		ndVector angularImpulse(ndVector::m_zero);
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			impulse += data.m_proxyImpulses[(j * proxyCount + i) * 2 + 0];
+			angularImpulse += data.m_proxyImpulses[(j * proxyCount + i) * 2 + 1];
+		}
+		ndBodyProxy& proxy = data.m_bodyProxies[i];
+		proxy.m_impulse += impulse & ndVector::m_triplexMask;
+		proxy.m_angularImpulse += angularImpulse & ndVector::m_triplexMask;
+	}
+}
+
+void ndBodySphFluid::UpdateBodyProxies(const ndWorld* const world, ndFloat32 timestep)
+{
+	D_TRACKTIME();
+	ndWorkingBuffers& data = *m_workingBuffers;
+	if (!m_coupleRigidBodies)
+	{
+		data.m_bodyProxies.SetCount(0);
+		return;
+	}
+
+	// the bodies may have been removed while the fluid was updating, 
+	// so the impulses of the last update go to the bodies that are 
+	// still overlapping the fluid, matched by their ids.
+	ndTree<ndInt32, ndUnsigned32> proxyMap;
+	for (ndInt32 i = 0; i < ndInt32(data.m_bodyProxies.GetCount()); ++i)
+	{
+		proxyMap.Insert(i, data.m_bodyProxies[i].m_bodyId);
+	}
+
+	const ndVector padding(GetSphGridSize());
+	ndBodiesInAabbNotify notify;
+	const ndScene* const scene = world->GetScene();
+	scene->BodiesInAabb(notify, (m_box0 - padding) & ndVector::m_triplexMask, (m_box1 + padding) & ndVector::m_triplexMask);
+
+	ndArray<ndBodyProxy> proxies;
+	const ndVector radius(GetParticleRadius());
+	const ndVector* const directions = data.m_couplingDirections;
+	for (ndInt32 i = 0; i < ndInt32(notify.m_bodyArray.GetCount()); ++i)
+	{
+		ndBodyKinematic* const body = ((ndBody*)notify.m_bodyArray[i])->GetAsBodyKinematic();
+		ndAssert(body);
+
+		ndTree<ndInt32, ndUnsigned32>::ndNode* const node = proxyMap.Find(body->GetId());
+		if (node)
+		{
+			const ndBodyProxy& proxy = data.m_bodyProxies[node->GetInfo()];
+			body->ApplyImpulsePair(proxy.m_impulse, proxy.m_angularImpulse, timestep);
+		}
+
+		const ndShapeInstance& shapeInstance = body->GetCollisionShape();
+		ndShape* const shape = (ndShape*)shapeInstance.GetShape();
+		if (!shape->GetAsShapeConvex() || shape->GetAsShapeNull())
+		{
+			continue;
+		}
+
+		ndVector minBox;
+		ndVector maxBox;
+		body->GetAABB(minBox, maxBox);
+
+		ndBodyProxy proxy;
+		proxy.m_matrix = shapeInstance.GetGlobalMatrix();
+		proxy.m_minBox = (minBox - radius) & ndVector::m_triplexMask;
+		proxy.m_maxBox = (maxBox + radius) & ndVector::m_triplexMask;
+		proxy.m_veloc = body->GetVelocity();
+		proxy.m_omega = body->GetOmega();
+		proxy.m_com = body->GetGlobalGetCentreOfMass();
+		proxy.m_impulse = ndVector::m_zero;
+		proxy.m_angularImpulse = ndVector::m_zero;
+		proxy.m_bodyId = body->GetId();
+		proxy.m_dynamic = body->GetInvMass() > ndFloat32(0.0f);
+		for (ndInt32 j = 0; j < D_SPH_COUPLING_DIRECTIONS; ++j)
+		{
+			proxy.m_support[j] = directions[j].DotProduct(shapeInstance.SupportVertex(directions[j])).GetScalar();
+		}
+		proxies.PushBack(proxy);
+	}
+	data.m_bodyProxies.Swap(proxies);
 }
 
 void ndBodySphFluid::Execute(ndThreadPool* const threadPool)
@@ -950,13 +1537,23 @@ void ndBodySphFluid::Execute(ndThreadPool* const threadPool)
 	if (m_posit.GetCount())
 	{
 		CaculateAabb(threadPool);
-		CreateGrids(threadPool);
-		SortGrids(threadPool);
+		const bool gridsReused = m_temporalCoherence && UpdateGrids(threadPool);
+		if (!gridsReused)
+		{
+			CreateGrids(threadPool, false);
+			SortGrids(threadPool);
+		}
 		CalculateScans(threadPool);
+		if (gridsReused)
+		{
+			SortGridCells(threadPool);
+		}
+		m_workingBuffers->m_gridIsValid = m_temporalCoherence;
 		BuildPairs(threadPool);
 		CalculateParticlesDensity(threadPool);
 		CalculateAccelerations(threadPool);
 		IntegrateParticles(threadPool);
+		CalculateBodyCoupling(threadPool);
 	}
 }
 
@@ -964,6 +1561,7 @@ void ndBodySphFluid::Update(const ndWorld* const world, ndFloat32 timestep)
 {
 	if (taskState() == ndBackgroundTask::m_taskCompleted)
 	{
+		UpdateBodyProxies(world, timestep);
 		m_timestep = timestep;
 		ndScene* const scene = world->GetScene();
 		scene->SendBackgroundTask(this);
@@ -47,6 +47,25 @@ class ndBodySphFluid: public ndBodyParticleSet
 
 	ndFloat32 GetSphGridSize() const;
 
+	/// Two way interaction with the rigid bodies of the world.
+	/// \brief when enabled, the particles collide with the convex bodies 
+	/// overlapping the fluid, and the momentum they exchange is applied
+	/// back to the bodies as impulses, so buoyancy and splash forces go both ways.
+	bool GetRigidBodyCoupling() const;
+	void SetRigidBodyCoupling(bool state);
+
+	/// Number of particle and body pairs tested by the last coupling pass.
+	/// \brief the bodies are binned in a grid over the fluid, so each
+	/// particle is only tested against the bodies sharing its cell.
+	ndInt32 GetCouplingTestCount() const;
+
+	/// Reuse the neighbor search grids of the last update.
+	/// \brief when enabled, only the particles that crossed a cell are
+	/// re-bucketed and merged with last update's sorted cells, the full
+	/// sort only runs when many particles moved or the fluid outgrew its box.
+	bool GetTemporalCoherence() const;
+	void SetTemporalCoherence(bool state);
+
 	virtual ndBodySphFluid* GetAsBodySphFluid();
 	D_NEWTON_API virtual void Save(const ndLoadSaveBase::ndSaveDescriptor& desc) const;
 
@@ -64,20 +83,23 @@ class ndBodySphFluid: public ndBodyParticleSet
 	};
 
 	class ndGridHash;
-	class ndParticlePair;
+	class ndBodyProxy;
 	class ndWorkingBuffers;
-	class ndParticleKernelDistance;
 
+	bool UpdateGrids(ndThreadPool* const threadPool);
 	void SortGrids(ndThreadPool* const threadPool);
+	void SortGridCells(ndThreadPool* const threadPool);
 	void BuildPairs(ndThreadPool* const threadPool);
-	void CreateGrids(ndThreadPool* const threadPool);
+	void CreateGrids(ndThreadPool* const threadPool, bool movedParticlesOnly);
 	void CaculateAabb(ndThreadPool* const threadPool);
 	void SortXdimension(ndThreadPool* const threadPool);
 	void CalculateScans(ndThreadPool* const threadPool);
-	void SortCellBuckects(ndThreadPool* const threadPool);
+	void SortCellBuckects(ndThreadPool* const threadPool, ndArray<ndGridHash>& grids);
 	void IntegrateParticles(ndThreadPool* const threadPool);
 	void CalculateAccelerations(ndThreadPool* const threadPool);
 	void CalculateParticlesDensity(ndThreadPool* const threadPool);
+	void CalculateBodyCoupling(ndThreadPool* const threadPool);
+	void UpdateBodyProxies(const ndWorld* const world, ndFloat32 timestep);
 
 	ndWorkingBuffers* m_workingBuffers;
 	ndFloat32 m_mass;
@@ -85,6 +107,9 @@ class ndBodySphFluid: public ndBodyParticleSet
 	ndFloat32 m_restDensity;
 	ndFloat32 m_gasConstant;
 	ndFloat32 m_timestep;
+	ndInt32 m_couplingTests;
+	bool m_coupleRigidBodies;
+	bool m_temporalCoherence;
 } D_GCC_NEWTON_ALIGN_32 ;
 
 inline bool ndBodySphFluid::RayCast(ndRayCastNotify&, const ndFastRay&, const ndFloat32) const
@@ -137,6 +162,31 @@ inline void ndBodySphFluid::SetGasConstant(ndFloat32 gasConst)
 	m_gasConstant = gasConst;
 }
 
+inline bool ndBodySphFluid::GetRigidBodyCoupling() const
+{
+	return m_coupleRigidBodies;
+}
+
+inline void ndBodySphFluid::SetRigidBodyCoupling(bool state)
+{
+	m_coupleRigidBodies = state;
+}
+
+inline ndInt32 ndBodySphFluid::GetCouplingTestCount() const
+{
+	return m_couplingTests;
+}
+
+inline bool ndBodySphFluid::GetTemporalCoherence() const
+{
+	return m_temporalCoherence;
+}
+
+inline void ndBodySphFluid::SetTemporalCoherence(bool state)
+{
+	m_temporalCoherence = state;
+}
+
 inline ndFloat32 ndBodySphFluid::GetSphGridSize() const
 {
 	return GetParticleRadius() * ndFloat32(2.0f) * ndFloat32(1.5f);
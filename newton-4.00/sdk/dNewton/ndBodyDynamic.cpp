@@ -378,7 +378,7 @@ void ndBodyDynamic::EvaluateSleepState(ndFloat32 freezeSpeed2, ndFloat32 freezeA
 		ndContactMap::Iterator it(m_contactList);
 		for (it.Begin(); it; it++)
 		{
-			ndContact* const contact = it.GetNode()->GetInfo();
+			ndContact* const contact = *it;
 			if (contact->IsActive())
 			{
 				if (contact->GetBody0()->GetAsBodyDynamic() && contact->GetBody1()->GetAsBodyDynamic())
@@ -90,8 +90,10 @@ class ndBodyDynamic: public ndBodyKinematic
 	friend class ndDynamicsUpdate;
 	friend class ndDynamicsUpdateSoa;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateCuda;
 	friend class ndDynamicsUpdateOpencl;
+	friend class ndDynamicsUpdateGraphColor;
 } D_GCC_NEWTON_ALIGN_32 ;
 
 inline ndVector ndBodyDynamic::GetForce() const
@@ -33,6 +33,12 @@
 ndDynamicsUpdate::ndDynamicsUpdate(ndWorld* const world)
 	:m_velocTol(ndFloat32(1.0e-8f))
 	,m_islands(D_DEFAULT_BUFFER_SIZE)
+	,m_islandScan(D_DEFAULT_BUFFER_SIZE)
+	,m_islandBodyScan(D_DEFAULT_BUFFER_SIZE)
+	,m_islandJoints(D_DEFAULT_BUFFER_SIZE)
+	,m_islandBodies(D_DEFAULT_BUFFER_SIZE)
+	,m_activeIslands(D_DEFAULT_BUFFER_SIZE)
+	,m_jointResidual(D_DEFAULT_BUFFER_SIZE)
 	,m_jointForcesIndex(D_DEFAULT_BUFFER_SIZE)
 	,m_internalForces(D_DEFAULT_BUFFER_SIZE)
 	,m_leftHandSide(D_DEFAULT_BUFFER_SIZE * 4)
@@ -48,8 +54,11 @@ ndDynamicsUpdate::ndDynamicsUpdate(ndWorld* const world)
 	,m_timestepRK(ndFloat32(0.0f))
 	,m_invTimestepRK(ndFloat32(0.0f))
 	,m_solverPasses(0)
+	,m_islandBodyCount(0)
+	,m_islandBodyPasses(0)
 	,m_activeJointCount(0)
 	,m_unConstrainedBodyCount(0)
+	,m_jacobiPreconditioner(true)
 {
 }
 
@@ -66,6 +75,12 @@ const char* ndDynamicsUpdate::GetStringId() const
 void ndDynamicsUpdate::Clear()
 {
 	m_islands.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_islandScan.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_islandBodyScan.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_islandJoints.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_islandBodies.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_activeIslands.Resize(D_DEFAULT_BUFFER_SIZE);
+	m_jointResidual.Resize(D_DEFAULT_BUFFER_SIZE);
 	m_rightHandSide.Resize(D_DEFAULT_BUFFER_SIZE);
 	m_internalForces.Resize(D_DEFAULT_BUFFER_SIZE);
 	m_bodyIslandOrder.Resize(D_DEFAULT_BUFFER_SIZE);
@@ -135,8 +150,8 @@ void ndDynamicsUpdate::SortBodyJointScan()
 	});
 	scene->ParallelExecute(CountJointBodyPairs);
 
-	scene->GetScratchBuffer().SetCount(bodyJointPairs.GetCount() * ndInt32 (sizeof (ndJointBodyPairIndex)));
-	ndJointBodyPairIndex* const tempBuffer = (ndJointBodyPairIndex*)&scene->GetScratchBuffer()[0];
+	ndFrameArenaScope arenaScope(scene->GetFrameArena());
+	ndJointBodyPairIndex* const tempBuffer = scene->GetFrameArena().Alloc<ndJointBodyPairIndex>(bodyJointPairs.GetCount());
 
 	ndCountingSort<ndJointBodyPairIndex, ndEvaluateKey0, D_MAX_BODY_RADIX_BIT>(*scene, &bodyJointPairs[0], tempBuffer, bodyJointPairs.GetCount(), nullptr, nullptr);
 	ndCountingSort<ndJointBodyPairIndex, ndEvaluateKey1, D_MAX_BODY_RADIX_BIT>(*scene, tempBuffer, &bodyJointPairs[0], bodyJointPairs.GetCount(), nullptr, nullptr);
@@ -259,6 +274,9 @@ void ndDynamicsUpdate::SortJointsScan()
 	ndInt32 movingJoints[D_MAX_THREADS_COUNT];
 	const ndInt32 threadCount = scene->GetThreadCount();
 	
+	ndFrameArenaScope arenaScope(scene->GetFrameArena());
+	ndConstraint** const tempJointBuffer = scene->GetFrameArena().Alloc<ndConstraint*>(jointArray.GetCount() + 32);
+
 	auto MarkFence0 = ndMakeObject::ndFunction([&jointArray](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(MarkFence0);
@@ -315,12 +333,11 @@ void ndDynamicsUpdate::SortJointsScan()
 		movingJoints[threadIndex] = activeJointCount;
 	});
 	
-	auto Scan0 = ndMakeObject::ndFunction([&jointArray, &histogram, scene](ndInt32 threadIndex, ndInt32 threadCount)
+	auto Scan0 = ndMakeObject::ndFunction([&jointArray, &histogram, tempJointBuffer](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(Scan0);
 		ndInt32* const hist = &histogram[threadIndex][0];
-		ndAssert(scene->GetScratchBuffer().GetCount() >= ndInt32 (jointArray.GetCount() * sizeof(ndConstraint*)));
-		ndConstraint** const dstBuffer = (ndConstraint**)&scene->GetScratchBuffer()[0];
+		ndConstraint** const dstBuffer = tempJointBuffer;
 	
 		hist[0] = 0;
 		hist[1] = 0;
@@ -337,12 +354,11 @@ void ndDynamicsUpdate::SortJointsScan()
 		}
 	});
 	
-	auto Sort0 = ndMakeObject::ndFunction([&jointArray, &histogram, scene](ndInt32 threadIndex, ndInt32 threadCount)
+	auto Sort0 = ndMakeObject::ndFunction([&jointArray, &histogram, tempJointBuffer](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(Sort0);
 		ndInt32* const hist = &histogram[threadIndex][0];
-		ndAssert(scene->GetScratchBuffer().GetCount() >= ndInt32 (jointArray.GetCount() * sizeof (ndConstraint*)));
-		ndConstraint** const dstBuffer = (ndConstraint**)&scene->GetScratchBuffer()[0];
+		ndConstraint** const dstBuffer = tempJointBuffer;
 	
 		const ndStartEnd startEnd(jointArray.GetCount(), threadIndex, threadCount);
 		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
@@ -357,9 +373,6 @@ void ndDynamicsUpdate::SortJointsScan()
 		}
 	});
 	
-	scene->GetScratchBuffer().SetCount((jointArray.GetCount() + 32) * ndInt32 (sizeof (ndConstraint*)));
-	ndConstraint** const tempJointBuffer = (ndConstraint**)&scene->GetScratchBuffer()[0];
-	
 	scene->ParallelExecute(MarkFence0);
 	scene->ParallelExecute(MarkFence1);
 	scene->ParallelExecute(Scan0);
@@ -794,7 +807,8 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 	ndBodyKinematic** const bodyArray = &scene->GetActiveBodyArray()[0];
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
-	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	ndWorkStealingRange jointRange(jointArray.GetCount(), scene->GetThreadCount());
+	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &jointArray, &jointRange](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(InitJacobianMatrix);
 		ndJacobian* const internalForces = &GetTempInternalForces()[0];
@@ -823,8 +837,10 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 			ndVector forceAcc1(zero);
 			ndVector torqueAcc1(zero);
 
-			const ndVector weigh0(body0->m_weigh);
-			const ndVector weigh1(body1->m_weigh);
+			// the jacobi passes scale the diagonal by the body connectivity, 
+			// sequential passes use the true diagonal.
+			const ndVector weigh0(m_jacobiPreconditioner ? body0->m_weigh : ndFloat32(1.0f));
+			const ndVector weigh1(m_jacobiPreconditioner ? body1->m_weigh : ndFloat32(1.0f));
 
 			const bool isBilateral = joint->IsBilateral();
 			for (ndInt32 i = 0; i < count; ++i)
@@ -883,12 +899,15 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 			outBody1.m_angular = torqueAcc1;
 		};
 
-		const ndInt32 jointCount = jointArray.GetCount();
-		for (ndInt32 i = threadIndex; i < jointCount; i += threadCount)
+		ndStartEnd startEnd;
+		while (jointRange.GetChunk(threadIndex, startEnd))
 		{
-			ndConstraint* const joint = jointArray[i];
-			GetJacobianDerivatives(joint);
-			BuildJacobianMatrix(joint, i);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				ndConstraint* const joint = jointArray[i];
+				GetJacobianDerivatives(joint);
+				BuildJacobianMatrix(joint, i);
+			}
 		}
 	});
 
@@ -1172,16 +1191,21 @@ void ndDynamicsUpdate::InitSkeletons()
 	ndScene* const scene = m_world->GetScene();
 	const ndArray<ndSkeletonContainer*>& activeSkeletons = m_world->m_activeSkeletons;
 
-	auto InitSkeletons = ndMakeObject::ndFunction([this, &activeSkeletons](ndInt32 threadIndex, ndInt32 threadCount)
+	ndWorkStealingRange skeletonRange(activeSkeletons.GetCount(), scene->GetThreadCount(), 1);
+	auto InitSkeletons = ndMakeObject::ndFunction([this, &activeSkeletons, &skeletonRange](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(InitSkeletons);
 		ndArray<ndRightHandSide>& rightHandSide = m_rightHandSide;
 		const ndArray<ndLeftHandSide>& leftHandSide = m_leftHandSide;
 
-		for (ndInt32 i = threadIndex; i < activeSkeletons.GetCount(); i += threadCount)
+		ndStartEnd startEnd;
+		while (skeletonRange.GetChunk(threadIndex, startEnd))
 		{
-			ndSkeletonContainer* const skeleton = activeSkeletons[i];
-			skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0]);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				ndSkeletonContainer* const skeleton = activeSkeletons[i];
+				skeleton->InitMassMatrix(&leftHandSide[0], &rightHandSide[0]);
+			}
 		}
 	});
 
@@ -1189,6 +1213,44 @@ void ndDynamicsUpdate::InitSkeletons()
 	{
 		scene->ParallelExecute(InitSkeletons);
 	}
+	InitParallelSkeletons();
+}
+
+void ndDynamicsUpdate::InitParallelSkeletons()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndSkeletonContainer*>& parallelSkeletons = m_world->m_parallelSkeletons;
+	if (parallelSkeletons.GetCount() < scene->GetThreadCount())
+	{
+		// not enough big skeletons for all the threads, 
+		// so all the threads factorize the subtrees of each one.
+		for (ndInt32 i = 0; i < parallelSkeletons.GetCount(); ++i)
+		{
+			ndSkeletonContainer* const skeleton = parallelSkeletons[i];
+			skeleton->InitMassMatrix(&m_leftHandSide[0], &m_rightHandSide[0], scene);
+		}
+	}
+	else
+	{
+		// each thread factorizes whole skeletons, 
+		// there is no need to pay for the barriers of the subtrees.
+		ndWorkStealingRange skeletonRange(parallelSkeletons.GetCount(), scene->GetThreadCount(), 1);
+		auto InitSkeletons = ndMakeObject::ndFunction([this, &parallelSkeletons, &skeletonRange](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(InitParallelSkeletons);
+			ndStartEnd startEnd;
+			while (skeletonRange.GetChunk(threadIndex, startEnd))
+			{
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+				{
+					ndSkeletonContainer* const skeleton = parallelSkeletons[i];
+					skeleton->InitMassMatrix(&m_leftHandSide[0], &m_rightHandSide[0]);
+				}
+			}
+		});
+		scene->ParallelExecute(InitSkeletons);
+	}
 }
 
 void ndDynamicsUpdate::UpdateSkeletons()
@@ -1198,14 +1260,19 @@ void ndDynamicsUpdate::UpdateSkeletons()
 	const ndArray<ndSkeletonContainer*>& activeSkeletons = m_world->m_activeSkeletons;
 	//const ndBodyKinematic** const bodyArray = (const ndBodyKinematic**)(&scene->GetActiveBodyArray()[0]);
 
-	auto UpdateSkeletons = ndMakeObject::ndFunction([this, &activeSkeletons](ndInt32 threadIndex, ndInt32 threadCount)
+	ndWorkStealingRange skeletonRange(activeSkeletons.GetCount(), scene->GetThreadCount(), 1);
+	auto UpdateSkeletons = ndMakeObject::ndFunction([this, &activeSkeletons, &skeletonRange](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(UpdateSkeletons);
 		ndJacobian* const internalForces = &GetInternalForces()[0];
-		for (ndInt32 i = threadIndex; i < activeSkeletons.GetCount(); i += threadCount)
+		ndStartEnd startEnd;
+		while (skeletonRange.GetChunk(threadIndex, startEnd))
 		{
-			ndSkeletonContainer* const skeleton = activeSkeletons[i];
-			skeleton->CalculateReactionForces(internalForces);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				ndSkeletonContainer* const skeleton = activeSkeletons[i];
+				skeleton->CalculateReactionForces(internalForces);
+			}
 		}
 	});
 
@@ -1213,6 +1280,185 @@ void ndDynamicsUpdate::UpdateSkeletons()
 	{
 		scene->ParallelExecute(UpdateSkeletons);
 	}
+	UpdateParallelSkeletons();
+}
+
+void ndDynamicsUpdate::UpdateParallelSkeletons()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	ndJacobian* const internalForces = &GetInternalForces()[0];
+	const ndArray<ndSkeletonContainer*>& parallelSkeletons = m_world->m_parallelSkeletons;
+	if (parallelSkeletons.GetCount() < scene->GetThreadCount())
+	{
+		for (ndInt32 i = 0; i < parallelSkeletons.GetCount(); ++i)
+		{
+			ndSkeletonContainer* const skeleton = parallelSkeletons[i];
+			skeleton->CalculateReactionForces(internalForces, scene);
+		}
+	}
+	else
+	{
+		// same split as InitParallelSkeletons
+		ndWorkStealingRange skeletonRange(parallelSkeletons.GetCount(), scene->GetThreadCount(), 1);
+		auto UpdateSkeletons = ndMakeObject::ndFunction([&parallelSkeletons, &skeletonRange, internalForces](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(UpdateParallelSkeletons);
+			ndStartEnd startEnd;
+			while (skeletonRange.GetChunk(threadIndex, startEnd))
+			{
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+				{
+					ndSkeletonContainer* const skeleton = parallelSkeletons[i];
+					skeleton->CalculateReactionForces(internalForces);
+				}
+			}
+		});
+		scene->ParallelExecute(UpdateSkeletons);
+	}
+}
+
+void ndDynamicsUpdate::BuildSolverIslands()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	ndFrameArena& arena = scene->GetFrameArena();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	const ndInt32 bodyCount = bodyArray.GetCount();
+	const ndInt32 jointCount = jointArray.GetCount();
+
+	m_islands.SetCount(0);
+	m_islandJoints.SetCount(jointCount);
+	m_islandBodies.SetCount(bodyCount);
+	m_jointResidual.SetCount(jointCount);
+	m_islandBodyPasses = 0;
+
+	ndFrameArenaScope arenaScope(arena);
+	ndInt32* const parent = arena.Alloc<ndInt32>(bodyCount);
+	ndInt32* const islandIndex = arena.Alloc<ndInt32>(bodyCount);
+	ndInt32* const jointIsland = arena.Alloc<ndInt32>(jointCount);
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		parent[i] = i;
+		islandIndex[i] = -1;
+	}
+
+	auto FindRoot = [parent](ndInt32 node)
+	{
+		while (parent[node] != node)
+		{
+			parent[node] = parent[parent[node]];
+			node = parent[node];
+		}
+		return node;
+	};
+
+	// static bodies do not propagate forces, so they do not merge islands. 
+	// the root is always the smallest index, so the islands are deterministic.
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndConstraint* const joint = jointArray[i];
+		const ndBodyKinematic* const body0 = joint->GetBody0();
+		const ndBodyKinematic* const body1 = joint->GetBody1();
+		if (!(body0->m_isStatic | body1->m_isStatic))
+		{
+			const ndInt32 root0 = FindRoot(body0->m_index);
+			const ndInt32 root1 = FindRoot(body1->m_index);
+			if (root0 != root1)
+			{
+				parent[ndMax(root0, root1)] = ndMin(root0, root1);
+			}
+		}
+	}
+
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndConstraint* const joint = jointArray[i];
+		const ndBodyKinematic* const body = joint->GetBody0()->m_isStatic ? joint->GetBody1() : joint->GetBody0();
+		const ndInt32 root = FindRoot(body->m_index);
+		if (islandIndex[root] < 0)
+		{
+			islandIndex[root] = m_islands.GetCount();
+			m_islands.PushBack(ndIsland(bodyArray[root]));
+		}
+		jointIsland[i] = islandIndex[root];
+		m_islands[jointIsland[i]].m_count++;
+	}
+
+	ndInt32 sum = 0;
+	for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+	{
+		ndIsland& island = m_islands[i];
+		island.m_start = sum;
+		sum += island.m_count;
+		island.m_count = 0;
+	}
+
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		ndIsland& island = m_islands[jointIsland[i]];
+		m_islandJoints[island.m_start + island.m_count] = i;
+		island.m_count++;
+	}
+
+	// the dynamic bodies of each island are also a contiguous range, 
+	// the bodies that are in no island go after all of them.
+	ndInt32* const bodyIsland = arena.Alloc<ndInt32>(bodyCount);
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		bodyIsland[i] = bodyArray[i]->m_isStatic ? -1 : islandIndex[FindRoot(i)];
+		if (bodyIsland[i] >= 0)
+		{
+			m_islands[bodyIsland[i]].m_bodyCount++;
+		}
+	}
+
+	sum = 0;
+	for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+	{
+		ndIsland& island = m_islands[i];
+		island.m_bodyStart = sum;
+		sum += island.m_bodyCount;
+		island.m_bodyCount = 0;
+	}
+	m_islandBodyCount = sum;
+
+	ndInt32 outsideCount = 0;
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		if (bodyIsland[i] >= 0)
+		{
+			ndIsland& island = m_islands[bodyIsland[i]];
+			m_islandBodies[island.m_bodyStart + island.m_bodyCount] = i;
+			island.m_bodyCount++;
+		}
+		else
+		{
+			m_islandBodies[m_islandBodyCount + outsideCount] = i;
+			outsideCount++;
+		}
+	}
+}
+
+// index of the island of an item, in the scan of the item counts of the active islands
+static inline ndInt32 ndFindScanIsland(const ndInt32* const scan, ndInt32 islandCount, ndInt32 item)
+{
+	ndInt32 lo = 0;
+	ndInt32 hi = islandCount;
+	while ((hi - lo) > 1)
+	{
+		const ndInt32 mid = (lo + hi) >> 1;
+		if (scan[mid] <= item)
+		{
+			lo = mid;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
 }
 
 void ndDynamicsUpdate::CalculateJointsForce()
@@ -1224,10 +1470,30 @@ void ndDynamicsUpdate::CalculateJointsForce()
 	ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
-	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	// the joints and the bodies of the islands still iterating are seen as 
+	// two ranges, m_islandScan and m_islandBodyScan map each item back to its island.
+	ndInt32 activeIslandCount = m_islands.GetCount();
+	m_activeIslands.SetCount(activeIslandCount);
+	m_islandScan.SetCount(activeIslandCount + 1);
+	m_islandBodyScan.SetCount(activeIslandCount + 1);
+	for (ndInt32 i = 0; i < activeIslandCount; ++i)
+	{
+		m_activeIslands[i] = i;
+	}
+
+	// the static bodies and the bodies without joints get no joint forces
+	ndJacobian* const internalForces = &GetInternalForces()[0];
+	for (ndInt32 i = m_islandBodyCount; i < bodyArray.GetCount(); ++i)
+	{
+		const ndInt32 index = m_islandBodies[i];
+		internalForces[index].m_linear = ndVector::m_zero;
+		internalForces[index].m_angular = ndVector::m_zero;
+	}
+
+	ndWorkStealingRange* jointRange = nullptr;
+	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &jointArray, &jointRange, &activeIslandCount](ndInt32 threadIndex, ndInt32)
 	{
 		D_TRACKTIME_NAMED(CalculateJointsForce);
-		const ndInt32 jointCount = jointArray.GetCount();
 		ndJacobian* const jointPartialForces = &GetTempInternalForces()[0];
 
 		auto JointForce = [this, &jointPartialForces](ndConstraint* const joint, ndInt32 jointIndex)
@@ -1360,16 +1626,29 @@ void ndDynamicsUpdate::CalculateJointsForce()
 			ndJacobian& outBody1 = jointPartialForces[index1];
 			outBody1.m_linear = forceM1;
 			outBody1.m_angular = torqueM1;
+			m_jointResidual[jointIndex] = accNorm.GetScalar();
 		};
 
-		for (ndInt32 i = threadIndex; i < jointCount; i += threadCount)
+		const ndInt32* const islandScan = &m_islandScan[0];
+		ndStartEnd startEnd;
+		while (jointRange->GetChunk(threadIndex, startEnd))
 		{
-			ndConstraint* const joint = jointArray[i];
-			JointForce(joint, i);
+			ndInt32 k = ndFindScanIsland(islandScan, activeIslandCount, startEnd.m_start);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				while (i >= islandScan[k + 1])
+				{
+					k++;
+				}
+				const ndIsland& island = m_islands[m_activeIslands[k]];
+				const ndInt32 jointIndex = m_islandJoints[island.m_start + i - islandScan[k]];
+				ndConstraint* const joint = jointArray[jointIndex];
+				JointForce(joint, jointIndex);
+			}
 		}
 	});
 
-	auto ApplyJacobianAccumulatePartialForces = ndMakeObject::ndFunction([this, &bodyArray](ndInt32 threadIndex, ndInt32 threadCount)
+	auto ApplyJacobianAccumulatePartialForces = ndMakeObject::ndFunction([this, &bodyArray, &activeIslandCount](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(ApplyJacobianAccumulatePartialForces);
 		const ndVector zero(ndVector::m_zero);
@@ -1380,16 +1659,26 @@ void ndDynamicsUpdate::CalculateJointsForce()
 		const ndJacobian* const jointInternalForces = &GetTempInternalForces()[0];
 		const ndJointBodyPairIndex* const jointBodyPairIndexBuffer = &GetJointBodyPairIndexBuffer()[0];
 
-		const ndStartEnd startEnd(bodyArray.GetCount(), threadIndex, threadCount);
-		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		// only the bodies of the islands still iterating, 
+		// the forces of the converged ones do not change.
+		const ndInt32* const islandScan = &m_islandBodyScan[0];
+		const ndStartEnd startEnd(islandScan[activeIslandCount], threadIndex, threadCount);
+		ndInt32 k = ndFindScanIsland(islandScan, activeIslandCount, startEnd.m_start);
+		for (ndInt32 n = startEnd.m_start; n < startEnd.m_end; ++n)
 		{
+			while (n >= islandScan[k + 1])
+			{
+				k++;
+			}
+			const ndIsland& island = m_islands[m_activeIslands[k]];
+			const ndInt32 i = m_islandBodies[island.m_bodyStart + n - islandScan[k]];
+
 			ndVector force(zero);
 			ndVector torque(zero);
-			const ndBodyKinematic* const body = bodyArray[i];
+			ndAssert(!bodyArray[i]->m_isStatic);
 
 			const ndInt32 startIndex = bodyIndex[i];
-			const ndInt32 mask = body->m_isStatic - 1;
-			const ndInt32 count = mask & (bodyIndex[i + 1] - startIndex);
+			const ndInt32 count = bodyIndex[i + 1] - startIndex;
 			for (ndInt32 j = 0; j < count; ++j)
 			{
 				const ndInt32 index = jointBodyPairIndexBuffer[startIndex + j].m_joint;
@@ -1399,12 +1688,56 @@ void ndDynamicsUpdate::CalculateJointsForce()
 			internalForces[i].m_linear = force;
 			internalForces[i].m_angular = torque;
 		}
+
+		const ndStartEnd islandStartEnd(activeIslandCount, threadIndex, threadCount);
+		for (ndInt32 i = islandStartEnd.m_start; i < islandStartEnd.m_end; ++i)
+		{
+			ndIsland& island = m_islands[m_activeIslands[i]];
+			ndFloat32 residual = ndFloat32(0.0f);
+			for (ndInt32 j = 0; j < island.m_count; ++j)
+			{
+				residual = ndMax(residual, m_jointResidual[m_islandJoints[island.m_start + j]]);
+			}
+			island.m_residual = residual;
+			island.m_passes++;
+		}
 	});
 
-	for (ndInt32 i = 0; i < ndInt32(passes); ++i)
+	const ndFloat32 tol2 = D_SOLVER_MAX_ERROR * D_SOLVER_MAX_ERROR;
+	for (ndInt32 i = 0; (i < ndInt32(passes)) && activeIslandCount; ++i)
 	{
+		ndInt32 sum = 0;
+		ndInt32 bodySum = 0;
+		for (ndInt32 j = 0; j < activeIslandCount; ++j)
+		{
+			const ndIsland& island = m_islands[m_activeIslands[j]];
+			m_islandScan[j] = sum;
+			m_islandBodyScan[j] = bodySum;
+			sum += island.m_count;
+			bodySum += island.m_bodyCount;
+		}
+		m_islandScan[activeIslandCount] = sum;
+		m_islandBodyScan[activeIslandCount] = bodySum;
+		m_islandBodyPasses += bodySum;
+
+		ndWorkStealingRange range(sum, scene->GetThreadCount());
+		jointRange = &range;
 		scene->ParallelExecute(CalculateJointsForce);
 		scene->ParallelExecute(ApplyJacobianAccumulatePartialForces);
+
+		// the partial forces of a converged island stay in the buffer, 
+		// so its bodies keep receiving them after it leaves the active set.
+		ndInt32 count = 0;
+		for (ndInt32 j = 0; j < activeIslandCount; ++j)
+		{
+			const ndInt32 index = m_activeIslands[j];
+			if (m_islands[index].m_residual > tol2)
+			{
+				m_activeIslands[count] = index;
+				count++;
+			}
+		}
+		activeIslandCount = count;
 	}
 }
 
@@ -1415,6 +1748,7 @@ void ndDynamicsUpdate::CalculateForces()
 	{
 		m_firstPassCoef = ndFloat32(0.0f);
 
+		BuildSolverIslands();
 		InitSkeletons();
 		for (ndInt32 step = 0; step < 4; step++)
 		{
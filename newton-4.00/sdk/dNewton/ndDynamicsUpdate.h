@@ -58,18 +58,28 @@ class ndDynamicsUpdate : public ndClassAlloc
 		ndBodyKinematic* m_root;
 	};
 
+	// a group of joints connected by dynamic bodies, the solver
+	// stops iterating an island as soon as its residual is small.
 	class ndIsland
 	{
 		public:
 		ndIsland(ndBodyKinematic* const root)
 			:m_start(0)
-			, m_count(0)
-			, m_root(root)
+			,m_count(0)
+			,m_bodyStart(0)
+			,m_bodyCount(0)
+			,m_passes(0)
+			,m_residual(ndFloat32(0.0f))
+			,m_root(root)
 		{
 		}
 
-		ndInt32 m_start;
-		ndInt32 m_count;
+		ndInt32 m_start;		// first entry in the island joint array
+		ndInt32 m_count;		// number of joints
+		ndInt32 m_bodyStart;	// first entry in the island body array
+		ndInt32 m_bodyCount;	// number of dynamic bodies
+		ndInt32 m_passes;		// solver passes of the last update, summed over all its substeps
+		ndFloat32 m_residual;	// squared residual of the last pass
 		ndBodyKinematic* m_root;
 	};
 
@@ -85,6 +95,7 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndVector GetVelocTol() const;
 	ndFloat32 GetTimestepRK() const;
 	ndArray<ndIsland>& GetIslands();
+	ndInt32 GetIslandBodyPasses() const;
 	ndArray<ndJacobian>& GetInternalForces();
 	ndArray<ndLeftHandSide>& GetLeftHandSide();
 	ndArray<ndInt32>& GetJointForceIndexBuffer();
@@ -93,7 +104,7 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndArray<ndBodyKinematic*>& GetBodyIslandOrder();
 	ndArray<ndJointBodyPairIndex>& GetJointBodyPairIndexBuffer();
 
-	private:
+	protected:
 	void SortJoints();
 	void SortIslands();
 	void BuildIsland();
@@ -103,6 +114,8 @@ class ndDynamicsUpdate : public ndClassAlloc
 	void CalculateForces();
 	void IntegrateBodies();
 	void UpdateSkeletons();
+	void InitParallelSkeletons();
+	void UpdateParallelSkeletons();
 	void InitJacobianMatrix();
 	void UpdateForceFeedback();
 	void CalculateJointsForce();
@@ -112,8 +125,8 @@ class ndDynamicsUpdate : public ndClassAlloc
 
 	void DetermineSleepStates();
 	void GetJacobianDerivatives(ndConstraint* const joint);
+	void BuildSolverIslands();
 
-	protected:
 	void Clear();
 	virtual void Update();
 	void SortJointsScan();
@@ -122,6 +135,12 @@ class ndDynamicsUpdate : public ndClassAlloc
 
 	ndVector m_velocTol;
 	ndArray<ndIsland> m_islands;
+	ndArray<ndInt32> m_islandScan;
+	ndArray<ndInt32> m_islandBodyScan;
+	ndArray<ndInt32> m_islandJoints;
+	ndArray<ndInt32> m_islandBodies;
+	ndArray<ndInt32> m_activeIslands;
+	ndArray<ndFloat32> m_jointResidual;
 	ndArray<ndInt32> m_jointForcesIndex;
 	ndArray<ndJacobian> m_internalForces;
 	ndArray<ndLeftHandSide> m_leftHandSide;
@@ -138,8 +157,11 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndFloat32 m_timestepRK;
 	ndFloat32 m_invTimestepRK;
 	ndUnsigned32 m_solverPasses;
+	ndInt32 m_islandBodyCount;
+	ndInt32 m_islandBodyPasses;
 	ndInt32 m_activeJointCount;
 	ndInt32 m_unConstrainedBodyCount;
+	bool m_jacobiPreconditioner;
 
 	friend class ndWorld;
 	friend class ndSkeletonContainer;
@@ -160,6 +182,12 @@ inline ndArray<ndDynamicsUpdate::ndIsland>& ndDynamicsUpdate::GetIslands()
 	return m_islands;
 }
 
+// bodies whose forces were accumulated, summed over all the passes of the last update
+inline ndInt32 ndDynamicsUpdate::GetIslandBodyPasses() const
+{
+	return m_islandBodyPasses;
+}
+
 inline ndArray<ndJacobian>& ndDynamicsUpdate::GetInternalForces()
 {
 	return m_internalForces;
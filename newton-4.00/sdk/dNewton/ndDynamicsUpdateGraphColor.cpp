@@ -0,0 +1,319 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndNewtonStdafx.h"
+#include "ndWorld.h"
+#include "ndBodyDynamic.h"
+#include "ndDynamicsUpdateGraphColor.h"
+
+#define D_GRAPH_COLOR_DEFAULT_BUFFER_SIZE	1024
+
+ndDynamicsUpdateGraphColor::ndDynamicsUpdateGraphColor(ndWorld* const world)
+	:ndDynamicsUpdate(world)
+	,m_jointColor(D_GRAPH_COLOR_DEFAULT_BUFFER_SIZE)
+	,m_colorJoints(D_GRAPH_COLOR_DEFAULT_BUFFER_SIZE)
+	,m_bodyColorMask(D_GRAPH_COLOR_DEFAULT_BUFFER_SIZE)
+	,m_colorCount(0)
+	,m_passes(0)
+	,m_residual(ndFloat32(0.0f))
+{
+	m_jacobiPreconditioner = false;
+	for (ndInt32 i = 0; i < ndInt32(sizeof(m_colorStart) / sizeof(m_colorStart[0])); ++i)
+	{
+		m_colorStart[i] = 0;
+	}
+}
+
+ndDynamicsUpdateGraphColor::~ndDynamicsUpdateGraphColor()
+{
+	Clear();
+	m_jointColor.Resize(D_GRAPH_COLOR_DEFAULT_BUFFER_SIZE);
+	m_colorJoints.Resize(D_GRAPH_COLOR_DEFAULT_BUFFER_SIZE);
+	m_bodyColorMask.Resize(D_GRAPH_COLOR_DEFAULT_BUFFER_SIZE);
+}
+
+const char* ndDynamicsUpdateGraphColor::GetStringId() const
+{
+	return "graph color";
+}
+
+void ndDynamicsUpdateGraphColor::ColorJointGraph()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	const ndInt32 jointCount = jointArray.GetCount();
+	const ndInt32 bodyCount = scene->GetActiveBodyArray().GetCount();
+
+	m_jointColor.SetCount(jointCount);
+	m_colorJoints.SetCount(jointCount);
+	m_bodyColorMask.SetCount(bodyCount);
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		m_bodyColorMask[i] = 0;
+	}
+
+	ndInt32 histogram[D_MAX_GRAPH_COLORS + 1];
+	for (ndInt32 i = 0; i <= D_MAX_GRAPH_COLORS; ++i)
+	{
+		histogram[i] = 0;
+	}
+
+	// greedy coloring in joint order, static bodies do not receive forces
+	// so they do not constrain the colors. This is linear in the joint count
+	// and deterministic, so it is done by one thread.
+	ndInt32 colorCount = 0;
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndConstraint* const joint = jointArray[i];
+		const ndBodyKinematic* const body0 = joint->GetBody0();
+		const ndBodyKinematic* const body1 = joint->GetBody1();
+		const ndInt32 m0 = body0->m_index;
+		const ndInt32 m1 = body1->m_index;
+		const ndUnsigned64 mask0 = body0->m_isStatic ? 0 : m_bodyColorMask[m0];
+		const ndUnsigned64 mask1 = body1->m_isStatic ? 0 : m_bodyColorMask[m1];
+		const ndUnsigned64 usedColors = mask0 | mask1;
+
+		ndInt32 color = 0;
+		while ((color < D_MAX_GRAPH_COLORS) && (usedColors & (ndUnsigned64(1) << color)))
+		{
+			color++;
+		}
+		if (color < D_MAX_GRAPH_COLORS)
+		{
+			const ndUnsigned64 colorBit = ndUnsigned64(1) << color;
+			m_bodyColorMask[m0] |= body0->m_isStatic ? 0 : colorBit;
+			m_bodyColorMask[m1] |= body1->m_isStatic ? 0 : colorBit;
+			colorCount = ndMax(colorCount, color + 1);
+		}
+		m_jointColor[i] = color;
+		histogram[color]++;
+	}
+
+	ndInt32 sum = 0;
+	for (ndInt32 i = 0; i <= D_MAX_GRAPH_COLORS; ++i)
+	{
+		m_colorStart[i] = sum;
+		sum += histogram[i];
+		histogram[i] = m_colorStart[i];
+	}
+	m_colorStart[D_MAX_GRAPH_COLORS + 1] = sum;
+
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndInt32 color = m_jointColor[i];
+		m_colorJoints[histogram[color]] = i;
+		histogram[color]++;
+	}
+	m_colorCount = colorCount;
+}
+
+ndFloat32 ndDynamicsUpdateGraphColor::SolveJoint(ndConstraint* const joint)
+{
+	const ndVector zero(ndVector::m_zero);
+	ndFloat32 residual = ndFloat32(0.0f);
+	ndBodyKinematic* const body0 = joint->GetBody0();
+	ndBodyKinematic* const body1 = joint->GetBody1();
+	ndAssert(body0);
+	ndAssert(body1);
+
+	const ndInt32 m0 = body0->m_index;
+	const ndInt32 m1 = body1->m_index;
+	const ndInt32 rowStart = joint->m_rowStart;
+	const ndInt32 rowsCount = joint->m_rowCount;
+
+	const ndInt32 resting = body0->m_equilibrium0 & body1->m_equilibrium0;
+	if (!resting)
+	{
+		ndJacobian& internalForce0 = m_internalForces[m0];
+		ndJacobian& internalForce1 = m_internalForces[m1];
+		ndVector forceM0(internalForce0.m_linear);
+		ndVector torqueM0(internalForce0.m_angular);
+		ndVector forceM1(internalForce1.m_linear);
+		ndVector torqueM1(internalForce1.m_angular);
+
+		const ndFloat32 tol = ndFloat32(0.125f);
+		const ndFloat32 tol2 = tol * tol;
+		ndVector maxAccel(tol2 * ndFloat32(2.0f));
+		for (ndInt32 k = 0; (k < 5) && (maxAccel.GetScalar() > tol2); ++k)
+		{
+			maxAccel = zero;
+			for (ndInt32 j = 0; j < rowsCount; ++j)
+			{
+				ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+				const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+				const ndVector force(rhs->m_force);
+
+				ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
+				a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
+
+				ndAssert(rhs->m_normalForceIndexFlat >= 0);
+				ndVector f(force + a.Scale(rhs->m_invJinvMJt));
+				const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
+				const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
+				const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
+				const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
+
+				a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
+				maxAccel = maxAccel.MulAdd(a, a);
+
+				f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+				rhs->m_force = f.GetScalar();
+
+				const ndVector deltaForce(f - force);
+				forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce);
+				torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce);
+				forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce);
+				torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce);
+			}
+			if (!k)
+			{
+				residual = maxAccel.GetScalar();
+			}
+		}
+
+		// no other joint of this color touches these bodies,
+		// static bodies are shared, but they never accumulate forces.
+		if (!body0->m_isStatic)
+		{
+			internalForce0.m_linear = forceM0;
+			internalForce0.m_angular = torqueM0;
+		}
+		if (!body1->m_isStatic)
+		{
+			internalForce1.m_linear = forceM1;
+			internalForce1.m_angular = torqueM1;
+		}
+	}
+
+	for (ndInt32 j = 0; j < rowsCount; ++j)
+	{
+		ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+		rhs->m_maxImpact = ndMax(ndAbs(rhs->m_force), rhs->m_maxImpact);
+	}
+	return residual;
+}
+
+void ndDynamicsUpdateGraphColor::CalculateJointsForce()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	ndInt32 batchStart = 0;
+	ndInt32 batchCount = 0;
+	ndFloat32 residualArray[D_MAX_THREADS_COUNT];
+	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &jointArray, &batchStart, &batchCount, &residualArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateJointsForce);
+		ndFloat32 residual = residualArray[threadIndex];
+		const ndInt32* const colorJoints = &m_colorJoints[batchStart];
+		const ndStartEnd startEnd(batchCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndConstraint* const joint = jointArray[colorJoints[i]];
+			residual = ndMax(residual, SolveJoint(joint));
+		}
+		residualArray[threadIndex] = residual;
+	});
+
+	const ndInt32 threadCount = scene->GetThreadCount();
+	const ndFloat32 tol2 = D_SOLVER_MAX_ERROR * D_SOLVER_MAX_ERROR;
+	const ndInt32 passes = ndInt32(m_solverPasses);
+	for (ndInt32 i = 0; i < passes; ++i)
+	{
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			residualArray[j] = ndFloat32(0.0f);
+		}
+
+		for (ndInt32 j = 0; j < m_colorCount; ++j)
+		{
+			batchStart = m_colorStart[j];
+			batchCount = m_colorStart[j + 1] - batchStart;
+			scene->ParallelExecute(CalculateJointsForce);
+		}
+
+		// joints that did not get a color are solved in order by this thread.
+		ndFloat32 residual = ndFloat32(0.0f);
+		for (ndInt32 j = m_colorStart[D_MAX_GRAPH_COLORS]; j < m_colorStart[D_MAX_GRAPH_COLORS + 1]; ++j)
+		{
+			residual = ndMax(residual, SolveJoint(jointArray[m_colorJoints[j]]));
+		}
+		for (ndInt32 j = 0; j < threadCount; ++j)
+		{
+			residual = ndMax(residual, residualArray[j]);
+		}
+
+		m_passes++;
+		m_residual = residual;
+		if (residual <= tol2)
+		{
+			break;
+		}
+	}
+}
+
+void ndDynamicsUpdateGraphColor::CalculateForces()
+{
+	D_TRACKTIME();
+	if (m_world->GetScene()->GetActiveContactArray().GetCount())
+	{
+		m_firstPassCoef = ndFloat32(0.0f);
+
+		ColorJointGraph();
+		InitSkeletons();
+		for (ndInt32 step = 0; step < 4; step++)
+		{
+			CalculateJointsAcceleration();
+			CalculateJointsForce();
+			UpdateSkeletons();
+			IntegrateBodiesVelocity();
+		}
+		UpdateForceFeedback();
+	}
+}
+
+void ndDynamicsUpdateGraphColor::Update()
+{
+	D_TRACKTIME();
+	m_timestep = m_world->GetScene()->GetTimestep();
+	m_passes = 0;
+	m_residual = ndFloat32(0.0f);
+
+	BuildIsland();
+	IntegrateUnconstrainedBodies();
+	InitWeights();
+
+	// each pass propagates forces across the whole graph,
+	// so the passes do not grow with the connectivity.
+	m_solverPasses = ndUnsigned32(m_world->GetSolverIterations() + 2);
+
+	InitBodyArray();
+	InitJacobianMatrix();
+	CalculateForces();
+	IntegrateBodies();
+	DetermineSleepStates();
+}
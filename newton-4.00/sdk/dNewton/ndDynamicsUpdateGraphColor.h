@@ -0,0 +1,87 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_WORLD_DYNAMICS_UPDATE_GRAPH_COLOR_H__
+#define __ND_WORLD_DYNAMICS_UPDATE_GRAPH_COLOR_H__
+
+#include "ndNewtonStdafx.h"
+#include "ndDynamicsUpdate.h"
+
+// number of colors tracked per body, joints that can not
+// find a free color go to a last batch solved by one thread.
+#define D_MAX_GRAPH_COLORS	64
+
+// gauss seidel solver.
+// the joints are partitioned in colors, so that no two joints of the same
+// color share a dynamic body. The colors are solved one after another, and
+// the joints of each color are solved in parallel writing their forces
+// directly to the bodies, so each joint sees the forces of the joints
+// solved before it. This converges much faster than the jacobi passes
+// of the default solver, and the number of passes does not have to grow
+// with the connectivity of the bodies. The passes stop as soon as the
+// largest joint residual is below the solver tolerance.
+D_MSV_NEWTON_ALIGN_32
+class ndDynamicsUpdateGraphColor: public ndDynamicsUpdate
+{
+	public:
+	ndDynamicsUpdateGraphColor(ndWorld* const world);
+	virtual ~ndDynamicsUpdateGraphColor();
+
+	virtual const char* GetStringId() const;
+	ndInt32 GetColorCount() const;
+	ndInt32 GetPasses() const;
+	ndFloat32 GetResidual() const;
+
+	protected:
+	virtual void Update();
+
+	private:
+	void ColorJointGraph();
+	void CalculateForces();
+	void CalculateJointsForce();
+	ndFloat32 SolveJoint(ndConstraint* const joint);
+
+	ndArray<ndInt32> m_jointColor;
+	ndArray<ndInt32> m_colorJoints;
+	ndArray<ndUnsigned64> m_bodyColorMask;
+	ndInt32 m_colorStart[D_MAX_GRAPH_COLORS + 2];
+	ndInt32 m_colorCount;
+	ndInt32 m_passes;		// solver passes of the last update, summed over all its substeps
+	ndFloat32 m_residual;	// squared residual of the last pass
+} D_GCC_NEWTON_ALIGN_32;
+
+inline ndInt32 ndDynamicsUpdateGraphColor::GetColorCount() const
+{
+	return m_colorCount;
+}
+
+inline ndInt32 ndDynamicsUpdateGraphColor::GetPasses() const
+{
+	return m_passes;
+}
+
+inline ndFloat32 ndDynamicsUpdateGraphColor::GetResidual() const
+{
+	return m_residual;
+}
+
+#endif
+
@@ -1070,6 +1070,7 @@ void ndDynamicsUpdateSoa::InitSkeletons()
 	{
 		scene->ParallelExecute(InitSkeletons);
 	}
+	InitParallelSkeletons();
 }
 
 void ndDynamicsUpdateSoa::UpdateSkeletons()
@@ -1094,6 +1095,7 @@ void ndDynamicsUpdateSoa::UpdateSkeletons()
 	{
 		scene->ParallelExecute(UpdateSkeletons);
 	}
+	UpdateParallelSkeletons();
 }
 
 void ndDynamicsUpdateSoa::CalculateJointsAcceleration()
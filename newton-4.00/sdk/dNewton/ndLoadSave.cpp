@@ -28,6 +28,7 @@
 #include "ndShapeCompound.h"
 #include "ndShapeInstance.h"
 #include "ndBodyDynamic.h"
+#include "ndWorldSnapshot.h"
 
 D_CLASS_REFLECTION_IMPLEMENT_LOADER(ndWordSettings);
 
@@ -504,6 +505,19 @@ void ndLoadSave::SaveScene(const char* const path, const ndWorld* const world, c
 	setlocale(LC_ALL, oldloc);
 }
 
+bool ndLoadSave::SaveSnapshot(const char* const path, const ndWorld* const world)
+{
+	ndWorldSnapshot snapshot;
+	snapshot.Capture(world);
+	return snapshot.Save(path);
+}
+
+bool ndLoadSave::LoadSnapshot(const char* const path, ndWorld* const world)
+{
+	ndFileMapping file(path);
+	return ndWorldSnapshot::Restore(world, file.GetData(), file.GetSize());
+}
+
 void ndLoadSave::SaveModel(const char* const path, const ndModel* const model)
 {
 	ndAssert(0);
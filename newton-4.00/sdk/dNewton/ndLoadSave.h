@@ -62,6 +62,11 @@ class ndLoadSave: public ndClassAlloc
 	D_NEWTON_API void SaveModel(const char* const path, const ndModel* const model);
 	D_NEWTON_API void SaveScene(const char* const path, const ndWorld* const world, const ndWordSettings* const setting);
 
+	// binary snapshot of the simulation state of a world already populated, 
+	// the file is memory mapped and restored in place, see ndWorldSnapshot. 
+	D_NEWTON_API bool LoadSnapshot(const char* const path, ndWorld* const world);
+	D_NEWTON_API bool SaveSnapshot(const char* const path, const ndWorld* const world);
+
 	private:
 	void SaveSceneSettings(ndLoadSaveInfo& info) const;
 	void SaveShapes(ndLoadSaveInfo& info);
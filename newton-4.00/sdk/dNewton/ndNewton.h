@@ -54,6 +54,7 @@
 #include <ndBodyKinematic.h>
 #include <ndContactSolver.h>
 #include <ndJointCylinder.h>
+#include <ndWorldSnapshot.h>
 #include <ndCharacterNode.h>
 #include <ndIk6DofEffector.h>
 #include <ndJointSpherical.h>
@@ -67,6 +68,7 @@
 #include <ndCharacterRootNode.h>
 #include <ndSkeletonContainer.h>
 #include <ndDynamicsUpdateSoa.h>
+#include <ndDynamicsUpdateGraphColor.h>
 #include <ndIkJointDoubleHinge.h>
 #include <ndBodyParticleSetList.h>
 #include <ndMultiBodyVehicleMotor.h>
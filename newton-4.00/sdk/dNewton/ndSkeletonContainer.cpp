@@ -29,6 +29,9 @@
 #include "ndJointBilateralConstraint.h"
 
 #define D_MAX_SKELETON_LCP_VALUE (D_LCP_MAX_VALUE * ndFloat32 (0.25f))
+#define D_SKELETON_PARTITION_SIZE	16
+
+ndInt32 ndSkeletonContainer::m_parallelBodyCount = 64;
 
 //ndInt64 ndSkeletonContainer::ndNode::m_ordinalInit = 0x0706050403020100ll;
 
@@ -354,6 +357,9 @@ ndSkeletonContainer::ndSkeletonContainer()
 	,m_deltaForce(nullptr)
 	,m_nodeList()
 	,m_loopingJoints(32)
+	,m_partitions()
+	,m_partitionRoots()
+	,m_partitionTopNodes()
 	,m_auxiliaryMemoryBuffer(1024 * 8)
 	,m_lock()
 	,m_blockSize(0)
@@ -390,6 +396,16 @@ ndSkeletonContainer::~ndSkeletonContainer()
 	m_nodeList.RemoveAll();
 }
 
+ndInt32 ndSkeletonContainer::GetParallelBodyCount()
+{
+	return m_parallelBodyCount;
+}
+
+void ndSkeletonContainer::SetParallelBodyCount(ndInt32 count)
+{
+	m_parallelBodyCount = ndMax(count, 2);
+}
+
 void ndSkeletonContainer::Clear()
 {
 	for (ndInt32 i = 0; i < m_loopCount; ++i)
@@ -468,6 +484,11 @@ void ndSkeletonContainer::Finalize(ndInt32 loopJointsCount, ndJointBilateralCons
 	ndInt32 index = 0;
 	SortGraph(m_skeleton, index);
 	ndAssert(index == m_nodeList.GetCount());
+
+	if (m_nodeList.GetCount() >= m_parallelBodyCount)
+	{
+		CalculatePartitions();
+	}
 	
 	for (ndInt32 i = 0; i < loopJointsCount; ++i) 
 	{
@@ -478,6 +499,68 @@ void ndSkeletonContainer::Finalize(ndInt32 loopJointsCount, ndJointBilateralCons
 	}
 }
 
+void ndSkeletonContainer::CalculatePartitions()
+{
+	// a subtree is a contiguous range of the post order array, the small 
+	// subtrees are partitions that can be factorized and solved in parallel,
+	// the top nodes above them are solved after, in post order.
+	const ndInt32 nodeCount = m_nodeList.GetCount();
+	ndInt32* const subtreeSize = ndAlloca(ndInt32, nodeCount);
+	for (ndInt32 i = 0; i < nodeCount; ++i)
+	{
+		const ndNode* const node = m_nodesOrder[i];
+		subtreeSize[i] = 1;
+		for (const ndNode* child = node->m_child; child; child = child->m_sibling)
+		{
+			subtreeSize[i] += subtreeSize[child->m_index];
+		}
+	}
+	ndAssert(subtreeSize[nodeCount - 1] == nodeCount);
+
+	auto IsTopNode = [subtreeSize](const ndNode* const node)
+	{
+		return !node->m_parent || (subtreeSize[node->m_index] > D_SKELETON_PARTITION_SIZE);
+	};
+
+	m_partitions.SetCount(0);
+	m_partitionRoots.SetCount(0);
+	m_partitionTopNodes.SetCount(0);
+	for (ndInt32 i = 0; i < nodeCount; ++i)
+	{
+		ndNode* const node = m_nodesOrder[i];
+		if (IsTopNode(node))
+		{
+			m_partitionTopNodes.PushBack(node);
+		}
+		else if (IsTopNode(node->m_parent))
+		{
+			// sibling subtrees are adjacent, so the small ones are merged
+			const ndInt32 start = i - subtreeSize[i] + 1;
+			const ndInt32 count = m_partitions.GetCount();
+			m_partitionRoots.PushBack(node);
+			if (count && (m_partitions[count - 1].m_end == start) && ((i + 1 - m_partitions[count - 1].m_start) <= D_SKELETON_PARTITION_SIZE))
+			{
+				m_partitions[count - 1].m_end = i + 1;
+			}
+			else
+			{
+				ndStartEnd partition;
+				partition.m_start = start;
+				partition.m_end = i + 1;
+				m_partitions.PushBack(partition);
+			}
+		}
+	}
+
+	if (m_partitions.GetCount() < 2)
+	{
+		// a chain, there is nothing to solve in parallel
+		m_partitions.SetCount(0);
+		m_partitionRoots.SetCount(0);
+		m_partitionTopNodes.SetCount(0);
+	}
+}
+
 void ndSkeletonContainer::ClearCloseLoopJoints()
 {
 	m_dynamicsLoopCount = 0;
@@ -580,11 +663,11 @@ void ndSkeletonContainer::CalculateBufferSizeInBytes()
 	m_auxiliaryMemoryBuffer.SetCount((size + 1024) & -0x10);
 }
 
-void ndSkeletonContainer::CalculateLoopMassMatrixCoefficients(ndFloat32* const diagDamp)
+void ndSkeletonContainer::CalculateLoopMassMatrixCoefficients(ndFloat32* const diagDamp, ndInt32 rowStart, ndInt32 rowEnd)
 {
 	D_TRACKTIME();
 	const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
-	for (ndInt32 index = 0; index < m_auxiliaryRowCount; index++) 
+	for (ndInt32 index = rowStart; index < rowEnd; index++) 
 	{
 		const ndInt32 ii = m_matrixRowsIndex[primaryCount + index];
 		const ndLeftHandSide* const row_i = &m_leftHandSide[ii];
@@ -743,7 +826,138 @@ inline void ndSkeletonContainer::SolveBackward(ndForcePair* const force) const
 	}
 }
 
-void ndSkeletonContainer::ConditionMassMatrix() const
+inline void ndSkeletonContainer::SolveForward(ndThreadPool& threadPool, const ndJacobian* const internalForces, ndForcePair* const force, ndForcePair* const accel) const
+{
+	// same operations in the same order as the serial solve, 
+	// but the partitions are solved by all the threads.
+	ndWorkStealingRange partitionRange(m_partitions.GetCount(), threadPool.GetThreadCount(), 1);
+	auto SolvePartitionsForward = ndMakeObject::ndFunction([this, &partitionRange, internalForces, force, accel](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(SolvePartitionsForward);
+		ndStartEnd startEnd;
+		while (partitionRange.GetChunk(threadIndex, startEnd))
+		{
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				const ndStartEnd& partition = m_partitions[i];
+				for (ndInt32 j = partition.m_start; j < partition.m_end; ++j)
+				{
+					ndNode* const node = m_nodesOrder[j];
+					ndAssert(node->m_joint);
+					ndAssert(node->m_index == j);
+					CalculateJointAccel(node, internalForces, accel);
+					ndForcePair& f = force[j];
+					const ndForcePair& a = accel[j];
+					f.m_body = a.m_body;
+					f.m_joint = a.m_joint;
+					for (ndNode* child = node->m_child; child; child = child->m_sibling)
+					{
+						child->BodyJacobianTimeMassForward(force[child->m_index], f);
+					}
+					node->JointJacobianTimeMassForward(f);
+				}
+
+				// the partition roots are still needed by the top nodes
+				for (ndInt32 j = partition.m_start; j < partition.m_end; ++j)
+				{
+					ndNode* const node = m_nodesOrder[j];
+					if (node->m_parent->m_index < partition.m_end)
+					{
+						ndForcePair& f = force[j];
+						node->BodyDiagInvTimeSolution(f);
+						node->JointDiagInvTimeSolution(f);
+					}
+				}
+			}
+		}
+	});
+	threadPool.ParallelExecute(SolvePartitionsForward);
+
+	const ndSpatialVector zero(ndSpatialVector::m_zero);
+	for (ndInt32 i = 0; i < m_partitionTopNodes.GetCount(); ++i)
+	{
+		ndNode* const node = m_partitionTopNodes[i];
+		const ndInt32 index = node->m_index;
+		ndForcePair& f = force[index];
+		if (node->m_joint)
+		{
+			CalculateJointAccel(node, internalForces, accel);
+		}
+		else
+		{
+			accel[index].m_body = zero;
+			accel[index].m_joint = zero;
+		}
+		f.m_body = accel[index].m_body;
+		f.m_joint = accel[index].m_joint;
+		for (ndNode* child = node->m_child; child; child = child->m_sibling)
+		{
+			child->BodyJacobianTimeMassForward(force[child->m_index], f);
+		}
+		if (node->m_joint)
+		{
+			node->JointJacobianTimeMassForward(f);
+		}
+	}
+
+	for (ndInt32 i = 0; i < m_partitionRoots.GetCount(); ++i)
+	{
+		ndNode* const node = m_partitionRoots[i];
+		ndForcePair& f = force[node->m_index];
+		node->BodyDiagInvTimeSolution(f);
+		node->JointDiagInvTimeSolution(f);
+	}
+
+	for (ndInt32 i = 0; i < m_partitionTopNodes.GetCount(); ++i)
+	{
+		ndNode* const node = m_partitionTopNodes[i];
+		ndForcePair& f = force[node->m_index];
+		node->BodyDiagInvTimeSolution(f);
+		if (node->m_joint)
+		{
+			node->JointDiagInvTimeSolution(f);
+		}
+	}
+}
+
+inline void ndSkeletonContainer::SolveBackward(ndThreadPool& threadPool, ndForcePair* const force) const
+{
+	for (ndInt32 i = m_partitionTopNodes.GetCount() - 1; i >= 0; --i)
+	{
+		ndNode* const node = m_partitionTopNodes[i];
+		if (node->m_parent)
+		{
+			ndForcePair& f = force[node->m_index];
+			node->JointJacobianTimeSolutionBackward(f, force[node->m_parent->m_index]);
+			node->BodyJacobianTimeSolutionBackward(f);
+		}
+	}
+
+	ndWorkStealingRange partitionRange(m_partitions.GetCount(), threadPool.GetThreadCount(), 1);
+	auto SolvePartitionsBackward = ndMakeObject::ndFunction([this, &partitionRange, force](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(SolvePartitionsBackward);
+		ndStartEnd startEnd;
+		while (partitionRange.GetChunk(threadIndex, startEnd))
+		{
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				const ndStartEnd& partition = m_partitions[i];
+				for (ndInt32 j = partition.m_end - 1; j >= partition.m_start; --j)
+				{
+					ndNode* const node = m_nodesOrder[j];
+					ndAssert(node->m_index == j);
+					ndForcePair& f = force[j];
+					node->JointJacobianTimeSolutionBackward(f, force[node->m_parent->m_index]);
+					node->BodyJacobianTimeSolutionBackward(f);
+				}
+			}
+		}
+	});
+	threadPool.ParallelExecute(SolvePartitionsBackward);
+}
+
+void ndSkeletonContainer::ConditionMassMatrix(ndInt32 rowStart, ndInt32 rowEnd) const
 {
 	D_TRACKTIME();
 	const ndInt32 nodeCount = m_nodeList.GetCount();
@@ -751,7 +965,7 @@ void ndSkeletonContainer::ConditionMassMatrix() const
 	const ndSpatialVector zero(ndSpatialVector::m_zero);
 
 	const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
-	for (ndInt32 i = 0; i < m_auxiliaryRowCount; ++i) 
+	for (ndInt32 i = rowStart; i < rowEnd; ++i) 
 	{
 		ndInt32 entry0 = 0;
 		ndInt32 startjoint = nodeCount;
@@ -797,12 +1011,12 @@ void ndSkeletonContainer::ConditionMassMatrix() const
 	}
 }
 
-void ndSkeletonContainer::RebuildMassMatrix(const ndFloat32* const diagDamp) const
+void ndSkeletonContainer::RebuildMassMatrix(const ndFloat32* const diagDamp, ndInt32 rowStart, ndInt32 rowEnd) const
 {
 	D_TRACKTIME();
 	const ndInt32 primaryCount = m_rowCount - m_auxiliaryRowCount;
 	ndInt16* const indexList = ndAlloca(ndInt16, primaryCount);
-	for (ndInt32 i = 0; i < m_auxiliaryRowCount; ++i) 
+	for (ndInt32 i = rowStart; i < rowEnd; ++i) 
 	{
 		const ndFloat32* const matrixRow10 = &m_massMatrix10[i * primaryCount];
 		ndFloat32* const matrixRow11 = &m_massMatrix11[i * m_auxiliaryRowCount];
@@ -860,7 +1074,7 @@ void ndSkeletonContainer::FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat3
 	}
 }
 
-void ndSkeletonContainer::InitLoopMassMatrix()
+void ndSkeletonContainer::InitLoopMassMatrix(ndThreadPool* const threadPool)
 {
 	CalculateBufferSizeInBytes();
 	ndInt8* const memoryBuffer = &m_auxiliaryMemoryBuffer[0];
@@ -970,9 +1184,52 @@ void ndSkeletonContainer::InitLoopMassMatrix()
 	memset(m_massMatrix10, 0, primaryCount * m_auxiliaryRowCount * sizeof(ndFloat32));
 	memset(m_massMatrix11, 0, m_auxiliaryRowCount * m_auxiliaryRowCount * sizeof(ndFloat32));
 
-	CalculateLoopMassMatrixCoefficients(diagDamp);
-	ConditionMassMatrix();
-	RebuildMassMatrix(diagDamp);
+	if (threadPool)
+	{
+		// each row of the mass matrix is independent of the others
+		ndWorkStealingRange rowRange(m_auxiliaryRowCount, threadPool->GetThreadCount(), 1);
+		auto CalculateCoefficients = ndMakeObject::ndFunction([this, &rowRange, diagDamp](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(CalculateCoefficients);
+			ndStartEnd startEnd;
+			while (rowRange.GetChunk(threadIndex, startEnd))
+			{
+				CalculateLoopMassMatrixCoefficients(diagDamp, startEnd.m_start, startEnd.m_end);
+			}
+		});
+
+		auto ConditionRows = ndMakeObject::ndFunction([this, &rowRange](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(ConditionRows);
+			ndStartEnd startEnd;
+			while (rowRange.GetChunk(threadIndex, startEnd))
+			{
+				ConditionMassMatrix(startEnd.m_start, startEnd.m_end);
+			}
+		});
+
+		auto RebuildRows = ndMakeObject::ndFunction([this, &rowRange, diagDamp](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(RebuildRows);
+			ndStartEnd startEnd;
+			while (rowRange.GetChunk(threadIndex, startEnd))
+			{
+				RebuildMassMatrix(diagDamp, startEnd.m_start, startEnd.m_end);
+			}
+		});
+
+		threadPool->ParallelExecute(CalculateCoefficients);
+		rowRange.Reset();
+		threadPool->ParallelExecute(ConditionRows);
+		rowRange.Reset();
+		threadPool->ParallelExecute(RebuildRows);
+	}
+	else
+	{
+		CalculateLoopMassMatrixCoefficients(diagDamp, 0, m_auxiliaryRowCount);
+		ConditionMassMatrix(0, m_auxiliaryRowCount);
+		RebuildMassMatrix(diagDamp, 0, m_auxiliaryRowCount);
+	}
 
 	if (m_blockSize) 
 	{
@@ -1046,40 +1303,45 @@ void ndSkeletonContainer::InitLoopMassMatrix()
 	}
 }
 
+inline void ndSkeletonContainer::CalculateJointAccel(const ndNode* const node, const ndJacobian* const internalForces, ndForcePair* const accel) const
+{
+	const ndSpatialVector zero(ndSpatialVector::m_zero);
+	ndForcePair& a = accel[node->m_index];
+	ndAssert(node->m_body);
+	a.m_body = zero;
+	a.m_joint = zero;
+
+	ndAssert(node->m_joint);
+	ndJointBilateralConstraint* const joint = node->m_joint;
+
+	const ndInt32 first = joint->m_rowStart;
+	const ndInt32 dof = joint->m_rowCount;
+	const ndInt32 m0 = joint->GetBody0()->m_index;
+	const ndInt32 m1 = joint->GetBody1()->m_index;
+	const ndJacobian& y0 = internalForces[m0];
+	const ndJacobian& y1 = internalForces[m1];
+
+	for (ndInt32 j = 0; j < dof; ++j)  
+	{
+		const ndInt32 k = node->m_ordinal.m_sourceJacobianIndex[j];
+		const ndLeftHandSide* const row = &m_leftHandSide[first + k];
+		const ndRightHandSide* const rhs = &m_rightHandSide[first + k];
+		ndVector diag(
+			row->m_JMinv.m_jacobianM0.m_linear * y0.m_linear + row->m_JMinv.m_jacobianM0.m_angular * y0.m_angular +
+			row->m_JMinv.m_jacobianM1.m_linear * y1.m_linear + row->m_JMinv.m_jacobianM1.m_angular * y1.m_angular);
+		a.m_joint[j] = -(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp - diag.AddHorizontal().GetScalar());
+	}
+}
+
 inline void ndSkeletonContainer::CalculateJointAccel(const ndJacobian* const internalForces, ndForcePair* const accel) const
 {
 	const ndSpatialVector zero(ndSpatialVector::m_zero);
 	const ndInt32 nodeCount = m_nodeList.GetCount();
 	for (ndInt32 i = 0; i < nodeCount - 1; ++i) 
 	{
-		ndNode* const node = m_nodesOrder[i];
+		const ndNode* const node = m_nodesOrder[i];
 		ndAssert(i == node->m_index);
-
-		ndForcePair& a = accel[i];
-		ndAssert(node->m_body);
-		a.m_body = zero;
-		a.m_joint = zero;
-
-		ndAssert(node->m_joint);
-		ndJointBilateralConstraint* const joint = node->m_joint;
-
-		const ndInt32 first = joint->m_rowStart;
-		const ndInt32 dof = joint->m_rowCount;
-		const ndInt32 m0 = joint->GetBody0()->m_index;
-		const ndInt32 m1 = joint->GetBody1()->m_index;
-		const ndJacobian& y0 = internalForces[m0];
-		const ndJacobian& y1 = internalForces[m1];
-
-		for (ndInt32 j = 0; j < dof; ++j)  
-		{
-			const ndInt32 k = node->m_ordinal.m_sourceJacobianIndex[j];
-			const ndLeftHandSide* const row = &m_leftHandSide[first + k];
-			const ndRightHandSide* const rhs = &m_rightHandSide[first + k];
-			ndVector diag(
-				row->m_JMinv.m_jacobianM0.m_linear * y0.m_linear + row->m_JMinv.m_jacobianM0.m_angular * y0.m_angular +
-				row->m_JMinv.m_jacobianM1.m_linear * y1.m_linear + row->m_JMinv.m_jacobianM1.m_angular * y1.m_angular);
-			a.m_joint[j] = -(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp - diag.AddHorizontal().GetScalar());
-		}
+		CalculateJointAccel(node, internalForces, accel);
 	}
 	ndAssert((nodeCount - 1) == m_nodesOrder[nodeCount - 1]->m_index);
 	accel[nodeCount - 1].m_body = zero;
@@ -1417,7 +1679,7 @@ void ndSkeletonContainer::SolveAuxiliary(ndJacobian* const internalForces, const
 	}
 }
 
-void ndSkeletonContainer::InitMassMatrix(const ndLeftHandSide* const leftHandSide, ndRightHandSide* const rightHandSide)
+void ndSkeletonContainer::InitMassMatrix(const ndLeftHandSide* const leftHandSide, ndRightHandSide* const rightHandSide, ndThreadPool* const threadPool)
 {
 	D_TRACKTIME();
 	if (m_isResting)
@@ -1432,7 +1694,43 @@ void ndSkeletonContainer::InitMassMatrix(const ndLeftHandSide* const leftHandSid
 	const ndInt32 nodeCount = m_nodeList.GetCount();
 	ndSpatialMatrix* const bodyMassArray = ndAlloca(ndSpatialMatrix, nodeCount);
 	ndSpatialMatrix* const jointMassArray = ndAlloca(ndSpatialMatrix, nodeCount);
-	if (m_nodesOrder)
+	if (m_nodesOrder && threadPool && IsParallel())
+	{
+		// the partitions are independent subtrees, 
+		// the top nodes are factorized after all their children.
+		ndAtomic<ndInt32> boundedDof(0);
+		ndWorkStealingRange partitionRange(m_partitions.GetCount(), threadPool->GetThreadCount(), 1);
+		auto FactorizePartitions = ndMakeObject::ndFunction([this, &partitionRange, &boundedDof, leftHandSide, rightHandSide, bodyMassArray, jointMassArray](ndInt32 threadIndex, ndInt32)
+		{
+			D_TRACKTIME_NAMED(FactorizePartitions);
+			ndStartEnd startEnd;
+			while (partitionRange.GetChunk(threadIndex, startEnd))
+			{
+				ndInt32 count = 0;
+				for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+				{
+					const ndStartEnd& partition = m_partitions[i];
+					for (ndInt32 j = partition.m_start; j < partition.m_end; ++j)
+					{
+						count += m_nodesOrder[j]->Factorize(leftHandSide, rightHandSide, bodyMassArray, jointMassArray);
+					}
+				}
+				boundedDof.fetch_add(count);
+			}
+		});
+		threadPool->ParallelExecute(FactorizePartitions);
+
+		auxiliaryCount = boundedDof.load();
+		for (ndInt32 i = 0; i < m_partitionTopNodes.GetCount(); ++i)
+		{
+			auxiliaryCount += m_partitionTopNodes[i]->Factorize(leftHandSide, rightHandSide, bodyMassArray, jointMassArray);
+		}
+		for (ndInt32 i = 0; i < nodeCount - 1; ++i)
+		{
+			rowCount += m_nodesOrder[i]->m_joint->m_rowCount;
+		}
+	}
+	else if (m_nodesOrder)
 	{
 		for (ndInt32 i = 0; i < nodeCount - 1; ++i)
 		{
@@ -1460,7 +1758,7 @@ void ndSkeletonContainer::InitMassMatrix(const ndLeftHandSide* const leftHandSid
 
 	if (m_auxiliaryRowCount)
 	{
-		InitLoopMassMatrix();
+		InitLoopMassMatrix(threadPool);
 	}
 }
 
@@ -1698,7 +1996,7 @@ void ndSkeletonContainer::SolveImmediate(ndIkSolver& solverInfo)
 	}
 }
 
-void ndSkeletonContainer::CalculateReactionForces(ndJacobian* const internalForces)
+void ndSkeletonContainer::CalculateReactionForces(ndJacobian* const internalForces, ndThreadPool* const threadPool)
 {
 	if (!m_isResting)
 	{
@@ -1707,8 +2005,16 @@ void ndSkeletonContainer::CalculateReactionForces(ndJacobian* const internalForc
 		ndForcePair* const force = ndAlloca(ndForcePair, nodeCount);
 		ndForcePair* const accel = ndAlloca(ndForcePair, nodeCount);
 
-		CalculateJointAccel(internalForces, accel);
-		CalculateForce(force, accel);
+		if (threadPool && IsParallel())
+		{
+			SolveForward(*threadPool, internalForces, force, accel);
+			SolveBackward(*threadPool, force);
+		}
+		else
+		{
+			CalculateJointAccel(internalForces, accel);
+			CalculateForce(force, accel);
+		}
 		if (m_auxiliaryRowCount)
 		{
 			SolveAuxiliary(internalForces, accel, force);
@@ -33,6 +33,19 @@ class ndSkeletonContainer
 	ndSkeletonContainer();
 	~ndSkeletonContainer();
 
+	/// Skeletons with this many bodies or more are solved by all the threads.
+	/// \brief the tree is cut in subtrees that are factorized and solved in 
+	/// parallel, smaller skeletons are solved one per thread. When there are 
+	/// at least as many big skeletons as threads, they are also solved one 
+	/// per thread. Only branching trees have subtrees, a chain like a long 
+	/// cable is always solved by one thread whatever its size. This is for 
+	/// tuning and testing, it only affects skeletons built after the call.
+	D_NEWTON_API static ndInt32 GetParallelBodyCount();
+	D_NEWTON_API static void SetParallelBodyCount(ndInt32 count);
+
+	/// True when the skeleton is factorized and solved by all the threads.
+	bool IsParallel() const;
+
 	protected:
 	class ndOrdinal
 	{
@@ -130,17 +143,18 @@ class ndSkeletonContainer
 	void Init(ndBodyKinematic* const rootBody);
 	ndNode* AddChild(ndJointBilateralConstraint* const joint, ndNode* const parent);
 	void Finalize(ndInt32 loopJoints, ndJointBilateralConstraint** const loopJointArray);
+	void CalculatePartitions();
 
-	void InitLoopMassMatrix();
+	void InitLoopMassMatrix(ndThreadPool* const threadPool);
 	void ClearCloseLoopJoints();
 	void AddCloseLoopJoint(ndConstraint* const joint);
-	void CalculateReactionForces(ndJacobian* const internalForces);
-	void InitMassMatrix(const ndLeftHandSide* const matrixRow, ndRightHandSide* const rightHandSide);
+	void CalculateReactionForces(ndJacobian* const internalForces, ndThreadPool* const threadPool = nullptr);
+	void InitMassMatrix(const ndLeftHandSide* const matrixRow, ndRightHandSide* const rightHandSide, ndThreadPool* const threadPool = nullptr);
 	void CalculateBufferSizeInBytes();
-	void ConditionMassMatrix() const;
+	void ConditionMassMatrix(ndInt32 rowStart, ndInt32 rowEnd) const;
 	void SortGraph(ndNode* const root, ndInt32& index);
-	void RebuildMassMatrix(const ndFloat32* const diagDamp) const;
-	void CalculateLoopMassMatrixCoefficients(ndFloat32* const diagDamp);
+	void RebuildMassMatrix(const ndFloat32* const diagDamp, ndInt32 rowStart, ndInt32 rowEnd) const;
+	void CalculateLoopMassMatrixCoefficients(ndFloat32* const diagDamp, ndInt32 rowStart, ndInt32 rowEnd);
 	void FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp) const;
 	void SolveAuxiliary(ndJacobian* const internalForces, const ndForcePair* const accel, ndForcePair* const force) const;
 	void SolveBlockLcp(ndInt32 size, ndInt32 blockSize, const ndFloat32* const x0, ndFloat32* const x, ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex) const;
@@ -150,6 +164,9 @@ class ndSkeletonContainer
 	inline void CalculateForce(ndForcePair* const force, const ndForcePair* const accel) const;
 	inline void UpdateForces(ndJacobian* const internalForces, const ndForcePair* const force) const;
 	inline void CalculateJointAccel(const ndJacobian* const internalForces, ndForcePair* const accel) const;
+	inline void CalculateJointAccel(const ndNode* const node, const ndJacobian* const internalForces, ndForcePair* const accel) const;
+	inline void SolveForward(ndThreadPool& threadPool, const ndJacobian* const internalForces, ndForcePair* const force, ndForcePair* const accel) const;
+	inline void SolveBackward(ndThreadPool& threadPool, ndForcePair* const force) const;
 	inline void SolveForward(ndForcePair* const force, const ndForcePair* const accel, ndInt32 startNode) const;
 
 	void SolveImmediate(ndIkSolver& solverInfo);
@@ -170,6 +187,9 @@ class ndSkeletonContainer
 
 	ndNodeList m_nodeList;
 	ndArray<ndConstraint*> m_loopingJoints;
+	ndArray<ndStartEnd> m_partitions;
+	ndArray<ndNode*> m_partitionRoots;
+	ndArray<ndNode*> m_partitionTopNodes;
 	ndArray<ndInt8> m_auxiliaryMemoryBuffer;
 	ndSpinLock m_lock;
 	ndInt32 m_blockSize;
@@ -180,6 +200,8 @@ class ndSkeletonContainer
 	ndInt32 m_dynamicsLoopCount;
 	ndUnsigned8 m_isResting;
 
+	static ndInt32 m_parallelBodyCount;
+
 	friend class ndWorld;
 	friend class ndIkSolver;
 	friend class ndSkeletonList;
@@ -187,6 +209,7 @@ class ndSkeletonContainer
 	friend class ndDynamicsUpdate;
 	friend class ndDynamicsUpdateSoa;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateCuda;
 };
 
@@ -195,6 +218,11 @@ inline ndSkeletonContainer::ndNode* ndSkeletonContainer::GetRoot() const
 	return m_skeleton;
 }
 
+inline bool ndSkeletonContainer::IsParallel() const
+{
+	return m_partitions.GetCount() ? true : false;
+}
+
 #endif
 
 
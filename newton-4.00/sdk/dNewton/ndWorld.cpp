@@ -30,11 +30,16 @@
 #include "ndBodyParticleSet.h"
 #include "ndDynamicsUpdateSoa.h"
 #include "ndJointBilateralConstraint.h"
+#include "ndDynamicsUpdateGraphColor.h"
 
 #ifdef _D_USE_AVX2_SOLVER
 	#include "ndDynamicsUpdateAvx2.h"
 #endif
 
+#ifdef _D_USE_AVX512_SOLVER
+	#include "ndDynamicsUpdateAvx512.h"
+#endif
+
 #ifdef _D_NEWTON_OPENCL
 	#include "ndDynamicsUpdateOpencl.h"
 #endif
@@ -108,6 +113,7 @@ ndWorld::ndWorld()
 	,m_deletedModels(256)
 	,m_deletedJoints(256)
 	,m_activeSkeletons(256)
+	,m_parallelSkeletons(16)
 	,m_deletedLock()
 	,m_timestep(ndFloat32 (0.0f))
 	,m_freezeAccel2(D_FREEZE_ACCEL2)
@@ -122,9 +128,11 @@ ndWorld::ndWorld()
 	,m_solverMode(ndStandardSolver)
 	,m_solverIterations(4)
 	,m_inUpdate(false)
+	,m_pipelinedSubSteps(false)
 {
 	// start the engine thread;
 	ndBody::m_uniqueIdCount = 0;
+	ndSimdDispatch::Initialize();
 	m_solver = new ndDynamicsUpdate(this);
 	m_scene = new ndWorldScene(this);
 
@@ -170,9 +178,11 @@ ndWorld::~ndWorld()
 void ndWorld::CleanUp()
 {
 	Sync();
+	m_scene->m_bvhSceneManager.SyncBackgroundBuild();
 	m_scene->m_backgroundThread.Terminate();
 
 	m_activeSkeletons.Resize(256);
+	m_parallelSkeletons.Resize(16);
 	while (m_skeletonList.GetFirst())
 	{
 		m_skeletonList.Remove(m_skeletonList.GetFirst());
@@ -239,6 +249,27 @@ void ndWorld::SetThreadCount(ndInt32 count)
 	m_scene->m_backgroundThread.SetThreadCount(count);
 }
 
+ndInt32 ndWorld::GetThreadSpinBudget() const
+{
+	return m_scene->GetSpinBudget();
+}
+
+void ndWorld::SetThreadSpinBudget(ndInt32 spinCount)
+{
+	m_scene->SetSpinBudget(spinCount);
+	m_scene->m_backgroundThread.SetSpinBudget(spinCount);
+}
+
+bool ndWorld::GetPipelinedSubSteps() const
+{
+	return m_pipelinedSubSteps;
+}
+
+void ndWorld::SetPipelinedSubSteps(bool state)
+{
+	m_pipelinedSubSteps = state;
+}
+
 ndInt32 ndWorld::GetSubSteps() const
 {
 	return m_subSteps;
@@ -344,6 +375,11 @@ void ndWorld::DebugScene(ndSceneTreeNotiFy* const notify)
 }
 
 
+ndDynamicsUpdate* ndWorld::GetSolver() const
+{
+	return m_solver;
+}
+
 ndWorld::ndSolverModes ndWorld::GetSelectedSolver() const
 {
 	return m_solverMode;
@@ -411,6 +447,8 @@ void ndWorld::AddJoint(ndSharedPtr<ndJointBilateralConstraint>& joint)
 		if (joint->IsSkeleton())
 		{
 			m_skeletonList.m_skelListIsDirty = true;
+			joint->GetBody0()->m_skeletonDirty = 1;
+			joint->GetBody1()->m_skeletonDirty = 1;
 		}
 		joint->m_worldNode = m_jointList.Append(joint);
 		joint->m_body0Node = joint->GetBody0()->AttachJoint(*joint);
@@ -527,19 +565,39 @@ void ndWorld::SubStepUpdate(ndFloat32 timestep)
 {
 	D_TRACKTIME();
 
+	// all transient buffers of the previous sub step are released at once.
+	m_scene->m_contactScratch = nullptr;
+	m_scene->m_frameArena.Reset();
+
 	// do physics step
 	m_scene->m_lru = m_scene->m_lru + 1;
 	m_scene->SetTimestep(timestep);
 
 	m_scene->BalanceScene();
-	m_scene->ApplyExtForce();
-	m_scene->InitBodyArray();
-
-	// update the collision system
-	m_scene->FindCollidingPairs();
-	m_scene->CreateNewContacts();
-	m_scene->CalculateContacts();
-	m_scene->DeleteDeadContacts();
+	if (m_pipelinedSubSteps && !m_scene->IsGPU())
+	{
+		// stages that only depend on a per body or per pair 
+		// result are pipelined, removing the barrier in between. 
+		// the bodies woken up by new contacts are the exception, 
+		// and they are woken up before the fused contact pass.
+		m_scene->ApplyExtForceAndInitBodyArray();
+
+		// update the collision system
+		m_scene->FindCollidingPairs();
+		m_scene->CreateAndCalculateContacts();
+		m_scene->DeleteDeadContacts();
+	}
+	else
+	{
+		m_scene->ApplyExtForce();
+		m_scene->InitBodyArray();
+
+		// update the collision system
+		m_scene->FindCollidingPairs();
+		m_scene->CreateNewContacts();
+		m_scene->CalculateContacts();
+		m_scene->DeleteDeadContacts();
+	}
 
 	// update all special bodies.
 	m_scene->UpdateSpecial();
@@ -642,265 +700,324 @@ bool ndWorld::SkeletonJointTest(ndJointBilateralConstraint* const constraint) co
 	return test;
 }
 
-void ndWorld::UpdateSkeletons()
+void ndWorld::RemoveSkeleton(ndBodyKinematic* const body)
 {
-	D_TRACKTIME();
-	if (m_skeletonList.m_skelListIsDirty)
+	ndSkeletonContainer* const skeleton = body->GetSkeleton();
+	if (skeleton)
 	{
-		m_skeletonList.m_skelListIsDirty = false;
-		while (m_skeletonList.GetFirst())
-		{
-			m_skeletonList.Remove(m_skeletonList.GetFirst());
-		}
+		m_skeletonList.Remove(m_skeletonList.GetNodeFromInfo(*skeleton));
+		ndAssert(!body->GetSkeleton());
+	}
+}
+
+void ndWorld::BuildSkeleton(ndSkeletonContainer* const container, ndBodyKinematic* const islandRoot)
+{
+	ndSkeletonQueue queuePool;
+	ndInt32 stack = 1;
+	ndBodyKinematic* stackPool[256];
+	stackPool[0] = islandRoot;
+	ndSkeletonContainer* skeleton = nullptr;
 	
-		// build connectivity graph and reset of all joint dirty state
-		ndDynamicsUpdate& solverUpdate = *m_solver;
-		for (ndJointList::ndNode* node = m_jointList.GetFirst(); node; node = node->GetNext())
+	// find if this root node is connected to static bodies 
+	// if so, them make that static body the root node and add all the children
+	while (stack)
+	{
+		stack--;
+		ndBodyKinematic* const rootBody = stackPool[stack];
+		if (!rootBody->m_skeletonMark1)
 		{
-			ndJointBilateralConstraint* const constraint = *node->GetInfo();
-			const bool test = SkeletonJointTest(constraint);
-			constraint->m_mark0 = 0;
-			constraint->m_mark1 = 0;
-			if (test)
+			rootBody->m_skeletonMark1 = 1;
+			for (ndBodyKinematic::ndJointList::ndNode* jointNode = rootBody->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
 			{
-				ndBodyKinematic* const body0 = constraint->GetBody0();
-				ndBodyKinematic* const body1 = constraint->GetBody1();
-				if (body1->GetInvMass() > ndFloat32(0.0f))
+				ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
+				ndAssert(constraint && constraint->GetAsBilateral());
+				if (!constraint->m_mark1)
 				{
-					ndBodyKinematic* root0 = solverUpdate.FindRootAndSplit(body0);
-					ndBodyKinematic* root1 = solverUpdate.FindRootAndSplit(body1);
-					if (root0 != root1)
+					constraint->m_mark1 = 1;
+					const bool test = SkeletonJointTest(constraint);
+					if (test && (constraint->GetSolverModel() != m_jointkinematicCloseLoop))
 					{
-						if (root0->m_buildSkelIndex > root1->m_buildSkelIndex)
+						ndBodyKinematic* const childBody = (constraint->GetBody0() != rootBody) ? constraint->GetBody0() : constraint->GetBody1();
+						if (childBody->GetInvMass() == ndFloat32(0.0f))
 						{
-							ndSwap(root0, root1);
+							if (!skeleton)
+							{
+								skeleton = container;
+								skeleton->Init(childBody);
+							}
+	
+							//dTrace(("%s %d %d\n", constraint->GetClassName(), constraint->GetBody0()->GetId(), constraint->GetBody1()->GetId()));
+							constraint->m_mark0 = 1;
+							ndAssert(childBody == skeleton->GetRoot()->m_body);
+							ndSkeletonContainer::ndNode* const node = skeleton->AddChild((ndJointBilateralConstraint*)constraint, skeleton->GetRoot());
+							node->m_body->m_skeletonMark = 1;
+							ndAssert(node->m_body != childBody);
+							queuePool.Push(node);
 						}
-						root0->m_islandParent = root1;
-						if (root0->m_buildSkelIndex == root1->m_buildSkelIndex)
+						else if (!childBody->m_skeletonMark1)
 						{
-							root1->m_buildSkelIndex += 1;
-							ndAssert(root1->m_buildSkelIndex <= 6);
+							stackPool[stack] = childBody;
+							stack++;
 						}
 					}
 				}
 			}
 		}
+	}
 	
-		// reset of all bodies dirty state
-		const ndArray<ndBodyKinematic*>& bodyArray = m_scene->GetActiveBodyArray();
-		for (ndInt32 i = bodyArray.GetCount() - 1; i >= 0; i--)
+	if (queuePool.IsEmpty())
+	{
+		// if this root node is not static, 
+		// them add the first children to this root
+		bool hasJoints = false;
+		ndBodyKinematic* const rootBody = islandRoot;
+		rootBody->m_skeletonMark0 = 1;
+		for (ndBodyKinematic::ndJointList::ndNode* jointNode = rootBody->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
 		{
-			ndBodyKinematic* const body = bodyArray[i];
-			body->m_index = -1;
-			body->m_skeletonMark = 0;
-			body->m_skeletonMark0 = 0;
-			body->m_skeletonMark1 = 0;
+			ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
+		
+			const bool test = SkeletonJointTest(constraint);
+			if (test && (constraint->GetSolverModel() != m_jointkinematicCloseLoop))
+			{
+				ndBodyKinematic* const childBody = (constraint->GetBody0() != rootBody) ? constraint->GetBody0() : constraint->GetBody1();
+				if (childBody->GetInvMass())
+				{
+					hasJoints = true;
+					break;
+				}
+			}
 		}
 	
-		// find all root nodes for all independent joint arrangements
-		ndInt32 inslandCount = 0;
-		solverUpdate.m_leftHandSide.SetCount(ndMax(bodyArray.GetCount() + 256, 1024));
-		ndIslandMember* const islands = (ndIslandMember*)&solverUpdate.m_leftHandSide[0];
-		for (ndInt32 i = 0; i < bodyArray.GetCount(); ++i)
+		if (hasJoints)
 		{
-			ndBodyKinematic* const body = bodyArray[i];
-			if (body->GetInvMass() > ndFloat32(0.0f))
+			// the root node is not static and has children, 
+			// them add the first children to this root
+			skeleton = container;
+			skeleton->Init(rootBody);
+	
+			for (ndBodyKinematic::ndJointList::ndNode* jointNode = rootBody->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
 			{
-				ndBodyKinematic* const root = solverUpdate.FindRootAndSplit(body);
-				if (root->m_index == -1)
-				{
-					ndIslandMember& entry = islands[inslandCount];
-					entry.m_body = body;
-					entry.m_root = body;
-					root->m_index = inslandCount;
-					inslandCount++;
-				}
-				ndInt32 index = root->m_index;
-				ndAssert(index != -1);
-				ndIslandMember& entry = islands[index];
-				if (body->GetInvMass() < entry.m_body->GetInvMass())
+				ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
+				//dTrace(("%s %d %d\n", constraint->GetClassName(), constraint->GetBody0()->GetId(), constraint->GetBody1()->GetId()));
+				const bool test = SkeletonJointTest(constraint);
+				if (test && (constraint->GetSolverModel() != m_jointkinematicCloseLoop))
 				{
-					entry.m_body = body;
+					constraint->m_mark0 = 1;
+					ndAssert(skeleton->GetRoot()->m_body != ((constraint->GetBody0() != rootBody) ? constraint->GetBody0() : constraint->GetBody1()));
+					ndSkeletonContainer::ndNode* const node = skeleton->AddChild((ndJointBilateralConstraint*)constraint, skeleton->GetRoot());
+					node->m_body->m_skeletonMark = 1;
+					ndAssert(node->m_body == ((constraint->GetBody0() != rootBody) ? constraint->GetBody0() : constraint->GetBody1()));
+					queuePool.Push(node);
 				}
 			}
 		}
+	}
+	
+	if (skeleton)
+	{
+		// add the rest the children to this skeleton
+		ndInt32 loopCount = 0;
+		ndJointBilateralConstraint* loopJoints[128];
 	
-		// build the root node
-		for (ndInt32 i = 0; i < inslandCount; ++i)
+		while (!queuePool.IsEmpty())
 		{
-			ndSkeletonQueue queuePool;
-			ndInt32 stack = 1;
-			ndBodyKinematic* stackPool[256];
-			stackPool[0] = islands[i].m_body;
-			ndSkeletonContainer* skeleton = nullptr;
-			
-			// find if this root node is connected to static bodies 
-			// if so, them make that static body the root node and add all the children
-			while (stack)
+			ndInt32 count = queuePool.m_firstIndex - queuePool.m_lastIndex;
+			if (count < 0)
+			{
+				count += queuePool.m_mod;
+			}
+	
+			ndInt32 index = queuePool.m_lastIndex;
+			queuePool.Reset();
+	
+			for (ndInt32 j = 0; j < count; ++j)
 			{
-				stack--;
-				ndBodyKinematic* const rootBody = stackPool[stack];
-				if (!rootBody->m_skeletonMark1)
+				ndSkeletonContainer::ndNode* const parentNode = queuePool[index];
+				ndBodyKinematic* const parentBody = parentNode->m_body;
+				if (!parentBody->m_skeletonMark0)
 				{
-					rootBody->m_skeletonMark1 = 1;
-					for (ndBodyKinematic::ndJointList::ndNode* jointNode = rootBody->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
+					parentBody->m_skeletonMark0 = 1;
+					for (ndBodyKinematic::ndJointList::ndNode* jointNode = parentBody->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
 					{
 						ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
-						ndAssert(constraint && constraint->GetAsBilateral());
-						if (!constraint->m_mark1)
+						if (!constraint->m_mark0)
 						{
-							constraint->m_mark1 = 1;
-							const bool test = SkeletonJointTest(constraint);
-							if (test && (constraint->GetSolverModel() != m_jointkinematicCloseLoop))
+							//dTrace(("%s %d %d\n", constraint->GetClassName(), constraint->GetBody0()->GetId(), constraint->GetBody1()->GetId()));
+							constraint->m_mark0 = 1;
+							if (SkeletonJointTest(constraint))
 							{
-								ndBodyKinematic* const childBody = (constraint->GetBody0() != rootBody) ? constraint->GetBody0() : constraint->GetBody1();
-								if (childBody->GetInvMass() == ndFloat32(0.0f))
+								ndBodyKinematic* const childBody = (constraint->GetBody0() == parentBody) ? constraint->GetBody1() : constraint->GetBody0();
+								if (!childBody->m_skeletonMark && (childBody->GetInvMass() != ndFloat32(0.0f)) && (constraint->GetSolverModel() != m_jointkinematicCloseLoop))
 								{
-									if (!skeleton)
-									{
-										skeleton = m_skeletonList.CreateContatiner(childBody);
-									}
-			
-									//dTrace(("%s %d %d\n", constraint->GetClassName(), constraint->GetBody0()->GetId(), constraint->GetBody1()->GetId()));
-									constraint->m_mark0 = 1;
-									ndAssert(childBody == skeleton->GetRoot()->m_body);
-									ndSkeletonContainer::ndNode* const node = skeleton->AddChild((ndJointBilateralConstraint*)constraint, skeleton->GetRoot());
-									node->m_body->m_skeletonMark = 1;
-									ndAssert(node->m_body != childBody);
-									queuePool.Push(node);
+									childBody->m_skeletonMark = 1;
+									ndSkeletonContainer::ndNode* const childNode = skeleton->AddChild(constraint, parentNode);
+									queuePool.Push(childNode);
 								}
-								else if (!childBody->m_skeletonMark1)
+								else if (loopCount < ndInt32 ((sizeof(loopJoints) / sizeof(loopJoints[0]))))
 								{
-									stackPool[stack] = childBody;
-									stack++;
+									loopJoints[loopCount] = (ndJointBilateralConstraint*)constraint;
+									loopCount++;
 								}
 							}
 						}
 					}
 				}
+	
+				index++;
+				if (index >= queuePool.m_mod)
+				{
+					index = 0;
+				}
 			}
-			
-			if (queuePool.IsEmpty())
+		}
+		skeleton->Finalize(loopCount, loopJoints);
+	}
+}
+
+void ndWorld::UpdateSkeletons()
+{
+	D_TRACKTIME();
+	if (m_skeletonList.m_skelListIsDirty)
+	{
+		m_skeletonList.m_skelListIsDirty = false;
+
+		// only the bodies connected to a joint that was added or removed are
+		// dirty, the skeletons of the rest of the world are left untouched.
+		ndFrameArenaScope arenaScope(m_scene->GetFrameArena());
+		const ndArray<ndBodyKinematic*>& bodyArray = m_scene->GetActiveBodyArray();
+		ndBodyKinematic** const dirtyBodies = m_scene->GetFrameArena().Alloc<ndBodyKinematic*>(bodyArray.GetCount());
+
+		ndInt32 dirtyCount = 0;
+		for (ndInt32 i = 0; i < bodyArray.GetCount(); ++i)
+		{
+			ndBodyKinematic* const body = bodyArray[i];
+			if (body->m_skeletonDirty)
 			{
-				// if this root node is not static, 
-				// them add the first children to this root
-				bool hasJoints = false;
-				ndBodyKinematic* const rootBody = islands[i].m_body;
-				rootBody->m_skeletonMark0 = 1;
-				for (ndBodyKinematic::ndJointList::ndNode* jointNode = rootBody->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
+				if (body->GetInvMass() > ndFloat32(0.0f))
 				{
-					ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
-				
-					const bool test = SkeletonJointTest(constraint);
-					if (test && (constraint->GetSolverModel() != m_jointkinematicCloseLoop))
-					{
-						ndBodyKinematic* const childBody = (constraint->GetBody0() != rootBody) ? constraint->GetBody0() : constraint->GetBody1();
-						if (childBody->GetInvMass())
-						{
-							hasJoints = true;
-							break;
-						}
-					}
+					dirtyBodies[dirtyCount] = body;
+					dirtyCount++;
 				}
-			
-				if (hasJoints)
+				else
 				{
-					// the root node is not static and has children, 
-					// them add the first children to this root
-					skeleton = m_skeletonList.CreateContatiner(rootBody);
-			
-					for (ndBodyKinematic::ndJointList::ndNode* jointNode = rootBody->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
+					body->m_skeletonDirty = 0;
+				}
+			}
+		}
+
+		// grow the dirty set to all the bodies connected by skeleton joints, 
+		// delete the skeletons it reaches and reset the dirty state of the 
+		// bodies and joints, the set is now a list of complete islands.
+		for (ndInt32 i = 0; i < dirtyCount; ++i)
+		{
+			ndBodyKinematic* const body = dirtyBodies[i];
+			RemoveSkeleton(body);
+			body->m_skeletonMark = 0;
+			body->m_skeletonMark0 = 0;
+			body->m_skeletonMark1 = 0;
+			for (ndBodyKinematic::ndJointList::ndNode* jointNode = body->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
+			{
+				ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
+				constraint->m_mark0 = 0;
+				constraint->m_mark1 = 0;
+				if (SkeletonJointTest(constraint))
+				{
+					ndBodyKinematic* const childBody = (constraint->GetBody0() == body) ? constraint->GetBody1() : constraint->GetBody0();
+					if (!childBody->m_skeletonDirty && (childBody->GetInvMass() > ndFloat32(0.0f)))
 					{
-						ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
-						//dTrace(("%s %d %d\n", constraint->GetClassName(), constraint->GetBody0()->GetId(), constraint->GetBody1()->GetId()));
-						const bool test = SkeletonJointTest(constraint);
-						if (test && (constraint->GetSolverModel() != m_jointkinematicCloseLoop))
-						{
-							constraint->m_mark0 = 1;
-							ndAssert(skeleton->GetRoot()->m_body != ((constraint->GetBody0() != rootBody) ? constraint->GetBody0() : constraint->GetBody1()));
-							ndSkeletonContainer::ndNode* const node = skeleton->AddChild((ndJointBilateralConstraint*)constraint, skeleton->GetRoot());
-							node->m_body->m_skeletonMark = 1;
-							ndAssert(node->m_body == ((constraint->GetBody0() != rootBody) ? constraint->GetBody0() : constraint->GetBody1()));
-							queuePool.Push(node);
-						}
+						ndAssert(dirtyCount < bodyArray.GetCount());
+						childBody->m_skeletonDirty = 1;
+						dirtyBodies[dirtyCount] = childBody;
+						dirtyCount++;
 					}
 				}
 			}
-			
-			if (skeleton)
+		}
+
+		// find the root of each island, the heaviest body, 
+		// or the first in the body array if there are many.
+		ndInt32 islandCount = 0;
+		ndBodyKinematic** const islands = m_scene->GetFrameArena().Alloc<ndBodyKinematic*>(dirtyCount + 1);
+		ndBodyKinematic** const stackPool = m_scene->GetFrameArena().Alloc<ndBodyKinematic*>(dirtyCount + 1);
+		for (ndInt32 i = 0; i < dirtyCount; ++i)
+		{
+			if (dirtyBodies[i]->m_skeletonDirty)
 			{
-				// add the rest the children to this skeleton
-				ndInt32 loopCount = 0;
-				ndJointBilateralConstraint* loopJoints[128];
-			
-				while (!queuePool.IsEmpty())
+				ndInt32 stack = 1;
+				ndBodyKinematic* islandRoot = dirtyBodies[i];
+				stackPool[0] = islandRoot;
+				islandRoot->m_skeletonDirty = 0;
+				while (stack)
 				{
-					ndInt32 count = queuePool.m_firstIndex - queuePool.m_lastIndex;
-					if (count < 0)
+					stack--;
+					ndBodyKinematic* const body = stackPool[stack];
+					const ndFloat32 invMass = body->GetInvMass();
+					const ndFloat32 rootInvMass = islandRoot->GetInvMass();
+					if ((invMass < rootInvMass) || ((invMass == rootInvMass) && (body->m_index < islandRoot->m_index)))
 					{
-						count += queuePool.m_mod;
+						islandRoot = body;
 					}
-			
-					ndInt32 index = queuePool.m_lastIndex;
-					queuePool.Reset();
-			
-					for (ndInt32 j = 0; j < count; ++j)
+
+					for (ndBodyKinematic::ndJointList::ndNode* jointNode = body->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
 					{
-						ndSkeletonContainer::ndNode* const parentNode = queuePool[index];
-						ndBodyKinematic* const parentBody = parentNode->m_body;
-						if (!parentBody->m_skeletonMark0)
-						{
-							parentBody->m_skeletonMark0 = 1;
-							for (ndBodyKinematic::ndJointList::ndNode* jointNode = parentBody->m_jointList.GetFirst(); jointNode; jointNode = jointNode->GetNext())
-							{
-								ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
-								if (!constraint->m_mark0)
-								{
-									//dTrace(("%s %d %d\n", constraint->GetClassName(), constraint->GetBody0()->GetId(), constraint->GetBody1()->GetId()));
-									constraint->m_mark0 = 1;
-									if (SkeletonJointTest(constraint))
-									{
-										ndBodyKinematic* const childBody = (constraint->GetBody0() == parentBody) ? constraint->GetBody1() : constraint->GetBody0();
-										if (!childBody->m_skeletonMark && (childBody->GetInvMass() != ndFloat32(0.0f)) && (constraint->GetSolverModel() != m_jointkinematicCloseLoop))
-										{
-											childBody->m_skeletonMark = 1;
-											ndSkeletonContainer::ndNode* const childNode = skeleton->AddChild(constraint, parentNode);
-											queuePool.Push(childNode);
-										}
-										else if (loopCount < ndInt32 ((sizeof(loopJoints) / sizeof(loopJoints[0]))))
-										{
-											loopJoints[loopCount] = (ndJointBilateralConstraint*)constraint;
-											loopCount++;
-										}
-									}
-								}
-							}
-						}
-			
-						index++;
-						if (index >= queuePool.m_mod)
+						ndJointBilateralConstraint* const constraint = jointNode->GetInfo();
+						ndBodyKinematic* const childBody = (constraint->GetBody0() == body) ? constraint->GetBody1() : constraint->GetBody0();
+						if (childBody->m_skeletonDirty && SkeletonJointTest(constraint))
 						{
-							index = 0;
+							childBody->m_skeletonDirty = 0;
+							stackPool[stack] = childBody;
+							stack++;
 						}
 					}
 				}
-				skeleton->Finalize(loopCount, loopJoints);
+				islands[islandCount] = islandRoot;
+				islandCount++;
 			}
 		}
-	
-		for (ndInt32 i = bodyArray.GetCount() - 1; i >= 0; i--)
+
+		// the islands are independent, so the skeletons are built in parallel,
+		// the containers are added serially so that the list order is the same.
+		ndSkeletonList::ndNode** const containers = m_scene->GetFrameArena().Alloc<ndSkeletonList::ndNode*>(islandCount + 1);
+		for (ndInt32 i = 0; i < islandCount; ++i)
 		{
-			ndBodyKinematic* const body = bodyArray[i];
-			body->PrepareStep(i);
-			ndAssert (bodyArray[i] == body);
+			containers[i] = m_skeletonList.Append();
 		}
-	
+
+		ndAtomic<ndInt32> counter(0);
+		auto BuildSkeletons = ndMakeObject::ndFunction([this, &counter, islands, containers, islandCount](ndInt32, ndInt32)
+		{
+			D_TRACKTIME_NAMED(BuildSkeletons);
+			for (ndInt32 i = counter.fetch_add(1); i < islandCount; i = counter.fetch_add(1))
+			{
+				BuildSkeleton(&containers[i]->GetInfo(), islands[i]);
+			}
+		});
+		m_scene->ParallelExecute(BuildSkeletons);
+
+		for (ndInt32 i = 0; i < islandCount; ++i)
+		{
+			if (!containers[i]->GetInfo().GetRoot())
+			{
+				m_skeletonList.Remove(containers[i]);
+			}
+		}
+
+		// the big skeletons are kept apart, the solver decides if they are
+		// split in subtrees or solved one per thread like the others
 		m_activeSkeletons.SetCount(0);
+		m_parallelSkeletons.SetCount(0);
 		ndSkeletonList::Iterator iter(m_skeletonList);
 		for (iter.Begin(); iter; iter++)
 		{
 			ndSkeletonContainer* const skeleton = &iter.GetNode()->GetInfo();
-			m_activeSkeletons.PushBack(skeleton);
+			if (skeleton->IsParallel())
+			{
+				m_parallelSkeletons.PushBack(skeleton);
+			}
+			else
+			{
+				m_activeSkeletons.PushBack(skeleton);
+			}
 		}
 	}
 	
@@ -909,6 +1026,11 @@ void ndWorld::UpdateSkeletons()
 		ndSkeletonContainer* const skeleton = m_activeSkeletons[i];
 		skeleton->ClearCloseLoopJoints();
 	}
+	for (ndInt32 i = 0; i < m_parallelSkeletons.GetCount(); ++i)
+	{
+		ndSkeletonContainer* const skeleton = m_parallelSkeletons[i];
+		skeleton->ClearCloseLoopJoints();
+	}
 }
 
 bool ndWorld::RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const
@@ -921,13 +1043,53 @@ bool ndWorld::ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& co
 	return m_scene->ConvexCast(callback, convexShape, globalOrigin, globalDest);
 }
 
+void ndWorld::RayCast(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count)
+{
+	m_scene->RayCast(rays, hits, count);
+}
+
+void ndWorld::ConvexCast(const ndConvexCastQuery* const casts, ndRayCastHit* const hits, ndInt32 count)
+{
+	m_scene->ConvexCast(casts, hits, count);
+}
+
 void ndWorld::BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const
 {
 	m_scene->BodiesInAabb(callback, minBox, maxBox);
 }
 
+// the simd solvers are compiled for a fix instruction set, 
+// so the cpu has to be checked before creating one of them.
+static bool ndCpuSupportsAvx2()
+{
+	#if defined(_D_USE_AVX2_SOLVER)
+		return ndSimdDispatch::CpuSupportsAvx2();
+	#else
+		return false;
+	#endif
+}
+
+static bool ndCpuSupportsAvx512()
+{
+	#if defined(_D_USE_AVX512_SOLVER)
+		return ndSimdDispatch::CpuSupportsAvx512();
+	#else
+		return false;
+	#endif
+}
+
 void ndWorld::SelectSolver(ndSolverModes solverMode)
 {
+	// fall back to the widest simd solver that this build and this cpu can run
+	if ((solverMode == ndSimdAvx512Solver) && !ndCpuSupportsAvx512())
+	{
+		solverMode = ndSimdAvx2Solver;
+	}
+	if ((solverMode == ndSimdAvx2Solver) && !ndCpuSupportsAvx2())
+	{
+		solverMode = ndSimdSoaSolver;
+	}
+
 	if (solverMode != m_solverMode)
 	{
 		Sync();
@@ -1039,6 +1201,37 @@ void ndWorld::SelectSolver(ndSolverModes solverMode)
 				break;
 			}
 
+			case ndSimdAvx512Solver:
+			{
+				#ifdef _D_USE_AVX512_SOLVER
+					ndWorldScene* const newScene = new ndWorldScene(*((ndWorldScene*)m_scene));
+					delete m_scene;
+					m_scene = newScene;
+
+					m_solverMode = solverMode;
+					m_solver = new ndDynamicsUpdateAvx512(this);
+				#else
+					ndWorldScene* const newScene = new ndWorldScene(*((ndWorldScene*)m_scene));
+					delete m_scene;
+					m_scene = newScene;
+
+					m_solverMode = ndSimdSoaSolver;
+					m_solver = new ndDynamicsUpdateSoa(this);
+				#endif
+				break;
+			}
+
+			case ndGraphColorSolver:
+			{
+				ndWorldScene* const newScene = new ndWorldScene(*((ndWorldScene*)m_scene));
+				delete m_scene;
+				m_scene = newScene;
+
+				m_solverMode = solverMode;
+				m_solver = new ndDynamicsUpdateGraphColor(this);
+				break;
+			}
+
 			case ndStandardSolver:
 			default:
 			{
@@ -1165,12 +1358,13 @@ void ndWorld::RemoveJoint(ndSharedPtr<ndJointBilateralConstraint>& joint)
 
 			if (joint->IsSkeleton())
 			{
+				// the skeleton is deleted now, while its bodies are still alive, 
+				// the next update rebuilds the skeletons of the two bodies.
 				m_skeletonList.m_skelListIsDirty = true;
-				ndSkeletonContainer* const skeleton = joint->GetBody0()->GetSkeleton();
-				if (skeleton)
-				{
-					skeleton->Clear();
-				}
+				RemoveSkeleton(joint->GetBody0());
+				RemoveSkeleton(joint->GetBody1());
+				joint->GetBody0()->m_skeletonDirty = 1;
+				joint->GetBody1()->m_skeletonDirty = 1;
 			}
 			joint->m_worldNode = nullptr;
 			joint->m_body0Node = nullptr;
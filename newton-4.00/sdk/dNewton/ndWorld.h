@@ -32,8 +32,11 @@ class ndWorld;
 class ndModel;
 class ndJointList;
 class ndBodyDynamic;
+class ndRayCastHit;
+class ndRayCastQuery;
 class ndRayCastNotify;
 class ndDynamicsUpdate;
+class ndConvexCastQuery;
 class ndConvexCastNotify;
 class ndBodiesInAabbNotify;
 class ndJointBilateralConstraint;
@@ -55,6 +58,8 @@ class ndWorld: public ndClassAlloc
 		ndCudaSolver,
 		ndOpenclSolver1,
 		ndOpenclSolver2,
+		ndGraphColorSolver,
+		ndSimdAvx512Solver,
 	};
 
 	D_NEWTON_API ndWorld();
@@ -73,9 +78,16 @@ class ndWorld: public ndClassAlloc
 	D_NEWTON_API ndInt32 GetThreadCount() const;
 	D_NEWTON_API void SetThreadCount(ndInt32 count);
 
+	D_NEWTON_API ndInt32 GetThreadSpinBudget() const;
+	D_NEWTON_API void SetThreadSpinBudget(ndInt32 spinCount);
+
 	D_NEWTON_API ndInt32 GetSubSteps() const;
 	D_NEWTON_API void SetSubSteps(ndInt32 subSteps);
 
+	D_NEWTON_API bool GetPipelinedSubSteps() const;
+	D_NEWTON_API void SetPipelinedSubSteps(bool state);
+
+	D_NEWTON_API ndDynamicsUpdate* GetSolver() const;
 	D_NEWTON_API ndSolverModes GetSelectedSolver() const;
 	D_NEWTON_API void SelectSolver(ndSolverModes solverMode);
 
@@ -120,6 +132,8 @@ class ndWorld: public ndClassAlloc
 	D_NEWTON_API void BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const;
 	D_NEWTON_API bool RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const;
 	D_NEWTON_API bool ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
+	D_NEWTON_API void RayCast(const ndRayCastQuery* const rays, ndRayCastHit* const hits, ndInt32 count);
+	D_NEWTON_API void ConvexCast(const ndConvexCastQuery* const casts, ndRayCastHit* const hits, ndInt32 count);
 
 	private:
 	void ThreadFunction();
@@ -157,6 +171,8 @@ class ndWorld: public ndClassAlloc
 	void ParticleUpdate(ndFloat32 timestep);
 
 	bool SkeletonJointTest(ndJointBilateralConstraint* const jointA) const;
+	void BuildSkeleton(ndSkeletonContainer* const container, ndBodyKinematic* const islandRoot);
+	void RemoveSkeleton(ndBodyKinematic* const body);
 	static ndInt32 CompareJointByInvMass(const ndJointBilateralConstraint* const jointA, const ndJointBilateralConstraint* const jointB, void* notUsed);
 
 	ndScene* m_scene;
@@ -169,6 +185,7 @@ class ndWorld: public ndClassAlloc
 	ndArray<ndModel*> m_deletedModels;
 	ndArray<ndJointBilateralConstraint*> m_deletedJoints;
 	ndArray<ndSkeletonContainer*> m_activeSkeletons;
+	ndArray<ndSkeletonContainer*> m_parallelSkeletons;
 	ndSpinLock m_deletedLock;
 
 	ndFloat32 m_timestep;
@@ -187,6 +204,7 @@ class ndWorld: public ndClassAlloc
 	ndSolverModes m_solverMode;
 	ndInt32 m_solverIterations;
 	bool m_inUpdate;
+	bool m_pipelinedSubSteps;
 	
 	friend class ndScene;
 	friend class ndWorldScene;
@@ -195,6 +213,7 @@ class ndWorld: public ndClassAlloc
 	friend class ndSkeletonContainer;
 	friend class ndDynamicsUpdateSoa;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateCuda;
 	friend class ndDynamicsUpdateOpencl;
 } D_GCC_NEWTON_ALIGN_32;
@@ -0,0 +1,530 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndNewtonStdafx.h"
+#include "ndWorld.h"
+#include "ndWorldSnapshot.h"
+#include "ndBodyDynamic.h"
+
+// the snapshot is a header followed by the tables of the shapes, bodies, 
+// joints, contacts and contact points. All records are plain data, 
+// so the snapshot can be read in place from a memory mapped file.
+#define D_SNAPSHOT_ALIGNMENT	16
+
+class ndSnapshotHeader
+{
+	public:
+	char m_magic[4];
+	ndInt32 m_version;
+	ndInt32 m_floatSize;
+	ndInt32 m_shapeCount;
+	ndInt32 m_bodyCount;
+	ndInt32 m_jointCount;
+	ndInt32 m_contactCount;
+	ndInt32 m_contactPointCount;
+	ndUnsigned64 m_size;
+};
+
+class ndSnapshotShape
+{
+	public:
+	ndInt32 m_collisionType;
+	ndInt32 m_padding;
+	ndFloat32 m_obbSize[4];
+	ndFloat32 m_obbOrigin[4];
+};
+
+class ndSnapshotBody
+{
+	public:
+	ndUnsigned32 m_id;
+	ndInt32 m_shapeIndex;
+	ndInt32 m_equilibrium;
+	ndInt32 m_autoSleep;
+	ndFloat32 m_matrix[4][4];
+	ndFloat32 m_veloc[4];
+	ndFloat32 m_omega[4];
+	ndFloat32 m_accel[4];
+	ndFloat32 m_alpha[4];
+	ndFloat32 m_force[4];
+	ndFloat32 m_torque[4];
+};
+
+class ndSnapshotJoint
+{
+	public:
+	ndUnsigned32 m_body0;
+	ndUnsigned32 m_body1;
+	ndFloat32 m_forceBody0[4];
+	ndFloat32 m_torqueBody0[4];
+	ndFloat32 m_forceBody1[4];
+	ndFloat32 m_torqueBody1[4];
+	ndFloat32 m_motorAcceleration[ND_BILATERAL_CONTRAINT_DOF];
+	ndForceImpactPair m_jointForce[ND_BILATERAL_CONTRAINT_DOF];
+};
+
+class ndSnapshotContact
+{
+	public:
+	ndInt32 m_body0;
+	ndInt32 m_body1;
+	ndInt32 m_start;
+	ndInt32 m_count;
+};
+
+class ndSnapshotContactPoint
+{
+	public:
+	ndFloat32 m_point[4];
+	ndForceImpactPair m_normal_Force;
+	ndForceImpactPair m_dir0_Force;
+	ndForceImpactPair m_dir1_Force;
+};
+
+class ndSnapshotLayout
+{
+	public:
+	ndSnapshotLayout(const ndSnapshotHeader& header)
+	{
+		m_shapes = Align(sizeof(ndSnapshotHeader));
+		m_bodies = Align(m_shapes + header.m_shapeCount * sizeof(ndSnapshotShape));
+		m_joints = Align(m_bodies + header.m_bodyCount * sizeof(ndSnapshotBody));
+		m_contacts = Align(m_joints + header.m_jointCount * sizeof(ndSnapshotJoint));
+		m_points = Align(m_contacts + header.m_contactCount * sizeof(ndSnapshotContact));
+		m_size = Align(m_points + header.m_contactPointCount * sizeof(ndSnapshotContactPoint));
+	}
+
+	static size_t Align(size_t offset)
+	{
+		return (offset + D_SNAPSHOT_ALIGNMENT - 1) & ~size_t(D_SNAPSHOT_ALIGNMENT - 1);
+	}
+
+	size_t m_shapes;
+	size_t m_bodies;
+	size_t m_joints;
+	size_t m_contacts;
+	size_t m_points;
+	size_t m_size;
+};
+
+static void ndSnapshotSetVector(ndFloat32* const dst, const ndVector& src)
+{
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		dst[i] = src[i];
+	}
+}
+
+static ndVector ndSnapshotGetVector(const ndFloat32* const src)
+{
+	return ndVector(src[0], src[1], src[2], src[3]);
+}
+
+static const ndSnapshotHeader* ndSnapshotValidate(const void* const data, size_t size)
+{
+	const ndSnapshotHeader* const header = (ndSnapshotHeader*)data;
+	if (!data || (size < sizeof(ndSnapshotHeader)))
+	{
+		return nullptr;
+	}
+	if (strncmp(header->m_magic, "ndSS", 4) || (header->m_version != D_WORLD_SNAPSHOT_VERSION) || (header->m_floatSize != ndInt32(sizeof(ndFloat32))))
+	{
+		return nullptr;
+	}
+	if ((header->m_shapeCount < 0) || (header->m_bodyCount < 0) || (header->m_jointCount < 0) || (header->m_contactCount < 0) || (header->m_contactPointCount < 0))
+	{
+		return nullptr;
+	}
+	const ndSnapshotLayout layout(*header);
+	if ((header->m_size != layout.m_size) || (size < layout.m_size))
+	{
+		return nullptr;
+	}
+	return header;
+}
+
+ndWorldSnapshot::ndWorldSnapshot()
+	:ndClassAlloc()
+	,m_buffer()
+{
+}
+
+ndWorldSnapshot::~ndWorldSnapshot()
+{
+}
+
+void ndWorldSnapshot::Capture(const ndWorld* const world)
+{
+	D_TRACKTIME();
+	world->Sync();
+
+	const ndBodyList& bodyList = world->GetBodyList();
+	const ndJointList& jointList = world->GetJointList();
+	const ndContactArray& contactArray = world->GetContactList();
+
+	// deduplicate the shapes, and give each body an index for the contacts table
+	ndTree<ndInt32, const ndShape*> shapeMap;
+	ndTree<ndInt32, const ndBodyKinematic*> bodyMap;
+	ndInt32 bodyCount = 0;
+	for (ndBodyList::ndNode* node = bodyList.GetFirst(); node; node = node->GetNext())
+	{
+		const ndBodyKinematic* const body = *node->GetInfo();
+		const ndShape* const shape = body->GetCollisionShape().GetShape();
+		if (!shapeMap.Find(shape))
+		{
+			shapeMap.Insert(shapeMap.GetCount(), shape);
+		}
+		bodyMap.Insert(bodyCount, body);
+		bodyCount++;
+	}
+
+	ndInt32 contactCount = 0;
+	ndInt32 contactPointCount = 0;
+	for (ndInt32 i = 0; i < contactArray.GetCount(); ++i)
+	{
+		const ndContact* const contact = contactArray[i];
+		if (contact->IsActive() && contact->GetContactPoints().GetCount())
+		{
+			contactCount++;
+			contactPointCount += contact->GetContactPoints().GetCount();
+		}
+	}
+
+	ndSnapshotHeader header;
+	memcpy(header.m_magic, "ndSS", 4);
+	header.m_version = D_WORLD_SNAPSHOT_VERSION;
+	header.m_floatSize = sizeof(ndFloat32);
+	header.m_shapeCount = shapeMap.GetCount();
+	header.m_bodyCount = bodyCount;
+	header.m_jointCount = jointList.GetCount();
+	header.m_contactCount = contactCount;
+	header.m_contactPointCount = contactPointCount;
+
+	const ndSnapshotLayout layout(header);
+	header.m_size = layout.m_size;
+
+	m_buffer.SetCount(ndInt32(layout.m_size));
+	ndUnsigned8* const data = &m_buffer[0];
+	memset(data, 0, layout.m_size);
+	memcpy(data, &header, sizeof(header));
+
+	ndSnapshotShape* const shapes = (ndSnapshotShape*)&data[layout.m_shapes];
+	ndTree<ndInt32, const ndShape*>::Iterator shapeIter(shapeMap);
+	for (shapeIter.Begin(); shapeIter; shapeIter++)
+	{
+		const ndShape* const shape = shapeIter.GetKey();
+		ndSnapshotShape& record = shapes[shapeIter.GetNode()->GetInfo()];
+		record.m_collisionType = shape->GetShapeInfo().m_collisionType;
+		ndSnapshotSetVector(record.m_obbSize, shape->GetObbSize());
+		ndSnapshotSetVector(record.m_obbOrigin, shape->GetObbOrigin());
+	}
+
+	ndInt32 index = 0;
+	ndSnapshotBody* const bodies = (ndSnapshotBody*)&data[layout.m_bodies];
+	for (ndBodyList::ndNode* node = bodyList.GetFirst(); node; node = node->GetNext())
+	{
+		ndBodyKinematic* const body = *node->GetInfo();
+		ndSnapshotBody& record = bodies[index];
+		const ndMatrix matrix(body->GetMatrix());
+
+		record.m_id = body->GetId();
+		record.m_shapeIndex = shapeMap.Find(body->GetCollisionShape().GetShape())->GetInfo();
+		record.m_equilibrium = body->GetSleepState() ? 1 : 0;
+		record.m_autoSleep = body->GetAutoSleep() ? 1 : 0;
+		for (ndInt32 i = 0; i < 4; ++i)
+		{
+			ndSnapshotSetVector(record.m_matrix[i], matrix[i]);
+		}
+		ndSnapshotSetVector(record.m_veloc, body->GetVelocity());
+		ndSnapshotSetVector(record.m_omega, body->GetOmega());
+		ndSnapshotSetVector(record.m_accel, body->GetAccel());
+		ndSnapshotSetVector(record.m_alpha, body->GetAlpha());
+		ndSnapshotSetVector(record.m_force, body->GetForce());
+		ndSnapshotSetVector(record.m_torque, body->GetTorque());
+		index++;
+	}
+
+	index = 0;
+	ndSnapshotJoint* const joints = (ndSnapshotJoint*)&data[layout.m_joints];
+	for (ndJointList::ndNode* node = jointList.GetFirst(); node; node = node->GetNext())
+	{
+		const ndJointBilateralConstraint* const joint = *node->GetInfo();
+		ndSnapshotJoint& record = joints[index];
+		record.m_body0 = joint->GetBody0()->GetId();
+		record.m_body1 = joint->GetBody1()->GetId();
+		ndSnapshotSetVector(record.m_forceBody0, joint->m_forceBody0);
+		ndSnapshotSetVector(record.m_torqueBody0, joint->m_torqueBody0);
+		ndSnapshotSetVector(record.m_forceBody1, joint->m_forceBody1);
+		ndSnapshotSetVector(record.m_torqueBody1, joint->m_torqueBody1);
+		for (ndInt32 i = 0; i < ND_BILATERAL_CONTRAINT_DOF; ++i)
+		{
+			record.m_jointForce[i] = joint->m_jointForce[i];
+			record.m_motorAcceleration[i] = joint->m_motorAcceleration[i];
+		}
+		index++;
+	}
+
+	ndInt32 pointIndex = 0;
+	ndInt32 contactIndex = 0;
+	ndSnapshotContact* const contacts = (ndSnapshotContact*)&data[layout.m_contacts];
+	ndSnapshotContactPoint* const points = (ndSnapshotContactPoint*)&data[layout.m_points];
+	for (ndInt32 i = 0; i < contactArray.GetCount(); ++i)
+	{
+		const ndContact* const contact = contactArray[i];
+		const ndContactPointList& contactPoints = contact->GetContactPoints();
+		if (contact->IsActive() && contactPoints.GetCount())
+		{
+			ndSnapshotContact& record = contacts[contactIndex];
+			record.m_body0 = bodyMap.Find(contact->GetBody0())->GetInfo();
+			record.m_body1 = bodyMap.Find(contact->GetBody1())->GetInfo();
+			record.m_start = pointIndex;
+			record.m_count = contactPoints.GetCount();
+			for (ndInt32 j = 0; j < contactPoints.GetCount(); ++j)
+			{
+				const ndContactMaterial& contactPoint = contactPoints[j];
+				ndSnapshotContactPoint& pointRecord = points[pointIndex];
+				ndSnapshotSetVector(pointRecord.m_point, contactPoint.m_point);
+				pointRecord.m_normal_Force = contactPoint.m_normal_Force;
+				pointRecord.m_dir0_Force = contactPoint.m_dir0_Force;
+				pointRecord.m_dir1_Force = contactPoint.m_dir1_Force;
+				pointIndex++;
+			}
+			contactIndex++;
+		}
+	}
+	ndAssert(contactIndex == contactCount);
+	ndAssert(pointIndex == contactPointCount);
+}
+
+bool ndWorldSnapshot::Restore(ndWorld* const world) const
+{
+	return m_buffer.GetCount() ? Restore(world, &m_buffer[0], size_t(m_buffer.GetCount())) : false;
+}
+
+bool ndWorldSnapshot::Restore(ndWorld* const world, const void* const data, size_t size)
+{
+	D_TRACKTIME();
+	const ndSnapshotHeader* const header = ndSnapshotValidate(data, size);
+	if (!header)
+	{
+		return false;
+	}
+
+	world->Sync();
+	const ndBodyList& bodyList = world->GetBodyList();
+	const ndJointList& jointList = world->GetJointList();
+	if ((header->m_bodyCount != bodyList.GetCount()) || (header->m_jointCount != jointList.GetCount()))
+	{
+		return false;
+	}
+
+	const ndSnapshotLayout layout(*header);
+	const ndUnsigned8* const buffer = (ndUnsigned8*)data;
+	const ndSnapshotShape* const shapes = (ndSnapshotShape*)&buffer[layout.m_shapes];
+	const ndSnapshotBody* const bodies = (ndSnapshotBody*)&buffer[layout.m_bodies];
+	const ndSnapshotJoint* const joints = (ndSnapshotJoint*)&buffer[layout.m_joints];
+	const ndSnapshotContact* const contacts = (ndSnapshotContact*)&buffer[layout.m_contacts];
+	const ndSnapshotContactPoint* const points = (ndSnapshotContactPoint*)&buffer[layout.m_points];
+
+	ndTree<ndBodyKinematic*, ndUnsigned32> bodyMap;
+	for (ndBodyList::ndNode* node = bodyList.GetFirst(); node; node = node->GetNext())
+	{
+		ndBodyKinematic* const body = *node->GetInfo();
+		bodyMap.Insert(body, body->GetId());
+	}
+
+	// validate everything before changing the world, so that a 
+	// snapshot that does not match leaves the world untouched.
+	ndArray<ndBodyKinematic*> bodyArray;
+	bodyArray.SetCount(header->m_bodyCount);
+	ndTree<ndInt32, const ndShape*> shapeMap;
+	for (ndInt32 i = 0; i < header->m_bodyCount; ++i)
+	{
+		const ndSnapshotBody& record = bodies[i];
+		ndTree<ndBodyKinematic*, ndUnsigned32>::ndNode* const bodyNode = bodyMap.Find(record.m_id);
+		if (!bodyNode || (record.m_shapeIndex < 0) || (record.m_shapeIndex >= header->m_shapeCount))
+		{
+			return false;
+		}
+		ndBodyKinematic* const body = bodyNode->GetInfo();
+		const ndShape* const shape = body->GetCollisionShape().GetShape();
+		ndTree<ndInt32, const ndShape*>::ndNode* shapeNode = shapeMap.Find(shape);
+		if (!shapeNode)
+		{
+			const ndSnapshotShape& shapeRecord = shapes[record.m_shapeIndex];
+			const ndVector obbSize(ndSnapshotGetVector(shapeRecord.m_obbSize));
+			const ndVector obbOrigin(ndSnapshotGetVector(shapeRecord.m_obbOrigin));
+			const ndVector diff((obbSize - shape->GetObbSize()).Abs() + (obbOrigin - shape->GetObbOrigin()).Abs());
+			if ((shapeRecord.m_collisionType != shape->GetShapeInfo().m_collisionType) || (diff.AddHorizontal().GetScalar() > ndFloat32(1.0e-4f)))
+			{
+				return false;
+			}
+			shapeNode = shapeMap.Insert(record.m_shapeIndex, shape);
+		}
+		if (shapeNode->GetInfo() != record.m_shapeIndex)
+		{
+			return false;
+		}
+		bodyArray[i] = body;
+	}
+
+	ndInt32 index = 0;
+	for (ndJointList::ndNode* node = jointList.GetFirst(); node; node = node->GetNext())
+	{
+		const ndJointBilateralConstraint* const joint = *node->GetInfo();
+		if ((joints[index].m_body0 != joint->GetBody0()->GetId()) || (joints[index].m_body1 != joint->GetBody1()->GetId()))
+		{
+			return false;
+		}
+		index++;
+	}
+
+	for (ndInt32 i = 0; i < header->m_bodyCount; ++i)
+	{
+		const ndSnapshotBody& record = bodies[i];
+		ndBodyKinematic* const body = bodyArray[i];
+
+		ndMatrix matrix;
+		for (ndInt32 j = 0; j < 4; ++j)
+		{
+			matrix[j] = ndSnapshotGetVector(record.m_matrix[j]);
+		}
+		body->SetMatrix(matrix);
+		body->SetVelocityNoSleep(ndSnapshotGetVector(record.m_veloc));
+		body->SetOmegaNoSleep(ndSnapshotGetVector(record.m_omega));
+		body->SetAccel(ndSnapshotGetVector(record.m_accel));
+		body->SetAlpha(ndSnapshotGetVector(record.m_alpha));
+		body->SetForce(ndSnapshotGetVector(record.m_force));
+		body->SetTorque(ndSnapshotGetVector(record.m_torque));
+		body->SetAutoSleep(record.m_autoSleep ? true : false);
+		body->RestoreSleepState(record.m_equilibrium ? true : false);
+	}
+
+	index = 0;
+	for (ndJointList::ndNode* node = jointList.GetFirst(); node; node = node->GetNext())
+	{
+		ndJointBilateralConstraint* const joint = *node->GetInfo();
+		const ndSnapshotJoint& record = joints[index];
+		joint->m_forceBody0 = ndSnapshotGetVector(record.m_forceBody0);
+		joint->m_torqueBody0 = ndSnapshotGetVector(record.m_torqueBody0);
+		joint->m_forceBody1 = ndSnapshotGetVector(record.m_forceBody1);
+		joint->m_torqueBody1 = ndSnapshotGetVector(record.m_torqueBody1);
+		for (ndInt32 i = 0; i < ND_BILATERAL_CONTRAINT_DOF; ++i)
+		{
+			joint->m_jointForce[i] = record.m_jointForce[i];
+			joint->m_motorAcceleration[i] = record.m_motorAcceleration[i];
+		}
+		index++;
+	}
+
+	// contacts are owned by the scene and can not be recreated here, the 
+	// bodies were teleported, so force all contacts to run the narrow phase 
+	// again, and restore the force cache to the contacts that still exist, 
+	// matching each point with the closest saved one.
+	const ndContactArray& contactArray = world->GetContactList();
+	for (ndInt32 i = 0; i < contactArray.GetCount(); ++i)
+	{
+		ndContact* const contact = contactArray[i];
+		ndContactPointList& contactPoints = contact->GetContactPoints();
+		contact->m_positAcc = ndVector(ndFloat32(10.0f));
+		for (ndInt32 j = 0; j < contactPoints.GetCount(); ++j)
+		{
+			ndContactMaterial& contactPoint = contactPoints[j];
+			contactPoint.m_normal_Force.Clear();
+			contactPoint.m_dir0_Force.Clear();
+			contactPoint.m_dir1_Force.Clear();
+		}
+	}
+
+	for (ndInt32 i = 0; i < header->m_contactCount; ++i)
+	{
+		const ndSnapshotContact& record = contacts[i];
+		if ((record.m_body0 < 0) || (record.m_body0 >= header->m_bodyCount) || (record.m_body1 < 0) || (record.m_body1 >= header->m_bodyCount))
+		{
+			continue;
+		}
+		if ((record.m_start < 0) || (record.m_count < 0) || (record.m_count > (header->m_contactPointCount - record.m_start)))
+		{
+			continue;
+		}
+		ndBodyKinematic* const body0 = bodyArray[record.m_body0];
+		ndBodyKinematic* const body1 = bodyArray[record.m_body1];
+		ndContact* const contact = body0->FindContact(body1);
+		if (contact)
+		{
+			ndContactPointList& contactPoints = contact->GetContactPoints();
+			for (ndInt32 j = 0; j < contactPoints.GetCount(); ++j)
+			{
+				ndContactMaterial& contactPoint = contactPoints[j];
+				ndInt32 closest = -1;
+				ndFloat32 minDist2 = ndFloat32(1.0e20f);
+				for (ndInt32 k = 0; k < record.m_count; ++k)
+				{
+					const ndVector dist(ndVector::m_triplexMask & (ndSnapshotGetVector(points[record.m_start + k].m_point) - contactPoint.m_point));
+					const ndFloat32 dist2 = dist.DotProduct(dist).GetScalar();
+					if (dist2 < minDist2)
+					{
+						closest = k;
+						minDist2 = dist2;
+					}
+				}
+				if (closest >= 0)
+				{
+					const ndSnapshotContactPoint& pointRecord = points[record.m_start + closest];
+					contactPoint.m_normal_Force = pointRecord.m_normal_Force;
+					contactPoint.m_dir0_Force = pointRecord.m_dir0_Force;
+					contactPoint.m_dir1_Force = pointRecord.m_dir1_Force;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool ndWorldSnapshot::Save(const char* const path) const
+{
+	if (!m_buffer.GetCount())
+	{
+		return false;
+	}
+	FILE* const file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	const size_t size = size_t(m_buffer.GetCount());
+	const bool ret = fwrite(&m_buffer[0], 1, size, file) == size;
+	fclose(file);
+	return ret;
+}
+
+bool ndWorldSnapshot::Load(const char* const path)
+{
+	ndFileMapping file(path);
+	if (!ndSnapshotValidate(file.GetData(), file.GetSize()))
+	{
+		return false;
+	}
+	m_buffer.SetCount(ndInt32(file.GetSize()));
+	memcpy(&m_buffer[0], file.GetData(), file.GetSize());
+	return true;
+}
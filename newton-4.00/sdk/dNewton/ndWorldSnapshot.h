@@ -0,0 +1,74 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_WORLD_SNAPSHOT_H__
+#define __ND_WORLD_SNAPSHOT_H__
+
+#include "ndNewtonStdafx.h"
+
+class ndWorld;
+
+#define D_WORLD_SNAPSHOT_VERSION	1
+
+/// Binary snapshot of the simulation state of a world.
+/// \brief a snapshot records the state of the bodies, the joints force 
+/// caches and the contact force caches of a world, in a flat versioned 
+/// binary buffer. It does not create objects, the world it is restored 
+/// into must have the same bodies and joints that the world it was 
+/// captured from, for example for networked rollback, or for reloading 
+/// a checkpoint of a scene previously loaded with ndLoadSave::LoadScene.
+/// shapes are deduplicated in a table that is used to validate that the 
+/// bodies of the world still match the snapshot.
+D_MSV_NEWTON_ALIGN_32
+class ndWorldSnapshot: public ndClassAlloc
+{
+	public:
+	D_NEWTON_API ndWorldSnapshot();
+	D_NEWTON_API ~ndWorldSnapshot();
+
+	/// Record the state of the world into the in memory buffer.
+	D_NEWTON_API void Capture(const ndWorld* const world);
+
+	/// Restore the state of the in memory buffer into the world.
+	/// \return false if the snapshot does not match the world content.
+	D_NEWTON_API bool Restore(ndWorld* const world) const;
+
+	/// Write the in memory buffer to a binary file.
+	D_NEWTON_API bool Save(const char* const path) const;
+
+	/// Read a binary file into the in memory buffer.
+	D_NEWTON_API bool Load(const char* const path);
+
+	/// Restore a snapshot directly from a memory block, for example a memory mapped file.
+	D_NEWTON_API static bool Restore(ndWorld* const world, const void* const data, size_t size);
+
+	const ndArray<ndUnsigned8>& GetBuffer() const;
+
+	private:
+	ndArray<ndUnsigned8> m_buffer;
+} D_GCC_NEWTON_ALIGN_32;
+
+inline const ndArray<ndUnsigned8>& ndWorldSnapshot::GetBuffer() const
+{
+	return m_buffer;
+}
+
+#endif
@@ -11,6 +11,8 @@
 */
 
 #include <cstdio>
+#include <thread>
+#include <vector>
 #include "ndNewton.h"
 #include <gtest/gtest.h>
 
@@ -196,3 +198,169 @@ TEST(RayCast, rayCastFilter)
 	// the second body hitpoint z coordinate should be Z_OFFSET + HALF_BOX_DIM;
 	EXPECT_TRUE(info.position.m_z == Z_OFFSET + HALF_BOX_DIM); 
 }
+
+// a grid of boxes, so that rays traverse a real scene tree
+static void addBoxGrid(ndWorld& world)
+{
+	ndShapeInstance box(new ndShapeBox(BOX_DIM, BOX_DIM, BOX_DIM));
+	for (ndInt32 i = 0; i < 8; ++i)
+	{
+		for (ndInt32 j = 0; j < 8; ++j)
+		{
+			ndSharedPtr<ndBodyKinematic> body(new ndBodyDynamic());
+			ndMatrix matrix(ndGetIdentityMatrix());
+			matrix.m_posit.m_x = ndFloat32(i) * 2.0f;
+			matrix.m_posit.m_z = ndFloat32(j) * 2.0f;
+			body->SetMatrix(matrix);
+			body->SetCollisionShape(box);
+			world.AddBody(body);
+		}
+	}
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+}
+
+// 103 rays, so that the last packet is partially filled
+static std::vector<ndRayCastQuery> makeRays()
+{
+	std::vector<ndRayCastQuery> rays(103);
+	for (size_t i = 0; i < rays.size(); ++i)
+	{
+		const ndFloat32 x = ndFloat32(i % 17) - 1.0f;
+		const ndFloat32 z = ndFloat32(i % 13) * 1.3f - 1.0f;
+		rays[i].m_origin = ndVector(x, 5.0f, z, 1.0f);
+		rays[i].m_dest = ndVector(x + 3.0f, -5.0f, z + 1.0f, 1.0f);
+	}
+	// a horizontal ray, parallel to two of the axis
+	rays[0].m_origin = ndVector(-5.0f, 0.0f, 0.0f, 1.0f);
+	rays[0].m_dest = ndVector(25.0f, 0.0f, 0.0f, 1.0f);
+	return rays;
+}
+
+// the batched hits must be the same as the hits of single ray casts, returns the hit count
+static ndInt32 checkBatchedHits(ndWorld& world, const std::vector<ndRayCastQuery>& rays, const std::vector<ndRayCastHit>& hits)
+{
+	ndInt32 hitCount = 0;
+	for (size_t i = 0; i < rays.size(); ++i)
+	{
+		ndRayCastClosestHitCallback callback;
+		const bool hit = world.RayCast(callback, rays[i].m_origin, rays[i].m_dest);
+		EXPECT_EQ(hit, hits[i].m_param < 1.0f);
+		if (hit)
+		{
+			hitCount++;
+			EXPECT_NEAR(callback.m_param, hits[i].m_param, 1.0e-5f);
+			EXPECT_EQ(callback.m_contact.m_body0, hits[i].m_contact.m_body0);
+		}
+	}
+	return hitCount;
+}
+
+// 37 spheres falling on the grid
+static std::vector<ndConvexCastQuery> makeConvexCasts(const ndShapeInstance& sphere)
+{
+	std::vector<ndConvexCastQuery> casts(37);
+	for (size_t i = 0; i < casts.size(); ++i)
+	{
+		ndMatrix origin(ndGetIdentityMatrix());
+		origin.m_posit = ndVector(ndFloat32(i % 9) * 1.7f, 5.0f, ndFloat32(i % 7) * 2.1f, 1.0f);
+		casts[i].m_origin = origin;
+		casts[i].m_dest = origin.m_posit - ndVector(0.0f, 10.0f, 0.0f, 0.0f);
+		casts[i].m_shape = &sphere;
+	}
+	return casts;
+}
+
+TEST(RayCast, batchedRayCast)
+{
+	ndWorld world;
+	world.SetSubSteps(2);
+	addBoxGrid(world);
+
+	const std::vector<ndRayCastQuery> rays(makeRays());
+	std::vector<ndRayCastHit> hits(rays.size());
+	world.RayCast(&rays[0], &hits[0], ndInt32(rays.size()));
+	EXPECT_GT(checkBatchedHits(world, rays, hits), 0);
+	EXPECT_LT(hits[0].m_param, 1.0f);
+}
+
+TEST(RayCast, batchedQueriesMultiThread)
+{
+	// with more than one thread the batched queries run on the worker threads
+	ndWorld world;
+	world.SetSubSteps(2);
+	world.SetThreadCount(4);
+	addBoxGrid(world);
+
+	const std::vector<ndRayCastQuery> rays(makeRays());
+	std::vector<ndRayCastHit> hits(rays.size());
+	world.RayCast(&rays[0], &hits[0], ndInt32(rays.size()));
+	EXPECT_GT(checkBatchedHits(world, rays, hits), 0);
+
+	ndShapeInstance sphere(new ndShapeSphere(0.25f));
+	const std::vector<ndConvexCastQuery> casts(makeConvexCasts(sphere));
+	std::vector<ndRayCastHit> castHits(casts.size());
+	world.ConvexCast(&casts[0], &castHits[0], ndInt32(casts.size()));
+	ndInt32 hitCount = 0;
+	for (size_t i = 0; i < casts.size(); ++i)
+	{
+		if (castHits[i].m_param < 1.0f)
+		{
+			hitCount++;
+			EXPECT_GT(castHits[i].m_param, 0.0f);
+		}
+	}
+	EXPECT_GT(hitCount, 0);
+
+	// the world must still update after the queries
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+}
+
+TEST(RayCast, batchedQueriesTwoThreads)
+{
+	// two application threads share the worker threads of the same world
+	ndWorld world;
+	world.SetSubSteps(2);
+	world.SetThreadCount(4);
+	addBoxGrid(world);
+
+	ndShapeInstance sphere(new ndShapeSphere(0.25f));
+	const std::vector<ndRayCastQuery> rays(makeRays());
+	const std::vector<ndConvexCastQuery> casts(makeConvexCasts(sphere));
+	std::vector<ndRayCastHit> rayHits(rays.size());
+	std::vector<ndRayCastHit> castHits(casts.size());
+	world.RayCast(&rays[0], &rayHits[0], ndInt32(rays.size()));
+	world.ConvexCast(&casts[0], &castHits[0], ndInt32(casts.size()));
+
+	bool sameHits[2] = { true, true };
+	auto Query = [&world, &rays, &casts, &rayHits, &castHits, &sameHits](ndInt32 index)
+	{
+		std::vector<ndRayCastHit> threadRayHits(rays.size());
+		std::vector<ndRayCastHit> threadCastHits(casts.size());
+		for (ndInt32 i = 0; i < 200; ++i)
+		{
+			world.RayCast(&rays[0], &threadRayHits[0], ndInt32(rays.size()));
+			world.ConvexCast(&casts[0], &threadCastHits[0], ndInt32(casts.size()));
+			for (size_t j = 0; j < rays.size(); ++j)
+			{
+				sameHits[index] = sameHits[index] && (threadRayHits[j].m_param == rayHits[j].m_param);
+			}
+			for (size_t j = 0; j < casts.size(); ++j)
+			{
+				sameHits[index] = sameHits[index] && (threadCastHits[j].m_param == castHits[j].m_param);
+			}
+		}
+	};
+
+	std::thread thread0(Query, 0);
+	std::thread thread1(Query, 1);
+	thread0.join();
+	thread1.join();
+	EXPECT_TRUE(sameHits[0]);
+	EXPECT_TRUE(sameHits[1]);
+
+	// the world must still update after the queries
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+}
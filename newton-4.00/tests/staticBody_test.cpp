@@ -11,6 +11,8 @@
 */
 
 #include <cstdio>
+#include <cstring>
+#include <vector>
 #include "ndNewton.h"
 #include <gtest/gtest.h>
 
@@ -1474,4 +1476,315 @@ TEST(StaticBody, mesh)
 	EXPECT_NEAR(staticBunny->GetMatrix().m_posit.m_x, startPosition.m_x, 1E-6);
 	EXPECT_NEAR(staticBunny->GetMatrix().m_posit.m_y, startPosition.m_y, 1E-6);
 	EXPECT_NEAR(staticBunny->GetMatrix().m_posit.m_z, startPosition.m_z, 1E-6);
-}
\ No newline at end of file
+}
+static ndVector DropBallOnBunny(bool wideLayout, ndInt32 frames)
+{
+	ndWorld world;
+	ndSharedPtr<ndBodyKinematic> staticBunny(BuildStaticBunny(ndVector(0.0f, 0.0f, 0.0f, 1.0f)));
+	world.AddBody(staticBunny);
+
+	ndShapeStatic_bvh* const mesh = staticBunny->GetCollisionShape().GetShape()->GetAsShapeStaticBVH();
+	mesh->SetWideNodeLayout(wideLayout);
+
+	ndVector p0;
+	ndVector p1;
+	mesh->GetAABB(p0, p1);
+
+	ndShapeInstance sphere(new ndShapeSphere(0.05f));
+	ndSharedPtr<ndBodyKinematic> ball(new ndBodyDynamic());
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit = ndVector(0.5f * (p0.m_x + p1.m_x), p1.m_y + 0.5f, 0.5f * (p0.m_z + p1.m_z), 1.0f);
+	ball->SetMatrix(matrix);
+	ball->SetCollisionShape(sphere);
+	ball->SetMassMatrix(1.0f, sphere);
+	ball->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+	world.AddBody(ball);
+
+	for (ndInt32 i = 0; i < frames; ++i)
+	{
+		world.Update(TIME_STEP);
+		world.Sync();
+	}
+	return ball->GetMatrix().m_posit;
+}
+
+TEST(StaticBody, wideMeshLayout)
+{
+	ndWorld world;
+	ndSharedPtr<ndBodyKinematic> staticBunny(BuildStaticBunny(ndVector(0.0f, 0.0f, 0.0f, 1.0f)));
+	world.AddBody(staticBunny);
+	world.Update(TIME_STEP);
+	world.Sync();
+
+	ndShapeStatic_bvh* const mesh = staticBunny->GetCollisionShape().GetShape()->GetAsShapeStaticBVH();
+	ASSERT_TRUE(mesh != nullptr);
+	EXPECT_FALSE(mesh->GetWideNodeLayout());
+
+	ndVector p0;
+	ndVector p1;
+	mesh->GetAABB(p0, p1);
+	const ndVector size(p1 - p0);
+
+	// a grid of slanted rays over the mesh, and one parallel to the z axis
+	std::vector<ndRayCastQuery> rays;
+	for (ndInt32 i = 0; i < 16; ++i)
+	{
+		for (ndInt32 j = 0; j < 16; ++j)
+		{
+			const ndFloat32 x = p0.m_x + size.m_x * (ndFloat32(i) + 0.5f) / 16.0f;
+			const ndFloat32 z = p0.m_z + size.m_z * (ndFloat32(j) + 0.5f) / 16.0f;
+			ndRayCastQuery ray;
+			ray.m_origin = ndVector(x, p1.m_y + 1.0f, z, 1.0f);
+			ray.m_dest = ndVector(x + 0.1f, p0.m_y - 1.0f, z, 1.0f);
+			rays.push_back(ray);
+		}
+	}
+	rays[0].m_origin = ndVector(0.5f * (p0.m_x + p1.m_x), 0.5f * (p0.m_y + p1.m_y), p0.m_z - 1.0f, 1.0f);
+	rays[0].m_dest = ndVector(0.5f * (p0.m_x + p1.m_x), 0.5f * (p0.m_y + p1.m_y), p1.m_z + 1.0f, 1.0f);
+
+	std::vector<ndRayCastHit> hits(rays.size());
+	world.RayCast(&rays[0], &hits[0], ndInt32(rays.size()));
+
+	mesh->SetWideNodeLayout(true);
+	EXPECT_TRUE(mesh->GetWideNodeLayout());
+
+	std::vector<ndRayCastHit> wideHits(rays.size());
+	world.RayCast(&rays[0], &wideHits[0], ndInt32(rays.size()));
+
+	// the wide hierarchy must find the same faces than the binary one
+	ndInt32 hitCount = 0;
+	for (size_t i = 0; i < rays.size(); ++i)
+	{
+		hitCount += (hits[i].m_param < 1.0f) ? 1 : 0;
+		EXPECT_NEAR(hits[i].m_param, wideHits[i].m_param, 1.0e-5f);
+	}
+	EXPECT_GT(hitCount, 0);
+	EXPECT_LT(wideHits[0].m_param, 1.0f);
+
+	mesh->SetWideNodeLayout(false);
+	EXPECT_FALSE(mesh->GetWideNodeLayout());
+
+	// a ball dropped on the mesh must land the same way with both layouts
+	const ndVector binaryPosit(DropBallOnBunny(false, 30));
+	const ndVector widePosit(DropBallOnBunny(true, 30));
+	EXPECT_GT(binaryPosit.m_y, p0.m_y);
+	EXPECT_NEAR(binaryPosit.m_x, widePosit.m_x, 1.0e-3f);
+	EXPECT_NEAR(binaryPosit.m_y, widePosit.m_y, 1.0e-3f);
+	EXPECT_NEAR(binaryPosit.m_z, widePosit.m_z, 1.0e-3f);
+}
+
+TEST(StaticBody, mappedMeshCache)
+{
+	ndWorld world;
+	ndSharedPtr<ndBodyKinematic> staticBunny(BuildStaticBunny(ndVector(0.0f, 0.0f, 0.0f, 1.0f)));
+	ndShapeStatic_bvh* const mesh = staticBunny->GetCollisionShape().GetShape()->GetAsShapeStaticBVH();
+	ASSERT_TRUE(mesh != nullptr);
+	EXPECT_FALSE(mesh->IsMapped());
+	const ndInt32 triangleCount = mesh->ndAabbPolygonSoup::GetTriangleCount();
+	EXPECT_GT(triangleCount, 0);
+	EXPECT_EQ(staticBunny->GetCollisionShape().GetShapeInfo().m_bvh.m_indexCount, triangleCount * 3);
+
+	const ndUnsigned64 hash = mesh->SerializeCache("bunny_cache_test.bin");
+	EXPECT_NE(hash, ndUnsigned64(0));
+	EXPECT_EQ(hash, mesh->CalculateContentHash());
+
+	// a cache with a different hash is rejected
+	ndShapeStatic_bvh* const rejected = new ndShapeStatic_bvh("bunny_cache_test.bin", hash + 1);
+	EXPECT_FALSE(rejected->IsMapped());
+	delete rejected;
+
+	ndShapeInstance mappedShape(new ndShapeStatic_bvh("bunny_cache_test.bin", hash));
+	ndShapeStatic_bvh* const mappedMesh = mappedShape.GetShape()->GetAsShapeStaticBVH();
+	EXPECT_TRUE(mappedMesh->IsMapped());
+	EXPECT_EQ(mappedMesh->CalculateContentHash(), hash);
+	EXPECT_EQ(mappedMesh->ndAabbPolygonSoup::GetTriangleCount(), triangleCount);
+
+	ndVector p0;
+	ndVector p1;
+	ndVector q0;
+	ndVector q1;
+	mesh->GetAABB(p0, p1);
+	mappedMesh->GetAABB(q0, q1);
+	EXPECT_NEAR(p0.m_y, q0.m_y, 1.0e-6f);
+	EXPECT_NEAR(p1.m_y, q1.m_y, 1.0e-6f);
+
+	// the mapped mesh is placed next to the original, and both are hit the same way
+	const ndFloat32 offset = 10.0f;
+	ndSharedPtr<ndBodyKinematic> mappedBunny(new ndBodyDynamic());
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_x = offset;
+	mappedBunny->SetMatrix(matrix);
+	mappedBunny->SetCollisionShape(mappedShape);
+	mappedBunny->SetMassMatrix(STATIC_MASS, mappedShape);
+
+	world.AddBody(staticBunny);
+	world.AddBody(mappedBunny);
+	world.Update(TIME_STEP);
+	world.Sync();
+
+	ndInt32 hitCount = 0;
+	const ndVector size(p1 - p0);
+	for (ndInt32 i = 0; i < 8; ++i)
+	{
+		for (ndInt32 j = 0; j < 8; ++j)
+		{
+			const ndFloat32 x = p0.m_x + size.m_x * (ndFloat32(i) + 0.5f) / 8.0f;
+			const ndFloat32 z = p0.m_z + size.m_z * (ndFloat32(j) + 0.5f) / 8.0f;
+			ndRayCastClosestHitCallback original;
+			ndRayCastClosestHitCallback mapped;
+			const bool hit0 = world.RayCast(original, ndVector(x, p1.m_y + 1.0f, z, 1.0f), ndVector(x, p0.m_y - 1.0f, z, 1.0f));
+			const bool hit1 = world.RayCast(mapped, ndVector(x + offset, p1.m_y + 1.0f, z, 1.0f), ndVector(x + offset, p0.m_y - 1.0f, z, 1.0f));
+			EXPECT_EQ(hit0, hit1);
+			if (hit0 && hit1)
+			{
+				hitCount++;
+				EXPECT_NEAR(original.m_param, mapped.m_param, 1.0e-5f);
+			}
+		}
+	}
+	EXPECT_GT(hitCount, 0);
+
+	world.CleanUp();
+	remove("bunny_cache_test.bin");
+}
+
+TEST(StaticBody, verifiedMeshCache)
+{
+	ndSharedPtr<ndBodyKinematic> staticBunny(BuildStaticBunny(ndVector(0.0f, 0.0f, 0.0f, 1.0f)));
+	ndShapeStatic_bvh* const mesh = staticBunny->GetCollisionShape().GetShape()->GetAsShapeStaticBVH();
+	ASSERT_TRUE(mesh != nullptr);
+	const ndUnsigned64 hash = mesh->SerializeCache("bunny_cache_verify.bin");
+	ASSERT_NE(hash, ndUnsigned64(0));
+
+	// a valid file passes the verification
+	ndShapeStatic_bvh* const verified = new ndShapeStatic_bvh("bunny_cache_verify.bin", hash, true);
+	EXPECT_TRUE(verified->IsMapped());
+	delete verified;
+
+	std::vector<char> data;
+	FILE* const file = fopen("bunny_cache_verify.bin", "rb");
+	ASSERT_TRUE(file != nullptr);
+	for (int c = fgetc(file); c != EOF; c = fgetc(file))
+	{
+		data.push_back(char(c));
+	}
+	fclose(file);
+
+	auto WriteCorrupt = [](const std::vector<char>& bytes)
+	{
+		FILE* const corruptFile = fopen("bunny_cache_corrupt.bin", "wb");
+		fwrite(&bytes[0], bytes.size(), 1, corruptFile);
+		fclose(corruptFile);
+	};
+
+	// a changed byte keeps a valid header, only the verification finds it
+	std::vector<char> changed(data);
+	changed[changed.size() / 2] ^= 0x01;
+	WriteCorrupt(changed);
+	ndShapeStatic_bvh* const unchecked = new ndShapeStatic_bvh("bunny_cache_corrupt.bin", hash);
+	EXPECT_TRUE(unchecked->IsMapped());
+	delete unchecked;
+	ndShapeStatic_bvh* const rejected = new ndShapeStatic_bvh("bunny_cache_corrupt.bin", hash, true);
+	EXPECT_FALSE(rejected->IsMapped());
+	delete rejected;
+
+	// the children of the last node point out of the arrays
+	std::vector<char> badLinks(data);
+	memset(&badLinks[badLinks.size() - 8], 0xff, 8);
+	WriteCorrupt(badLinks);
+	ndShapeStatic_bvh* const badLinksMesh = new ndShapeStatic_bvh("bunny_cache_corrupt.bin", 0, true);
+	EXPECT_FALSE(badLinksMesh->IsMapped());
+	delete badLinksMesh;
+
+	remove("bunny_cache_verify.bin");
+	remove("bunny_cache_corrupt.bin");
+}
+
+static void BuildTerrain(ndPolygonSoupBuilder& builder, ndFloat32 bump)
+{
+	// a 64 x 64 height field, with more faces than one optimizer sector
+	const ndInt32 size = 64;
+	builder.Begin();
+	for (ndInt32 i = 0; i < size; ++i)
+	{
+		for (ndInt32 j = 0; j < size; ++j)
+		{
+			ndVector quad[4];
+			for (ndInt32 k = 0; k < 4; ++k)
+			{
+				const ndInt32 x = i + ((k == 1) || (k == 2) ? 1 : 0);
+				const ndInt32 z = j + ((k == 2) || (k == 3) ? 1 : 0);
+				ndFloat32 y = ndFloat32(ndSin(ndFloat32(x) * 0.3f) * ndCos(ndFloat32(z) * 0.2f));
+				if ((x < 4) && (z < 4))
+				{
+					y += bump;
+				}
+				quad[k] = ndVector(ndFloat32(x), y, ndFloat32(z), ndFloat32(0.0f));
+			}
+			builder.AddFace(&quad[0].m_x, sizeof(ndVector), 3, 0);
+			quad[1] = quad[3];
+			builder.AddFace(&quad[0].m_x, sizeof(ndVector), 3, 0);
+		}
+	}
+}
+
+static void ExpectSameSoup(const ndPolygonSoupBuilder& a, const ndPolygonSoupBuilder& b)
+{
+	ASSERT_EQ(a.m_faceVertexCount.GetCount(), b.m_faceVertexCount.GetCount());
+	ASSERT_EQ(a.m_vertexIndex.GetCount(), b.m_vertexIndex.GetCount());
+	ASSERT_EQ(a.m_vertexPoints.GetCount(), b.m_vertexPoints.GetCount());
+	ASSERT_EQ(a.m_normalPoints.GetCount(), b.m_normalPoints.GetCount());
+	for (ndInt32 i = 0; i < a.m_faceVertexCount.GetCount(); ++i)
+	{
+		EXPECT_EQ(a.m_faceVertexCount[i], b.m_faceVertexCount[i]);
+	}
+	for (ndInt32 i = 0; i < a.m_vertexIndex.GetCount(); ++i)
+	{
+		EXPECT_EQ(a.m_vertexIndex[i], b.m_vertexIndex[i]);
+	}
+	for (ndInt32 i = 0; i < a.m_vertexPoints.GetCount(); ++i)
+	{
+		EXPECT_EQ(a.m_vertexPoints[i].m_x, b.m_vertexPoints[i].m_x);
+		EXPECT_EQ(a.m_vertexPoints[i].m_y, b.m_vertexPoints[i].m_y);
+		EXPECT_EQ(a.m_vertexPoints[i].m_z, b.m_vertexPoints[i].m_z);
+	}
+}
+
+TEST(StaticBody, parallelIncrementalBuild)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	world.Update(TIME_STEP);
+	world.Sync();
+
+	ndPolygonSoupBuilder serial;
+	BuildTerrain(serial, 0.0f);
+	serial.End(true);
+	EXPECT_GT(serial.m_faceVertexCount.GetCount(), 0);
+
+	// the parallel build must produce the same soup than the serial one
+	ndPolygonSoupBuilder parallel;
+	BuildTerrain(parallel, 0.0f);
+	parallel.End(true, world.GetScene());
+	ExpectSameSoup(serial, parallel);
+
+	// after a local edit, the incremental build must produce 
+	// the same soup than a full build of the edited mesh
+	ndPolygonSoupBuilder incremental;
+	incremental.SetIncremental(true);
+	EXPECT_TRUE(incremental.GetIncremental());
+	BuildTerrain(incremental, 0.0f);
+	incremental.End(true, world.GetScene());
+	ExpectSameSoup(serial, incremental);
+
+	BuildTerrain(incremental, 0.5f);
+	incremental.End(true, world.GetScene());
+
+	ndPolygonSoupBuilder edited;
+	BuildTerrain(edited, 0.5f);
+	edited.End(true);
+	ExpectSameSoup(edited, incremental);
+
+	ndShapeInstance shape(new ndShapeStatic_bvh(incremental));
+	EXPECT_GT(shape.GetShape()->GetAsShapeStaticBVH()->ndAabbPolygonSoup::GetTriangleCount(), 0);
+}
@@ -11,6 +11,10 @@
 
 #include "ndNewton.h"
 #include <gtest/gtest.h>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
 
 /* Baseline test: create and destroy an empty Newton world. */
 TEST(HelloNewton, CreateWorld) {
@@ -19,3 +23,1333 @@ TEST(HelloNewton, CreateWorld) {
   world.Update(1.0f / 60.0f);
   world.Sync();
 }
+
+/* Add a static floor with its top at y = 0, and count bodies of unit mass falling with gravity.
+   place(i, matrix) sets the matrix of body i and returns its shape. */
+template <typename PlaceFunction>
+static std::vector<ndBodyKinematic*> AddFloorAndBodies(ndWorld& world, ndFloat32 floorSize, int count, PlaceFunction place) {
+  ndShapeInstance floorShape(new ndShapeBox(floorSize, 1.0f, floorSize));
+  ndSharedPtr<ndBodyKinematic> floor(new ndBodyDynamic());
+  floor->SetCollisionShape(floorShape);
+  ndMatrix floorMatrix(ndGetIdentityMatrix());
+  floorMatrix.m_posit.m_y = -0.5f;
+  floor->SetMatrix(floorMatrix);
+  world.AddBody(floor);
+
+  std::vector<ndBodyKinematic*> bodies;
+  for (int i = 0; i < count; i++) {
+    ndMatrix matrix(ndGetIdentityMatrix());
+    const ndShapeInstance& shape = place(i, matrix);
+    ndSharedPtr<ndBodyKinematic> body(new ndBodyDynamic());
+    body->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+    body->SetMatrix(matrix);
+    body->SetCollisionShape(shape);
+    body->GetAsBodyDynamic()->SetMassMatrix(1.0f, shape);
+    world.AddBody(body);
+    bodies.push_back(*body);
+  }
+  return bodies;
+}
+
+/* Add a column of count spheres over the floor and return them. */
+static std::vector<ndBodyKinematic*> AddSphereColumn(ndWorld& world, int count) {
+  ndShapeInstance sphereShape(new ndShapeSphere(0.5f));
+  return AddFloorAndBodies(world, 20.0f, count, [&](int i, ndMatrix& matrix) -> const ndShapeInstance& {
+    matrix.m_posit.m_y = 1.0f + ndFloat32(i) * 1.1f;
+    return sphereShape;
+  });
+}
+
+/* Add sixteen separate piles of three boxes and return the boxes, pile by pile. */
+static std::vector<ndBodyKinematic*> AddBoxPiles(ndWorld& world) {
+  ndShapeInstance boxShape(new ndShapeBox(1.0f, 1.0f, 1.0f));
+  return AddFloorAndBodies(world, 40.0f, 16 * 3, [&](int i, ndMatrix& matrix) -> const ndShapeInstance& {
+    const int pile = i / 3;
+    matrix.m_posit.m_x = ndFloat32(pile % 4) * 3.0f - 6.0f;
+    matrix.m_posit.m_z = ndFloat32(pile / 4) * 3.0f - 6.0f;
+    matrix.m_posit.m_y = 0.5f + ndFloat32(i % 3) * 1.01f;
+    return boxShape;
+  });
+}
+
+/* Let the box piles settle with four threads, then rain spheres on them. 
+   Return the final positions of all the bodies and the body ids of the contacts in order. */
+static std::vector<ndVector> RainOnBoxPiles(bool pipelined, std::vector<ndUnsigned32>& contactOrder) {
+  ndWorld world;
+  world.SetThreadCount(4);
+  world.SetSubSteps(2);
+  world.SetPipelinedSubSteps(pipelined);
+  std::vector<ndBodyKinematic*> bodies(AddBoxPiles(world));
+  for (int i = 0; i < 60; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+
+  ndShapeInstance sphereShape(new ndShapeSphere(0.25f));
+  for (int i = 0; i < 120; i++) {
+    for (int j = 0; j < 8; j++) {
+      const int index = i * 8 + j;
+      ndMatrix matrix(ndGetIdentityMatrix());
+      matrix.m_posit.m_x = ndFloat32(index % 13) * 0.9f - 6.5f;
+      matrix.m_posit.m_y = 4.5f + ndFloat32(j & 1) * 0.6f;
+      matrix.m_posit.m_z = ndFloat32(index % 11) * 1.1f - 6.5f;
+      ndSharedPtr<ndBodyKinematic> sphere(new ndBodyDynamic());
+      sphere->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+      sphere->SetMatrix(matrix);
+      sphere->SetCollisionShape(sphereShape);
+      sphere->GetAsBodyDynamic()->SetMassMatrix(1.0f, sphereShape);
+      world.AddBody(sphere);
+      bodies.push_back(*sphere);
+    }
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+
+  const ndContactArray& contacts = world.GetContactList();
+  for (ndInt32 i = 0; i < contacts.GetCount(); ++i) {
+    contactOrder.push_back(contacts[i]->GetBody0()->GetId());
+    contactOrder.push_back(contacts[i]->GetBody1()->GetId());
+  }
+
+  std::vector<ndVector> positions;
+  for (ndBodyKinematic* const body : bodies) {
+    positions.push_back(body->GetMatrix().m_posit);
+  }
+  return positions;
+}
+
+/* Two simulations must give the same contacts in the same order and the same positions, bit for bit. */
+static void ExpectSameSimulation(bool pipelined0, bool pipelined1) {
+  std::vector<ndUnsigned32> contactOrder0;
+  std::vector<ndUnsigned32> contactOrder1;
+  const std::vector<ndVector> positions0(RainOnBoxPiles(pipelined0, contactOrder0));
+  const std::vector<ndVector> positions1(RainOnBoxPiles(pipelined1, contactOrder1));
+  EXPECT_GT(contactOrder0.size(), 0u);
+  EXPECT_EQ(contactOrder0, contactOrder1);
+  ASSERT_EQ(positions0.size(), positions1.size());
+  for (size_t i = 0; i < positions0.size(); ++i) {
+    EXPECT_EQ(positions0[i].m_x, positions1[i].m_x);
+    EXPECT_EQ(positions0[i].m_y, positions1[i].m_y);
+    EXPECT_EQ(positions0[i].m_z, positions1[i].m_z);
+  }
+}
+
+/* Pipelined sub steps must produce the same simulation as the standard update. */
+TEST(HelloNewton, PipelinedSubSteps) {
+  ExpectSameSimulation(false, true);
+}
+
+/* The threads steal pair finding work in any order, the simulation must still repeat exactly. */
+TEST(HelloNewton, DeterministicPairs) {
+  ExpectSameSimulation(false, false);
+}
+
+/* Restoring a snapshot must rewind the world, and replaying must give the same result. */
+TEST(HelloNewton, WorldSnapshot) {
+  ndWorld world;
+  world.SetSubSteps(2);
+  ndBodyKinematic* const top = AddSphereColumn(world, 4).back();
+
+  for (int i = 0; i < 5; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+
+  ndWorldSnapshot snapshot;
+  snapshot.Capture(&world);
+  const ndFloat32 savedHeight = top->GetMatrix().m_posit.m_y;
+
+  for (int i = 0; i < 30; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+  const ndFloat32 height = top->GetMatrix().m_posit.m_y;
+  EXPECT_LT(height, savedHeight);
+
+  EXPECT_TRUE(snapshot.Restore(&world));
+  EXPECT_EQ(top->GetMatrix().m_posit.m_y, savedHeight);
+  for (int i = 0; i < 30; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+  EXPECT_NEAR(top->GetMatrix().m_posit.m_y, height, 1.0e-3f);
+
+  // round trip through a memory mapped file in the temp directory
+  class TempFile {
+   public:
+    TempFile(const char* const name) {
+#ifdef _WIN32
+      const char* const dir = getenv("TEMP");
+      m_path = std::string(dir ? dir : ".") + "\\" + name;
+#else
+      const char* const dir = getenv("TMPDIR");
+      m_path = std::string((dir && dir[0]) ? dir : "/tmp") + "/" + name;
+#endif
+    }
+    ~TempFile() { remove(m_path.c_str()); }
+    std::string m_path;
+  };
+  TempFile file("world_snapshot_test.bin");
+  ndLoadSave loadSave;
+  EXPECT_TRUE(snapshot.Save(file.m_path.c_str()));
+  EXPECT_TRUE(loadSave.LoadSnapshot(file.m_path.c_str(), &world));
+  EXPECT_EQ(top->GetMatrix().m_posit.m_y, savedHeight);
+}
+
+/* A free list block with a size no other engine class uses. */
+class FreeListTestBlock : public ndFreeListAlloc {
+ public:
+  char m_data[1000];
+};
+
+/* Free list blocks recycle through the thread caches, also when freed by another thread. */
+TEST(HelloNewton, FreeListThreadCaches) {
+  const int count = 1000;
+  ndFreeListStatistics stats0;
+  ndMemory::GetFreeListStatistics(stats0);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.push_back(std::thread([count]() {
+      std::vector<FreeListTestBlock*> blocks;
+      for (int j = 0; j < 10; j++) {
+        for (int k = 0; k < count / 10; k++) {
+          blocks.push_back(new FreeListTestBlock);
+        }
+        for (size_t k = 0; k < blocks.size(); k++) {
+          delete blocks[k];
+        }
+        blocks.clear();
+      }
+    }));
+  }
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+
+  ndFreeListStatistics stats1;
+  ndMemory::GetFreeListStatistics(stats1);
+  EXPECT_GT(stats1.m_cacheHits, stats0.m_cacheHits);
+  EXPECT_GT(stats1.m_sharedBlocks, 0u);
+
+  /* allocate on one thread, free on another, the blocks must be reused by a third. */
+  std::vector<FreeListTestBlock*> blocks;
+  std::thread producer([&blocks, count]() {
+    for (int i = 0; i < count; i++) {
+      blocks.push_back(new FreeListTestBlock);
+    }
+  });
+  producer.join();
+  std::thread consumer([&blocks]() {
+    for (size_t i = 0; i < blocks.size(); i++) {
+      delete blocks[i];
+    }
+  });
+  consumer.join();
+  blocks.clear();
+
+  ndFreeListStatistics stats2;
+  ndMemory::GetFreeListStatistics(stats2);
+  for (int i = 0; i < count; i++) {
+    blocks.push_back(new FreeListTestBlock);
+  }
+  ndFreeListStatistics stats3;
+  ndMemory::GetFreeListStatistics(stats3);
+  EXPECT_EQ(stats3.m_systemAllocations, stats2.m_systemAllocations);
+  for (size_t i = 0; i < blocks.size(); i++) {
+    delete blocks[i];
+  }
+
+  ndFreeListAlloc::Flush();
+  ndFreeListStatistics stats4;
+  ndMemory::GetFreeListStatistics(stats4);
+  EXPECT_EQ(stats4.m_sharedBlocks, 0u);
+  EXPECT_EQ(stats4.m_cachedBlocks, 0u);
+}
+
+/* A bare thread pool driven from the test thread. */
+class TestThreadPool : public ndThreadPool {
+ public:
+  TestThreadPool() : ndThreadPool("testPool") {}
+  ~TestThreadPool() { Finish(); }
+  virtual void ThreadFunction() {}
+};
+
+/* Run many short updates of a few jobs each, so that the workers keep parking and waking 
+   up between them, and check that every job ran on every item. Then do the same with a world. */
+static void RunShortUpdates(ndInt32 spinBudget) {
+  TestThreadPool pool;
+  pool.SetThreadCount(4);
+  pool.SetSpinBudget(spinBudget);
+  EXPECT_EQ(pool.GetSpinBudget(), spinBudget);
+
+  const ndInt32 itemCount = 1000;
+  std::vector<ndInt32> items(itemCount, 0);
+  ndInt32 errors = 0;
+  for (ndInt32 update = 0; update < 2000; ++update) {
+    ndAtomic<ndInt32> jobsRun(0);
+    pool.Begin();
+    for (ndInt32 job = 0; job < 3; ++job) {
+      auto AddJob = ndMakeObject::ndFunction([&items, &jobsRun, itemCount](ndInt32 threadIndex, ndInt32 threadCount) {
+        const ndStartEnd startEnd(itemCount, threadIndex, threadCount);
+        for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i) {
+          items[size_t(i)] += i;
+        }
+        jobsRun.fetch_add(1);
+      });
+      pool.ParallelExecute(AddJob);
+    }
+    pool.End();
+
+    errors += (jobsRun.load() != 3 * pool.GetThreadCount()) ? 1 : 0;
+    for (ndInt32 i = 0; i < itemCount; ++i) {
+      errors += (items[size_t(i)] != 3 * i) ? 1 : 0;
+      items[size_t(i)] = 0;
+    }
+  }
+  EXPECT_EQ(errors, 0);
+
+  ndWorld world;
+  world.SetThreadCount(4);
+  world.SetThreadSpinBudget(spinBudget);
+  const std::vector<ndBodyKinematic*> spheres(AddSphereColumn(world, 8));
+  for (int i = 0; i < 600; i++) {
+    world.Update(1.0f / 240.0f);
+    world.Sync();
+  }
+  for (size_t i = 0; i < spheres.size(); i++) {
+    EXPECT_NEAR(spheres[i]->GetMatrix().m_posit.m_y, 0.5f + ndFloat32(i), 0.05f);
+  }
+}
+
+/* Workers that park as soon as they are idle must wake up for every job and every update. */
+TEST(HelloNewton, ThreadPoolParkWake) {
+  RunShortUpdates(0);
+}
+
+/* Workers that never park must also finish every update. */
+TEST(HelloNewton, ThreadPoolAlwaysSpin) {
+  RunShortUpdates(-1);
+}
+
+/* The transient step buffers come from the scene frame arena, which settles in one page. */
+TEST(HelloNewton, FrameArena) {
+  ndWorld world;
+  world.SetSubSteps(2);
+
+  ndShapeInstance sphereShape(new ndShapeSphere(0.5f));
+  AddFloorAndBodies(world, 20.0f, 64, [&](int i, ndMatrix& matrix) -> const ndShapeInstance& {
+    matrix.m_posit.m_x = ndFloat32(i % 8) * 1.05f - 4.0f;
+    matrix.m_posit.m_y = 0.6f + ndFloat32(i / 8) * 1.05f;
+    return sphereShape;
+  });
+
+  for (int i = 0; i < 30; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+
+  const ndFrameArena& arena = world.GetScene()->GetFrameArena();
+  const size_t capacity = arena.GetCapacity();
+  EXPECT_GT(arena.GetFramePeakUsage(), 0u);
+  EXPECT_LE(arena.GetFramePeakUsage(), capacity);
+  EXPECT_EQ(arena.GetUsed(), 0u);
+
+  for (int i = 0; i < 30; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+    EXPECT_EQ(arena.GetUsed(), 0u);
+    EXPECT_EQ(arena.GetCapacity(), capacity);
+  }
+  EXPECT_GE(arena.GetPeakUsage(), arena.GetFramePeakUsage());
+}
+
+/* Drop a pile of spheres for a few scene rebuild periods and return the sum of their heights. */
+static ndFloat32 DropSpherePile(bool backgroundBuild) {
+  ndWorld world;
+  world.SetSubSteps(2);
+  world.GetScene()->SetBackgroundBvhBuild(backgroundBuild);
+
+  ndShapeInstance sphereShape(new ndShapeSphere(0.5f));
+  const std::vector<ndBodyKinematic*> spheres(AddFloorAndBodies(world, 40.0f, 128, [&](int i, ndMatrix& matrix) -> const ndShapeInstance& {
+    matrix.m_posit.m_x = ndFloat32(i % 8) * 1.5f - 6.0f;
+    matrix.m_posit.m_z = ndFloat32((i / 8) % 4) * 1.5f - 3.0f;
+    matrix.m_posit.m_y = 1.0f + ndFloat32(i / 32) * 3.0f + ndFloat32(i % 3) * 0.25f;
+    return sphereShape;
+  }));
+
+  for (int i = 0; i < 200; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+
+  ndFloat32 sum = 0.0f;
+  for (size_t i = 0; i < spheres.size(); i++) {
+    const ndFloat32 y = spheres[i]->GetMatrix().m_posit.m_y;
+    EXPECT_GT(y, 0.0f);
+    sum += y;
+  }
+  return sum;
+}
+
+/* The broad phase tree rebuilt in the background must give a valid and repeatable simulation. */
+TEST(HelloNewton, BackgroundBvhBuild) {
+  const ndFloat32 foreground = DropSpherePile(false);
+  const ndFloat32 background0 = DropSpherePile(true);
+  const ndFloat32 background1 = DropSpherePile(true);
+  EXPECT_EQ(background0, background1);
+  EXPECT_NEAR(foreground, background0, 1.0f);
+}
+
+/* Simulate a tall stack of boxes with the selected solver and return the top box position, 
+   the solver passes of every update are added to passes. */
+static ndVector StackBoxes(ndWorld::ndSolverModes solverMode, ndInt32 iterations = 4, ndInt32* const passes = nullptr) {
+  ndWorld world;
+  world.SetSubSteps(2);
+  world.SetSolverIterations(iterations);
+  world.SelectSolver(solverMode);
+  EXPECT_EQ(world.GetSelectedSolver(), solverMode);
+
+  ndShapeInstance boxShape(new ndShapeBox(1.0f, 1.0f, 1.0f));
+  ndBodyKinematic* const top = AddFloorAndBodies(world, 20.0f, 12, [&](int i, ndMatrix& matrix) -> const ndShapeInstance& {
+    matrix.m_posit.m_y = 0.5f + ndFloat32(i) * 1.01f;
+    return boxShape;
+  }).back();
+
+  for (int i = 0; i < 240; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+    if (passes && (solverMode == ndWorld::ndGraphColorSolver)) {
+      *passes += static_cast<ndDynamicsUpdateGraphColor*>(world.GetSolver())->GetPasses();
+    } else if (passes) {
+      const ndArray<ndDynamicsUpdate::ndIsland>& islands = world.GetSolver()->GetIslands();
+      for (ndInt32 j = 0; j < islands.GetCount(); ++j) {
+        *passes += islands[j].m_passes;
+      }
+    }
+  }
+  return top->GetMatrix().m_posit;
+}
+
+/* The graph colored gauss seidel solver must keep a tall stack standing, 
+   and reach the solver tolerance in fewer passes than the jacobi solver. */
+TEST(HelloNewton, GraphColorSolver) {
+  const ndVector posit(StackBoxes(ndWorld::ndGraphColorSolver));
+  EXPECT_NEAR(posit.m_y, 11.5f, 0.05f);
+  EXPECT_NEAR(posit.m_x, 0.0f, 0.01f);
+  EXPECT_NEAR(posit.m_z, 0.0f, 0.01f);
+
+  const ndVector reference(StackBoxes(ndWorld::ndStandardSolver));
+  EXPECT_NEAR(posit.m_y, reference.m_y, 0.05f);
+
+  ndInt32 colorPasses = 0;
+  ndInt32 jacobiPasses = 0;
+  StackBoxes(ndWorld::ndGraphColorSolver, 32, &colorPasses);
+  StackBoxes(ndWorld::ndStandardSolver, 32, &jacobiPasses);
+  EXPECT_GT(colorPasses, 0);
+  EXPECT_LT(2 * colorPasses, jacobiPasses);
+}
+
+/* Separate piles form separate solver islands, and resting piles stop iterating early, 
+   the forces of their bodies are not accumulated again after they converge. */
+TEST(HelloNewton, SolverIslandEarlyOut) {
+  ndWorld world;
+  world.SetSubSteps(2);
+  const std::vector<ndBodyKinematic*> boxes(AddBoxPiles(world));
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    boxes[i]->SetAutoSleep(false);
+  }
+
+  // a box dropped on one pile keeps its island busy after the others rest
+  ndShapeInstance boxShape(new ndShapeBox(1.0f, 1.0f, 1.0f));
+  ndSharedPtr<ndBodyKinematic> box(new ndBodyDynamic());
+  ndMatrix matrix(ndGetIdentityMatrix());
+  matrix.m_posit = ndVector(-6.0f, 8.0f, -6.0f, 1.0f);
+  box->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+  box->SetMatrix(matrix);
+  box->SetCollisionShape(boxShape);
+  box->GetAsBodyDynamic()->SetMassMatrix(1.0f, boxShape);
+  world.AddBody(box);
+
+  int minPasses = 1 << 30;
+  int maxPasses = 0;
+  int skippedFrames = 0;
+  for (int i = 0; i < 120; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+    ndDynamicsUpdate* const solver = world.GetSolver();
+    const ndArray<ndDynamicsUpdate::ndIsland>& islands = solver->GetIslands();
+    if (i == 20) {
+      EXPECT_EQ(islands.GetCount(), 16);
+    }
+    int bodyCount = 0;
+    int bodyPasses = 0;
+    int frameMaxPasses = 0;
+    for (ndInt32 j = 0; j < islands.GetCount(); ++j) {
+      minPasses = ndMin(minPasses, int(islands[j].m_passes));
+      maxPasses = ndMax(maxPasses, int(islands[j].m_passes));
+      frameMaxPasses = ndMax(frameMaxPasses, int(islands[j].m_passes));
+      bodyCount += islands[j].m_bodyCount;
+      bodyPasses += islands[j].m_bodyCount * islands[j].m_passes;
+    }
+    if (i == 20) {
+      EXPECT_EQ(bodyCount, 16 * 3);
+    }
+    // each body is visited once per pass of its island, and no more
+    EXPECT_EQ(solver->GetIslandBodyPasses(), bodyPasses);
+    skippedFrames += (solver->GetIslandBodyPasses() < bodyCount * frameMaxPasses) ? 1 : 0;
+  }
+  EXPECT_GE(minPasses, 4);
+  EXPECT_LT(minPasses, maxPasses);
+  EXPECT_GT(skippedFrames, 10);
+}
+
+/* The avx512 solver falls back on older cpus, and must keep stacks standing with full and partial joint groups. */
+TEST(HelloNewton, Avx512Solver) {
+  ndWorld world;
+  world.SetSubSteps(2);
+  world.SelectSolver(ndWorld::ndSimdAvx512Solver);
+  const ndWorld::ndSolverModes mode = world.GetSelectedSolver();
+  EXPECT_TRUE((mode == ndWorld::ndSimdAvx512Solver) || (mode == ndWorld::ndSimdAvx2Solver) || (mode == ndWorld::ndSimdSoaSolver));
+  if (mode != ndWorld::ndSimdAvx512Solver) {
+    GTEST_SKIP() << "avx512 solver not available, fell back to " << world.GetSolverString();
+  }
+
+  // twelve contacts, one partially filled group
+  const ndVector posit(StackBoxes(ndWorld::ndSimdAvx512Solver));
+  EXPECT_NEAR(posit.m_y, 11.5f, 0.05f);
+  EXPECT_NEAR(posit.m_x, 0.0f, 0.01f);
+  EXPECT_NEAR(posit.m_z, 0.0f, 0.01f);
+
+  // forty eight contacts, three full groups
+  const std::vector<ndBodyKinematic*> boxes(AddBoxPiles(world));
+
+  for (int i = 0; i < 180; i++) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+  for (size_t i = 2; i < boxes.size(); i += 3) {
+    EXPECT_NEAR(boxes[i]->GetMatrix().m_posit.m_y, 2.5f, 0.05f);
+  }
+}
+
+/* The dispatched kernels must give the same answers at every instruction set the cpu can run. */
+TEST(HelloNewton, SimdDispatch) {
+  ndWorld world;
+  const ndSimdIsa cpuIsa = ndSimdDispatch::GetCpuIsa();
+  EXPECT_EQ(ndSimdDispatch::GetActiveIsa(), cpuIsa);
+  for (ndInt32 i = 0; i < ndSimdKernelCount; ++i) {
+    EXPECT_LE(ndSimdDispatch::GetKernelIsa(ndSimdKernel(i)), cpuIsa);
+  }
+
+  ndFloat32 points[18][3];
+  for (ndInt32 i = 0; i < 18; ++i) {
+    const ndFloat32 angle = ndFloat32(i) * ndPi * 2.0f / 18.0f;
+    points[i][0] = 1.5f * ndCos(angle);
+    points[i][1] = (i & 1) ? 0.5f : -0.5f;
+    points[i][2] = 0.75f * ndSin(angle);
+  }
+  ndShapeInstance hull(new ndShapeConvexHull(18, 3 * sizeof(ndFloat32), 0.0f, &points[0][0]));
+
+  const ndFastRay ray(ndVector(-4.0f, 0.25f, 0.1f, 0.0f), ndVector(4.0f, -0.25f, 0.3f, 0.0f));
+  const ndVector minBox0(-1.0f, -1.0f, -1.0f, 0.0f);
+  const ndVector maxBox0(1.0f, 1.0f, 1.0f, 0.0f);
+  const ndVector minBox1(2.0f, 2.0f, 2.0f, 0.0f);
+  const ndVector maxBox1(3.0f, 3.0f, 3.0f, 0.0f);
+
+  for (ndInt32 isa = ndSimdGeneric; isa <= cpuIsa; ++isa) {
+    EXPECT_EQ(ndSimdDispatch::SetActiveIsa(ndSimdIsa(isa)), ndSimdIsa(isa));
+
+    for (ndInt32 i = 0; i < 64; ++i) {
+      const ndFloat32 angle = ndFloat32(i) * 0.37f;
+      const ndVector dir(ndVector(ndCos(angle), ndSin(angle * 1.3f), ndSin(angle), 0.0f).Normalize());
+      ndFloat32 maxProj = -1.0e10f;
+      for (ndInt32 j = 0; j < 18; ++j) {
+        const ndVector p(points[j][0], points[j][1], points[j][2], 0.0f);
+        maxProj = ndMax(maxProj, p.DotProduct(dir).GetScalar());
+      }
+      const ndVector support(hull.SupportVertex(dir));
+      EXPECT_NEAR(support.DotProduct(dir).GetScalar(), maxProj, 1.0e-5f);
+    }
+
+    // far vertices project below any seed value, and a nan direction
+    // must return the first vertex, for full and partial register tails
+    for (ndInt32 groupCount = 1; groupCount <= 7; groupCount += 2) {
+      const ndInt32 vertexCount = groupCount * 4 - 1;
+      std::vector<ndVector> x(groupCount), y(groupCount), z(groupCount), index(groupCount);
+      for (ndInt32 i = 0; i < groupCount * 4; ++i) {
+        const ndInt32 j = (i < vertexCount) ? i : 0;
+        x[i / 4][i % 4] = -1.0e22f - ndFloat32(ndAbs(j - vertexCount / 2)) * 1.0e21f;
+        y[i / 4][i % 4] = ndFloat32(j % 3);
+        z[i / 4][i % 4] = ndFloat32(j % 5);
+        index[i / 4][i % 4] = ndFloat32(j);
+      }
+      const ndVector farDir(1.0f, 0.0f, 0.0f, 0.0f);
+      EXPECT_EQ(ndSimdDispatch::SupportVertex(&x[0], &y[0], &z[0], &index[0], groupCount, farDir), vertexCount / 2);
+
+      const ndFloat32 nan = std::numeric_limits<ndFloat32>::quiet_NaN();
+      const ndVector nanDir(nan, nan, nan, 0.0f);
+      EXPECT_EQ(ndSimdDispatch::SupportVertex(&x[0], &y[0], &z[0], &index[0], groupCount, nanDir), 0);
+    }
+
+    ndFloat32 dist[2];
+    ndSimdDispatch::RayBoxIntersect(ray, minBox0, maxBox0, minBox1, maxBox1, dist);
+    EXPECT_EQ(dist[0], ray.BoxIntersect(minBox0, maxBox0));
+    EXPECT_EQ(dist[1], ray.BoxIntersect(minBox1, maxBox1));
+
+    for (ndInt32 size = 4; size <= 36; size += 16) {
+      std::vector<ndUnsigned32> scans(3 * size);
+      std::vector<ndUnsigned32> sum(size);
+      for (ndInt32 i = 0; i < 3 * size; ++i) {
+        scans[i] = ndUnsigned32(i % 7);
+      }
+      ndSimdDispatch::HistogramScan(&scans[0], &sum[0], 3, size);
+      for (ndInt32 i = 0; i < size; ++i) {
+        EXPECT_EQ(scans[i], 0u);
+        EXPECT_EQ(scans[size + i], ndUnsigned32(i % 7));
+        EXPECT_EQ(scans[2 * size + i], ndUnsigned32(i % 7 + (size + i) % 7));
+        EXPECT_EQ(sum[i], ndUnsigned32(i % 7 + (size + i) % 7 + (2 * size + i) % 7));
+      }
+    }
+  }
+  ndSimdDispatch::SetActiveIsa(cpuIsa);
+}
+
+/* Worlds created and kernels switched from other threads must not disturb the threads running the kernels. */
+TEST(HelloNewton, SimdDispatchThreads) {
+  const ndSimdIsa cpuIsa = ndSimdDispatch::GetCpuIsa();
+  const ndFastRay ray(ndVector(-4.0f, 0.25f, 0.1f, 0.0f), ndVector(4.0f, -0.25f, 0.3f, 0.0f));
+  const ndVector minBox0(-1.0f, -1.0f, -1.0f, 0.0f);
+  const ndVector maxBox0(1.0f, 1.0f, 1.0f, 0.0f);
+  const ndVector minBox1(-0.5f, -2.0f, 0.0f, 0.0f);
+  const ndVector maxBox1(3.0f, 3.0f, 3.0f, 0.0f);
+  const ndFloat32 dist0 = ray.BoxIntersect(minBox0, maxBox0);
+  const ndFloat32 dist1 = ray.BoxIntersect(minBox1, maxBox1);
+
+  std::vector<ndInt32> errors(3, 0);
+  std::vector<std::thread> threads;
+  for (ndInt32 t = 0; t < 2; ++t) {
+    threads.push_back(std::thread([&, t]() {
+      for (ndInt32 i = 0; i < 20000; ++i) {
+        ndFloat32 dist[2];
+        const ndRayBoxIntersectFunction rayBoxIntersect = ndSimdDispatch::GetRayBoxIntersect();
+        rayBoxIntersect(ray, minBox0, maxBox0, minBox1, maxBox1, dist);
+        errors[t] += ((dist[0] != dist0) || (dist[1] != dist1)) ? 1 : 0;
+        ndSimdDispatch::RayBoxIntersect(ray, minBox0, maxBox0, minBox1, maxBox1, dist);
+        errors[t] += ((dist[0] != dist0) || (dist[1] != dist1)) ? 1 : 0;
+      }
+    }));
+  }
+  threads.push_back(std::thread([&]() {
+    for (ndInt32 i = 0; i < 200; ++i) {
+      ndWorld world;
+      const ndSimdIsa isa = ndSimdIsa(i % (cpuIsa + 1));
+      errors[2] += (ndSimdDispatch::SetActiveIsa(isa) != isa) ? 1 : 0;
+    }
+  }));
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+  ndSimdDispatch::SetActiveIsa(cpuIsa);
+
+  EXPECT_EQ(errors[0], 0);
+  EXPECT_EQ(errors[1], 0);
+  EXPECT_EQ(errors[2], 0);
+  EXPECT_EQ(ndSimdDispatch::GetActiveIsa(), cpuIsa);
+}
+
+/* The threaded iso surface extraction must produce the same mesh as the single thread one. */
+TEST(HelloNewton, ParallelIsoSurface) {
+  ndWorld world;
+  world.SetThreadCount(4);
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+
+  ndArray<ndVector> points;
+  const ndFloat32 spacing = 0.1f;
+  for (ndInt32 i = 0; i < 24; ++i) {
+    for (ndInt32 j = 0; j < 24; ++j) {
+      for (ndInt32 k = 0; k < 24; ++k) {
+        const ndVector p(ndFloat32(i - 12), ndFloat32(j - 12), ndFloat32(k - 12), 0.0f);
+        if (p.DotProduct(p).GetScalar() < 12.0f * 12.0f) {
+          const ndFloat32 jitter = 0.3f * ndSin(ndFloat32(i * 7 + j * 13 + k * 17));
+          points.PushBack(ndVector(p.Scale(spacing) + ndVector(jitter * spacing, 0.0f, 0.0f, 0.0f)));
+        }
+      }
+    }
+  }
+
+  ndIsoSurface serial;
+  serial.GenerateMesh(points, spacing);
+  ndIsoSurface parallel;
+  parallel.GenerateMesh(world.GetScene(), points, spacing);
+
+  const ndArray<ndVector>& serialPoints = serial.GetPoints();
+  const ndArray<ndVector>& parallelPoints = parallel.GetPoints();
+  ASSERT_GT(serialPoints.GetCount(), 0);
+  ASSERT_EQ(serialPoints.GetCount(), parallelPoints.GetCount());
+  for (ndInt32 i = 0; i < serialPoints.GetCount(); ++i) {
+    const ndVector diff(serialPoints[i] - parallelPoints[i]);
+    ASSERT_EQ(diff.DotProduct(diff).GetScalar(), 0.0f);
+  }
+
+  const ndInt32 count = serialPoints.GetCount();
+  std::vector<ndInt32> serialIndex(count);
+  std::vector<ndInt32> parallelIndex(count);
+  std::vector<ndReal> serialVertex(count * 6);
+  std::vector<ndReal> parallelVertex(count * 6);
+  const ndInt32 serialCount = serial.GenerateListIndexList(&serialIndex[0], 6, &serialVertex[0], &serialVertex[3]);
+  const ndInt32 parallelCount = parallel.GenerateListIndexList(world.GetScene(), &parallelIndex[0], 6, &parallelVertex[0], &parallelVertex[3]);
+  EXPECT_EQ(serialCount, parallelCount);
+  EXPECT_TRUE(serialIndex == parallelIndex);
+  EXPECT_TRUE(std::equal(serialVertex.begin(), serialVertex.begin() + serialCount * 6, parallelVertex.begin()));
+}
+
+/* Fluid particles falling on a box must be stopped by it and push it down. */
+class ndCoupledFluid : public ndBodySphFluid {
+ public:
+  using ndBodySphFluid::Update;
+};
+
+TEST(HelloNewton, FluidRigidBodyCoupling) {
+  ndWorld world;
+  world.SetThreadCount(4);
+
+  ndShapeInstance boxShape(new ndShapeBox(2.0f, 1.0f, 2.0f));
+  ndSharedPtr<ndBodyKinematic> box(new ndBodyDynamic());
+  box->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, 0.0f, 0.0f, 0.0f)));
+  ndMatrix matrix(ndGetIdentityMatrix());
+  matrix.m_posit.m_y = 2.0f;
+  box->SetMatrix(matrix);
+  box->SetCollisionShape(boxShape);
+  box->GetAsBodyDynamic()->SetMassMatrix(1.0f, boxShape);
+  world.AddBody(box);
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+
+  ndCoupledFluid fluid;
+  fluid.SetAsynUpdate(false);
+  fluid.SetRigidBodyCoupling(true);
+  fluid.SetParticleRadius(0.05f);
+  fluid.SetGravity(ndVector(0.0f, -10.0f, 0.0f, 0.0f));
+  ndArray<ndVector>& posit = fluid.GetPositions();
+  ndArray<ndVector>& veloc = fluid.GetVelocity();
+  for (ndInt32 i = 0; i < 10; ++i) {
+    for (ndInt32 j = 0; j < 4; ++j) {
+      for (ndInt32 k = 0; k < 10; ++k) {
+        posit.PushBack(ndVector(ndFloat32(i - 5) * 0.1f, 2.6f + ndFloat32(j) * 0.1f, ndFloat32(k - 5) * 0.1f, 0.0f));
+        veloc.PushBack(ndVector(0.0f, -5.0f, 0.0f, 0.0f));
+      }
+    }
+  }
+
+  for (ndInt32 i = 0; i < 20; ++i) {
+    fluid.Update(&world, 1.0f / 60.0f);
+  }
+  fluid.Sync();
+
+  // the top face of the box is at 2.5
+  for (ndInt32 i = 0; i < posit.GetCount(); ++i) {
+    EXPECT_GT(posit[i].m_y, 2.5f);
+  }
+
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+  EXPECT_LT(box->GetVelocity().m_y, -0.01f);
+  EXPECT_NEAR(box->GetMatrix().m_posit.m_x, 0.0f, 1.0e-3f);
+}
+
+/* Each particle is only tested against the bodies binned in its cell, 
+   and must still be stopped by every box of a grid of boxes. */
+TEST(HelloNewton, FluidCouplingBins) {
+  ndWorld world;
+  world.SetThreadCount(4);
+
+  const ndInt32 boxCount = 4;
+  ndShapeInstance boxShape(new ndShapeBox(0.4f, 0.4f, 0.4f));
+  std::vector<ndSharedPtr<ndBodyKinematic>> boxes;
+  for (ndInt32 i = 0; i < boxCount; ++i) {
+    for (ndInt32 j = 0; j < boxCount; ++j) {
+      ndSharedPtr<ndBodyKinematic> box(new ndBodyDynamic());
+      box->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, 0.0f, 0.0f, 0.0f)));
+      ndMatrix matrix(ndGetIdentityMatrix());
+      matrix.m_posit = ndVector(ndFloat32(i) * 0.5f - 0.75f, 2.0f, ndFloat32(j) * 0.5f - 0.75f, 1.0f);
+      box->SetMatrix(matrix);
+      box->SetCollisionShape(boxShape);
+      box->GetAsBodyDynamic()->SetMassMatrix(1.0f, boxShape);
+      world.AddBody(box);
+      boxes.push_back(box);
+    }
+  }
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+
+  ndCoupledFluid fluid;
+  fluid.SetAsynUpdate(false);
+  fluid.SetRigidBodyCoupling(true);
+  fluid.SetParticleRadius(0.05f);
+  fluid.SetGravity(ndVector(0.0f, -10.0f, 0.0f, 0.0f));
+  ndArray<ndVector>& posit = fluid.GetPositions();
+  ndArray<ndVector>& veloc = fluid.GetVelocity();
+  for (ndInt32 i = 0; i < 20; ++i) {
+    for (ndInt32 j = 0; j < 2; ++j) {
+      for (ndInt32 k = 0; k < 20; ++k) {
+        posit.PushBack(ndVector(ndFloat32(i) * 0.1f - 0.95f, 2.3f + ndFloat32(j) * 0.1f, ndFloat32(k) * 0.1f - 0.95f, 0.0f));
+        veloc.PushBack(ndVector(0.0f, -5.0f, 0.0f, 0.0f));
+      }
+    }
+  }
+
+  const ndInt32 bruteForceTests = ndInt32(posit.GetCount() * boxes.size());
+  for (ndInt32 i = 0; i < 10; ++i) {
+    fluid.Update(&world, 1.0f / 60.0f);
+    fluid.Sync();
+    EXPECT_GT(fluid.GetCouplingTestCount(), 0);
+    EXPECT_LT(fluid.GetCouplingTestCount() * 4, bruteForceTests);
+  }
+
+  // no particle gets inside a box, the box tops are at 2.2
+  for (ndInt32 i = 0; i < posit.GetCount(); ++i) {
+    for (size_t j = 0; j < boxes.size(); ++j) {
+      const ndVector local(posit[i] - boxes[j]->GetMatrix().m_posit);
+      const bool inside = (ndAbs(local.m_x) < 0.2f) && (ndAbs(local.m_y) < 0.2f) && (ndAbs(local.m_z) < 0.2f);
+      EXPECT_FALSE(inside);
+    }
+  }
+
+  // and every box is pushed down
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+  for (size_t j = 0; j < boxes.size(); ++j) {
+    EXPECT_LT(boxes[j]->GetVelocity().m_y, -0.01f);
+  }
+}
+
+/* Reusing the neighbor grids of the last update must give the same simulation as rebuilding them. */
+static void RunFluid(bool temporalCoherence, ndArray<ndVector>& positOut) {
+  ndWorld world;
+  world.SetThreadCount(1);
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+
+  ndCoupledFluid fluid;
+  fluid.SetAsynUpdate(false);
+  fluid.SetTemporalCoherence(temporalCoherence);
+  fluid.SetParticleRadius(0.05f);
+  fluid.SetGravity(ndVector(0.0f, -10.0f, 0.0f, 0.0f));
+  ndArray<ndVector>& posit = fluid.GetPositions();
+  ndArray<ndVector>& veloc = fluid.GetVelocity();
+  for (ndInt32 i = 0; i < 16; ++i) {
+    for (ndInt32 j = 0; j < 16; ++j) {
+      for (ndInt32 k = 0; k < 16; ++k) {
+        const ndFloat32 jitter = 0.01f * ndSin(ndFloat32(j + k));
+        posit.PushBack(ndVector(ndFloat32(i) * 0.1f + jitter, 1.2f + ndFloat32(j) * 0.1f, ndFloat32(k) * 0.1f, 0.0f));
+        veloc.PushBack(ndVector::m_zero);
+      }
+    }
+  }
+
+  for (ndInt32 i = 0; i < 30; ++i) {
+    fluid.Update(&world, 1.0f / 60.0f);
+  }
+  fluid.Sync();
+  positOut.SetCount(0);
+  for (ndInt32 i = 0; i < posit.GetCount(); ++i) {
+    positOut.PushBack(posit[i]);
+  }
+}
+
+TEST(HelloNewton, FluidTemporalCoherence) {
+  ndArray<ndVector> rebuilt;
+  ndArray<ndVector> reused;
+  RunFluid(false, rebuilt);
+  RunFluid(true, reused);
+  ASSERT_EQ(rebuilt.GetCount(), reused.GetCount());
+  for (ndInt32 i = 0; i < rebuilt.GetCount(); ++i) {
+    const ndVector diff((rebuilt[i] - reused[i]) & ndVector::m_triplexMask);
+    EXPECT_LT(diff.DotProduct(diff).GetScalar(), 1.0e-8f);
+  }
+}
+
+/* The closed form contacts of the primitive pairs must match the gjk and epa search. */
+static void CalculatePrimitiveContacts(bool analytic, const ndShapeInstance& shape0, const ndMatrix& matrix0,
+                                       const ndShapeInstance& shape1, const ndMatrix& matrix1,
+                                       ndFixSizeArray<ndContactPoint, 16>& contacts) {
+  ndContactNotify notification;
+  ndContactSolver solver;
+  const bool state = ndContactSolver::GetAnalyticContacts();
+  ndContactSolver::SetAnalyticContacts(analytic);
+  contacts.SetCount(0);
+  solver.CalculateContacts(&shape0, matrix0, ndVector::m_zero, &shape1, matrix1, ndVector::m_zero, contacts, &notification);
+  ndContactSolver::SetAnalyticContacts(state);
+}
+
+/* The overlap of two boxes projected on an axis. */
+static ndFloat32 BoxOverlap(const ndVector& halfSize, const ndMatrix& matrix0, const ndMatrix& matrix1, const ndVector& axis) {
+  const ndVector dir(axis & ndVector::m_triplexMask);
+  ndFloat32 radius = 0.0f;
+  for (ndInt32 i = 0; i < 3; ++i) {
+    radius += halfSize[i] * (ndAbs(dir.DotProduct(matrix0[i]).GetScalar()) + ndAbs(dir.DotProduct(matrix1[i]).GetScalar()));
+  }
+  return radius - ndAbs(dir.DotProduct(matrix1.m_posit - matrix0.m_posit).GetScalar());
+}
+
+/* The exact penetration of two boxes, the smallest overlap over the 6 face and 9 edge axes. */
+static ndFloat32 BoxPenetration(const ndVector& halfSize, const ndMatrix& matrix0, const ndMatrix& matrix1, bool& edgeAxis) {
+  ndFloat32 overlap = 1.0e10f;
+  edgeAxis = false;
+  for (ndInt32 i = 0; i < 3; ++i) {
+    overlap = ndMin(overlap, BoxOverlap(halfSize, matrix0, matrix1, matrix0[i]));
+    overlap = ndMin(overlap, BoxOverlap(halfSize, matrix0, matrix1, matrix1[i]));
+  }
+  for (ndInt32 i = 0; i < 3; ++i) {
+    for (ndInt32 j = 0; j < 3; ++j) {
+      const ndVector axis(matrix0[i].CrossProduct(matrix1[j]) & ndVector::m_triplexMask);
+      const ndFloat32 mag2 = axis.DotProduct(axis).GetScalar();
+      if (mag2 > 1.0e-6f) {
+        const ndFloat32 edgeOverlap = BoxOverlap(halfSize, matrix0, matrix1, axis.Scale(1.0f / ndSqrt(mag2)));
+        if (edgeOverlap < overlap) {
+          overlap = edgeOverlap;
+          edgeAxis = true;
+        }
+      }
+    }
+  }
+  return overlap;
+}
+
+TEST(HelloNewton, AnalyticContacts) {
+  const ndVector boxSize(1.0f, 0.5f, 2.0f, 0.0f);
+  ndShapeInstance shapes[] = {
+    ndShapeInstance(new ndShapeSphere(0.5f)),
+    ndShapeInstance(new ndShapeBox(boxSize.m_x, boxSize.m_y, boxSize.m_z)),
+    ndShapeInstance(new ndShapeCapsule(0.25f, 0.25f, 1.5f)),
+  };
+  const ndInt32 shapeCount = ndInt32(sizeof(shapes) / sizeof(shapes[0]));
+
+  ndUnsigned32 seed = 12345;
+  auto Random = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return ndFloat32(seed >> 8) / ndFloat32(1 << 24);
+  };
+  auto RandomMatrix = [&Random]() {
+    return ndPitchMatrix(Random() * 2.0f * ndPi) * ndYawMatrix(Random() * 2.0f * ndPi) * ndRollMatrix(Random() * 2.0f * ndPi);
+  };
+
+  // with the contact plane only the tangent part of the distance counts
+  auto ExpectSamePoints = [](const ndFixSizeArray<ndContactPoint, 16>& generic, const ndFixSizeArray<ndContactPoint, 16>& analytic, bool contactPlane) {
+    const ndVector normal(contactPlane ? analytic[0].m_normal & ndVector::m_triplexMask : ndVector::m_zero);
+    for (ndInt32 m = 0; m < analytic.GetCount(); ++m) {
+      ndFloat32 minDist2 = 1.0e10f;
+      for (ndInt32 n = 0; n < generic.GetCount(); ++n) {
+        ndVector diff((analytic[m].m_point - generic[n].m_point) & ndVector::m_triplexMask);
+        diff = diff - normal.Scale(diff.DotProduct(normal).GetScalar());
+        minDist2 = ndMin(minDist2, diff.DotProduct(diff).GetScalar());
+      }
+      EXPECT_LT(minDist2, 1.0e-2f * 1.0e-2f);
+    }
+  };
+
+  ndInt32 boxCases = 0;
+  ndInt32 edgeCases = 0;
+  ndInt32 contactCases = 0;
+  const ndVector boxHalfSize(boxSize.Scale(0.5f));
+  for (ndInt32 i = 0; i < shapeCount; ++i) {
+    for (ndInt32 j = 0; j < shapeCount; ++j) {
+      for (ndInt32 k = 0; k < 200; ++k) {
+        ndMatrix matrix0(RandomMatrix());
+        matrix0.m_posit = ndVector(Random(), Random(), Random(), 1.0f);
+        ndMatrix matrix1(RandomMatrix());
+        const ndVector dir(ndVector(Random() - 0.5f, Random() - 0.5f, Random() - 0.5f, 0.0f).Normalize());
+        matrix1.m_posit = matrix0.m_posit + dir.Scale(0.4f + Random() * 0.8f);
+
+        ndFixSizeArray<ndContactPoint, 16> generic;
+        ndFixSizeArray<ndContactPoint, 16> analytic;
+        CalculatePrimitiveContacts(false, shapes[i], matrix0, shapes[j], matrix1, generic);
+        CalculatePrimitiveContacts(true, shapes[i], matrix0, shapes[j], matrix1, analytic);
+        if ((i == 1) && (j == 1)) {
+          // the generic penetration of two boxes is approximated, so the closed 
+          // form contacts are checked against the exact separating axis test.
+          bool edgeAxis;
+          const ndFloat32 penetration = BoxPenetration(boxHalfSize, matrix0, matrix1, edgeAxis);
+          if (penetration < -1.0e-2f) {
+            EXPECT_EQ(generic.GetCount(), 0);
+            EXPECT_EQ(analytic.GetCount(), 0);
+          } else if (generic.GetCount() || analytic.GetCount()) {
+            boxCases++;
+            edgeCases += edgeAxis ? 1 : 0;
+            ASSERT_GT(generic.GetCount(), 0);
+            ASSERT_GT(analytic.GetCount(), 0);
+            EXPECT_NEAR(analytic[0].m_penetration, penetration, 2.0e-3f);
+            EXPECT_NEAR(BoxOverlap(boxHalfSize, matrix0, matrix1, analytic[0].m_normal), penetration, 2.0e-3f);
+            for (ndInt32 m = 0; m < analytic.GetCount(); ++m) {
+              const ndVector point0(matrix0.UntransformVector(analytic[m].m_point).Abs());
+              const ndVector point1(matrix1.UntransformVector(analytic[m].m_point).Abs());
+              for (ndInt32 n = 0; n < 3; ++n) {
+                EXPECT_LT(point0[n], boxHalfSize[n] + penetration + 1.0e-2f);
+                EXPECT_LT(point1[n], boxHalfSize[n] + penetration + 1.0e-2f);
+              }
+            }
+            // both methods clip the same pair of faces when they settle on the same axis, 
+            // when the generic search stops on a deeper axis the manifolds are different. 
+            // the points are compared in the contact plane because the generic depth 
+            // error moves them along the normal, and a small tilt of a deep contact 
+            // already moves the clipped faces.
+            const ndFloat32 normalDot = generic[0].m_normal.DotProduct(analytic[0].m_normal).GetScalar();
+            if (normalDot > 0.9999f) {
+              EXPECT_EQ(generic.GetCount(), analytic.GetCount());
+            }
+            if (normalDot > 0.99999f) {
+              ExpectSamePoints(generic, analytic, true);
+            }
+          }
+        } else if (generic.GetCount() && analytic.GetCount()) {
+          // grazing contacts may be found by one method and not the other
+          contactCases++;
+          EXPECT_EQ(generic.GetCount(), analytic.GetCount());
+          EXPECT_NEAR(generic[0].m_penetration, analytic[0].m_penetration, 2.0e-3f);
+          EXPECT_GT(generic[0].m_normal.DotProduct(analytic[0].m_normal).GetScalar(), 0.99f);
+          ExpectSamePoints(generic, analytic, false);
+        } else {
+          EXPECT_TRUE(ndAbs(generic.GetCount() ? generic[0].m_penetration : analytic.GetCount() ? analytic[0].m_penetration : 0.0f) < 1.0e-2f);
+        }
+      }
+    }
+  }
+  EXPECT_GT(contactCases, 200);
+  EXPECT_GT(boxCases, 150);
+  EXPECT_GT(edgeCases, 50);
+}
+
+static ndVector StackHulls(bool warmStart) {
+  const bool state = ndContactSolver::GetWarmStart();
+  ndContactSolver::SetWarmStart(warmStart);
+
+  ndWorld world;
+  world.SetSubSteps(2);
+
+  // octagonal prisms, so that the pairs go to the gjk and the epa
+  ndFloat32 points[16][3];
+  for (ndInt32 i = 0; i < 16; ++i) {
+    const ndFloat32 angle = ndFloat32(i / 2) * ndPi * 2.0f / 8.0f;
+    points[i][0] = 0.6f * ndCos(angle);
+    points[i][1] = (i & 1) ? 0.5f : -0.5f;
+    points[i][2] = 0.6f * ndSin(angle);
+  }
+  ndShapeInstance hullShape(new ndShapeConvexHull(16, 3 * sizeof(ndFloat32), 0.0f, &points[0][0]));
+
+  ndBodyKinematic* const top = AddFloorAndBodies(world, 20.0f, 8, [&](int i, ndMatrix& matrix) -> const ndShapeInstance& {
+    matrix = ndYawMatrix(ndFloat32(i) * 0.3f);
+    matrix.m_posit = ndVector(0.0f, 0.5f + ndFloat32(i) * 1.01f, 0.0f, 1.0f);
+    return hullShape;
+  }).back();
+
+  for (ndInt32 i = 0; i < 240; ++i) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+  ndContactSolver::SetWarmStart(state);
+  return top->GetMatrix().m_posit;
+}
+
+/* Warm started contacts must keep a stack of polytopes resting like the cold start. */
+TEST(HelloNewton, NarrowPhaseWarmStart) {
+  const ndVector warm(StackHulls(true));
+  const ndVector cold(StackHulls(false));
+  EXPECT_NEAR(warm.m_y, 7.5f, 0.05f);
+  EXPECT_NEAR(warm.m_y, cold.m_y, 0.01f);
+  EXPECT_NEAR(warm.m_x, cold.m_x, 0.01f);
+  EXPECT_NEAR(warm.m_z, cold.m_z, 0.01f);
+}
+
+static ndFloat32 PackSpheres(bool analytic, ndFloat32& minHeight) {
+  const bool state = ndContactSolver::GetAnalyticContacts();
+  ndContactSolver::SetAnalyticContacts(analytic);
+
+  ndWorld world;
+  world.SetSubSteps(2);
+
+  // a layer of touching spheres with a few boxes, so that there are
+  // sphere pairs, sphere box pairs and box pairs in the same update
+  ndShapeInstance sphereShape(new ndShapeSphere(0.5f));
+  ndShapeInstance boxShape(new ndShapeBox(1.0f, 1.0f, 1.0f));
+  const std::vector<ndBodyKinematic*> bodies(AddFloorAndBodies(world, 20.0f, 49, [&](int i, ndMatrix& matrix) -> const ndShapeInstance& {
+    matrix.m_posit = ndVector(ndFloat32(i % 7) - 3.0f, 1.0f + ndFloat32(i % 3) * 0.5f, ndFloat32(i / 7) - 3.0f, 1.0f);
+    return (i % 5) ? sphereShape : boxShape;
+  }));
+
+  for (ndInt32 i = 0; i < 180; ++i) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+  ndContactSolver::SetAnalyticContacts(state);
+
+  ndFloat32 sum = 0.0f;
+  minHeight = 1.0e10f;
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    const ndFloat32 y = bodies[i]->GetMatrix().m_posit.m_y;
+    minHeight = ndMin(minHeight, y);
+    sum += y;
+  }
+  return sum;
+}
+
+/* Batched sphere contacts must rest a layer of bodies like the generic contact calculation. */
+TEST(HelloNewton, BatchedNarrowPhase) {
+  ndFloat32 batchedMin;
+  ndFloat32 genericMin;
+  const ndFloat32 batched = PackSpheres(true, batchedMin);
+  const ndFloat32 generic = PackSpheres(false, genericMin);
+  EXPECT_GT(batchedMin, 0.45f);
+  EXPECT_NEAR(batched / 49.0f, 0.5f, 0.01f);
+  EXPECT_NEAR(batched, generic, 0.05f);
+}
+
+/* Every lane of the four wide sphere kernels, in full and partial groups, 
+   must give the closest points of the scalar closed form kernels. */
+TEST(HelloNewton, BatchedKernelLanes) {
+  ndSetRandSeed(17);
+  auto Random = [](ndFloat32 low, ndFloat32 high) {
+    return low + (high - low) * ndRand();
+  };
+
+  std::vector<ndShapeInstance> spheres;
+  std::vector<ndShapeInstance> others;
+  const ndInt32 pairCount = 4 * 25 + 3;
+  for (ndInt32 i = 0; i < 2 * pairCount; ++i) {
+    ndMatrix matrix(ndPitchMatrix(Random(-ndPi, ndPi)) * ndYawMatrix(Random(-ndPi, ndPi)) * ndRollMatrix(Random(-ndPi, ndPi)));
+    matrix.m_posit = ndVector(Random(-1.5f, 1.5f), Random(-1.5f, 1.5f), Random(-1.5f, 1.5f), 1.0f);
+    ndShapeInstance sphere(new ndShapeSphere(Random(0.1f, 1.0f)));
+    sphere.SetGlobalMatrix(matrix);
+    spheres.push_back(sphere);
+
+    matrix.m_posit = ndVector(Random(-1.5f, 1.5f), Random(-1.5f, 1.5f), Random(-1.5f, 1.5f), 1.0f);
+    ndShapeInstance other((i < pairCount) ? (ndShape*)new ndShapeSphere(Random(0.1f, 1.0f)) : (ndShape*)new ndShapeBox(Random(0.2f, 2.0f), Random(0.2f, 2.0f), Random(0.2f, 2.0f)));
+    other.SetGlobalMatrix(matrix);
+    others.push_back(other);
+  }
+
+  auto ExpectNear = [](const ndVector& a, const ndVector& b) {
+    EXPECT_NEAR(a.m_x, b.m_x, 1.0e-4f);
+    EXPECT_NEAR(a.m_y, b.m_y, 1.0e-4f);
+    EXPECT_NEAR(a.m_z, b.m_z, 1.0e-4f);
+  };
+
+  ndInt32 validCount = 0;
+  for (ndInt32 kind = 0; kind < 2; ++kind) {
+    for (ndInt32 start = 0; start < pairCount; start += 4) {
+      const ndInt32 count = ndMin(pairCount - start, 4);
+      ndContactSolver::ndBatchedPair batch[4];
+      for (ndInt32 i = 0; i < count; ++i) {
+        batch[i].m_instance0 = &spheres[kind * pairCount + start + i];
+        batch[i].m_instance1 = &others[kind * pairCount + start + i];
+      }
+      ndContactSolver::CalculateBatchedClosestPoints(batch, count);
+
+      for (ndInt32 i = 0; i < count; ++i) {
+        ndContactSolver::ndBatchedPair scalar;
+        scalar.m_instance0 = batch[i].m_instance0;
+        scalar.m_instance1 = batch[i].m_instance1;
+        const bool valid = ndContactSolver::CalculateAnalyticClosestPoints(scalar);
+        if (batch[i].m_valid) {
+          // the batched kernels only give up on pairs the scalar ones solve another way
+          EXPECT_TRUE(valid);
+          ExpectNear(batch[i].m_separatingVector, scalar.m_separatingVector);
+          ExpectNear(batch[i].m_closestPoint0, scalar.m_closestPoint0);
+          ExpectNear(batch[i].m_closestPoint1, scalar.m_closestPoint1);
+          validCount++;
+        }
+      }
+    }
+  }
+  // only concentric spheres and box centers inside boxes are not valid
+  EXPECT_GT(validCount, pairCount);
+}
+
+/* Adding or removing a joint must only rebuild the skeletons connected to it. */
+TEST(HelloNewton, IncrementalSkeletons) {
+  ndWorld world;
+  ndShapeInstance shape(new ndShapeSphere(0.25f));
+
+  ndSharedPtr<ndBodyKinematic> anchor(new ndBodyDynamic());
+  anchor->SetCollisionShape(ndShapeInstance(new ndShapeBox(20.0f, 1.0f, 1.0f)));
+  ndMatrix anchorMatrix(ndGetIdentityMatrix());
+  anchorMatrix.m_posit.m_y = 10.0f;
+  anchor->SetMatrix(anchorMatrix);
+  world.AddBody(anchor);
+
+  // hanging chains of three links, one skeleton each
+  std::vector<std::vector<ndBodyKinematic*>> chains;
+  std::vector<ndSharedPtr<ndJointBilateralConstraint>> rootJoints;
+  auto AddChain = [&]() {
+    const ndFloat32 x = ndFloat32(chains.size()) * 2.0f - 8.0f;
+    std::vector<ndBodyKinematic*> links;
+    ndBodyKinematic* parent = *anchor;
+    for (ndInt32 i = 0; i < 3; ++i) {
+      ndSharedPtr<ndBodyKinematic> link(new ndBodyDynamic());
+      link->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+      ndMatrix matrix(ndGetIdentityMatrix());
+      matrix.m_posit = ndVector(x, 9.0f - ndFloat32(i), 0.0f, 1.0f);
+      link->SetMatrix(matrix);
+      link->SetCollisionShape(shape);
+      link->GetAsBodyDynamic()->SetMassMatrix(1.0f, shape);
+      world.AddBody(link);
+
+      ndMatrix pivot(matrix);
+      pivot.m_posit.m_y += 0.5f;
+      ndSharedPtr<ndJointBilateralConstraint> joint(new ndJointSpherical(pivot, *link, parent));
+      world.AddJoint(joint);
+      if (i == 1) {
+        rootJoints.push_back(joint);
+      }
+      links.push_back(*link);
+      parent = *link;
+    }
+    chains.push_back(links);
+  };
+
+  for (ndInt32 i = 0; i < 4; ++i) {
+    AddChain();
+  }
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+  EXPECT_EQ(world.GetSkeletonList().GetCount(), 4);
+
+  std::vector<ndSkeletonContainer*> skeletons;
+  for (size_t i = 0; i < chains.size(); ++i) {
+    ndSkeletonContainer* const skeleton = chains[i][0]->GetSkeleton();
+    EXPECT_TRUE(skeleton != nullptr);
+    EXPECT_EQ(chains[i][2]->GetSkeleton(), skeleton);
+    skeletons.push_back(skeleton);
+  }
+
+  // a new chain does not touch the others
+  AddChain();
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+  EXPECT_EQ(world.GetSkeletonList().GetCount(), 5);
+  for (size_t i = 0; i < skeletons.size(); ++i) {
+    EXPECT_EQ(chains[i][0]->GetSkeleton(), skeletons[i]);
+  }
+
+  // cutting the first chain splits it in two skeletons
+  world.RemoveJoint(*rootJoints[0]);
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+  EXPECT_EQ(world.GetSkeletonList().GetCount(), 6);
+  EXPECT_TRUE(chains[0][0]->GetSkeleton() != nullptr);
+  EXPECT_TRUE(chains[0][1]->GetSkeleton() != nullptr);
+  EXPECT_NE(chains[0][0]->GetSkeleton(), chains[0][1]->GetSkeleton());
+  EXPECT_EQ(chains[0][1]->GetSkeleton(), chains[0][2]->GetSkeleton());
+  for (size_t i = 1; i < skeletons.size(); ++i) {
+    EXPECT_EQ(chains[i][0]->GetSkeleton(), skeletons[i]);
+  }
+
+  // tying the ends of two chains merges their skeletons
+  ndMatrix pivot(chains[1][2]->GetMatrix());
+  ndSharedPtr<ndJointBilateralConstraint> tie(new ndJointSpherical(pivot, chains[1][2], chains[2][2]));
+  world.AddJoint(tie);
+  world.Update(1.0f / 60.0f);
+  world.Sync();
+  EXPECT_EQ(world.GetSkeletonList().GetCount(), 5);
+  EXPECT_EQ(chains[1][0]->GetSkeleton(), chains[2][0]->GetSkeleton());
+  EXPECT_EQ(chains[3][0]->GetSkeleton(), skeletons[3]);
+
+  for (ndInt32 i = 0; i < 30; ++i) {
+    world.Update(1.0f / 60.0f);
+    world.Sync();
+  }
+  for (size_t i = 0; i < chains.size(); ++i) {
+    EXPECT_TRUE(chains[i][2]->GetMatrix().m_posit.m_y > -100.0f);
+  }
+}
+
+TEST(HelloNewton, ParallelSkeletons) {
+  // trees of spheres hanging from static bodies, with a few loops, solved
+  // by one thread and by subtrees must give the same result. with at least 
+  // as many trees as threads, the big trees are solved one per thread.
+  auto Simulate = [](ndInt32 parallelBodyCount, ndInt32 treeCount, bool& isParallel) {
+    const ndInt32 savedCount = ndSkeletonContainer::GetParallelBodyCount();
+    ndSkeletonContainer::SetParallelBodyCount(parallelBodyCount);
+
+    ndWorld world;
+    world.SetThreadCount(4);
+    ndShapeInstance shape(new ndShapeSphere(0.1f));
+
+    std::vector<ndBodyKinematic*> bodies;
+    for (ndInt32 tree = 0; tree < treeCount; ++tree) {
+      ndSharedPtr<ndBodyKinematic> anchor(new ndBodyDynamic());
+      anchor->SetCollisionShape(ndShapeInstance(new ndShapeBox(1.0f, 1.0f, 1.0f)));
+      ndMatrix anchorMatrix(ndGetIdentityMatrix());
+      anchorMatrix.m_posit.m_y = 20.0f;
+      anchorMatrix.m_posit.m_z = ndFloat32(tree) * 10.0f;
+      anchor->SetMatrix(anchorMatrix);
+      world.AddBody(anchor);
+
+      // a binary tree six levels deep
+      std::vector<ndBodyKinematic*> level(1, *anchor);
+      for (ndInt32 depth = 0; depth < 6; ++depth) {
+        std::vector<ndBodyKinematic*> nextLevel;
+        const ndFloat32 spacing = ndFloat32(1 << (5 - depth)) * 0.5f;
+        for (size_t i = 0; i < level.size(); ++i) {
+          for (ndInt32 j = 0; j < 2; ++j) {
+            ndMatrix matrix(ndGetIdentityMatrix());
+            matrix.m_posit = level[i]->GetMatrix().m_posit;
+            matrix.m_posit.m_x += ndFloat32(j * 2 - 1) * spacing;
+            matrix.m_posit.m_y -= 1.0f;
+            matrix.m_posit.m_z += ndFloat32(j) * 0.25f;
+
+            ndSharedPtr<ndBodyKinematic> body(new ndBodyDynamic());
+            body->SetNotifyCallback(new ndBodyNotify(ndVector(0.0f, -10.0f, 0.0f, 0.0f)));
+            body->SetMatrix(matrix);
+            body->SetCollisionShape(shape);
+            body->GetAsBodyDynamic()->SetMassMatrix(1.0f, shape);
+            world.AddBody(body);
+
+            ndSharedPtr<ndJointBilateralConstraint> joint(new ndJointSpherical(matrix, *body, level[i]));
+            world.AddJoint(joint);
+            nextLevel.push_back(*body);
+            bodies.push_back(*body);
+          }
+        }
+        level = nextLevel;
+      }
+
+      // tie a few neighbor leaves to close some loops
+      for (size_t i = 1; i < level.size(); i += 8) {
+        ndSharedPtr<ndJointBilateralConstraint> tie(new ndJointSpherical(level[i]->GetMatrix(), level[i], level[i + 1]));
+        world.AddJoint(tie);
+      }
+    }
+
+    for (ndInt32 i = 0; i < 60; ++i) {
+      world.Update(1.0f / 60.0f);
+      world.Sync();
+    }
+    isParallel = bodies[0]->GetSkeleton()->IsParallel();
+
+    std::vector<ndVector> positions;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+      positions.push_back(bodies[i]->GetMatrix().m_posit);
+    }
+    ndSkeletonContainer::SetParallelBodyCount(savedCount);
+    return positions;
+  };
+
+  const ndInt32 treeCounts[] = { 1, 8 };
+  for (ndInt32 k = 0; k < 2; ++k) {
+    bool serialIsParallel = true;
+    bool parallelIsParallel = false;
+    const std::vector<ndVector> serial(Simulate(1 << 30, treeCounts[k], serialIsParallel));
+    const std::vector<ndVector> parallel(Simulate(16, treeCounts[k], parallelIsParallel));
+    EXPECT_FALSE(serialIsParallel);
+    EXPECT_TRUE(parallelIsParallel);
+    ASSERT_EQ(serial.size(), parallel.size());
+    for (size_t i = 0; i < serial.size(); ++i) {
+      EXPECT_EQ(serial[i].m_x, parallel[i].m_x);
+      EXPECT_EQ(serial[i].m_y, parallel[i].m_y);
+      EXPECT_EQ(serial[i].m_z, parallel[i].m_z);
+    }
+    EXPECT_TRUE(parallel.back().m_y > 0.0f);
+  }
+}